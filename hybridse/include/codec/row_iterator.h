@@ -17,6 +17,7 @@
 #define HYBRIDSE_INCLUDE_CODEC_ROW_ITERATOR_H_
 
 #include <memory>
+#include <optional>
 #include <string>
 
 #include "base/iterator.h"
@@ -78,6 +79,10 @@ class WindowIterator {
     /// Return the key of current segment of
     /// dataset if Valid() is `true`
     virtual const Row GetKey() = 0;
+    /// Return the version of current segment if Valid() is `true`. The version
+    /// is changed by every change of the rows except appending a row newer than
+    /// all of them. Return `std::nullopt` by default if it isn't tracked.
+    virtual std::optional<uint64_t> GetVersion() { return std::nullopt; }
 };
 }  // namespace codec
 }  // namespace hybridse
@@ -94,6 +94,8 @@ enum SqlNodeType {
     kCreateFunctionStmt,
     kDynamicUdfFnDef,
     kDynamicUdafFnDef,
+    kDiskRowLayout,
+    kCompressType,
     kUnknow = -1
 };
 
@@ -331,6 +333,16 @@ enum StorageMode {
     kHDD = 3,
 };
 
+enum DiskRowLayout {
+    kRowPerIndex = 1,
+    kSingleRow = 2,
+};
+
+enum CompressType {
+    kNoCompress = 0,
+    kDictionary = 2,
+};
+
 // batch plan node type
 enum BatchPlanNodeType { kBatchDataset, kBatchPartition, kBatchMap };
 
@@ -386,6 +386,10 @@ class NodeManager {
 
     SqlNode *MakeStorageModeNode(StorageMode storage_mode);
 
+    SqlNode *MakeDiskRowLayoutNode(DiskRowLayout layout);
+
+    SqlNode *MakeCompressTypeNode(CompressType type);
+
     SqlNode *MakePartitionNumNode(int num);
 
     SqlNode *MakeDistributionsNode(const NodePointVector& distribution_list);
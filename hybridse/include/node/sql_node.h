@@ -311,6 +311,52 @@ inline const StorageMode NameToStorageMode(const std::string& name) {
     }
 }
 
+inline const std::string DiskRowLayoutName(DiskRowLayout layout) {
+    switch (layout) {
+        case kRowPerIndex:
+            return "per_index";
+        case kSingleRow:
+            return "single_row";
+        default:
+            return "unknown";
+    }
+}
+
+// return false if `name` is not a layout
+inline bool NameToDiskRowLayout(const std::string& name, DiskRowLayout* layout) {
+    if (boost::iequals(name, "per_index")) {
+        *layout = kRowPerIndex;
+    } else if (boost::iequals(name, "single_row")) {
+        *layout = kSingleRow;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+inline const std::string CompressTypeName(CompressType type) {
+    switch (type) {
+        case kNoCompress:
+            return "nocompress";
+        case kDictionary:
+            return "dictionary";
+        default:
+            return "unknown";
+    }
+}
+
+// return false if `name` is not a compress type
+inline bool NameToCompressType(const std::string& name, CompressType* type) {
+    if (boost::iequals(name, "nocompress")) {
+        *type = kNoCompress;
+    } else if (boost::iequals(name, "dictionary")) {
+        *type = kDictionary;
+    } else {
+        return false;
+    }
+    return true;
+}
+
 inline const std::string RoleTypeName(RoleType type) {
     switch (type) {
         case kLeader:
@@ -1799,6 +1845,34 @@ class StorageModeNode : public SqlNode {
     StorageMode storage_mode_;
 };
 
+class DiskRowLayoutNode : public SqlNode {
+ public:
+    explicit DiskRowLayoutNode(DiskRowLayout layout) : SqlNode(kDiskRowLayout, 0, 0), layout_(layout) {}
+
+    ~DiskRowLayoutNode() {}
+
+    DiskRowLayout GetLayout() const { return layout_; }
+
+    void Print(std::ostream &output, const std::string &org_tab) const;
+
+ private:
+    DiskRowLayout layout_;
+};
+
+class CompressTypeNode : public SqlNode {
+ public:
+    explicit CompressTypeNode(CompressType type) : SqlNode(kCompressType, 0, 0), type_(type) {}
+
+    ~CompressTypeNode() {}
+
+    CompressType GetCompressType() const { return type_; }
+
+    void Print(std::ostream &output, const std::string &org_tab) const;
+
+ private:
+    CompressType type_;
+};
+
 class CreateStmt : public SqlNode {
  public:
     CreateStmt()
@@ -18,6 +18,7 @@
 #define HYBRIDSE_INCLUDE_VM_CATALOG_H_
 #include <map>
 #include <memory>
+#include <optional>
 #include <set>
 #include <string>
 #include <utility>
@@ -258,6 +259,11 @@ class TableHandler : public DataHandler {
         const std::string& index_name, const std::vector<std::string>& pks) {
         return std::shared_ptr<Tablet>();
     }
+
+    /// Return the version of the dataset, which is changed by every change of
+    /// the rows except appending a row newer than all of them.
+    /// Return `std::nullopt` by default if it isn't tracked.
+    virtual std::optional<uint64_t> GetVersion() { return std::nullopt; }
 };
 
 /// \brief A table dataset's error handler, representing a error table
@@ -369,6 +375,10 @@ class PartitionHandler : public TableHandler {
         return std::shared_ptr<TableHandler>();
     }
 
+    /// Hint that the segments binding to given keys will be read soon, so the
+    /// partition can load them in batch. Do nothing by default.
+    virtual void Prefetch(const std::vector<std::string>& keys) {}
+
     /// Return a sequence of table handles of specify segments binding to given
     /// keys set.
     virtual std::vector<std::shared_ptr<TableHandler>> GetSegments(
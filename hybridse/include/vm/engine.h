@@ -42,6 +42,8 @@ namespace vm {
 using ::hybridse::codec::Row;
 
 inline constexpr const char* LONG_WINDOWS = "long_windows";
+// the max partitions of which the window states are kept across requests
+inline constexpr const char* WINDOW_STATE_CACHE = "window_state_cache";
 
 class Engine;
 /// \brief An options class for controlling engine behaviour.
@@ -120,6 +122,15 @@ class EngineOptions {
     /// Return the maximum number of entries we can hold for compiling cache.
     inline uint32_t GetMaxSqlCacheSize() const { return max_sql_cache_size_; }
 
+    /// Set the number of threads to run batch window and group aggregations on
+    /// partition keys, default is `1`, which runs them on the calling thread.
+    inline EngineOptions* SetBatchAggParallelism(uint32_t parallelism) {
+        batch_agg_parallelism_ = parallelism;
+        return this;
+    }
+    /// Return the number of threads to run batch window and group aggregations.
+    inline uint32_t GetBatchAggParallelism() const { return batch_agg_parallelism_; }
+
     /// Return JitOptions
     inline hybridse::vm::JitOptions& jit_options() { return jit_options_; }
 
@@ -133,6 +144,7 @@ class EngineOptions {
     bool enable_batch_window_parallelization_;
     bool enable_window_column_pruning_;
     uint32_t max_sql_cache_size_;
+    uint32_t batch_agg_parallelism_;
     JitOptions jit_options_;
 };
 
@@ -192,6 +204,21 @@ class RunSession {
     friend Engine;
 };
 
+/// \brief BatchRunCursor iterates the result rows of a batch mode query.
+/// The rows are produced on demand by the runners, the cursor keeps the running
+/// context and compile information alive until it is destroyed.
+class BatchRunCursor {
+ public:
+    BatchRunCursor() {}
+    virtual ~BatchRunCursor() {}
+    /// Return if the cursor points to a valid row.
+    virtual bool Valid() const = 0;
+    /// Return the current row.
+    virtual const Row& GetValue() = 0;
+    /// Move to the next row.
+    virtual void Next() = 0;
+};
+
 /// \brief BatchRunSession is a kind of RunSession designed for batch mode query.
 class BatchRunSession : public RunSession {
  public:
@@ -207,6 +234,11 @@ class BatchRunSession : public RunSession {
     /// Query results will be returned as std::vector<Row> in output
     int32_t Run(std::vector<Row>& output,  // NOLINT
                 uint64_t limit = 0);
+
+    /// \brief Query sql with parameter row in batch mode.
+    /// Query results will be returned by the cursor, so the caller is able
+    /// to consume them without materializing all the rows
+    int32_t Run(const Row& parameter_row, std::unique_ptr<BatchRunCursor>* cursor);
     /// Bing the run session with specific parameter schema
     void SetParameterSchema(const codec::Schema& schema) { parameter_schema_ = schema; }
     /// Return query parameter schema.
@@ -418,6 +450,11 @@ class Engine {
     /// \brief Get engine's options
     EngineOptions GetEngineOptions();
 
+    /// \brief Get the hit and miss count of jit object cache.
+    ///
+    /// Return false if the cache is not enabled in jit options
+    bool GetJitObjectCacheStat(uint64_t* hit_cnt, uint64_t* miss_cnt);
+
  private:
     bool GetDependentTables(const node::PlanNode* node, const std::string& default_db,
                             std::set<std::pair<std::string, std::string>>* db_tables, base::Status& status);  // NOLINT
@@ -101,11 +101,21 @@ class JitOptions {
     bool IsEnablePerf() const { return enable_perf_; }
     void SetEnablePerf(bool flag) { enable_perf_ = flag; }
 
+    /// the directory to keep the compiled objects, empty means disabled
+    const std::string& GetObjectCachePath() const { return object_cache_path_; }
+    void SetObjectCachePath(const std::string& path) { object_cache_path_ = path; }
+
+    /// the max number of compiled objects kept, 0 means unlimited
+    uint32_t GetObjectCacheCapacity() const { return object_cache_capacity_; }
+    void SetObjectCacheCapacity(uint32_t capacity) { object_cache_capacity_ = capacity; }
+
  private:
     bool enable_mcjit_ = false;
     bool enable_vtune_ = false;
     bool enable_gdb_ = false;
     bool enable_perf_ = false;
+    std::string object_cache_path_;
+    uint32_t object_cache_capacity_ = 1000;
 };
 }  // namespace vm
 }  // namespace hybridse
@@ -209,9 +209,9 @@ class MemTimeTableHandler : public TableHandler {
     std::unique_ptr<WindowIterator> GetWindowIterator(
         const std::string& idx_name);
     void AddRow(const uint64_t key, const Row& v);
-    void AddFrontRow(const uint64_t key, const Row& v);
-    void PopBackRow();
-    void PopFrontRow();
+    virtual void AddFrontRow(const uint64_t key, const Row& v);
+    virtual void PopBackRow();
+    virtual void PopFrontRow();
     virtual const std::pair<uint64_t, Row>& GetFrontRow() {
         return table_.front();
     }
@@ -819,8 +819,14 @@ class PhysicalGroupAggrerationNode : public PhysicalProjectNode {
     virtual ~PhysicalGroupAggrerationNode() {}
     static PhysicalGroupAggrerationNode *CastFrom(PhysicalOpNode *node);
     virtual void Print(std::ostream &output, const std::string &tab) const;
+    // the number of threads to aggregate the groups in batch mode
+    uint32_t parallelism() const { return parallelism_; }
+    void set_parallelism(uint32_t parallelism) { parallelism_ = parallelism; }
     ConditionFilter having_condition_;
     Key group_;
+
+ private:
+    uint32_t parallelism_ = 1;
 };
 
 class PhysicalUnionNode;
@@ -1133,6 +1139,9 @@ class PhysicalWindowAggrerationNode : public PhysicalProjectNode {
     const bool exclude_current_row() const { return exclude_current_row_; }
     void set_exclude_current_row(bool flag) { exclude_current_row_ = flag; }
     bool need_append_input() const { return need_append_input_; }
+    // the number of threads to compute the windows of partition keys in batch mode
+    uint32_t parallelism() const { return parallelism_; }
+    void set_parallelism(uint32_t parallelism) { parallelism_ = parallelism; }
 
     WindowOp &window() { return window_; }
     WindowJoinList &window_joins() { return window_joins_; }
@@ -1157,6 +1166,7 @@ class PhysicalWindowAggrerationNode : public PhysicalProjectNode {
     const bool instance_not_in_window_;
     const bool exclude_current_time_;
     bool exclude_current_row_ = false;
+    uint32_t parallelism_ = 1;
 };
 
 class PhysicalJoinNode : public PhysicalBinaryNode {
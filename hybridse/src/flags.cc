@@ -22,3 +22,20 @@ DEFINE_string(default_db_name, "_hybridse",
 // Offline Spark config
 DEFINE_bool(enable_spark_unsaferow_format, false,
             "config if codec uses Spark UnsafeRow format");
+
+// Batch window config
+DEFINE_bool(enable_incremental_window_agg, false,
+            "config if the window aggregations of sum/count/avg/min/max are computed incrementally");
+
+// Request window config
+DEFINE_bool(enable_lazy_request_window, true,
+            "config if the window of request union reads the rows of union segments lazily instead of copying them");
+DEFINE_bool(enable_batch_request_prefetch, true,
+            "config if the request union of batch request prefetches the segments of all request rows in batch");
+DEFINE_uint64(window_state_cache_max_rows, 10000,
+              "config the max rows of a request window whose states are kept by the window_state_cache of deployment");
+
+// Cluster request config
+DEFINE_bool(enable_async_subquery, true,
+            "config if the remote subqueries which don't depend on other subqueries are issued before running the "
+            "main task, so that they are in flight concurrently");
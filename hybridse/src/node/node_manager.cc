@@ -1058,6 +1058,16 @@ SqlNode *NodeManager::MakeStorageModeNode(StorageMode storage_mode) {
     return RegisterNode(node_ptr);
 }
 
+SqlNode *NodeManager::MakeDiskRowLayoutNode(DiskRowLayout layout) {
+    SqlNode *node_ptr = new DiskRowLayoutNode(layout);
+    return RegisterNode(node_ptr);
+}
+
+SqlNode *NodeManager::MakeCompressTypeNode(CompressType type) {
+    SqlNode *node_ptr = new CompressTypeNode(type);
+    return RegisterNode(node_ptr);
+}
+
 SqlNode *NodeManager::MakePartitionNumNode(int num) {
     SqlNode *node_ptr = new PartitionNumNode(num);
     return RegisterNode(node_ptr);
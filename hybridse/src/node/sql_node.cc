@@ -1257,6 +1257,12 @@ std::string NameOfSqlNodeType(const SqlNodeType &type) {
         case kStorageMode:
             output = "kStorageMode";
             break;
+        case kDiskRowLayout:
+            output = "kDiskRowLayout";
+            break;
+        case kCompressType:
+            output = "kCompressType";
+            break;
         case kFn:
             output = "kFn";
             break;
@@ -2665,6 +2671,20 @@ void StorageModeNode::Print(std::ostream &output, const std::string &org_tab) co
     PrintValue(output, tab, StorageModeName(storage_mode_), "storage_mode", true);
 }
 
+void DiskRowLayoutNode::Print(std::ostream &output, const std::string &org_tab) const {
+    SqlNode::Print(output, org_tab);
+    const std::string tab = org_tab + INDENT + SPACE_ED;
+    output << "\n";
+    PrintValue(output, tab, DiskRowLayoutName(layout_), "disk_row_layout", true);
+}
+
+void CompressTypeNode::Print(std::ostream &output, const std::string &org_tab) const {
+    SqlNode::Print(output, org_tab);
+    const std::string tab = org_tab + INDENT + SPACE_ED;
+    output << "\n";
+    PrintValue(output, tab, CompressTypeName(type_), "compress_type", true);
+}
+
 void PartitionNumNode::Print(std::ostream &output, const std::string &org_tab) const {
     SqlNode::Print(output, org_tab);
     const std::string tab = org_tab + INDENT + SPACE_ED;
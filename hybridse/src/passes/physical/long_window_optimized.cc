@@ -32,6 +32,10 @@ static const absl::flat_hash_set<absl::string_view> WHERE_FUNS = {
     "count_where", "sum_where", "avg_where", "min_where", "max_where",
 };
 
+static const absl::flat_hash_set<absl::string_view> CATE_FUNS = {
+    "count_cate", "sum_cate", "avg_cate", "min_cate", "max_cate",
+};
+
 LongWindowOptimized::LongWindowOptimized(PhysicalPlanContext* plan_ctx) : TransformUpPysicalPass(plan_ctx) {
     std::vector<std::string> windows;
     const auto* options = plan_ctx_->GetOptions();
@@ -338,8 +342,10 @@ absl::StatusOr<absl::string_view> CheckCountWhereArgs(const node::ExprNode* righ
 // - min(col)
 // - max(col)
 // - avg(col)
+// - approx_distinct_count(col)
 // - count_where(col, simple_expr)
 // - count_where(*, simple_expr)
+// - {count/sum/avg/min/max}_cate(col, cate_col)
 //
 // simple_expr can be
 // - BinaryExpr
@@ -372,7 +378,19 @@ absl::StatusOr<LongWindowOptimized::AggInfo> LongWindowOptimized::CheckCallExpr(
             absl::StrCat("[Long Window] first arg to op is not column or * :", call->GetExprString()));
     }
 
-    if (call->GetChildNum() == 2) {
+    const auto& fn_name = call->GetFnDef()->GetName();
+    if (fn_name == "approx_distinct_count" && expr_type != node::kExprColumnRef) {
+        return absl::UnimplementedError(absl::StrCat("[Long Window] expect column as arg: ", call->GetExprString()));
+    }
+
+    if (call->GetChildNum() == 2 && CATE_FUNS.contains(fn_name)) {
+        // the category column is the filter column of pre-aggr table
+        if (expr_type != node::kExprColumnRef || call->GetChild(1)->GetExprType() != node::kExprColumnRef) {
+            return absl::UnimplementedError(
+                absl::StrCat("[Long Window] expect value and category as columns: ", call->GetExprString()));
+        }
+        filter_col = dynamic_cast<const node::ColumnRefNode*>(call->GetChild(1))->GetColumnName();
+    } else if (call->GetChildNum() == 2) {
         if (absl::c_none_of(WHERE_FUNS, [&call](absl::string_view e) { return call->GetFnDef()->GetName() == e; })) {
             return absl::UnimplementedError(absl::StrCat(call->GetFnDef()->GetName(), " not implemented"));
         }
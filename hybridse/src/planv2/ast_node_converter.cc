@@ -1716,6 +1716,20 @@ base::Status ConvertTableOption(const zetasql::ASTOptionsEntry* entry, node::Nod
         CHECK_STATUS(AstStringLiteralToString(entry->value(), &storage_mode));
         boost::to_lower(storage_mode);
         *output = node_manager->MakeStorageModeNode(node::NameToStorageMode(storage_mode));
+    } else if (boost::equals("disk_row_layout", identifier)) {
+        std::string layout_name;
+        CHECK_STATUS(AstStringLiteralToString(entry->value(), &layout_name));
+        node::DiskRowLayout layout;
+        CHECK_TRUE(node::NameToDiskRowLayout(layout_name, &layout), common::kSqlAstError,
+                   "disk_row_layout should be per_index or single_row, but got ", layout_name);
+        *output = node_manager->MakeDiskRowLayoutNode(layout);
+    } else if (boost::equals("compress_type", identifier)) {
+        std::string type_name;
+        CHECK_STATUS(AstStringLiteralToString(entry->value(), &type_name));
+        node::CompressType type;
+        CHECK_TRUE(node::NameToCompressType(type_name, &type), common::kSqlAstError,
+                   "compress_type should be nocompress or dictionary, but got ", type_name);
+        *output = node_manager->MakeCompressTypeNode(type);
     } else {
         return base::Status(common::kOk, "create table option ignored");
     }
@@ -649,6 +649,54 @@ TEST_F(PlannerV2Test, CreateTableStmtPlanTest) {
     ASSERT_EQ("column2", table->indexes(0).second_key());
 }
 
+TEST_F(PlannerV2Test, CreateTableDiskRowLayoutTest) {
+    const std::string sql_str =
+        "create table t1 (c1 string, c2 int, c3 timestamp, index(key=c1, ts=c3), index(key=c2, ts=c3)) "
+        "OPTIONS (storage_mode='ssd', disk_row_layout='single_row');";
+    node::PlanNodeList trees;
+    base::Status status;
+    ASSERT_TRUE(plan::PlanAPI::CreatePlanTreeFromScript(sql_str, trees, manager_, status)) << status;
+    ASSERT_EQ(1u, trees.size());
+    auto create_plan = dynamic_cast<node::CreatePlanNode *>(trees[0]);
+    ASSERT_TRUE(create_plan != nullptr);
+    bool has_layout = false;
+    for (auto table_option : create_plan->GetTableOptionList()) {
+        if (table_option->GetType() == node::kDiskRowLayout) {
+            ASSERT_EQ(node::kSingleRow, dynamic_cast<node::DiskRowLayoutNode *>(table_option)->GetLayout());
+            has_layout = true;
+        }
+    }
+    ASSERT_TRUE(has_layout);
+
+    trees.clear();
+    ASSERT_FALSE(plan::PlanAPI::CreatePlanTreeFromScript(
+        "create table t1 (c1 string, c3 timestamp) OPTIONS (disk_row_layout='copy');", trees, manager_, status));
+}
+
+TEST_F(PlannerV2Test, CreateTableCompressTypeTest) {
+    const std::string sql_str =
+        "create table t1 (c1 string, c2 string, c3 timestamp, index(key=c1, ts=c3)) "
+        "OPTIONS (compress_type='Dictionary');";
+    node::PlanNodeList trees;
+    base::Status status;
+    ASSERT_TRUE(plan::PlanAPI::CreatePlanTreeFromScript(sql_str, trees, manager_, status)) << status;
+    ASSERT_EQ(1u, trees.size());
+    auto create_plan = dynamic_cast<node::CreatePlanNode *>(trees[0]);
+    ASSERT_TRUE(create_plan != nullptr);
+    bool has_compress_type = false;
+    for (auto table_option : create_plan->GetTableOptionList()) {
+        if (table_option->GetType() == node::kCompressType) {
+            ASSERT_EQ(node::kDictionary, dynamic_cast<node::CompressTypeNode *>(table_option)->GetCompressType());
+            has_compress_type = true;
+        }
+    }
+    ASSERT_TRUE(has_compress_type);
+
+    trees.clear();
+    ASSERT_FALSE(plan::PlanAPI::CreatePlanTreeFromScript(
+        "create table t1 (c1 string, c3 timestamp) OPTIONS (compress_type='zstd');", trees, manager_, status));
+}
+
 TEST_F(PlannerV2Test, CmdStmtPlanTest) {
     {
         const std::string sql_str = "show databases;";
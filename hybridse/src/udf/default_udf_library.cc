@@ -29,6 +29,7 @@
 #include "codegen/string_ir_builder.h"
 #include "codegen/timestamp_ir_builder.h"
 #include "udf/containers.h"
+#include "udf/sketch.h"
 #include "udf/udf.h"
 #include "udf/udf_registry.h"
 
@@ -532,6 +533,196 @@ struct MaxWhereDef {
     }
 };
 
+// the raw bytes of values feeding the sketches
+template <typename T>
+struct SketchBytesTrait {
+    static std::string ToBytes(T value) {
+        // -0.0 and 0.0 are the same value
+        if (std::is_floating_point<T>::value && value == 0) {
+            value = 0;
+        }
+        return std::string(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    static T FromBytes(const std::string& bytes) {
+        T value;
+        memcpy(&value, bytes.data(), sizeof(T));
+        return value;
+    }
+};
+
+template <>
+struct SketchBytesTrait<Date> {
+    static std::string ToBytes(Date* value) {
+        return SketchBytesTrait<int32_t>::ToBytes(value->date_);
+    }
+    static Date FromBytes(const std::string& bytes) { return Date(SketchBytesTrait<int32_t>::FromBytes(bytes)); }
+};
+
+template <>
+struct SketchBytesTrait<Timestamp> {
+    static std::string ToBytes(Timestamp* value) {
+        return SketchBytesTrait<int64_t>::ToBytes(value->ts_);
+    }
+    static Timestamp FromBytes(const std::string& bytes) {
+        return Timestamp(SketchBytesTrait<int64_t>::FromBytes(bytes));
+    }
+};
+
+template <>
+struct SketchBytesTrait<StringRef> {
+    static std::string ToBytes(StringRef* value) { return std::string(value->data_, value->size_); }
+    // the output refers to `bytes`
+    static StringRef FromBytes(const std::string& bytes) { return StringRef(bytes.size(), bytes.data()); }
+};
+
+template <typename T>
+struct ApproxDistinctCountDef {
+    using ArgT = typename DataTypeTrait<T>::CCallArgType;
+    using SketchT = sketch::HyperLogLog;
+
+    void operator()(UdafRegistryHelper& helper) {  // NOLINT
+        std::string suffix = ".opaque_hll_" + DataTypeTrait<T>::to_string();
+        helper.templates<int64_t, Opaque<SketchT>, Nullable<T>>()
+            .init("approx_distinct_count_init" + suffix, Init)
+            .update("approx_distinct_count_update" + suffix, Update)
+            .output("approx_distinct_count_output" + suffix, Output);
+    }
+
+    static void Init(SketchT* addr) { new (addr) SketchT(); }
+
+    static SketchT* Update(SketchT* sketch, ArgT value, bool is_null) {
+        if (!is_null) {
+            auto bytes = SketchBytesTrait<T>::ToBytes(value);
+            sketch->Add(bytes.data(), bytes.size());
+        }
+        return sketch;
+    }
+
+    static int64_t Output(SketchT* sketch) {
+        int64_t cnt = sketch->Estimate();
+        sketch->~SketchT();
+        return cnt;
+    }
+};
+
+template <typename T>
+struct ApproxPercentileDef {
+    using ArgT = typename DataTypeTrait<T>::CCallArgType;
+    struct ContainerT {
+        sketch::TDigest digest;
+        double percentage = 0;
+    };
+
+    void operator()(UdafRegistryHelper& helper) {  // NOLINT
+        std::string suffix = ".opaque_tdigest_" + DataTypeTrait<T>::to_string();
+        helper.templates<Nullable<double>, Opaque<ContainerT>, Nullable<T>, double>()
+            .init("approx_percentile_init" + suffix, Init)
+            .update("approx_percentile_update" + suffix, Update)
+            .output("approx_percentile_output" + suffix, reinterpret_cast<void*>(Output), true);
+    }
+
+    static void Init(ContainerT* addr) { new (addr) ContainerT(); }
+
+    static ContainerT* Update(ContainerT* container, ArgT value, bool is_null, double percentage) {
+        container->percentage = percentage;
+        if (!is_null) {
+            container->digest.Add(static_cast<double>(value));
+        }
+        return container;
+    }
+
+    static void Output(ContainerT* container, double* ret, bool* is_null) {
+        *is_null = container->digest.Empty() || !(container->percentage >= 0 && container->percentage <= 1);
+        if (!*is_null) {
+            *ret = container->digest.Quantile(container->percentage);
+        }
+        container->~ContainerT();
+    }
+};
+
+template <typename T>
+struct ApproxTopNFrequencyDef {
+    static const size_t MAXIMUM_TOPN = 1024;
+    using ArgT = typename DataTypeTrait<T>::CCallArgType;
+    using StorageT = typename container::ContainerStorageTypeTrait<T>::type;
+    struct ContainerT {
+        sketch::FrequentItems items;
+        int32_t top_n = 0;
+    };
+
+    void operator()(UdafRegistryHelper& helper) {  // NOLINT
+        std::string suffix = ".opaque_count_min_" + DataTypeTrait<T>::to_string();
+        helper.templates<StringRef, Opaque<ContainerT>, Nullable<T>, int32_t>()
+            .init("approx_topn_frequency_init" + suffix, Init)
+            .update("approx_topn_frequency_update" + suffix, Update)
+            .output("approx_topn_frequency_output" + suffix, Output);
+    }
+
+    static void Init(ContainerT* addr) { new (addr) ContainerT(); }
+
+    static ContainerT* Update(ContainerT* container, ArgT value, bool is_null, int32_t top_n) {
+        if (container->top_n != top_n) {
+            container->top_n = top_n;
+            // track more items than output to reduce the error of the estimated order
+            size_t capacity = std::min<size_t>(std::max(top_n, 0), MAXIMUM_TOPN) * 4;
+            container->items.SetCapacity(std::max<size_t>(capacity, 32));
+        }
+        if (!is_null) {
+            container->items.Add(SketchBytesTrait<T>::ToBytes(value));
+        }
+        return container;
+    }
+
+    // the same format as topn_frequency, the keys sorted by frequency and
+    // padded with NULL if there are less than top n keys
+    static void Output(ContainerT* container, StringRef* output) {
+        size_t top_n = std::min<size_t>(std::max(container->top_n, 0), MAXIMUM_TOPN);
+        if (top_n == 0) {
+            output->data_ = "";
+            output->size_ = 0;
+            container->~ContainerT();
+            return;
+        }
+        auto items = container->items.Items();
+        std::vector<std::pair<StorageT, uint64_t>> entries;
+        for (const auto& item : items) {
+            entries.emplace_back(SketchBytesTrait<T>::FromBytes(item.first), item.second);
+        }
+        std::sort(entries.begin(), entries.end(), [](const auto& x, const auto& y) {
+            return x.second > y.second || (x.second == y.second && x.first < y.first);
+        });
+        uint32_t str_len = 0;
+        for (size_t i = 0; i < top_n; ++i) {
+            str_len += i < entries.size() ? v1::to_string_len(entries[i].first) + 1 : 5;
+        }
+        char* buffer = udf::v1::AllocManagedStringBuf(str_len);
+        if (buffer == nullptr) {
+            output->data_ = "";
+            output->size_ = 0;
+            container->~ContainerT();
+            return;
+        }
+        char* cur = buffer;
+        uint32_t remain_space = str_len;
+        for (size_t i = 0; i < top_n; ++i) {
+            uint32_t key_len;
+            if (i < entries.size()) {
+                key_len = v1::format_string(entries[i].first, cur, remain_space);
+            } else {
+                key_len = 4;
+                snprintf(cur, 5, "NULL");  // NOLINT
+            }
+            cur += key_len;
+            *(cur++) = ',';
+            remain_space -= key_len + 1;
+        }
+        *(buffer + str_len - 1) = '\0';
+        output->data_ = buffer;
+        output->size_ = str_len - 1;
+        container->~ContainerT();
+    }
+};
+
 template <typename T>
 struct TopKDef {
     void operator()(UdafRegistryHelper& helper) {  // NOLINT
@@ -2754,6 +2945,81 @@ void DefaultUdfLibrary::InitUdaf() {
         )")
         .args_in<int16_t, int32_t, int64_t, float, double>();
 
+    RegisterUdafTemplate<ApproxDistinctCountDef>("approx_distinct_count")
+        .doc(R"(
+            @brief Compute the approximate number of distinct values by HyperLogLog.
+            It keeps at most 4KB for each window and the standard error is about 1.6%.
+
+            @param value  Specify value column to aggregate on.
+
+            Example:
+
+            |value|
+            |--|
+            |0|
+            |0|
+            |2|
+            |2|
+            |4|
+            @code{.sql}
+                SELECT approx_distinct_count(value) OVER w;
+                -- output 3
+            @endcode
+            @since 0.7.0
+        )")
+        .args_in<bool, int16_t, int32_t, int64_t, float, double, Timestamp, Date, StringRef>();
+
+    RegisterUdafTemplate<ApproxPercentileDef>("approx_percentile")
+        .doc(R"(
+            @brief Compute the approximate percentile of values by t-digest.
+            The result is exact if there are only a few values, and the extreme percentiles
+            are more accurate than the median. Return NULL if there is no value or the
+            percentage is out of [0, 1].
+
+            @param value  Specify value column to aggregate on.
+            @param percentage  The percentage in [0, 1].
+
+            Example:
+
+            |value|
+            |--|
+            |1|
+            |2|
+            |3|
+            |4|
+            @code{.sql}
+                SELECT approx_percentile(value, 0.5) OVER w;
+                -- output 2.5
+            @endcode
+            @since 0.7.0
+        )")
+        .args_in<int16_t, int32_t, int64_t, float, double>();
+
+    RegisterUdafTemplate<ApproxTopNFrequencyDef>("approx_topn_frequency")
+        .doc(R"(
+            @brief Return the approximate topN keys sorted by their frequency, estimated by
+            count-min sketch. The output is the same format as topn_frequency.
+
+            @param value  Specify value column to aggregate on.
+            @param top_n  The number of keys to output.
+
+            Example:
+
+            |value|
+            |--|
+            |1|
+            |2|
+            |2|
+            |3|
+            |3|
+            |3|
+            @code{.sql}
+                SELECT approx_topn_frequency(value, 2) OVER w;
+                -- output "3,2"
+            @endcode
+            @since 0.7.0
+        )")
+        .args_in<int16_t, int32_t, int64_t, float, double, Date, Timestamp, StringRef>();
 
     InitAggByCateUdafs();
 }
@@ -0,0 +1,422 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "udf/sketch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "base/fe_hash.h"
+
+namespace hybridse {
+namespace udf {
+namespace sketch {
+
+static const uint32_t kHashSeed = 0xe17a1465;
+
+template <typename T>
+static void Append(std::string* output, const T& value) {
+    output->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// read a value at `*pos` and move `*pos` after it, return false if out of range
+template <typename T>
+static bool Read(const char* data, uint32_t size, uint32_t* pos, T* value) {
+    if (*pos + sizeof(T) > size) {
+        return false;
+    }
+    memcpy(value, data + *pos, sizeof(T));
+    *pos += sizeof(T);
+    return true;
+}
+
+void HyperLogLog::AddHash(uint64_t hash) {
+    uint32_t idx = hash >> (64 - kPrecision);
+    uint64_t rest = hash << kPrecision;
+    uint8_t rank = rest == 0 ? 64 - kPrecision + 1 : __builtin_clzll(rest) + 1;
+    SetRegister(idx, rank);
+}
+
+void HyperLogLog::Add(const void* data, uint32_t size) {
+    AddHash(base::MurmurHash64A(data, size, kHashSeed));
+}
+
+void HyperLogLog::SetRegister(uint32_t idx, uint8_t rank) {
+    if (!registers_.empty()) {
+        registers_[idx] = std::max(registers_[idx], rank);
+        return;
+    }
+    auto& cur = sparse_[idx];
+    cur = std::max(cur, rank);
+    // the sparse entry costs more bytes than a register
+    if (sparse_.size() > kRegisterCnt / 8) {
+        ToDense();
+    }
+}
+
+void HyperLogLog::ToDense() {
+    registers_.assign(kRegisterCnt, 0);
+    for (const auto& kv : sparse_) {
+        registers_[kv.first] = kv.second;
+    }
+    sparse_.clear();
+}
+
+void HyperLogLog::Merge(const HyperLogLog& other) {
+    if (other.registers_.empty()) {
+        for (const auto& kv : other.sparse_) {
+            SetRegister(kv.first, kv.second);
+        }
+        return;
+    }
+    if (registers_.empty()) {
+        ToDense();
+    }
+    for (uint32_t i = 0; i < kRegisterCnt; i++) {
+        registers_[i] = std::max(registers_[i], other.registers_[i]);
+    }
+}
+
+uint64_t HyperLogLog::Estimate() const {
+    double sum = 0;
+    uint32_t zeros = 0;
+    if (registers_.empty()) {
+        zeros = kRegisterCnt - sparse_.size();
+        sum = zeros;
+        for (const auto& kv : sparse_) {
+            sum += std::ldexp(1.0, -kv.second);
+        }
+    } else {
+        for (auto rank : registers_) {
+            sum += std::ldexp(1.0, -rank);
+            zeros += rank == 0;
+        }
+    }
+    const double m = kRegisterCnt;
+    double alpha = 0.7213 / (1 + 1.079 / m);
+    double estimate = alpha * m * m / sum;
+    // linear counting is more accurate for small cardinalities
+    if (estimate <= 2.5 * m && zeros > 0) {
+        estimate = m * std::log(m / zeros);
+    }
+    return static_cast<uint64_t>(std::llround(estimate));
+}
+
+void HyperLogLog::Serialize(std::string* output) const {
+    output->clear();
+    Append<uint8_t>(output, kPrecision);
+    Append<uint8_t>(output, registers_.empty() ? 0 : 1);
+    if (registers_.empty()) {
+        Append<uint32_t>(output, sparse_.size());
+        for (const auto& kv : sparse_) {
+            Append<uint16_t>(output, kv.first);
+            Append<uint8_t>(output, kv.second);
+        }
+    } else {
+        output->append(reinterpret_cast<const char*>(registers_.data()), registers_.size());
+    }
+}
+
+bool HyperLogLog::Deserialize(const char* data, uint32_t size) {
+    sparse_.clear();
+    registers_.clear();
+    uint32_t pos = 0;
+    uint8_t precision = 0;
+    uint8_t dense = 0;
+    if (!Read(data, size, &pos, &precision) || precision != kPrecision || !Read(data, size, &pos, &dense)) {
+        return false;
+    }
+    if (dense) {
+        if (size - pos != kRegisterCnt) {
+            return false;
+        }
+        registers_.assign(data + pos, data + size);
+        return true;
+    }
+    uint32_t cnt = 0;
+    if (!Read(data, size, &pos, &cnt)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < cnt; i++) {
+        uint16_t idx = 0;
+        uint8_t rank = 0;
+        if (!Read(data, size, &pos, &idx) || !Read(data, size, &pos, &rank) || idx >= kRegisterCnt) {
+            sparse_.clear();
+            return false;
+        }
+        SetRegister(idx, rank);
+    }
+    return true;
+}
+
+void TDigest::Add(double value, double weight) {
+    if (std::isnan(value) || weight <= 0) {
+        return;
+    }
+    if (Empty()) {
+        min_ = max_ = value;
+    } else {
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+    buffer_.push_back({value, weight});
+    buffer_weight_ += weight;
+    if (buffer_.size() >= 5 * compression_) {
+        Compress();
+    }
+}
+
+void TDigest::Merge(const TDigest& other) {
+    if (other.Empty()) {
+        return;
+    }
+    if (Empty()) {
+        min_ = other.min_;
+        max_ = other.max_;
+    } else {
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+    for (const auto* list : {&other.centroids_, &other.buffer_}) {
+        for (const auto& c : *list) {
+            buffer_.push_back(c);
+            buffer_weight_ += c.weight;
+        }
+    }
+    Compress();
+}
+
+// merge the sorted centroids while the quantile range of a centroid is small
+// enough by the k1 scale function k(q) = compression / (2 * pi) * asin(2q - 1),
+// so the centroids near q = 0 or q = 1 keep only a few values
+void TDigest::Compress() {
+    if (buffer_.empty()) {
+        return;
+    }
+    std::vector<Centroid> all;
+    all.reserve(centroids_.size() + buffer_.size());
+    all.insert(all.end(), centroids_.begin(), centroids_.end());
+    all.insert(all.end(), buffer_.begin(), buffer_.end());
+    std::sort(all.begin(), all.end(), [](const Centroid& l, const Centroid& r) { return l.mean < r.mean; });
+    double total = total_weight_ + buffer_weight_;
+    auto q_limit = [&](double q) {
+        double k = compression_ / (2 * M_PI) * std::asin(std::min(1.0, std::max(-1.0, 2 * q - 1)));
+        double angle = std::min((k + 1) * 2 * M_PI / compression_, M_PI / 2);
+        return (std::sin(angle) + 1) / 2;
+    };
+    centroids_.clear();
+    Centroid cur = all[0];
+    double q0 = 0;
+    double limit = q_limit(q0);
+    for (size_t i = 1; i < all.size(); i++) {
+        const auto& c = all[i];
+        if (q0 + (cur.weight + c.weight) / total <= limit) {
+            cur.mean += (c.mean - cur.mean) * c.weight / (cur.weight + c.weight);
+            cur.weight += c.weight;
+        } else {
+            centroids_.push_back(cur);
+            q0 += cur.weight / total;
+            limit = q_limit(q0);
+            cur = c;
+        }
+    }
+    centroids_.push_back(cur);
+    total_weight_ = total;
+    buffer_.clear();
+    buffer_weight_ = 0;
+}
+
+double TDigest::Quantile(double q) {
+    Compress();
+    if (centroids_.empty()) {
+        return 0;
+    }
+    if (centroids_.size() == 1) {
+        return centroids_[0].mean;
+    }
+    q = std::min(1.0, std::max(0.0, q));
+    // the value of a centroid is at the middle of its weight, interpolate between
+    // the neighbour centroids, or the centroid and min/max at the tails
+    double target = q * total_weight_;
+    const auto& first = centroids_.front();
+    if (target < first.weight / 2) {
+        return min_ + (first.mean - min_) * target / (first.weight / 2);
+    }
+    double cum = 0;
+    for (size_t i = 0; i + 1 < centroids_.size(); i++) {
+        const auto& c = centroids_[i];
+        const auto& next = centroids_[i + 1];
+        double center = cum + c.weight / 2;
+        double next_center = cum + c.weight + next.weight / 2;
+        if (target <= next_center) {
+            return c.mean + (next.mean - c.mean) * (target - center) / (next_center - center);
+        }
+        cum += c.weight;
+    }
+    const auto& last = centroids_.back();
+    double center = total_weight_ - last.weight / 2;
+    return last.mean + (max_ - last.mean) * (target - center) / (last.weight / 2);
+}
+
+void TDigest::Serialize(std::string* output) {
+    Compress();
+    output->clear();
+    Append<double>(output, compression_);
+    Append<double>(output, min_);
+    Append<double>(output, max_);
+    Append<uint32_t>(output, centroids_.size());
+    for (const auto& c : centroids_) {
+        Append<double>(output, c.mean);
+        Append<double>(output, c.weight);
+    }
+}
+
+bool TDigest::Deserialize(const char* data, uint32_t size) {
+    centroids_.clear();
+    buffer_.clear();
+    total_weight_ = 0;
+    buffer_weight_ = 0;
+    uint32_t pos = 0;
+    uint32_t cnt = 0;
+    if (!Read(data, size, &pos, &compression_) || !Read(data, size, &pos, &min_) || !Read(data, size, &pos, &max_) ||
+        !Read(data, size, &pos, &cnt)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < cnt; i++) {
+        Centroid c;
+        if (!Read(data, size, &pos, &c.mean) || !Read(data, size, &pos, &c.weight)) {
+            centroids_.clear();
+            total_weight_ = 0;
+            return false;
+        }
+        centroids_.push_back(c);
+        total_weight_ += c.weight;
+    }
+    return true;
+}
+
+void FrequentItems::SetCapacity(uint32_t capacity) {
+    capacity_ = capacity;
+    while (items_.size() > capacity_) {
+        items_.erase(ordered_.begin()->second);
+        ordered_.erase(ordered_.begin());
+    }
+}
+
+uint64_t FrequentItems::Update(const std::string& item, uint64_t cnt) {
+    uint64_t hash = base::MurmurHash64A(item.data(), item.size(), kHashSeed);
+    uint32_t h1 = hash;
+    uint32_t h2 = hash >> 32;
+    uint64_t estimate = UINT64_MAX;
+    for (uint32_t i = 0; i < kDepth; i++) {
+        auto& count = counts_[i * kWidth + (h1 + i * h2) % kWidth];
+        count = std::min<uint64_t>(UINT32_MAX, count + cnt);
+        estimate = std::min<uint64_t>(estimate, count);
+    }
+    return estimate;
+}
+
+void FrequentItems::Track(const std::string& item, uint64_t estimate) {
+    auto it = items_.find(item);
+    if (it != items_.end()) {
+        ordered_.erase({it->second, item});
+        it->second = estimate;
+        ordered_.insert({estimate, item});
+        return;
+    }
+    if (items_.size() >= capacity_) {
+        if (ordered_.empty() || estimate <= ordered_.begin()->first) {
+            return;
+        }
+        items_.erase(ordered_.begin()->second);
+        ordered_.erase(ordered_.begin());
+    }
+    items_.emplace(item, estimate);
+    ordered_.insert({estimate, item});
+}
+
+void FrequentItems::Add(const std::string& item, uint64_t cnt) { Track(item, Update(item, cnt)); }
+
+void FrequentItems::Merge(const FrequentItems& other) {
+    for (size_t i = 0; i < counts_.size(); i++) {
+        counts_[i] = std::min<uint64_t>(UINT32_MAX, static_cast<uint64_t>(counts_[i]) + other.counts_[i]);
+    }
+    capacity_ = std::max(capacity_, other.capacity_);
+    // re-estimate the tracked items of both sides by the merged counts
+    std::vector<std::string> candidates;
+    for (const auto& kv : items_) {
+        candidates.push_back(kv.first);
+    }
+    for (const auto& kv : other.items_) {
+        candidates.push_back(kv.first);
+    }
+    items_.clear();
+    ordered_.clear();
+    for (const auto& item : candidates) {
+        Track(item, Update(item, 0));
+    }
+}
+
+std::vector<std::pair<std::string, uint64_t>> FrequentItems::Items() const {
+    std::vector<std::pair<std::string, uint64_t>> items;
+    for (auto it = ordered_.rbegin(); it != ordered_.rend(); ++it) {
+        items.emplace_back(it->second, it->first);
+    }
+    return items;
+}
+
+void FrequentItems::Serialize(std::string* output) const {
+    output->clear();
+    Append<uint32_t>(output, capacity_);
+    output->append(reinterpret_cast<const char*>(counts_.data()), counts_.size() * sizeof(uint32_t));
+    Append<uint32_t>(output, items_.size());
+    for (const auto& kv : items_) {
+        Append<uint32_t>(output, kv.first.size());
+        output->append(kv.first);
+    }
+}
+
+bool FrequentItems::Deserialize(const char* data, uint32_t size) {
+    items_.clear();
+    ordered_.clear();
+    uint32_t pos = 0;
+    if (!Read(data, size, &pos, &capacity_) || pos + counts_.size() * sizeof(uint32_t) > size) {
+        return false;
+    }
+    memcpy(counts_.data(), data + pos, counts_.size() * sizeof(uint32_t));
+    pos += counts_.size() * sizeof(uint32_t);
+    uint32_t cnt = 0;
+    if (!Read(data, size, &pos, &cnt)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < cnt; i++) {
+        uint32_t len = 0;
+        if (!Read(data, size, &pos, &len) || pos + len > size) {
+            items_.clear();
+            ordered_.clear();
+            return false;
+        }
+        std::string item(data + pos, len);
+        pos += len;
+        Track(item, Update(item, 0));
+    }
+    return true;
+}
+
+}  // namespace sketch
+}  // namespace udf
+}  // namespace hybridse
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_SRC_UDF_SKETCH_H_
+#define HYBRIDSE_SRC_UDF_SKETCH_H_
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace hybridse {
+namespace udf {
+namespace sketch {
+
+// The sketches keep a summary of values in bounded memory. All of them can be
+// serialized into a string and merged with another sketch, so the partial
+// sketches of buckets, e.g. pre-aggregation, are combined into the sketch of
+// the whole window.
+
+// HyperLogLog estimates the number of distinct values with 2^kPrecision
+// registers, the standard error is about 1.6%. The registers are kept sparse
+// until enough of them are set.
+class HyperLogLog {
+ public:
+    static constexpr uint32_t kPrecision = 12;
+    static constexpr uint32_t kRegisterCnt = 1 << kPrecision;
+
+    HyperLogLog() {}
+
+    void AddHash(uint64_t hash);
+    void Add(const void* data, uint32_t size);
+    void Merge(const HyperLogLog& other);
+    uint64_t Estimate() const;
+
+    void Serialize(std::string* output) const;
+    bool Deserialize(const char* data, uint32_t size);
+
+ private:
+    void SetRegister(uint32_t idx, uint8_t rank);
+    void ToDense();
+
+    // index -> rank, used before the registers are dense
+    std::unordered_map<uint16_t, uint8_t> sparse_;
+    std::vector<uint8_t> registers_;
+};
+
+// TDigest estimates the quantiles by merging the values into centroids, the
+// centroids at the tails are smaller so the extreme quantiles are accurate.
+// The quantiles are exact if there are only a few values.
+class TDigest {
+ public:
+    explicit TDigest(double compression = 100) : compression_(compression) {}
+
+    void Add(double value, double weight = 1);
+    void Merge(const TDigest& other);
+    // return the value at quantile `q` in [0, 1], 0 if empty
+    double Quantile(double q);
+    double Count() const { return total_weight_ + buffer_weight_; }
+    bool Empty() const { return Count() == 0; }
+
+    void Serialize(std::string* output);
+    bool Deserialize(const char* data, uint32_t size);
+
+ private:
+    struct Centroid {
+        double mean;
+        double weight;
+    };
+    void Compress();
+
+    double compression_;
+    double min_ = 0;
+    double max_ = 0;
+    std::vector<Centroid> centroids_;
+    double total_weight_ = 0;
+    // the values not merged into centroids
+    std::vector<Centroid> buffer_;
+    double buffer_weight_ = 0;
+};
+
+// FrequentItems estimates the counts of items by a count-min sketch and keeps
+// the `capacity` items with the largest estimated counts. The items are the raw
+// bytes of values.
+class FrequentItems {
+ public:
+    static constexpr uint32_t kDepth = 4;
+    static constexpr uint32_t kWidth = 512;
+
+    FrequentItems() : counts_(kDepth * kWidth, 0) {}
+
+    void SetCapacity(uint32_t capacity);
+    uint32_t GetCapacity() const { return capacity_; }
+    void Add(const std::string& item, uint64_t cnt = 1);
+    void Merge(const FrequentItems& other);
+    // the items sorted by estimated counts in descending order
+    std::vector<std::pair<std::string, uint64_t>> Items() const;
+
+    void Serialize(std::string* output) const;
+    bool Deserialize(const char* data, uint32_t size);
+
+ private:
+    uint64_t Update(const std::string& item, uint64_t cnt);
+    void Track(const std::string& item, uint64_t estimate);
+
+    uint32_t capacity_ = 0;
+    std::vector<uint32_t> counts_;
+    // the tracked items ordered by estimated counts
+    std::unordered_map<std::string, uint64_t> items_;
+    std::set<std::pair<uint64_t, std::string>> ordered_;
+};
+
+}  // namespace sketch
+}  // namespace udf
+}  // namespace hybridse
+#endif  // HYBRIDSE_SRC_UDF_SKETCH_H_
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "udf/sketch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace hybridse {
+namespace udf {
+namespace sketch {
+
+class SketchTest : public ::testing::Test {};
+
+TEST_F(SketchTest, HyperLogLogTest) {
+    for (int64_t n : {0, 1, 100, 1000, 100000}) {
+        HyperLogLog all;
+        HyperLogLog parts[3];
+        for (int64_t i = 0; i < n; i++) {
+            all.Add(&i, sizeof(i));
+            parts[i % 3].Add(&i, sizeof(i));
+            // duplicated values are not counted
+            parts[(i + 1) % 3].Add(&i, sizeof(i));
+        }
+        ASSERT_NEAR(n, all.Estimate(), n * 0.05) << n;
+
+        HyperLogLog merged;
+        for (auto& part : parts) {
+            std::string buf;
+            part.Serialize(&buf);
+            HyperLogLog decoded;
+            ASSERT_TRUE(decoded.Deserialize(buf.data(), buf.size()));
+            merged.Merge(decoded);
+        }
+        ASSERT_EQ(all.Estimate(), merged.Estimate()) << n;
+    }
+    HyperLogLog hll;
+    ASSERT_FALSE(hll.Deserialize("abc", 3));
+}
+
+TEST_F(SketchTest, TDigestTest) {
+    TDigest small;
+    for (double v : {3.0, 1.0, 4.0, 2.0}) {
+        small.Add(v);
+    }
+    ASSERT_DOUBLE_EQ(1.0, small.Quantile(0));
+    ASSERT_DOUBLE_EQ(2.5, small.Quantile(0.5));
+    ASSERT_DOUBLE_EQ(4.0, small.Quantile(1));
+
+    std::mt19937 rng(7);
+    std::normal_distribution<double> dist(0, 1);
+    std::vector<double> values;
+    TDigest all;
+    TDigest parts[4];
+    for (int i = 0; i < 100000; i++) {
+        double v = dist(rng);
+        values.push_back(v);
+        all.Add(v);
+        parts[i % 4].Add(v);
+    }
+    std::sort(values.begin(), values.end());
+    TDigest merged;
+    for (auto& part : parts) {
+        std::string buf;
+        part.Serialize(&buf);
+        TDigest decoded;
+        ASSERT_TRUE(decoded.Deserialize(buf.data(), buf.size()));
+        merged.Merge(decoded);
+    }
+    ASSERT_DOUBLE_EQ(all.Count(), merged.Count());
+    for (double q : {0.0, 0.01, 0.1, 0.5, 0.9, 0.99, 1.0}) {
+        double expect = values[std::min<size_t>(values.size() - 1, q * values.size())];
+        ASSERT_NEAR(expect, all.Quantile(q), 0.02) << q;
+        ASSERT_NEAR(expect, merged.Quantile(q), 0.02) << q;
+    }
+}
+
+TEST_F(SketchTest, FrequentItemsTest) {
+    FrequentItems all;
+    FrequentItems parts[2];
+    all.SetCapacity(16);
+    parts[0].SetCapacity(16);
+    parts[1].SetCapacity(16);
+    // item i appears 1000 / i times
+    for (int i = 1; i <= 1000; i++) {
+        std::string item = "item" + std::to_string(i);
+        for (int j = 0; j < 1000 / i; j++) {
+            all.Add(item);
+            parts[j % 2].Add(item);
+        }
+    }
+    auto items = all.Items();
+    ASSERT_EQ(16u, items.size());
+    for (int i = 1; i <= 5; i++) {
+        ASSERT_EQ("item" + std::to_string(i), items[i - 1].first);
+        ASSERT_GE(items[i - 1].second, 1000u / i);
+    }
+
+    std::string buf;
+    parts[1].Serialize(&buf);
+    FrequentItems decoded;
+    ASSERT_TRUE(decoded.Deserialize(buf.data(), buf.size()));
+    parts[0].Merge(decoded);
+    auto merged = parts[0].Items();
+    for (int i = 0; i < 5; i++) {
+        ASSERT_EQ(items[i], merged[i]);
+    }
+    ASSERT_FALSE(decoded.Deserialize(buf.data(), 10));
+}
+
+}  // namespace sketch
+}  // namespace udf
+}  // namespace hybridse
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -122,6 +122,48 @@ TEST_F(UdafTest, MedianTest) {
     CheckUdafOneParam<Nullable<double>, Nullable<double>>("median", 3.0, {1.0, 5.0, 2.0, 4.0, 3.0});
 }
 
+TEST_F(UdafTest, ApproxDistinctCountTest) {
+    CheckUdafOneParam<int64_t, Nullable<int32_t>>("approx_distinct_count", 0, {});
+    CheckUdafOneParam<int64_t, Nullable<int32_t>>("approx_distinct_count", 0, {nullptr});
+    CheckUdafOneParam<int64_t, Nullable<int32_t>>("approx_distinct_count", 3, {0, 0, 2, 2, 4, nullptr});
+    CheckUdafOneParam<int64_t, Nullable<double>>("approx_distinct_count", 2, {0.0, -0.0, 1.5});
+    CheckUdafOneParam<int64_t, Nullable<StringRef>>("approx_distinct_count", 2,
+                                                    {StringRef("a"), StringRef("bc"), StringRef("a")});
+}
+
+TEST_F(UdafTest, ApproxPercentileTest) {
+    CheckUdf<Nullable<double>, ListRef<Nullable<int32_t>>, ListRef<double>>(
+        "approx_percentile", nullptr, MakeList<Nullable<int32_t>>({}), MakeList<double>({}));
+    CheckUdf<Nullable<double>, ListRef<Nullable<int32_t>>, ListRef<double>>(
+        "approx_percentile", nullptr, MakeList<Nullable<int32_t>>({nullptr}), MakeList<double>({0.5}));
+    // exact if there are only a few values
+    CheckUdf<Nullable<double>, ListRef<Nullable<int32_t>>, ListRef<double>>(
+        "approx_percentile", 2.5, MakeList<Nullable<int32_t>>({1, 3, nullptr, 2, 4}),
+        MakeList<double>({0.5, 0.5, 0.5, 0.5, 0.5}));
+    CheckUdf<Nullable<double>, ListRef<double>, ListRef<double>>(
+        "approx_percentile", 4.0, MakeList<double>({1.0, 3.0, 2.0, 4.0}), MakeList<double>({1, 1, 1, 1}));
+    CheckUdf<Nullable<double>, ListRef<int64_t>, ListRef<double>>(
+        "approx_percentile", 1.0, MakeList<int64_t>({3, 1, 2}), MakeList<double>({0, 0, 0}));
+    CheckUdf<Nullable<double>, ListRef<int64_t>, ListRef<double>>(
+        "approx_percentile", nullptr, MakeList<int64_t>({3, 1, 2}), MakeList<double>({2, 2, 2}));
+}
+
+TEST_F(UdafTest, ApproxTopNFrequencyTest) {
+    CheckUdf<StringRef, ListRef<Nullable<int32_t>>, ListRef<int32_t>>(
+        "approx_topn_frequency", StringRef("3,2"), MakeList<Nullable<int32_t>>({1, 2, 2, 3, 3, 3, nullptr}),
+        MakeList<int32_t>({2, 2, 2, 2, 2, 2, 2}));
+    // keys of the same frequency are sorted in ascending order
+    CheckUdf<StringRef, ListRef<StringRef>, ListRef<int32_t>>(
+        "approx_topn_frequency", StringRef("b,a,c"),
+        MakeList<StringRef>({StringRef("c"), StringRef("b"), StringRef("a"), StringRef("b")}),
+        MakeList<int32_t>({3, 3, 3, 3}));
+    CheckUdf<StringRef, ListRef<Date>, ListRef<int32_t>>(
+        "approx_topn_frequency", StringRef("1900-01-01,NULL"), MakeList<Date>({Date(1), Date(1)}),
+        MakeList<int32_t>({2, 2}));
+    CheckUdf<StringRef, ListRef<int32_t>, ListRef<int32_t>>("approx_topn_frequency", StringRef(""),
+                                                            MakeList<int32_t>({}), MakeList<int32_t>({}));
+}
+
 TEST_F(UdafTest, SumWhereTest) {
     CheckUdf<int32_t, ListRef<int32_t>, ListRef<bool>>(
         "sum_where", 10, MakeList<int32_t>({4, 5, 6}),
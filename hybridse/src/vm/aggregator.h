@@ -18,14 +18,22 @@
 #define HYBRIDSE_SRC_VM_AGGREGATOR_H_
 
 #include <algorithm>
+#include <functional>
 #include <limits>
+#include <map>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 #include <boost/algorithm/string/compare.hpp>
 
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
 #include "codec/fe_row_codec.h"
 #include "codec/row.h"
 #include "proto/fe_type.pb.h"
+#include "udf/sketch.h"
+#include "udf/udf.h"
 
 namespace hybridse {
 namespace vm {
@@ -368,6 +376,208 @@ class MaxAggregator : public Aggregator<T> {
     }
 };
 
+// ApproxDistinctCountAggregator merges the HyperLogLog sketches of pre-aggr rows, the values of base rows
+// are added by the bytes of their storage types
+class ApproxDistinctCountAggregator : public BaseAggregator {
+ public:
+    ApproxDistinctCountAggregator(type::Type type, const Schema& output_schema)
+        : BaseAggregator(type, output_schema) {}
+
+    void Update(const std::string& bval) override {
+        udf::sketch::HyperLogLog sketch;
+        if (!sketch.Deserialize(bval.data(), bval.size())) {
+            LOG(ERROR) << "encoded aggr val is not valid";
+            return;
+        }
+        sketch_.Merge(sketch);
+    }
+
+    void UpdateBytes(const void* data, uint32_t size) {
+        sketch_.Add(data, size);
+    }
+
+    bool IsNull() const override {
+        return false;
+    }
+
+    Row Output() override {
+        uint32_t total_len = this->row_builder_.CalTotalLength(0);
+        int8_t* buf = static_cast<int8_t*>(malloc(total_len));
+        this->row_builder_.SetBuffer(buf, total_len);
+        this->row_builder_.AppendInt64(sketch_.Estimate());
+        Reset();
+        return Row(base::RefCountedSlice::CreateManaged(buf, total_len));
+    }
+
+    void Reset() override {
+        BaseAggregator::Reset();
+        sketch_ = udf::sketch::HyperLogLog();
+    }
+
+ private:
+    udf::sketch::HyperLogLog sketch_;
+};
+
+// CateAggregator keeps an aggregator per category and outputs 'K:V' separated by comma, the same as
+// the *_cate udafs. The categories are in the string form of the filter key of pre-aggr rows, i.e.
+// integers and timestamps in digits, dates as 'year-month-day' and bools as 'true' or 'false'. They are
+// ordered by value and formatted as the udafs in output.
+class CateAggregator : public BaseAggregator {
+ public:
+    using Factory = std::function<std::unique_ptr<BaseAggregator>()>;
+
+    CateAggregator(type::Type type, type::Type cate_type, const Schema& output_schema, Factory factory)
+        : BaseAggregator(type, output_schema),
+          cate_type_(cate_type),
+          factory_(std::move(factory)),
+          cates_(CateLess{cate_type}) {}
+
+    // the category is required
+    void Update(const std::string& bval) override {
+        LOG(ERROR) << "category is required for *_cate aggregator";
+    }
+
+    void UpdateCate(const std::string& cate, const std::string& bval) {
+        GetCate(cate)->Update(bval);
+    }
+
+    // return the aggregator of category, created if not exists
+    BaseAggregator* GetCate(const std::string& cate) {
+        auto it = cates_.find(cate);
+        if (it == cates_.end()) {
+            it = cates_.emplace(cate, factory_()).first;
+        }
+        return it->second.get();
+    }
+
+    bool IsNull() const override {
+        return false;
+    }
+
+    Row Output() override {
+        std::string output;
+        for (auto& kv : cates_) {
+            if (kv.second->IsNull()) {
+                continue;
+            }
+            if (!output.empty()) {
+                output.append(",");
+            }
+            output.append(FormatCate(cate_type_, kv.first)).append(":").append(FormatValue(kv.second.get()));
+        }
+        uint32_t total_len = this->row_builder_.CalTotalLength(output.size());
+        int8_t* buf = static_cast<int8_t*>(malloc(total_len));
+        this->row_builder_.SetBuffer(buf, total_len);
+        this->row_builder_.AppendString(output.data(), output.size());
+        Reset();
+        return Row(base::RefCountedSlice::CreateManaged(buf, total_len));
+    }
+
+    void Reset() override {
+        BaseAggregator::Reset();
+        cates_.clear();
+    }
+
+ private:
+    // parse the category of non-string type into a value of the same order, return false if it is malformed
+    static bool ParseCate(type::Type cate_type, const std::string& cate, int64_t* val) {
+        switch (cate_type) {
+            case type::kBool:
+                if (cate == "true" || cate == "false") {
+                    *val = cate == "true";
+                    return true;
+                }
+                return false;
+            case type::kInt16:
+            case type::kInt32:
+            case type::kInt64:
+            case type::kTimestamp:
+                return absl::SimpleAtoi(cate, val);
+            case type::kDate: {
+                std::vector<std::string> parts = absl::StrSplit(cate, '-');
+                int32_t year = 0;
+                int32_t month = 0;
+                int32_t day = 0;
+                if (parts.size() != 3 || !absl::SimpleAtoi(parts[0], &year) || !absl::SimpleAtoi(parts[1], &month) ||
+                    !absl::SimpleAtoi(parts[2], &day)) {
+                    return false;
+                }
+                *val = openmldb::base::Date(year, month, day).date_;
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+
+    static std::string FormatCate(type::Type cate_type, const std::string& cate) {
+        int64_t val = 0;
+        if ((cate_type != type::kTimestamp && cate_type != type::kDate) || !ParseCate(cate_type, cate, &val)) {
+            return cate;
+        }
+        char buf[64];
+        uint32_t len = 0;
+        if (cate_type == type::kTimestamp) {
+            len = udf::v1::format_string(openmldb::base::Timestamp(val), buf, sizeof(buf));
+        } else {
+            len = udf::v1::format_string(openmldb::base::Date(static_cast<int32_t>(val)), buf, sizeof(buf));
+        }
+        return std::string(buf, std::min<size_t>(len, sizeof(buf) - 1));
+    }
+
+    // the malformed categories, e.g. the empty category of null filter key, are ordered after the others
+    // by string
+    struct CateLess {
+        type::Type cate_type;
+        bool operator()(const std::string& lhs, const std::string& rhs) const {
+            if (cate_type == type::kVarchar) {
+                return lhs < rhs;
+            }
+            int64_t lval = 0;
+            int64_t rval = 0;
+            bool lok = ParseCate(cate_type, lhs, &lval);
+            bool rok = ParseCate(cate_type, rhs, &rval);
+            if (lok && rok) {
+                return lval < rval;
+            }
+            if (lok != rok) {
+                return lok;
+            }
+            return lhs < rhs;
+        }
+    };
+
+    template <class T>
+    static std::string Format(BaseAggregator* aggregator) {
+        T val = dynamic_cast<Aggregator<T>*>(aggregator)->val();
+        char buf[64];
+        uint32_t len = udf::v1::format_string(val, buf, sizeof(buf));
+        return std::string(buf, std::min<size_t>(len, sizeof(buf) - 1));
+    }
+
+    static std::string FormatValue(BaseAggregator* aggregator) {
+        switch (aggregator->GetRepType()) {
+            case type::kInt16:
+                return Format<int16_t>(aggregator);
+            case type::kInt32:
+                return Format<int32_t>(aggregator);
+            case type::kInt64:
+                return Format<int64_t>(aggregator);
+            case type::kFloat:
+                return Format<float>(aggregator);
+            case type::kDouble:
+                return Format<double>(aggregator);
+            default:
+                LOG(ERROR) << "ERROR: unsupport type " << Type_Name(aggregator->GetRepType());
+                return "";
+        }
+    }
+
+    const type::Type cate_type_;
+    Factory factory_;
+    std::map<std::string, std::unique_ptr<BaseAggregator>, CateLess> cates_;
+};
+
 template <template<class> class AggregatorClass>
 std::unique_ptr<BaseAggregator> MakeOverflowAggregator(type::Type agg_col_type, const Schema& output_schema) {
     switch (agg_col_type) {
@@ -14,6 +14,9 @@
 * limitations under the License.
 */
 
+#include <string>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "proto/fe_type.pb.h"
 #include "vm/aggregator.h"
@@ -550,6 +553,39 @@ TEST_F(AggregatorVMTest, NullTest) {
     check_null(aggregator.get());
 }
 
+TEST_F(AggregatorVMTest, CateTest) {
+    codec::Schema value_schema;
+    auto column = value_schema.Add();
+    column->set_type(type::kInt64);
+    column->set_name("val");
+    codec::Schema schema;
+    column = schema.Add();
+    column->set_type(type::kVarchar);
+    column->set_name("val");
+    codec::RowView row_view(schema);
+
+    auto output = [&](type::Type cate_type, const std::vector<std::string>& cates) {
+        CateAggregator aggregator(type::kInt64, cate_type, schema, [&value_schema]() {
+            return std::make_unique<CountAggregator>(type::kInt64, value_schema);
+        });
+        for (const auto& cate : cates) {
+            dynamic_cast<CountAggregator*>(aggregator.GetCate(cate))->UpdateValue(1);
+        }
+        Row row = aggregator.Output();
+        row_view.Reset(row.buf());
+        const char* val = nullptr;
+        uint32_t len = 0;
+        row_view.GetString(0, &val, &len);
+        return std::string(val, len);
+    };
+    EXPECT_EQ("-1:1,9:2,10:1", output(type::kInt32, {"10", "9", "-1", "9"}));
+    // the malformed categories are ordered after the others instead of failing
+    EXPECT_EQ("9:1,10:1,:1,x:1", output(type::kInt64, {"x", "10", "", "9"}));
+    EXPECT_EQ("false:1,true:2", output(type::kBool, {"true", "false", "true"}));
+    EXPECT_EQ("2022-01-05:1,2022-01-10:1", output(type::kDate, {"2022-1-10", "2022-1-5"}));
+    EXPECT_EQ("a:1,b:1", output(type::kVarchar, {"b", "a"}));
+}
+
 }  // namespace vm
 }  // namespace hybridse
 
@@ -15,6 +15,7 @@
  */
 
 #include "vm/engine.h"
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -28,6 +29,7 @@
 #include "gflags/gflags.h"
 #include "llvm-c/Target.h"
 #include "udf/default_udf_library.h"
+#include "vm/jit_object_cache.h"
 #include "vm/local_tablet_handler.h"
 #include "vm/mem_catalog.h"
 #include "vm/sql_compiler.h"
@@ -48,7 +50,8 @@ EngineOptions::EngineOptions()
       enable_expr_optimize_(true),
       enable_batch_window_parallelization_(false),
       enable_window_column_pruning_(false),
-      max_sql_cache_size_(50) {
+      max_sql_cache_size_(50),
+      batch_agg_parallelism_(1) {
 }
 
 Engine::Engine(const std::shared_ptr<Catalog>& catalog) : cl_(catalog), options_(), mu_(), lru_cache_() {}
@@ -224,6 +227,7 @@ bool Engine::Get(const std::string& sql, const std::string& db, RunSession& sess
     sql_context.enable_batch_window_parallelization = options_.IsEnableBatchWindowParallelization();
     sql_context.enable_window_column_pruning = options_.IsEnableWindowColumnPruning();
     sql_context.enable_expr_optimize = options_.IsEnableExprOptimize();
+    sql_context.batch_agg_parallelism = options_.GetBatchAggParallelism();
     sql_context.jit_options = options_.jit_options();
     sql_context.options = session.GetOptions();
     if (session.engine_mode() == kBatchMode) {
@@ -301,6 +305,7 @@ bool Engine::Explain(const std::string& sql, const std::string& db, EngineMode e
     ctx.parameter_types = parameter_schema;
     ctx.is_cluster_optimized = options_.IsClusterOptimzied();
     ctx.is_batch_request_optimized = !common_column_indices.empty();
+    ctx.batch_agg_parallelism = options_.GetBatchAggParallelism();
     ctx.batch_request_info.common_column_indices = common_column_indices;
     SqlCompiler compiler(std::atomic_load_explicit(&cl_, std::memory_order_acquire), true, true, true);
     bool ok = compiler.Compile(ctx, *status);
@@ -370,6 +375,12 @@ void Engine::ClearCacheLocked(const std::string& db) {
     std::lock_guard<base::SpinMutex> lock(mu_);
     if (db.empty()) {
         lru_cache_.clear();
+        // the objects may call the functions which are changed
+        auto object_cache = JitObjectCache::Get(options_.jit_options().GetObjectCachePath(),
+                                                options_.jit_options().GetObjectCacheCapacity());
+        if (object_cache != nullptr) {
+            object_cache->Clear();
+        }
         return;
     }
     for (auto& cache : lru_cache_) {
@@ -382,6 +393,17 @@ EngineOptions Engine::GetEngineOptions() {
     return options_;
 }
 
+bool Engine::GetJitObjectCacheStat(uint64_t* hit_cnt, uint64_t* miss_cnt) {
+    auto object_cache = JitObjectCache::Get(options_.jit_options().GetObjectCachePath(),
+                                            options_.jit_options().GetObjectCacheCapacity());
+    if (object_cache == nullptr) {
+        return false;
+    }
+    *hit_cnt = object_cache->GetHitCnt();
+    *miss_cnt = object_cache->GetMissCnt();
+    return true;
+}
+
 std::shared_ptr<CompileInfo> Engine::GetCacheLocked(const std::string& db, const std::string& sql,
                                                     EngineMode engine_mode) {
     std::lock_guard<base::SpinMutex> lock(mu_);
@@ -454,6 +476,7 @@ int32_t RequestRunSession::Run(const uint32_t task_id, const Row& in_row, Row* o
     DLOG(INFO) << "Request Row Run with task_id " << task_id;
     RunnerContext ctx(&std::dynamic_pointer_cast<SqlCompileInfo>(compile_info_)->get_sql_context().cluster_job, in_row,
                       sp_name_, is_debug_);
+    ctx.cluster_job()->IssueSubQueries(task_id, ctx, false);
     auto output = task->RunWithCache(ctx);
     if (!output) {
         LOG(WARNING) << "Run request plan output is null";
@@ -480,6 +503,7 @@ int32_t BatchRequestRunSession::Run(const uint32_t id, const std::vector<Row>& r
         LOG(WARNING) << "Fail to run request plan: taskid" << id << " not exist!";
         return -2;
     }
+    ctx.cluster_job()->IssueSubQueries(id, ctx, true);
     auto handler = task->BatchRequestRun(ctx);
     if (!handler) {
         LOG(WARNING) << "Run request plan output is null";
@@ -496,35 +520,105 @@ int32_t BatchRunSession::Run(std::vector<Row>& rows, uint64_t limit) {
     return Run(Row(), rows, limit);
 }
 int32_t BatchRunSession::Run(const Row& parameter_row, std::vector<Row>& rows, uint64_t limit) {
-    auto& sql_ctx = std::dynamic_pointer_cast<SqlCompileInfo>(compile_info_)->get_sql_context();
-    RunnerContext ctx(&sql_ctx.cluster_job, parameter_row, is_debug_);
-    auto output = sql_ctx.cluster_job.GetTask(0).GetRoot()->RunWithCache(ctx);
-    if (!output) {
-        DLOG(INFO) << "Run batch plan output is empty";
-        return 0;
+    std::unique_ptr<BatchRunCursor> cursor;
+    int32_t ret = Run(parameter_row, &cursor);
+    if (ret != 0) {
+        return ret;
+    }
+    while (cursor->Valid()) {
+        rows.push_back(cursor->GetValue());
+        cursor->Next();
     }
-    switch (output->GetHandlerType()) {
-        case kTableHandler: {
-            auto iter = std::dynamic_pointer_cast<TableHandler>(output)->GetIterator();
-            if (!iter) {
+    return 0;
+}
+
+/// BatchRunCursorImpl holds the context of running, the output handlers refer to
+/// the parameter row of context while iterating
+class BatchRunCursorImpl : public BatchRunCursor {
+ public:
+    BatchRunCursorImpl(const std::shared_ptr<SqlCompileInfo>& compile_info, const Row& parameter_row,
+                       bool is_debug)
+        : compile_info_(compile_info),
+          ctx_(&compile_info->get_sql_context().cluster_job, parameter_row, is_debug),
+          output_(),
+          iter_(),
+          row_(),
+          valid_(false) {}
+    ~BatchRunCursorImpl() {}
+
+    int32_t Init() {
+        output_ = compile_info_->get_sql_context().cluster_job.GetTask(0).GetRoot()->RunWithCache(ctx_);
+        if (!output_) {
+            DLOG(INFO) << "Run batch plan output is empty";
+            return 0;
+        }
+        switch (output_->GetHandlerType()) {
+            case kTableHandler: {
+                iter_ = std::dynamic_pointer_cast<TableHandler>(output_)->GetIterator();
+                if (iter_) {
+                    iter_->SeekToFirst();
+                }
                 return 0;
             }
-            iter->SeekToFirst();
-            while (iter->Valid()) {
-                rows.push_back(iter->GetValue());
-                iter->Next();
+            case kRowHandler: {
+                row_ = std::dynamic_pointer_cast<RowHandler>(output_)->GetValue();
+                valid_ = true;
+                return 0;
+            }
+            case kPartitionHandler: {
+                LOG(WARNING) << "Partition output is invalid";
+                return -1;
             }
-            return 0;
         }
-        case kRowHandler: {
-            rows.push_back(std::dynamic_pointer_cast<RowHandler>(output)->GetValue());
-            return 0;
+        return 0;
+    }
+
+    bool Valid() const override {
+        if (iter_) {
+            return iter_->Valid();
         }
-        case kPartitionHandler: {
-            LOG(WARNING) << "Partition output is invalid";
-            return -1;
+        return valid_;
+    }
+
+    const Row& GetValue() override {
+        if (iter_) {
+            return iter_->GetValue();
         }
+        return row_;
+    }
+
+    void Next() override {
+        if (iter_) {
+            iter_->Next();
+        } else {
+            valid_ = false;
+        }
+    }
+
+ private:
+    std::shared_ptr<SqlCompileInfo> compile_info_;
+    RunnerContext ctx_;
+    std::shared_ptr<DataHandler> output_;
+    std::unique_ptr<RowIterator> iter_;
+    Row row_;
+    bool valid_;
+};
+
+int32_t BatchRunSession::Run(const Row& parameter_row, std::unique_ptr<BatchRunCursor>* cursor) {
+    if (cursor == nullptr) {
+        return -1;
+    }
+    auto compile_info = std::dynamic_pointer_cast<SqlCompileInfo>(compile_info_);
+    if (!compile_info) {
+        LOG(WARNING) << "Run batch session without compile info";
+        return -1;
+    }
+    auto impl = std::make_unique<BatchRunCursorImpl>(compile_info, parameter_row, is_debug_);
+    int32_t ret = impl->Init();
+    if (ret != 0) {
+        return ret;
     }
+    *cursor = std::move(impl);
     return 0;
 }
 
@@ -14,15 +14,20 @@
  * limitations under the License.
  */
 
+#include "absl/strings/match.h"
 #include "case/case_data_mock.h"
 #include "gtest/gtest.h"
 #include "gtest/internal/gtest-param-util.h"
 #include "testing/engine_test_base.h"
 #include "udf/openmldb_udf.h"
+#include "vm/runner.h"
+#include "vm/sql_compiler.h"
 
 using namespace llvm;       // NOLINT (build/namespaces)
 using namespace llvm::orc;  // NOLINT (build/namespaces)
 
+DECLARE_bool(enable_incremental_window_agg);
+
 namespace hybridse {
 namespace vm {
 using hybridse::sqlcase::CaseDataMock;
@@ -506,6 +511,154 @@ TEST_F(EngineCompileTest, ExplainBatchRequestTest) {
     ASSERT_EQ(true, output_schema.Get(4).is_constant());
     ASSERT_EQ(true, output_schema.Get(5).is_constant());
 }
+TEST_F(EngineCompileTest, BatchAggParallelismTest) {
+    auto catalog = BuildSimpleCatalog();
+    hybridse::type::Database db;
+    db.set_name("simple_db");
+    hybridse::type::TableDef table_def;
+    std::vector<Row> rows;
+    CaseDataMock::BuildOnePkTableData(table_def, rows, 1000);
+    table_def.set_name("t1");
+    AddTable(db, table_def);
+    catalog->AddDatabase(db);
+    ASSERT_TRUE(catalog->InsertRows("simple_db", "t1", rows));
+
+    auto run = [&](const std::string& sql, uint32_t parallelism) {
+        EngineOptions options;
+        options.SetBatchAggParallelism(parallelism);
+        Engine engine(catalog, options);
+        ExplainOutput explain_output;
+        base::Status status;
+        EXPECT_TRUE(engine.Explain(sql, "simple_db", kBatchMode, &explain_output, &status)) << status;
+        EXPECT_EQ(parallelism > 1, absl::StrContains(explain_output.physical_plan,
+                                                     "parallelism=" + std::to_string(parallelism)))
+            << explain_output.physical_plan;
+        BatchRunSession session;
+        EXPECT_TRUE(engine.Get(sql, "simple_db", session, status)) << status;
+        std::vector<Row> output;
+        EXPECT_EQ(0, session.Run(output));
+        std::vector<std::string> result;
+        for (auto& row : output) {
+            result.push_back(row.ToString());
+        }
+        return result;
+    };
+    std::string window_sql =
+        "select col1, col5, sum(col4) over w, count(col0) over w from t1 "
+        "window w as (partition by col1 order by col5 rows between 10 preceding and current row);";
+    auto expect = run(window_sql, 1);
+    ASSERT_EQ(rows.size(), expect.size());
+    ASSERT_EQ(expect, run(window_sql, 4));
+    ASSERT_EQ(expect, run(window_sql, 200));
+
+    std::string group_sql = "select col1, sum(col3), count(col5) from t1 group by col1 having count(col5) > 5;";
+    expect = run(group_sql, 1);
+    ASSERT_FALSE(expect.empty());
+    ASSERT_EQ(expect, run(group_sql, 4));
+}
+TEST_F(EngineCompileTest, IncrementalWindowAggTest) {
+    auto catalog = BuildSimpleCatalog();
+    hybridse::type::Database db;
+    db.set_name("simple_db");
+    hybridse::type::TableDef table_def;
+    sqlcase::CaseSchemaMock::BuildTableDef(table_def);
+    table_def.set_name("t1");
+    AddTable(db, table_def);
+    hybridse::type::TableDef table_def2;
+    sqlcase::CaseSchemaMock::BuildTableDef(table_def2);
+    table_def2.set_name("t2");
+    AddTable(db, table_def2);
+    catalog->AddDatabase(db);
+
+    // the rows with nulls, negative values and duplicated keys in each partition
+    codec::RowBuilder builder(table_def.columns());
+    auto make_row = [&](int i, int64_t ts) {
+        std::string str = "k" + std::to_string(i % 4);
+        uint32_t size = builder.CalTotalLength(str.size() + 1);
+        int8_t* buf = static_cast<int8_t*>(malloc(size));
+        builder.SetBuffer(buf, size);
+        builder.AppendString(str.c_str(), str.size());
+        builder.AppendInt32(i % 2 + 1);
+        if (i % 7 == 0) {
+            builder.AppendNULL();
+        } else {
+            builder.AppendInt16(static_cast<int16_t>(i * 37 % 11 - 5));
+        }
+        if (i % 5 == 0) {
+            builder.AppendNULL();
+        } else {
+            builder.AppendFloat(static_cast<float>(i * 13 % 17) / 2);
+        }
+        builder.AppendDouble(i * 7 % 23 - 10.0);
+        builder.AppendInt64(ts);
+        builder.AppendString("s", 1);
+        return Row(base::RefCountedSlice::CreateManaged(buf, size));
+    };
+    std::vector<Row> rows;
+    for (int i = 0; i < 60; i++) {
+        rows.push_back(make_row(i, 1000 + i / 3));
+    }
+    ASSERT_TRUE(catalog->InsertRows("simple_db", "t1", rows));
+    rows.clear();
+    for (int i = 0; i < 20; i++) {
+        rows.push_back(make_row(i + 3, 1000 + i * 2 + 1));
+    }
+    ASSERT_TRUE(catalog->InsertRows("simple_db", "t2", rows));
+
+    auto run = [&](const std::string& sql, bool incremental) {
+        FLAGS_enable_incremental_window_agg = incremental;
+        Engine engine(catalog);
+        base::Status status;
+        BatchRunSession session;
+        EXPECT_TRUE(engine.Get(sql, "simple_db", session, status)) << status;
+        FLAGS_enable_incremental_window_agg = false;
+        std::vector<std::string> result;
+        if (!status.isOK()) {
+            return result;
+        }
+        // the runner computes incrementally only if the flag is on
+        auto compile_info = std::dynamic_pointer_cast<SqlCompileInfo>(session.GetCompileInfo());
+        std::vector<Runner*> runners = {compile_info->get_sql_context().cluster_job.GetTask(0).GetRoot()};
+        WindowAggRunner* window_runner = nullptr;
+        while (!runners.empty() && window_runner == nullptr) {
+            auto runner = runners.back();
+            runners.pop_back();
+            window_runner = dynamic_cast<WindowAggRunner*>(runner);
+            runners.insert(runners.end(), runner->GetProducers().begin(), runner->GetProducers().end());
+        }
+        EXPECT_TRUE(window_runner != nullptr && window_runner->IsIncremental() == incremental) << sql;
+        std::vector<Row> output;
+        EXPECT_EQ(0, session.Run(output));
+        codec::RowView view(session.GetSchema());
+        for (auto& row : output) {
+            view.Reset(row.buf(), row.size());
+            result.push_back(view.GetRowString());
+        }
+        return result;
+    };
+    std::string projects =
+        "select col0, col1, col5, sum(col2) over w as s2, count(col3) over w as c3, avg(col2) over w as a2, "
+        "min(col3) over w as m3, max(col4) over w as x4, min(col5) over w as m5, "
+        "sum_where(col5, col2 > 0) over w as sw, count_where(col0, col1 = 1) over w as cw, "
+        "avg_where(col1, col3 < 4.0) over w as aw, min_where(col2, col4 >= 0.0) over w as mw, "
+        "max_where(col3, col2 != 2) over w as xw from t1 ";
+    for (const std::string window : {
+             "window w as (partition by col1 order by col5 rows_range between 4 preceding and current row);",
+             "window w as (partition by col1 order by col5 rows between 5 preceding and current row);",
+             "window w as (partition by col1 order by col5 rows_range between 4 preceding and current row "
+             "exclude current_time);",
+             "window w as (partition by col1 order by col5 rows between 5 preceding and current row "
+             "exclude current_time);",
+             "window w as (union t2 partition by col1 order by col5 rows_range between 6 preceding and current row "
+             "instance_not_in_window);",
+             "window w as (union t2 partition by col1 order by col5 rows between 5 preceding and current row "
+             "instance_not_in_window exclude current_time);",
+         }) {
+        auto expect = run(projects + window, false);
+        ASSERT_EQ(60u, expect.size()) << window;
+        ASSERT_EQ(expect, run(projects + window, true)) << window;
+    }
+}
 TEST_F(EngineCompileTest, MockRequestExplainTest) {
     // Build Simple Catalog
     auto catalog = BuildSimpleCatalog();
@@ -0,0 +1,610 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/incremental_window.h"
+
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "glog/logging.h"
+#include "vm/internal/eval.h"
+
+namespace hybridse {
+namespace vm {
+
+namespace {
+
+struct AggFunc {
+    IncrementalWindowAgg::ProjectType type;
+    bool with_cond;
+};
+
+const absl::flat_hash_map<std::string, AggFunc>& GetAggFuncs() {
+    static const auto* funcs = new absl::flat_hash_map<std::string, AggFunc>{
+        {"sum", {IncrementalWindowAgg::kSum, false}},
+        {"count", {IncrementalWindowAgg::kCount, false}},
+        {"avg", {IncrementalWindowAgg::kAvg, false}},
+        {"min", {IncrementalWindowAgg::kMin, false}},
+        {"max", {IncrementalWindowAgg::kMax, false}},
+        {"sum_where", {IncrementalWindowAgg::kSum, true}},
+        {"count_where", {IncrementalWindowAgg::kCount, true}},
+        {"avg_where", {IncrementalWindowAgg::kAvg, true}},
+        {"min_where", {IncrementalWindowAgg::kMin, true}},
+        {"max_where", {IncrementalWindowAgg::kMax, true}},
+    };
+    return *funcs;
+}
+
+bool IsNumber(type::Type type) {
+    switch (type) {
+        case type::kInt16:
+        case type::kInt32:
+        case type::kInt64:
+        case type::kFloat:
+        case type::kDouble:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool IsInteger(type::Type type) {
+    return type == type::kInt16 || type == type::kInt32 || type == type::kInt64;
+}
+
+bool ResolveColumn(const SchemasContext* ctx, const node::ExprNode* expr, int32_t* schema_idx, uint32_t* col_idx,
+                   type::Type* type) {
+    if (expr->GetExprType() != node::kExprColumnRef && expr->GetExprType() != node::kExprColumnId) {
+        return false;
+    }
+    size_t column_id = 0;
+    size_t slice = 0;
+    size_t idx = 0;
+    if (!ctx->ResolveColumnID(expr, &column_id).isOK() ||
+        !ctx->ResolveColumnIndexByID(column_id, &slice, &idx).isOK()) {
+        return false;
+    }
+    *schema_idx = static_cast<int32_t>(slice);
+    *col_idx = static_cast<uint32_t>(idx);
+    *type = ctx->GetSchemaSource(slice)->GetSchema()->Get(idx).type();
+    return true;
+}
+
+bool ResolveCond(const SchemasContext* ctx, const node::ExprNode* cond, IncrementalWindowAgg::Project* project) {
+    type::Type type = type::kNull;
+    if (ResolveColumn(ctx, cond, &project->cond_schema_idx, &project->cond_col_idx, &type)) {
+        return type == type::kBool;
+    }
+    // the comparison evaluated by internal::EvalCond
+    if (cond->GetExprType() != node::kExprBinary) {
+        return false;
+    }
+    auto bin_expr = dynamic_cast<const node::BinaryExpr*>(cond);
+    switch (bin_expr->GetOp()) {
+        case node::kFnOpLt:
+        case node::kFnOpLe:
+        case node::kFnOpGt:
+        case node::kFnOpGe:
+        case node::kFnOpEq:
+        case node::kFnOpNeq:
+            break;
+        default:
+            return false;
+    }
+    const node::ExprNode* column = nullptr;
+    if (bin_expr->GetChild(0)->GetExprType() == node::kExprColumnRef &&
+        bin_expr->GetChild(1)->GetExprType() == node::kExprPrimary) {
+        column = bin_expr->GetChild(0);
+    } else if (bin_expr->GetChild(1)->GetExprType() == node::kExprColumnRef &&
+               bin_expr->GetChild(0)->GetExprType() == node::kExprPrimary) {
+        column = bin_expr->GetChild(1);
+    } else {
+        return false;
+    }
+    size_t schema_idx = 0;
+    size_t col_idx = 0;
+    if (!ctx->ResolveColumnRefIndex(dynamic_cast<const node::ColumnRefNode*>(column), &schema_idx, &col_idx)
+             .isOK()) {
+        return false;
+    }
+    project->cond = cond;
+    return true;
+}
+
+bool ResolveProject(const SchemasContext* ctx, const node::ExprNode* expr, IncrementalWindowAgg::Project* project) {
+    if (ResolveColumn(ctx, expr, &project->schema_idx, &project->col_idx, &project->input_type)) {
+        project->type = IncrementalWindowAgg::kColumn;
+        return project->input_type == project->output_type;
+    }
+    if (expr->GetExprType() != node::kExprCall) {
+        return false;
+    }
+    auto call = dynamic_cast<const node::CallExprNode*>(expr);
+    if (call->GetFnDef() == nullptr) {
+        return false;
+    }
+    auto& funcs = GetAggFuncs();
+    auto it = funcs.find(call->GetFnDef()->GetName());
+    if (it == funcs.end() || call->GetChildNum() != (it->second.with_cond ? 2u : 1u)) {
+        return false;
+    }
+    project->type = it->second.type;
+    if (it->second.with_cond && !ResolveCond(ctx, call->GetChild(1), project)) {
+        return false;
+    }
+    project->skip_zero = it->second.with_cond &&
+                         (project->type == IncrementalWindowAgg::kSum || project->type == IncrementalWindowAgg::kAvg);
+
+    auto arg = call->GetChild(0);
+    if (project->type == IncrementalWindowAgg::kCount) {
+        if (project->output_type != type::kInt64) {
+            return false;
+        }
+        if (arg->GetExprType() == node::kExprAll && !it->second.with_cond) {
+            project->schema_idx = -1;
+            return true;
+        }
+        // count only checks null, so all the column types are supported
+        return ResolveColumn(ctx, arg, &project->schema_idx, &project->col_idx, &project->input_type);
+    }
+    if (!ResolveColumn(ctx, arg, &project->schema_idx, &project->col_idx, &project->input_type)) {
+        return false;
+    }
+    // a float point sum can't be kept by adding and subtracting, e.g. the small values are lost
+    // once a huge one is subtracted, so only the integer sums are computed incrementally
+    switch (project->type) {
+        case IncrementalWindowAgg::kSum:
+            return (IsInteger(project->input_type) || project->input_type == type::kTimestamp) &&
+                   project->input_type == project->output_type;
+        case IncrementalWindowAgg::kAvg:
+            // the udaf sums in double, which is exact for the sum of int16 and int32 values
+            return (project->input_type == type::kInt16 || project->input_type == type::kInt32) &&
+                   project->output_type == type::kDouble;
+        case IncrementalWindowAgg::kMin:
+        case IncrementalWindowAgg::kMax:
+            return (IsNumber(project->input_type) || project->input_type == type::kTimestamp ||
+                    project->input_type == type::kDate) &&
+                   project->input_type == project->output_type;
+        default:
+            return false;
+    }
+}
+
+}  // namespace
+
+std::unique_ptr<IncrementalWindowAgg> IncrementalWindowAgg::Build(const ColumnProjects& projects,
+                                                                  const SchemasContext* input_ctx) {
+    const auto* output_schema = projects.fn_info().fn_schema();
+    if (input_ctx == nullptr || projects.size() == 0 || output_schema->size() != static_cast<int>(projects.size())) {
+        return nullptr;
+    }
+    std::unique_ptr<IncrementalWindowAgg> agg(new IncrementalWindowAgg(input_ctx, *output_schema));
+    auto primary_frame = projects.GetPrimaryFrame();
+    for (size_t i = 0; i < projects.size(); i++) {
+        // the window only maintains the primary frame
+        auto frame = projects.GetFrame(i);
+        if (frame != nullptr && frame != primary_frame &&
+            (primary_frame == nullptr || !node::SqlEquals(frame, primary_frame))) {
+            return nullptr;
+        }
+        Project project;
+        project.output_type = output_schema->Get(i).type();
+        if (!ResolveProject(input_ctx, projects.GetExpr(i), &project)) {
+            DLOG(INFO) << "window project " << projects.GetExpr(i)->GetExprString()
+                       << " can't be computed incrementally";
+            return nullptr;
+        }
+        agg->projects_.push_back(project);
+    }
+    return agg;
+}
+
+IncrementalWindow::IncrementalWindow(const WindowRange& window_range, const IncrementalWindowAgg* agg)
+    : HistoryWindow(window_range),
+      agg_(agg),
+      row_parser_(agg->input_ctx()),
+      row_views_(),
+      row_builder_(agg->output_schema()),
+      states_(agg->projects().size()),
+      values_(),
+      begin_seq_(0),
+      end_seq_(0) {
+    for (size_t i = 0; i < agg->input_ctx()->GetSchemaSourceSize(); i++) {
+        row_views_.emplace_back(*agg->input_ctx()->GetSchemaSource(i)->GetSchema());
+    }
+}
+
+bool IncrementalWindow::IsFloat(const IncrementalWindowAgg::Project& project) const {
+    return project.input_type == type::kFloat || project.input_type == type::kDouble;
+}
+
+bool IncrementalWindow::EvalCond(const IncrementalWindowAgg::Project& project, const Row& row) {
+    if (project.cond_schema_idx >= 0) {
+        bool val = false;
+        return 0 == row_views_[project.cond_schema_idx].GetValue(row.buf(project.cond_schema_idx),
+                                                                  project.cond_col_idx, type::kBool, &val) &&
+               val;
+    }
+    auto matches = internal::EvalCond(&row_parser_, row, project.cond);
+    if (!matches.ok()) {
+        LOG(WARNING) << matches.status();
+        return false;
+    }
+    return matches->value_or(false);
+}
+
+IncrementalWindow::Value IncrementalWindow::Extract(const IncrementalWindowAgg::Project& project, const Row& row) {
+    Value value;
+    if (project.type == IncrementalWindowAgg::kColumn) {
+        return value;
+    }
+    if (project.cond != nullptr || project.cond_schema_idx >= 0) {
+        if (!EvalCond(project, row)) {
+            return value;
+        }
+    }
+    if (project.schema_idx < 0) {
+        // count(*)
+        value.valid = true;
+        return value;
+    }
+    const int8_t* buf = row.buf(project.schema_idx);
+    const auto& row_view = row_views_[project.schema_idx];
+    if (buf == nullptr || row_view.IsNULL(buf, project.col_idx)) {
+        return value;
+    }
+    int32_t ret = 0;
+    switch (project.input_type) {
+        case type::kInt16: {
+            int16_t v = 0;
+            ret = row_view.GetValue(buf, project.col_idx, project.input_type, &v);
+            value.i = v;
+            break;
+        }
+        case type::kInt32:
+        case type::kDate: {
+            int32_t v = 0;
+            ret = row_view.GetValue(buf, project.col_idx, project.input_type, &v);
+            value.i = v;
+            break;
+        }
+        case type::kInt64:
+        case type::kTimestamp: {
+            ret = row_view.GetValue(buf, project.col_idx, project.input_type, &value.i);
+            break;
+        }
+        case type::kFloat: {
+            float v = 0;
+            ret = row_view.GetValue(buf, project.col_idx, project.input_type, &v);
+            value.d = v;
+            break;
+        }
+        case type::kDouble: {
+            ret = row_view.GetValue(buf, project.col_idx, project.input_type, &value.d);
+            break;
+        }
+        default:
+            // count of the other types only checks null
+            break;
+    }
+    if (ret != 0) {
+        return value;
+    }
+    if (project.skip_zero && (IsFloat(project) ? value.d == 0 : value.i == 0)) {
+        return value;
+    }
+    value.valid = true;
+    return value;
+}
+
+bool IncrementalWindow::Dominate(const IncrementalWindowAgg::Project& project, const Value& lhs,
+                                 const Value& rhs) const {
+    if (project.type == IncrementalWindowAgg::kMin) {
+        return IsFloat(project) ? lhs.d <= rhs.d : lhs.i <= rhs.i;
+    }
+    return IsFloat(project) ? lhs.d >= rhs.d : lhs.i >= rhs.i;
+}
+
+void IncrementalWindow::PushExtreme(size_t idx, uint64_t seq, const Value& value) {
+    const auto& project = agg_->projects()[idx];
+    auto& extremes = states_[idx].extremes;
+    while (!extremes.empty() && Dominate(project, value, extremes.back().second)) {
+        extremes.pop_back();
+    }
+    extremes.emplace_back(seq, value);
+}
+
+void IncrementalWindow::AddFrontRow(const uint64_t key, const Row& row) {
+    HistoryWindow::AddFrontRow(key, row);
+    AddValues(row);
+}
+
+void IncrementalWindow::AddFrontRowValues(const uint64_t key, const Row& row) {
+    HistoryWindow::AddFrontRow(key, Row());
+    AddValues(row);
+}
+
+void IncrementalWindow::AddValues(const Row& row) {
+    const auto& projects = agg_->projects();
+    uint64_t seq = end_seq_++;
+    // the values of newest row are at front in the order of projects
+    for (size_t i = projects.size(); i > 0; i--) {
+        const auto& project = projects[i - 1];
+        Value value = Extract(project, row);
+        values_.push_front(value);
+        if (!value.valid) {
+            continue;
+        }
+        auto& state = states_[i - 1];
+        state.cnt++;
+        switch (project.type) {
+            case IncrementalWindowAgg::kSum:
+            case IncrementalWindowAgg::kAvg:
+                state.isum += value.i;
+                break;
+            case IncrementalWindowAgg::kMin:
+            case IncrementalWindowAgg::kMax:
+                PushExtreme(i - 1, seq, value);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+uint64_t IncrementalWindow::GetBackKeyCount() const {
+    uint64_t cnt = 0;
+    for (auto it = table_.rbegin(); it != table_.rend() && it->first == table_.back().first; ++it) {
+        cnt++;
+    }
+    return cnt;
+}
+
+void IncrementalWindow::PopBackRow() {
+    HistoryWindow::PopBackRow();
+    const auto& projects = agg_->projects();
+    uint64_t seq = begin_seq_++;
+    for (size_t i = projects.size(); i > 0; i--) {
+        Value value = values_.back();
+        values_.pop_back();
+        if (!value.valid) {
+            continue;
+        }
+        auto& state = states_[i - 1];
+        state.cnt--;
+        switch (projects[i - 1].type) {
+            case IncrementalWindowAgg::kSum:
+            case IncrementalWindowAgg::kAvg:
+                state.isum -= value.i;
+                break;
+            case IncrementalWindowAgg::kMin:
+            case IncrementalWindowAgg::kMax:
+                if (!state.extremes.empty() && state.extremes.front().first == seq) {
+                    state.extremes.pop_front();
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void IncrementalWindow::PopFrontRow() {
+    HistoryWindow::PopFrontRow();
+    const auto& projects = agg_->projects();
+    uint64_t seq = --end_seq_;
+    for (size_t i = 0; i < projects.size(); i++) {
+        Value value = values_.front();
+        values_.pop_front();
+        if (!value.valid) {
+            continue;
+        }
+        auto& state = states_[i];
+        state.cnt--;
+        switch (projects[i].type) {
+            case IncrementalWindowAgg::kSum:
+            case IncrementalWindowAgg::kAvg:
+                state.isum -= value.i;
+                break;
+            case IncrementalWindowAgg::kMin:
+            case IncrementalWindowAgg::kMax: {
+                auto& extremes = state.extremes;
+                if (extremes.empty() || extremes.back().first != seq) {
+                    break;
+                }
+                extremes.pop_back();
+                // push back the newer rows which were evicted by the popped one
+                uint64_t from = extremes.empty() ? begin_seq_ : extremes.back().first + 1;
+                for (uint64_t s = from; s < end_seq_; s++) {
+                    // the values of projects 0..i of the popped row are out of values_ already
+                    const Value& v = values_[(end_seq_ - s) * projects.size() - 1];
+                    if (v.valid) {
+                        PushExtreme(i, s, v);
+                    }
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+void IncrementalWindow::AppendColumn(const IncrementalWindowAgg::Project& project, const Row& row) {
+    const int8_t* buf = row.buf(project.schema_idx);
+    const auto& row_view = row_views_[project.schema_idx];
+    if (buf == nullptr || row_view.IsNULL(buf, project.col_idx)) {
+        row_builder_.AppendNULL();
+        return;
+    }
+    switch (project.input_type) {
+        case type::kBool: {
+            bool v = false;
+            row_view.GetValue(buf, project.col_idx, project.input_type, &v);
+            row_builder_.AppendBool(v);
+            break;
+        }
+        case type::kInt16: {
+            int16_t v = 0;
+            row_view.GetValue(buf, project.col_idx, project.input_type, &v);
+            row_builder_.AppendInt16(v);
+            break;
+        }
+        case type::kInt32: {
+            int32_t v = 0;
+            row_view.GetValue(buf, project.col_idx, project.input_type, &v);
+            row_builder_.AppendInt32(v);
+            break;
+        }
+        case type::kDate: {
+            int32_t v = 0;
+            row_view.GetValue(buf, project.col_idx, project.input_type, &v);
+            row_builder_.AppendDate(v);
+            break;
+        }
+        case type::kInt64: {
+            int64_t v = 0;
+            row_view.GetValue(buf, project.col_idx, project.input_type, &v);
+            row_builder_.AppendInt64(v);
+            break;
+        }
+        case type::kTimestamp: {
+            int64_t v = 0;
+            row_view.GetValue(buf, project.col_idx, project.input_type, &v);
+            row_builder_.AppendTimestamp(v);
+            break;
+        }
+        case type::kFloat: {
+            float v = 0;
+            row_view.GetValue(buf, project.col_idx, project.input_type, &v);
+            row_builder_.AppendFloat(v);
+            break;
+        }
+        case type::kDouble: {
+            double v = 0;
+            row_view.GetValue(buf, project.col_idx, project.input_type, &v);
+            row_builder_.AppendDouble(v);
+            break;
+        }
+        case type::kVarchar: {
+            const char* str = nullptr;
+            uint32_t size = 0;
+            row_view.GetValue(buf, project.col_idx, &str, &size);
+            row_builder_.AppendString(str, size);
+            break;
+        }
+        default:
+            row_builder_.AppendNULL();
+            break;
+    }
+}
+
+void IncrementalWindow::AppendNumber(type::Type type, const Value& value, bool is_float) {
+    switch (type) {
+        case type::kInt16:
+            row_builder_.AppendInt16(static_cast<int16_t>(is_float ? value.d : value.i));
+            break;
+        case type::kInt32:
+            row_builder_.AppendInt32(static_cast<int32_t>(is_float ? value.d : value.i));
+            break;
+        case type::kDate:
+            row_builder_.AppendDate(static_cast<int32_t>(value.i));
+            break;
+        case type::kInt64:
+            row_builder_.AppendInt64(is_float ? static_cast<int64_t>(value.d) : value.i);
+            break;
+        case type::kTimestamp:
+            row_builder_.AppendTimestamp(is_float ? static_cast<int64_t>(value.d) : value.i);
+            break;
+        case type::kFloat:
+            row_builder_.AppendFloat(static_cast<float>(is_float ? value.d : value.i));
+            break;
+        case type::kDouble:
+            row_builder_.AppendDouble(is_float ? value.d : static_cast<double>(value.i));
+            break;
+        default:
+            row_builder_.AppendNULL();
+            break;
+    }
+}
+
+Row IncrementalWindow::Output(const Row& row) {
+    const auto& projects = agg_->projects();
+    uint32_t str_len = 0;
+    for (const auto& project : projects) {
+        if (project.type != IncrementalWindowAgg::kColumn || project.input_type != type::kVarchar) {
+            continue;
+        }
+        const int8_t* buf = row.buf(project.schema_idx);
+        const auto& row_view = row_views_[project.schema_idx];
+        if (buf == nullptr || row_view.IsNULL(buf, project.col_idx)) {
+            continue;
+        }
+        const char* str = nullptr;
+        uint32_t size = 0;
+        row_view.GetValue(buf, project.col_idx, &str, &size);
+        str_len += size;
+    }
+    uint32_t total_len = row_builder_.CalTotalLength(str_len);
+    int8_t* buf = static_cast<int8_t*>(malloc(total_len));
+    row_builder_.SetBuffer(buf, total_len);
+    for (size_t i = 0; i < projects.size(); i++) {
+        const auto& project = projects[i];
+        const auto& state = states_[i];
+        switch (project.type) {
+            case IncrementalWindowAgg::kColumn:
+                AppendColumn(project, row);
+                break;
+            case IncrementalWindowAgg::kCount:
+                row_builder_.AppendInt64(state.cnt);
+                break;
+            case IncrementalWindowAgg::kSum: {
+                if (state.cnt == 0) {
+                    row_builder_.AppendNULL();
+                    break;
+                }
+                Value sum;
+                sum.i = state.isum;
+                AppendNumber(project.output_type, sum, false);
+                break;
+            }
+            case IncrementalWindowAgg::kAvg: {
+                if (state.cnt == 0) {
+                    row_builder_.AppendNULL();
+                    break;
+                }
+                row_builder_.AppendDouble(static_cast<double>(state.isum) / state.cnt);
+                break;
+            }
+            case IncrementalWindowAgg::kMin:
+            case IncrementalWindowAgg::kMax: {
+                if (state.extremes.empty()) {
+                    row_builder_.AppendNULL();
+                    break;
+                }
+                AppendNumber(project.output_type, state.extremes.front().second, IsFloat(project));
+                break;
+            }
+            default:
+                row_builder_.AppendNULL();
+                break;
+        }
+    }
+    return Row(base::RefCountedSlice::CreateManaged(buf, total_len));
+}
+
+}  // namespace vm
+}  // namespace hybridse
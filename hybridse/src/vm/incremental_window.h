@@ -0,0 +1,145 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_SRC_VM_INCREMENTAL_WINDOW_H_
+#define HYBRIDSE_SRC_VM_INCREMENTAL_WINDOW_H_
+
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "codec/fe_row_codec.h"
+#include "codec/row.h"
+#include "node/sql_node.h"
+#include "vm/mem_catalog.h"
+#include "vm/physical_op.h"
+#include "vm/schemas_context.h"
+
+namespace hybridse {
+namespace vm {
+
+// IncrementalWindowAgg describes a window project whose outputs are all
+// columns of the current row or aggregations the window can keep up to date
+// as rows enter and leave it:
+// * count, and sum/avg of integers, and the *_where variants, by adding and subtracting
+// * min/max and the *_where variants, by a monotonic deque
+// The *_where condition should be a bool column or a comparison between a column
+// and a constant. The results are the same as the udafs, the sums of integers wrap
+// around like the udafs and the float point sums are not supported.
+class IncrementalWindowAgg {
+ public:
+    enum ProjectType {
+        kColumn,
+        kSum,
+        kCount,
+        kAvg,
+        kMin,
+        kMax,
+    };
+
+    struct Project {
+        ProjectType type;
+        // the input column, schema_idx < 0 for count(*)
+        int32_t schema_idx = -1;
+        uint32_t col_idx = 0;
+        type::Type input_type = type::kNull;
+        // the condition of *_where, a bool column or a binary expr
+        const node::ExprNode* cond = nullptr;
+        int32_t cond_schema_idx = -1;
+        uint32_t cond_col_idx = 0;
+        // sum_where and avg_where skip zero since the udafs check `value && cond`
+        bool skip_zero = false;
+        type::Type output_type = type::kNull;
+    };
+
+    // return nullptr if any project of the window can't be computed incrementally
+    static std::unique_ptr<IncrementalWindowAgg> Build(const ColumnProjects& projects,
+                                                       const SchemasContext* input_ctx);
+
+    const std::vector<Project>& projects() const { return projects_; }
+    const SchemasContext* input_ctx() const { return input_ctx_; }
+    const codec::Schema& output_schema() const { return output_schema_; }
+
+ private:
+    IncrementalWindowAgg(const SchemasContext* input_ctx, const codec::Schema& output_schema)
+        : input_ctx_(input_ctx), output_schema_(output_schema) {}
+
+    const SchemasContext* input_ctx_;
+    const codec::Schema output_schema_;
+    std::vector<Project> projects_;
+};
+
+// IncrementalWindow is the history window that keeps the states of an
+// IncrementalWindowAgg for the rows in it, so the output of each instance
+// row costs O(1) amortized instead of iterating the whole window.
+class IncrementalWindow : public HistoryWindow {
+ public:
+    IncrementalWindow(const WindowRange& window_range, const IncrementalWindowAgg* agg);
+    ~IncrementalWindow() {}
+
+    void AddFrontRow(const uint64_t key, const Row& row) override;
+    // add the row but only keep the values of projects, the row isn't referred after return
+    void AddFrontRowValues(const uint64_t key, const Row& row);
+    void PopBackRow() override;
+    void PopFrontRow() override;
+
+    // the count of rows at the key of the oldest row
+    uint64_t GetBackKeyCount() const;
+
+    // compute the output row for the current row by the states of window
+    Row Output(const Row& row);
+
+ private:
+    // the numeric value of a row, integers and date are kept in `i`, float points in `d`
+    struct Value {
+        bool valid = false;
+        int64_t i = 0;
+        double d = 0;
+    };
+
+    struct State {
+        int64_t cnt = 0;
+        int64_t isum = 0;
+        // the valid values with seq of rows, monotonic from the oldest to the newest
+        std::deque<std::pair<uint64_t, Value>> extremes;
+    };
+
+    Value Extract(const IncrementalWindowAgg::Project& project, const Row& row);
+    bool EvalCond(const IncrementalWindowAgg::Project& project, const Row& row);
+    bool IsFloat(const IncrementalWindowAgg::Project& project) const;
+    // return true if `lhs` should evict `rhs` out of the extremes
+    bool Dominate(const IncrementalWindowAgg::Project& project, const Value& lhs, const Value& rhs) const;
+    void PushExtreme(size_t idx, uint64_t seq, const Value& value);
+    void AddValues(const Row& row);
+    void AppendColumn(const IncrementalWindowAgg::Project& project, const Row& row);
+    void AppendNumber(type::Type type, const Value& value, bool is_float);
+
+    const IncrementalWindowAgg* agg_;
+    RowParser row_parser_;
+    std::vector<codec::RowView> row_views_;
+    codec::RowBuilder row_builder_;
+    std::vector<State> states_;
+    // the values of projects of rows in window, the newest row at front
+    std::deque<Value> values_;
+    // the seq of the oldest row and the seq after the newest row in window
+    uint64_t begin_seq_;
+    uint64_t end_seq_;
+};
+
+}  // namespace vm
+}  // namespace hybridse
+#endif  // HYBRIDSE_SRC_VM_INCREMENTAL_WINDOW_H_
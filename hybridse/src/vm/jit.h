@@ -21,6 +21,7 @@
 #include <memory>
 #include <string>
 #include "llvm/ExecutionEngine/GenericValue.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/ExecutionEngine/Orc/LLJIT.h"
 #include "vm/jit_wrapper.h"
 
@@ -87,7 +88,7 @@ std::string LlvmToString(const T& value) {
 
 class HybridSeLlvmJitWrapper : public HybridSeJitWrapper {
  public:
-    HybridSeLlvmJitWrapper() {}
+    explicit HybridSeLlvmJitWrapper(::llvm::ObjectCache* object_cache = nullptr) : object_cache_(object_cache) {}
     ~HybridSeLlvmJitWrapper() {}
 
     bool Init() override;
@@ -105,6 +106,8 @@ class HybridSeLlvmJitWrapper : public HybridSeJitWrapper {
  private:
     std::unique_ptr<HybridSeJit> jit_;
     std::unique_ptr<::llvm::orc::MangleAndInterner> mi_;
+    // the compiled objects are loaded from and saved to it if not null
+    ::llvm::ObjectCache* object_cache_;
 };
 
 #ifdef LLVM_EXT_ENABLE
@@ -0,0 +1,241 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/jit_object_cache.h"
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+#include "hybridse_version.h"  // NOLINT
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace hybridse {
+namespace vm {
+
+static const char kModuleKeyPrefix[] = "hybridse_jit_obj_";
+
+static const char kObjectSuffix[] = ".o";
+
+JitObjectCache::JitObjectCache(const std::string& path, uint32_t capacity)
+    : path_(path), capacity_(capacity), hit_cnt_(0), miss_cnt_(0) {}
+
+JitObjectCache* JitObjectCache::Get(const std::string& path, uint32_t capacity) {
+    if (path.empty()) {
+        return nullptr;
+    }
+    // the caches are never destroyed since the jit of compile info may outlive the engine
+    static std::mutex mu;
+    static auto* caches = new std::map<std::string, JitObjectCache*>();
+    std::lock_guard<std::mutex> lock(mu);
+    auto it = caches->find(path);
+    if (it != caches->end()) {
+        it->second->SetCapacity(capacity);
+        return it->second;
+    }
+    auto ec = ::llvm::sys::fs::create_directories(path);
+    if (ec) {
+        LOG(WARNING) << "fail to create jit object cache directory " << path << ": " << ec.message();
+        return nullptr;
+    }
+    auto cache = new JitObjectCache(path, capacity);
+    cache->LoadKeys();
+    caches->emplace(path, cache);
+    LOG(INFO) << "jit object cache is enabled in " << path << ", capacity " << capacity << ", objects "
+              << cache->GetSize();
+    return cache;
+}
+
+void JitObjectCache::LoadKeys() {
+    std::vector<std::pair<::llvm::sys::TimePoint<>, std::string>> objects;
+    std::error_code ec;
+    for (::llvm::sys::fs::directory_iterator it(path_, ec), end; it != end && !ec; it.increment(ec)) {
+        auto name = ::llvm::sys::path::filename(it->path());
+        if (!name.startswith(kModuleKeyPrefix) || !name.endswith(kObjectSuffix)) {
+            continue;
+        }
+        auto status = it->status();
+        if (!status) {
+            continue;
+        }
+        objects.emplace_back(status->getLastModificationTime(), name.drop_back(sizeof(kObjectSuffix) - 1).str());
+    }
+    if (ec) {
+        LOG(WARNING) << "fail to list jit object cache directory " << path_ << ": " << ec.message();
+    }
+    std::sort(objects.begin(), objects.end());
+    std::lock_guard<std::mutex> lock(mu_);
+    for (const auto& object : objects) {
+        lru_.push_front(object.second);
+        index_[object.second] = lru_.begin();
+    }
+    EvictLocked();
+}
+
+void JitObjectCache::SetCapacity(uint32_t capacity) {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (capacity_ != capacity) {
+        capacity_ = capacity;
+        EvictLocked();
+    }
+}
+
+void JitObjectCache::Touch(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return;
+    }
+    lru_.push_front(key);
+    index_.emplace(key, lru_.begin());
+    EvictLocked();
+}
+
+void JitObjectCache::Remove(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+    ::llvm::sys::fs::remove(GetObjectPath(key));
+}
+
+void JitObjectCache::EvictLocked() {
+    while (capacity_ > 0 && lru_.size() > capacity_) {
+        const std::string& key = lru_.back();
+        auto ec = ::llvm::sys::fs::remove(GetObjectPath(key));
+        if (ec) {
+            LOG(WARNING) << "fail to remove jit object " << key << ": " << ec.message();
+        }
+        DLOG(INFO) << "evict jit object " << key;
+        index_.erase(key);
+        lru_.pop_back();
+    }
+}
+
+void JitObjectCache::Clear() {
+    std::lock_guard<std::mutex> lock(mu_);
+    for (const auto& key : lru_) {
+        ::llvm::sys::fs::remove(GetObjectPath(key));
+    }
+    lru_.clear();
+    index_.clear();
+}
+
+size_t JitObjectCache::GetSize() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return lru_.size();
+}
+
+std::string JitObjectCache::GenModuleKey(const ::llvm::Module& module) {
+    std::string str;
+    ::llvm::raw_string_ostream ss(str);
+    ss << HYBRIDSE_VERSION_MAJOR << "." << HYBRIDSE_VERSION_MEDIUM << "." << HYBRIDSE_VERSION_MINOR << "."
+       << HYBRIDSE_VERSION_BUG << "\n"
+       << ::llvm::sys::getProcessTriple() << "\n"
+       << ::llvm::sys::getHostCPUName() << "\n"
+       << module;
+    ss.flush();
+    ::llvm::MD5 md5;
+    md5.update(str);
+    ::llvm::MD5::MD5Result result;
+    md5.final(result);
+    return kModuleKeyPrefix + result.digest().str().str();
+}
+
+std::string JitObjectCache::GetObjectPath(const std::string& key) const { return path_ + "/" + key + kObjectSuffix; }
+
+bool JitObjectCache::Contains(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        return false;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return true;
+}
+
+void JitObjectCache::notifyObjectCompiled(const ::llvm::Module* module, ::llvm::MemoryBufferRef obj) {
+    const std::string& key = module->getModuleIdentifier();
+    if (!::llvm::StringRef(key).startswith(kModuleKeyPrefix)) {
+        return;
+    }
+    std::string path = GetObjectPath(key);
+    int fd = -1;
+    ::llvm::SmallString<128> tmp_path;
+    auto ec = ::llvm::sys::fs::createUniqueFile(path + ".%%%%%%.tmp", fd, tmp_path);
+    if (ec) {
+        LOG(WARNING) << "fail to create jit object file for " << key << ": " << ec.message();
+        return;
+    }
+    ::llvm::raw_fd_ostream os(fd, true);
+    os << obj.getBuffer();
+    os.close();
+    if (os.has_error()) {
+        LOG(WARNING) << "fail to write jit object file " << tmp_path.str().str();
+        os.clear_error();
+        ::llvm::sys::fs::remove(tmp_path);
+        return;
+    }
+    // the object is renamed after written completely, so it is never read partially
+    ec = ::llvm::sys::fs::rename(tmp_path, path);
+    if (ec) {
+        LOG(WARNING) << "fail to rename jit object file to " << path << ": " << ec.message();
+        ::llvm::sys::fs::remove(tmp_path);
+        return;
+    }
+    Touch(key);
+    DLOG(INFO) << "save jit object " << path;
+}
+
+std::unique_ptr<::llvm::MemoryBuffer> JitObjectCache::getObject(const ::llvm::Module* module) {
+    const std::string& key = module->getModuleIdentifier();
+    if (!::llvm::StringRef(key).startswith(kModuleKeyPrefix)) {
+        return nullptr;
+    }
+    std::string path = GetObjectPath(key);
+    auto buf = ::llvm::MemoryBuffer::getFile(path);
+    if (!buf) {
+        Remove(key);
+        miss_cnt_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    auto obj = ::llvm::object::ObjectFile::createObjectFile((*buf)->getMemBufferRef());
+    if (!obj) {
+        LOG(WARNING) << "drop broken jit object file " << path;
+        ::llvm::consumeError(obj.takeError());
+        Remove(key);
+        miss_cnt_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    Touch(key);
+    hit_cnt_.fetch_add(1, std::memory_order_relaxed);
+    DLOG(INFO) << "load jit object " << path;
+    return std::move(*buf);
+}
+
+}  // namespace vm
+}  // namespace hybridse
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_SRC_VM_JIT_OBJECT_CACHE_H_
+#define HYBRIDSE_SRC_VM_JIT_OBJECT_CACHE_H_
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+
+#include "llvm/ExecutionEngine/ObjectCache.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+namespace hybridse {
+namespace vm {
+
+/// JitObjectCache keeps the object files compiled by jit in a directory, so a module
+/// which has been compiled before, e.g. the deployments reloaded after restart,
+/// skips the optimization and code generation. Only the modules named by
+/// GenModuleKey are cached.
+///
+/// At most `capacity` objects are kept, the least recently used ones are removed
+/// from the directory. The objects left in directory by the previous process are
+/// ordered by their modification time.
+class JitObjectCache : public ::llvm::ObjectCache {
+ public:
+    /// Return the cache of directory path, nullptr if path is empty.
+    /// `capacity` 0 means unlimited, the cache of path takes the capacity of the last call
+    static JitObjectCache* Get(const std::string& path, uint32_t capacity);
+
+    /// The key is generated from the ir of module, engine version and host cpu,
+    /// so the modules with the same key are compiled to the same object
+    static std::string GenModuleKey(const ::llvm::Module& module);
+
+    /// Return true if the object of key is cached, and mark it as recently used
+    /// so it is not removed before it is loaded by getObject
+    bool Contains(const std::string& key);
+
+    /// Remove all the cached objects
+    void Clear();
+
+    void notifyObjectCompiled(const ::llvm::Module* module, ::llvm::MemoryBufferRef obj) override;
+
+    std::unique_ptr<::llvm::MemoryBuffer> getObject(const ::llvm::Module* module) override;
+
+    uint64_t GetHitCnt() const { return hit_cnt_.load(std::memory_order_relaxed); }
+    uint64_t GetMissCnt() const { return miss_cnt_.load(std::memory_order_relaxed); }
+    size_t GetSize();
+
+ private:
+    JitObjectCache(const std::string& path, uint32_t capacity);
+
+    std::string GetObjectPath(const std::string& key) const;
+
+    // load the keys of objects in directory
+    void LoadKeys();
+    void SetCapacity(uint32_t capacity);
+    // mark key as the most recently used, and add it if absent
+    void Touch(const std::string& key);
+    void Remove(const std::string& key);
+    // remove the least recently used objects out of capacity, mu_ should be held
+    void EvictLocked();
+
+    const std::string path_;
+    std::mutex mu_;
+    uint32_t capacity_;
+    // the most recently used at front
+    std::list<std::string> lru_;
+    std::unordered_map<std::string, std::list<std::string>::iterator> index_;
+    std::atomic<uint64_t> hit_cnt_;
+    std::atomic<uint64_t> miss_cnt_;
+};
+
+}  // namespace vm
+}  // namespace hybridse
+#endif  // HYBRIDSE_SRC_VM_JIT_OBJECT_CACHE_H_
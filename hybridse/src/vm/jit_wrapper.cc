@@ -39,6 +39,7 @@
 #include "udf/default_udf_library.h"
 #include "udf/udf.h"
 #include "vm/jit.h"
+#include "vm/jit_object_cache.h"
 
 namespace hybridse {
 namespace vm {
@@ -83,7 +84,8 @@ HybridSeJitWrapper* HybridSeJitWrapper::Create(const JitOptions& jit_options) {
             jit_options.IsEnableGdb()) {
             LOG(WARNING) << "LLJIT do not support jit events";
         }
-        return new HybridSeLlvmJitWrapper();
+        return new HybridSeLlvmJitWrapper(JitObjectCache::Get(jit_options.GetObjectCachePath(),
+                                                                  jit_options.GetObjectCacheCapacity()));
     }
 }
 
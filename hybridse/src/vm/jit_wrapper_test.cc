@@ -15,10 +15,12 @@
  */
 
 #include "vm/jit_wrapper.h"
+#include "boost/filesystem.hpp"
 #include "codec/fe_row_codec.h"
 #include "gtest/gtest.h"
 #include "udf/udf.h"
 #include "vm/engine.h"
+#include "vm/jit_object_cache.h"
 #include "vm/simple_catalog.h"
 #include "vm/sql_compiler.h"
 
@@ -162,6 +164,79 @@ TEST_F(JitWrapperTest, test_window) {
     delete jit;
 }
 
+TEST_F(JitWrapperTest, test_object_cache) {
+    std::string path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+    EngineOptions options;
+    options.jit_options().SetObjectCachePath(path);
+    auto object_cache = JitObjectCache::Get(path, options.jit_options().GetObjectCacheCapacity());
+    ASSERT_TRUE(object_cache != nullptr);
+    auto catalog = GetTestCatalog();
+    auto schema = catalog->GetTable("db", "t1")->GetSchema();
+    for (uint64_t i = 0; i < 2; i++) {
+        // every compiling creates a new engine and jit, only the first one compiles the module
+        auto compile_info = Compile("select col_1, col_2 + 1 from t1;", options, catalog);
+        ASSERT_TRUE(compile_info != nullptr);
+        ASSERT_EQ(1u, object_cache->GetMissCnt());
+        ASSERT_EQ(i, object_cache->GetHitCnt());
+        uint64_t hit_cnt = 0;
+        uint64_t miss_cnt = 0;
+        Engine engine(catalog, options);
+        ASSERT_TRUE(engine.GetJitObjectCacheStat(&hit_cnt, &miss_cnt));
+        ASSERT_EQ(i, hit_cnt);
+        ASSERT_EQ(1u, miss_cnt);
+
+        auto fn = compile_info->get_sql_context().physical_plan->GetFnInfos()[0]->fn_ptr();
+        ASSERT_TRUE(fn != nullptr);
+        int8_t buf[1024];
+        codec::RowBuilder row_builder(*schema);
+        row_builder.SetBuffer(buf, 1024);
+        row_builder.AppendDouble(3.14);
+        row_builder.AppendInt64(42);
+        hybridse::codec::Row empty_parameter;
+        hybridse::codec::Row row(base::RefCountedSlice::Create(buf, 1024));
+        hybridse::codec::Row output = CoreAPI::RowProject(fn, row, empty_parameter);
+        codec::RowView row_view(*schema, output.buf(), output.size());
+        double c1;
+        int64_t c2;
+        ASSERT_EQ(row_view.GetDouble(0, &c1), 0);
+        ASSERT_EQ(row_view.GetInt64(1, &c2), 0);
+        ASSERT_EQ(c1, 3.14);
+        ASSERT_EQ(c2, 43);
+    }
+    EngineOptions disabled_options;
+    uint64_t hit_cnt = 0;
+    uint64_t miss_cnt = 0;
+    Engine engine(catalog, disabled_options);
+    ASSERT_FALSE(engine.GetJitObjectCacheStat(&hit_cnt, &miss_cnt));
+    boost::filesystem::remove_all(path);
+}
+
+TEST_F(JitWrapperTest, test_object_cache_capacity) {
+    std::string path = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+    EngineOptions options;
+    options.jit_options().SetObjectCachePath(path);
+    options.jit_options().SetObjectCacheCapacity(1);
+    auto object_cache = JitObjectCache::Get(path, 1);
+    ASSERT_TRUE(object_cache != nullptr);
+    auto catalog = GetTestCatalog();
+    ASSERT_TRUE(Compile("select col_1 + 1 from t1;", options, catalog) != nullptr);
+    ASSERT_TRUE(Compile("select col_2 + 1 from t1;", options, catalog) != nullptr);
+    // the object of the first sql is evicted
+    ASSERT_EQ(1u, object_cache->GetSize());
+    ASSERT_TRUE(Compile("select col_1 + 1 from t1;", options, catalog) != nullptr);
+    ASSERT_EQ(3u, object_cache->GetMissCnt());
+    ASSERT_EQ(0u, object_cache->GetHitCnt());
+    ASSERT_TRUE(Compile("select col_1 + 1 from t1;", options, catalog) != nullptr);
+    ASSERT_EQ(1u, object_cache->GetHitCnt());
+    ASSERT_EQ(1u, object_cache->GetSize());
+
+    // the objects are dropped with the engine cache
+    Engine engine(catalog, options);
+    engine.ClearCacheLocked("");
+    ASSERT_EQ(0u, object_cache->GetSize());
+    boost::filesystem::remove_all(path);
+}
+
 }  // namespace vm
 }  // namespace hybridse
 
@@ -635,6 +635,9 @@ void PhysicalGroupAggrerationNode::Print(std::ostream& output,
     if (having_condition_.ValidCondition()) {
         output << ", having_" << having_condition_.ToString();
     }
+    if (parallelism_ > 1) {
+        output << ", parallelism=" << parallelism_;
+    }
     PrintOptional(output, "limit", limit_cnt_);
     output << ")";
     output << "\n";
@@ -757,6 +760,9 @@ void PhysicalWindowAggrerationNode::Print(std::ostream& output, const std::strin
     if (need_append_input()) {
         output << ", NEED_APPEND_INPUT";
     }
+    if (parallelism_ > 1) {
+        output << ", parallelism=" << parallelism_;
+    }
     PrintOptional(output, "limit", limit_cnt_);
     output << ")\n";
 
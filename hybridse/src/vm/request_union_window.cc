@@ -0,0 +1,164 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/request_union_window.h"
+
+#include "vm/runner.h"
+
+namespace hybridse {
+namespace vm {
+
+// RequestUnionWindowIterator merges the union segments like a k-way merge and stops
+// at the bound of window
+class RequestUnionWindowIterator : public RowIterator {
+ public:
+    RequestUnionWindowIterator(const Row* request, bool output_request_row,
+                               const std::vector<std::shared_ptr<TableHandler>>* union_segments,
+                               const WindowRange* window_range, const RequestWindowBound* bound)
+        : request_(request),
+          output_request_row_(output_request_row),
+          union_segments_(union_segments),
+          window_range_(window_range),
+          bound_(bound),
+          iters_(union_segments->size()),
+          status_(union_segments->size()) {
+        SeekToFirst();
+    }
+    ~RequestUnionWindowIterator() {}
+
+    bool Valid() const override { return valid_; }
+
+    void Next() override {
+        if (at_request_) {
+            at_request_ = false;
+        } else {
+            Advance();
+        }
+        Forward();
+    }
+
+    const uint64_t& GetKey() const override {
+        return at_request_ ? bound_->request_key : status_[pos_].key_;
+    }
+
+    const Row& GetValue() override { return at_request_ ? *request_ : iters_[pos_]->GetValue(); }
+
+    // the keys are in descending order
+    void Seek(const uint64_t& key) override {
+        SeekToFirst();
+        while (Valid() && GetKey() > key) {
+            Next();
+        }
+    }
+
+    void SeekToFirst() override {
+        for (size_t i = 0; i < iters_.size(); i++) {
+            status_[i] = IteratorStatus();
+            if (!(*union_segments_)[i]) {
+                iters_[i].reset();
+                continue;
+            }
+            iters_[i] = (*union_segments_)[i]->GetIterator();
+            if (!iters_[i]) {
+                continue;
+            }
+            iters_[i]->Seek(bound_->end.value_or(0));
+            if (iters_[i]->Valid()) {
+                status_[i] = IteratorStatus(iters_[i]->GetKey());
+            }
+        }
+        pos_ = IteratorStatus::FindFirstIteratorWithMaximizeKey(status_);
+        cnt_ = 0;
+        auto range_status = window_range_->GetWindowPositionStatus(
+            cnt_ > bound_->rows_start_preceding, window_range_->end_offset_ < 0,
+            bound_->request_key < bound_->start);
+        if (WindowRange::kInWindow == range_status) {
+            cnt_++;
+        }
+        if (output_request_row_) {
+            at_request_ = true;
+            valid_ = true;
+            return;
+        }
+        at_request_ = false;
+        Forward();
+    }
+
+    bool IsSeekable() const override { return true; }
+
+ private:
+    // move to the first row in window from the current position
+    void Forward() {
+        while (-1 != pos_) {
+            if (bound_->max_size > 0 && cnt_ >= bound_->max_size) {
+                break;
+            }
+            auto range_status = window_range_->GetWindowPositionStatus(
+                cnt_ > bound_->rows_start_preceding, status_[pos_].key_ > bound_->end,
+                status_[pos_].key_ < bound_->start);
+            if (WindowRange::kExceedWindow == range_status) {
+                break;
+            }
+            if (WindowRange::kInWindow == range_status) {
+                cnt_++;
+                valid_ = true;
+                return;
+            }
+            Advance();
+        }
+        valid_ = false;
+    }
+
+    // move the iterator of current position and pick the next one with maximum key
+    void Advance() {
+        if (-1 == pos_) {
+            return;
+        }
+        iters_[pos_]->Next();
+        if (!iters_[pos_]->Valid()) {
+            status_[pos_].MarkInValid();
+        } else {
+            status_[pos_].set_key(iters_[pos_]->GetKey());
+        }
+        pos_ = IteratorStatus::FindFirstIteratorWithMaximizeKey(status_);
+    }
+
+    const Row* request_;
+    const bool output_request_row_;
+    const std::vector<std::shared_ptr<TableHandler>>* union_segments_;
+    const WindowRange* window_range_;
+    const RequestWindowBound* bound_;
+    std::vector<std::unique_ptr<RowIterator>> iters_;
+    std::vector<IteratorStatus> status_;
+    int32_t pos_ = -1;
+    uint64_t cnt_ = 0;
+    bool at_request_ = false;
+    bool valid_ = false;
+};
+
+RowIterator* RequestUnionWindowHandler::GetRawIterator() {
+    return new RequestUnionWindowIterator(&request_, output_request_row_, &union_segments_, &window_range_, &bound_);
+}
+
+const uint64_t RequestUnionWindowHandler::GetCount() {
+    if (!count_.has_value()) {
+        count_ = TableHandler::GetCount();
+    }
+    return count_.value();
+}
+
+}  // namespace vm
+}  // namespace hybridse
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_SRC_VM_REQUEST_UNION_WINDOW_H_
+#define HYBRIDSE_SRC_VM_REQUEST_UNION_WINDOW_H_
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "vm/catalog.h"
+#include "vm/mem_catalog.h"
+
+namespace hybridse {
+namespace vm {
+
+// the bounds of request window computed from the request key and window range
+struct RequestWindowBound {
+    uint64_t request_key = 0;
+    uint64_t start = 0;
+    // end is empty means there is no effective window range
+    std::optional<uint64_t> end = UINT64_MAX;
+    uint64_t rows_start_preceding = 0;
+    uint64_t max_size = 0;
+};
+
+// RequestUnionWindowHandler is the window of request union. The rows are merged from
+// the union segments by key in descending order when the window is iterated, so the
+// rows are never copied and each iterator only reads the rows in window bound.
+// The request row is the first row if `output_request_row` is true.
+class RequestUnionWindowHandler : public TableHandler {
+ public:
+    RequestUnionWindowHandler(const Row& request, bool output_request_row,
+                              const std::vector<std::shared_ptr<TableHandler>>& union_segments,
+                              const WindowRange& window_range, const RequestWindowBound& bound)
+        : request_(request),
+          output_request_row_(output_request_row),
+          union_segments_(union_segments),
+          window_range_(window_range),
+          bound_(bound) {}
+    ~RequestUnionWindowHandler() {}
+
+    std::unique_ptr<RowIterator> GetIterator() override {
+        return std::unique_ptr<RowIterator>(GetRawIterator());
+    }
+    RowIterator* GetRawIterator() override;
+    const uint64_t GetCount() override;
+
+    const Types& GetTypes() override { return types_; }
+    const IndexHint& GetIndex() override { return index_hint_; }
+    std::unique_ptr<WindowIterator> GetWindowIterator(const std::string&) override { return nullptr; }
+    const Schema* GetSchema() override { return nullptr; }
+    const std::string& GetName() override { return name_; }
+    const std::string& GetDatabase() override { return db_; }
+    const std::string GetHandlerTypeName() override { return "RequestUnionWindowHandler"; }
+
+    const Row& request() const { return request_; }
+    bool output_request_row() const { return output_request_row_; }
+    const std::vector<std::shared_ptr<TableHandler>>& union_segments() const { return union_segments_; }
+    const RequestWindowBound& bound() const { return bound_; }
+
+ private:
+    const Row request_;
+    const bool output_request_row_;
+    const std::vector<std::shared_ptr<TableHandler>> union_segments_;
+    const WindowRange window_range_;
+    const RequestWindowBound bound_;
+    // the count is computed when it is first required
+    std::optional<uint64_t> count_;
+    Types types_;
+    IndexHint index_hint_;
+    std::string name_;
+    std::string db_;
+};
+
+}  // namespace vm
+}  // namespace hybridse
+#endif  // HYBRIDSE_SRC_VM_REQUEST_UNION_WINDOW_H_
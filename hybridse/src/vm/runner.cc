@@ -16,8 +16,12 @@
 
 #include "vm/runner.h"
 
+#include <algorithm>
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <string>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
@@ -31,8 +35,13 @@
 #include "vm/internal/eval.h"
 #include "vm/jit_runtime.h"
 #include "vm/mem_catalog.h"
+#include "vm/request_union_window.h"
 
 DECLARE_bool(enable_spark_unsaferow_format);
+DECLARE_bool(enable_incremental_window_agg);
+DECLARE_bool(enable_lazy_request_window);
+DECLARE_bool(enable_batch_request_prefetch);
+DECLARE_bool(enable_async_subquery);
 
 namespace hybridse {
 namespace vm {
@@ -211,6 +220,24 @@ ClusterTask RunnerBuilder::Build(PhysicalOpNode* node, Status& status) {
                     }
                     CreateRunner<AggRunner>(&runner, id_++, node->schemas_ctx(), op->GetLimitCnt(),
                                             agg_node->having_condition_, op->project().fn_info());
+                    if (window_state_cache_size_ > 0 && kRunnerRequestUnion == input->type_ &&
+                        !agg_node->having_condition_.ValidCondition() && !FLAGS_enable_spark_unsaferow_format) {
+                        auto union_runner = dynamic_cast<RequestUnionRunner*>(input);
+                        auto& windows_gen = union_runner->windows_union_gen_.windows_gen_;
+                        // the window of one table whose partition is the index key
+                        if (windows_gen.size() == 1 && windows_gen[0].index_seek_gen_.Valid() &&
+                            !windows_gen[0].filter_gen_.Valid() && union_runner->output_request_row_ &&
+                            !union_runner->exclude_current_time_ && !union_runner->exclude_current_row_ &&
+                            RequestWindowStateCache::IsSupported(union_runner->range_gen_.window_range_)) {
+                            auto agg = IncrementalWindowAgg::Build(op->project(), node->GetProducer(0)->schemas_ctx());
+                            if (agg) {
+                                runner->SetWindowStateCache(
+                                    union_runner, std::make_unique<RequestWindowStateCache>(
+                                                      std::move(agg), union_runner->range_gen_.window_range_,
+                                                      window_state_cache_size_));
+                            }
+                        }
+                    }
                     return RegisterTask(node, UnaryInheritTask(cluster_task, runner));
                 }
                 case kGroupAggregation: {
@@ -228,6 +255,7 @@ ClusterTask RunnerBuilder::Build(PhysicalOpNode* node, Status& status) {
                     CreateRunner<GroupAggRunner>(
                         &runner, id_++, node->schemas_ctx(), op->GetLimitCnt(),
                         op->group_, op->having_condition_, op->project().fn_info());
+                    runner->SetParallelism(op->parallelism());
                     return RegisterTask(node,
                                         UnaryInheritTask(cluster_task, runner));
                 }
@@ -246,6 +274,13 @@ ClusterTask RunnerBuilder::Build(PhysicalOpNode* node, Status& status) {
                         &runner, id_++, op->schemas_ctx(), op->GetLimitCnt(), op->window_, op->project().fn_info(),
                         op->instance_not_in_window(), op->exclude_current_time(), op->exclude_current_row(),
                         op->need_append_input() ? node->GetProducer(0)->schemas_ctx()->GetSchemaSourceSize() : 0);
+                    runner->SetParallelism(op->parallelism());
+                    // the rows of window joins are not resolved by the input schemas
+                    if (FLAGS_enable_incremental_window_agg && !FLAGS_enable_spark_unsaferow_format &&
+                        op->window_joins_.Empty()) {
+                        runner->SetIncrementalAgg(
+                            IncrementalWindowAgg::Build(op->project(), node->GetProducer(0)->schemas_ctx()));
+                    }
                     size_t input_slices = input->output_schemas()->GetSchemaSourceSize();
                     if (!op->window_unions_.Empty()) {
                         for (auto window_union :
@@ -1103,6 +1138,9 @@ std::shared_ptr<DataHandlerList> Runner::BatchRequestRun(RunnerContext& ctx) {
     for (size_t idx = producers_.size(); idx > 0; idx--) {
         batch_inputs[idx - 1] = producers_[idx - 1]->BatchRequestRun(ctx);
     }
+    if (ctx.GetRequestSize() > 1) {
+        PrepareBatch(ctx, batch_inputs);
+    }
 
     for (size_t idx = 0; idx < ctx.GetRequestSize(); idx++) {
         inputs.clear();
@@ -1411,6 +1449,53 @@ std::shared_ptr<DataHandler> SelectSliceRunner::Run(
     return nullptr;
 }
 
+// run `fn` on each key by `parallelism` threads. the keys are split into chunks which are picked by
+// the idle threads, so a few huge partitions do not stall the others. the outputs of chunks are
+// appended to `output_table` in order of keys, the same as running `fn` on the keys one by one.
+// return false if `fn` fails on any key
+static bool RunOnKeysInParallel(const std::vector<std::string>& keys, uint32_t parallelism,
+                                const std::function<bool(const std::string&, std::shared_ptr<MemTableHandler>)>& fn,
+                                MemTableHandler* output_table) {
+    // more chunks than threads for balance, but not too small to share the work of a thread
+    const size_t chunk_size = std::max<size_t>(1, keys.size() / (parallelism * 8));
+    const size_t chunk_cnt = (keys.size() + chunk_size - 1) / chunk_size;
+    std::vector<std::shared_ptr<MemTableHandler>> outputs(chunk_cnt);
+    std::atomic<size_t> next_chunk(0);
+    std::atomic<bool> ok(true);
+    auto worker = [&]() {
+        size_t chunk = 0;
+        while (ok.load(std::memory_order_relaxed) && (chunk = next_chunk.fetch_add(1)) < chunk_cnt) {
+            auto output = std::make_shared<MemTableHandler>();
+            size_t end = std::min(keys.size(), (chunk + 1) * chunk_size);
+            for (size_t i = chunk * chunk_size; i < end; i++) {
+                if (!fn(keys[i], output)) {
+                    ok.store(false, std::memory_order_relaxed);
+                    break;
+                }
+            }
+            outputs[chunk] = output;
+        }
+    };
+    std::vector<std::thread> threads;
+    size_t thread_cnt = std::min<size_t>(parallelism, chunk_cnt);
+    for (size_t i = 1; i < thread_cnt; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (!ok.load()) {
+        return false;
+    }
+    for (auto& output : outputs) {
+        for (uint64_t i = 0; i < output->GetCount(); i++) {
+            output_table->AddRow(output->At(i));
+        }
+    }
+    return true;
+}
+
 std::shared_ptr<DataHandler> WindowAggRunner::Run(
     RunnerContext& ctx,
     const std::vector<std::shared_ptr<DataHandler>>& inputs) {
@@ -1448,6 +1533,22 @@ std::shared_ptr<DataHandler> WindowAggRunner::Run(
 
     // Compute output
     std::shared_ptr<MemTableHandler> output_table = std::make_shared<MemTableHandler>();
+    // the limit counts the output of previous keys and window joins may not be thread safe
+    if (parallelism_ > 1 && !limit_cnt_.has_value() && !windows_join_gen_.Valid()) {
+        std::vector<std::string> keys;
+        while (instance_partition_iter->Valid()) {
+            keys.push_back(instance_partition_iter->GetKey().ToString());
+            instance_partition_iter->Next();
+        }
+        RunOnKeysInParallel(
+            keys, parallelism_,
+            [&](const std::string& key, std::shared_ptr<MemTableHandler> output) {
+                RunWindowAggOnKey(parameter, instance_partition, union_partitions, join_right_tables, key, output);
+                return true;
+            },
+            output_table.get());
+        return output_table;
+    }
     while (instance_partition_iter->Valid()) {
         auto key = instance_partition_iter->GetKey().ToString();
         RunWindowAggOnKey(parameter, instance_partition, union_partitions,
@@ -1512,10 +1613,16 @@ void WindowAggRunner::RunWindowAggOnKey(
 
     int32_t min_union_pos = IteratorStatus::FindLastIteratorWithMininumKey(union_segment_status);
     int32_t cnt = output_table->GetCount();
-    HistoryWindow window(instance_window_gen_.range_gen_.window_range_);
-    window.set_instance_not_in_window(instance_not_in_window_);
-    window.set_exclude_current_time(exclude_current_time_);
-    window.set_exclude_current_row(exclude_current_row_);
+    std::unique_ptr<HistoryWindow> window;
+    if (incremental_agg_) {
+        window = std::make_unique<IncrementalWindow>(instance_window_gen_.range_gen_.window_range_,
+                                                     incremental_agg_.get());
+    } else {
+        window = std::make_unique<HistoryWindow>(instance_window_gen_.range_gen_.window_range_);
+    }
+    window->set_instance_not_in_window(instance_not_in_window_);
+    window->set_exclude_current_time(exclude_current_time_);
+    window->set_exclude_current_row(exclude_current_row_);
 
     while (instance_segment_iter->Valid()) {
         if (limit_cnt_.has_value() && cnt >= limit_cnt_) {
@@ -1531,9 +1638,7 @@ void WindowAggRunner::RunWindowAggOnKey(
             if (windows_join_gen_.Valid()) {
                 row = windows_join_gen_.Join(row, join_right_tables, parameter);
             }
-            window_project_gen_.Gen(
-                union_segment_iters[min_union_pos]->GetKey(), row, parameter,
-                false, append_slices_, &window);
+            WindowProject(union_segment_iters[min_union_pos]->GetKey(), row, parameter, false, window.get());
 
             // Update Iterator Status
             union_segment_iters[min_union_pos]->Next();
@@ -1549,11 +1654,9 @@ void WindowAggRunner::RunWindowAggOnKey(
 
         if (windows_join_gen_.Valid()) {
             Row row = windows_join_gen_.Join(instance_row, join_right_tables, parameter);
-            output_table->AddRow(
-                window_project_gen_.Gen(instance_order, row, parameter, true, append_slices_, &window));
+            output_table->AddRow(WindowProject(instance_order, row, parameter, true, window.get()));
         } else {
-            output_table->AddRow(
-                window_project_gen_.Gen(instance_order, instance_row, parameter, true, append_slices_, &window));
+            output_table->AddRow(WindowProject(instance_order, instance_row, parameter, true, window.get()));
         }
 
         cnt++;
@@ -1561,6 +1664,33 @@ void WindowAggRunner::RunWindowAggOnKey(
     }
 }
 
+// cache the row into window and if `is_instance`, compute window project for
+// current row, by the states of window if it is incremental
+Row WindowAggRunner::WindowProject(const uint64_t key, const Row& row, const Row& parameter, const bool is_instance,
+                                   HistoryWindow* window) {
+    if (!incremental_agg_) {
+        return window_project_gen_.Gen(key, row, parameter, is_instance, append_slices_, window);
+    }
+    if (row.empty()) {
+        return row;
+    }
+    if (!window->BufferData(key, row)) {
+        LOG(WARNING) << "fail to buffer data";
+        return Row();
+    }
+    if (!is_instance) {
+        return Row();
+    }
+    Row out_row = dynamic_cast<IncrementalWindow*>(window)->Output(row);
+    if (window->instance_not_in_window()) {
+        window->PopFrontData();
+    }
+    if (append_slices_ > 0) {
+        return Row(append_slices_, row, 1, out_row);
+    }
+    return out_row;
+}
+
 std::shared_ptr<DataHandler> RequestLastJoinRunner::Run(
     RunnerContext& ctx,
     const std::vector<std::shared_ptr<DataHandler>>& inputs) {  // NOLINT
@@ -2642,6 +2772,28 @@ std::shared_ptr<DataHandler> GroupAggRunner::Run(
             return std::shared_ptr<DataHandler>();
         }
         iter->SeekToFirst();
+        if (parallelism_ > 1 && !limit_cnt_.has_value()) {
+            std::vector<std::string> keys;
+            while (iter->Valid()) {
+                keys.push_back(iter->GetKey().ToString());
+                iter->Next();
+            }
+            bool ok = RunOnKeysInParallel(
+                keys, parallelism_,
+                [&](const std::string& key, std::shared_ptr<MemTableHandler> output) {
+                    auto segment = partition->GetSegment(key);
+                    if (!segment) {
+                        LOG(WARNING) << "group aggregation fail: segment segment is null";
+                        return false;
+                    }
+                    if (!having_condition_.Valid() || having_condition_.Gen(segment, parameter)) {
+                        output->AddRow(agg_gen_.Gen(parameter, segment));
+                    }
+                    return true;
+                },
+                output_table.get());
+            return ok ? output_table : std::shared_ptr<DataHandler>();
+        }
         int32_t cnt = 0;
         while (iter->Valid()) {
             auto key = iter->GetKey().ToString();
@@ -2665,6 +2817,120 @@ std::shared_ptr<DataHandler> GroupAggRunner::Run(
     }
 }
 
+// add the value to sketch by the bytes of its storage type, the same as the pre-aggregator and udaf
+static void UpdateSketch(const RowParser* row_parser, const Row& row, const std::string& col,
+                         ApproxDistinctCountAggregator* aggregator) {
+    auto type = row_parser->GetType(col);
+    switch (type) {
+        case type::Type::kBool: {
+            bool val = false;
+            row_parser->GetValue(row, col, type, &val);
+            aggregator->UpdateBytes(&val, sizeof(bool));
+            break;
+        }
+        case type::Type::kInt16: {
+            int16_t val = 0;
+            row_parser->GetValue(row, col, type, &val);
+            aggregator->UpdateBytes(&val, sizeof(int16_t));
+            break;
+        }
+        case type::Type::kDate:
+        case type::Type::kInt32: {
+            int32_t val = 0;
+            row_parser->GetValue(row, col, type, &val);
+            aggregator->UpdateBytes(&val, sizeof(int32_t));
+            break;
+        }
+        case type::Type::kTimestamp:
+        case type::Type::kInt64: {
+            int64_t val = 0;
+            row_parser->GetValue(row, col, type, &val);
+            aggregator->UpdateBytes(&val, sizeof(int64_t));
+            break;
+        }
+        case type::Type::kFloat: {
+            float val = 0;
+            row_parser->GetValue(row, col, type, &val);
+            // -0.0 and 0.0 are the same value
+            if (val == 0) {
+                val = 0;
+            }
+            aggregator->UpdateBytes(&val, sizeof(float));
+            break;
+        }
+        case type::Type::kDouble: {
+            double val = 0;
+            row_parser->GetValue(row, col, type, &val);
+            if (val == 0) {
+                val = 0;
+            }
+            aggregator->UpdateBytes(&val, sizeof(double));
+            break;
+        }
+        case type::Type::kVarchar: {
+            std::string val;
+            row_parser->GetString(row, col, &val);
+            aggregator->UpdateBytes(val.data(), val.size());
+            break;
+        }
+        default:
+            LOG(ERROR) << "Not support type: " << Type_Name(type);
+            break;
+    }
+}
+
+// get the category in the same string form as the filter key of pre-aggr rows, return false if null
+static bool GetCateKey(const RowParser* row_parser, const Row& row, const std::string& col, type::Type type,
+                       std::string* key) {
+    if (row_parser->IsNull(row, col)) {
+        return false;
+    }
+    switch (type) {
+        case type::Type::kInt16: {
+            int16_t val = 0;
+            row_parser->GetValue(row, col, type, &val);
+            *key = std::to_string(val);
+            return true;
+        }
+        case type::Type::kInt32: {
+            int32_t val = 0;
+            row_parser->GetValue(row, col, type, &val);
+            *key = std::to_string(val);
+            return true;
+        }
+        case type::Type::kInt64:
+        case type::Type::kTimestamp: {
+            int64_t val = 0;
+            row_parser->GetValue(row, col, type, &val);
+            *key = std::to_string(val);
+            return true;
+        }
+        case type::Type::kBool: {
+            bool val = false;
+            row_parser->GetValue(row, col, type, &val);
+            *key = val ? "true" : "false";
+            return true;
+        }
+        case type::Type::kDate: {
+            int32_t val = 0;
+            row_parser->GetValue(row, col, type, &val);
+            int32_t year = 0;
+            int32_t month = 0;
+            int32_t day = 0;
+            if (!openmldb::base::Date::Decode(val, &year, &month, &day)) {
+                return false;
+            }
+            *key = absl::StrCat(year, "-", month, "-", day);
+            return true;
+        }
+        case type::Type::kVarchar:
+            return 0 == row_parser->GetString(row, col, key);
+        default:
+            LOG(ERROR) << "Not support category type: " << Type_Name(type);
+            return false;
+    }
+}
+
 bool RequestAggUnionRunner::InitAggregator() {
     auto func_name = func_->GetName();
     auto type_it = agg_type_map_.find(func_name);
@@ -2674,6 +2940,17 @@ bool RequestAggUnionRunner::InitAggregator() {
     }
 
     agg_type_ = type_it->second;
+    if (IsCate()) {
+        // the second arg of *_cate is the category column instead of filter condition
+        if (cond_ == nullptr || cond_->GetExprType() != node::kExprColumnRef ||
+            agg_col_->GetExprType() != node::kExprColumnRef) {
+            LOG(ERROR) << "expect value and category columns for " << func_name;
+            return false;
+        }
+        cate_col_name_ = dynamic_cast<const node::ColumnRefNode*>(cond_)->GetColumnName();
+        cate_col_type_ = producers_[1]->row_parser()->GetType(cate_col_name_);
+        cond_ = nullptr;
+    }
     if (agg_col_->GetExprType() == node::kExprColumnRef) {
         agg_col_type_ = producers_[1]->row_parser()->GetType(agg_col_name_);
     } else if (agg_col_->GetExprType() == node::kExprAll) {
@@ -2691,6 +2968,26 @@ bool RequestAggUnionRunner::InitAggregator() {
 
 std::unique_ptr<BaseAggregator> RequestAggUnionRunner::CreateAggregator() const {
     switch (agg_type_) {
+        case kCountCate:
+        case kSumCate:
+        case kAvgCate:
+        case kMinCate:
+        case kMaxCate: {
+            static const absl::flat_hash_map<AggType, AggType> value_types = {
+                {kCountCate, kCount}, {kSumCate, kSum}, {kAvgCate, kAvg}, {kMinCate, kMin}, {kMaxCate, kMax}};
+            AggType value_type = value_types.at(agg_type_);
+            return std::make_unique<CateAggregator>(agg_col_type_, cate_col_type_, *output_schemas_->GetOutputSchema(),
+                                                    [this, value_type]() { return CreateValueAggregator(value_type); });
+        }
+        case kApproxDistinctCount:
+            return std::make_unique<ApproxDistinctCountAggregator>(agg_col_type_, *output_schemas_->GetOutputSchema());
+        default:
+            return CreateValueAggregator(agg_type_);
+    }
+}
+
+std::unique_ptr<BaseAggregator> RequestAggUnionRunner::CreateValueAggregator(AggType agg_type) const {
+    switch (agg_type) {
         case kSum:
         case kSumWhere:
             return MakeOverflowAggregator<SumAggregator>(agg_col_type_, *output_schemas_->GetOutputSchema());
@@ -2822,12 +3119,30 @@ std::shared_ptr<TableHandler> RequestAggUnionRunner::RequestUnionWindow(
     int64_t request_key = ts_gen > 0 ? ts_gen : 0;
 
     auto aggregator = CreateAggregator();
+    if (!aggregator) {
+        return nullptr;
+    }
     auto update_base_aggregator = [aggregator = aggregator.get(), row_parser = base_row_parser, this](const Row& row) {
         DLOG(INFO) << "[Update Base]\n" << GetPrettyRow(row_parser->schema_ctx(), row);
         if (!agg_col_name_.empty() && row_parser->IsNull(row, agg_col_name_)) {
             return;
         }
 
+        if (agg_type_ == kApproxDistinctCount) {
+            UpdateSketch(row_parser, row, agg_col_name_, dynamic_cast<ApproxDistinctCountAggregator*>(aggregator));
+            return;
+        }
+
+        // *_cate updates the aggregator of the category
+        BaseAggregator* target = aggregator;
+        if (IsCate()) {
+            std::string cate;
+            if (!GetCateKey(row_parser, row, cate_col_name_, cate_col_type_, &cate)) {
+                return;
+            }
+            target = dynamic_cast<CateAggregator*>(aggregator)->GetCate(cate);
+        }
+
         if (cond_ != nullptr) {
             // for those condition exists and evaluated to NULL/false
             // will apply to functions `*_where`
@@ -2844,9 +3159,9 @@ std::shared_ptr<TableHandler> RequestAggUnionRunner::RequestUnionWindow(
             }
         }
 
-        auto type = aggregator->type();
-        if (agg_type_ == kCount || agg_type_ == kCountWhere) {
-            dynamic_cast<Aggregator<int64_t>*>(aggregator)->UpdateValue(1);
+        auto type = target->type();
+        if (agg_type_ == kCount || agg_type_ == kCountWhere || agg_type_ == kCountCate) {
+            dynamic_cast<Aggregator<int64_t>*>(target)->UpdateValue(1);
             return;
         }
 
@@ -2857,39 +3172,39 @@ std::shared_ptr<TableHandler> RequestAggUnionRunner::RequestUnionWindow(
             case type::Type::kInt16: {
                 int16_t val = 0;
                 row_parser->GetValue(row, agg_col_name_, type, &val);
-                AggregatorUpdate(aggregator, val);
+                AggregatorUpdate(target, val);
                 break;
             }
             case type::Type::kDate:
             case type::Type::kInt32: {
                 int32_t val = 0;
                 row_parser->GetValue(row, agg_col_name_, type, &val);
-                AggregatorUpdate(aggregator, val);
+                AggregatorUpdate(target, val);
                 break;
             }
             case type::Type::kTimestamp:
             case type::Type::kInt64: {
                 int64_t val = 0;
                 row_parser->GetValue(row, agg_col_name_, type, &val);
-                AggregatorUpdate(aggregator, val);
+                AggregatorUpdate(target, val);
                 break;
             }
             case type::Type::kFloat: {
                 float val = 0;
                 row_parser->GetValue(row, agg_col_name_, type, &val);
-                AggregatorUpdate(aggregator, val);
+                AggregatorUpdate(target, val);
                 break;
             }
             case type::Type::kDouble: {
                 double val = 0;
                 row_parser->GetValue(row, agg_col_name_, type, &val);
-                AggregatorUpdate(aggregator, val);
+                AggregatorUpdate(target, val);
                 break;
             }
             case type::Type::kVarchar: {
                 std::string val;
                 row_parser->GetString(row, agg_col_name_, &val);
-                AggregatorUpdate(aggregator, val);
+                AggregatorUpdate(target, val);
                 break;
             }
             default:
@@ -2919,6 +3234,15 @@ std::shared_ptr<TableHandler> RequestAggUnionRunner::RequestUnionWindow(
 
         std::string agg_val;
         row_parser->GetString(row, "agg_val", &agg_val);
+        if (IsCate()) {
+            // the pre-aggr rows of empty category have null filter key
+            std::string cate;
+            if (!row_parser->IsNull(row, "filter_key")) {
+                row_parser->GetString(row, "filter_key", &cate);
+            }
+            dynamic_cast<CateAggregator*>(aggregator)->UpdateCate(cate, agg_val);
+            return;
+        }
         aggregator->Update(agg_val);
     };
 
@@ -3024,7 +3348,7 @@ std::shared_ptr<TableHandler> RequestAggUnionRunner::RequestUnionWindow(
             break;
         }
 
-        if (cond_ == nullptr) {
+        if (cond_ == nullptr && !IsCate()) {
             const uint64_t ts_start = agg_it->GetKey();
             const Row& row = agg_it->GetValue();
             if (prev_ts_start == ts_start) {
@@ -3070,11 +3394,12 @@ std::shared_ptr<TableHandler> RequestAggUnionRunner::RequestUnionWindow(
 
                 std::string filter_val;
                 if (agg_row_parser->IsNull(drow, "filter_key")) {
-                    LOG(ERROR) << "filter_key is null for *_where op";
-                    agg_it->Next();
-                    continue;
-                }
-                if (0 != agg_row_parser->GetString(drow, "filter_key", &filter_val)) {
+                    if (!IsCate()) {
+                        LOG(ERROR) << "filter_key is null for *_where op";
+                        agg_it->Next();
+                        continue;
+                    }
+                } else if (0 != agg_row_parser->GetString(drow, "filter_key", &filter_val)) {
                     LOG(ERROR) << "failed to get value of filter_key";
                     agg_it->Next();
                     continue;
@@ -3224,32 +3549,42 @@ std::shared_ptr<DataHandler> RequestUnionRunner::Run(
                               range_gen_.window_range_, output_request_row_,
                               exclude_current_time_, exclude_current_row_);
 }
+void RequestUnionRunner::PrepareBatch(RunnerContext& ctx,
+                                      const std::vector<std::shared_ptr<DataHandlerList>>& batch_inputs) {
+    // the request rows seek different keys, prefetch the segments of all of them
+    // in batch so the storage can overlap the reads instead of seeking one by one
+    if (!FLAGS_enable_batch_request_prefetch || batch_inputs.empty() || !batch_inputs[0]) {
+        return;
+    }
+    std::vector<Row> requests;
+    requests.reserve(ctx.GetRequestSize());
+    for (size_t idx = 0; idx < ctx.GetRequestSize(); idx++) {
+        auto input = batch_inputs[0]->Get(idx);
+        if (!input || kRowHandler != input->GetHandlerType()) {
+            return;
+        }
+        requests.push_back(std::dynamic_pointer_cast<RowHandler>(input)->GetValue());
+    }
+    auto union_inputs = windows_union_gen_.RunInputs(ctx);
+    windows_union_gen_.PrefetchRequestWindows(requests, ctx.GetParameterRow(), union_inputs);
+}
 std::shared_ptr<TableHandler> RequestUnionRunner::RequestUnionWindow(
     const Row& request, std::vector<std::shared_ptr<TableHandler>> union_segments, int64_t ts_gen,
     const WindowRange& window_range, bool output_request_row, bool exclude_current_time, bool exclude_current_row) {
-    uint64_t start = 0;
-    // end is empty means end value < 0, that there is no effective window range
-    // this happend when `ts_gen` is 0 and exclude current_time needed
-    std::optional<uint64_t> end = UINT64_MAX;
-    uint64_t rows_start_preceding = 0;
-    uint64_t max_size = 0;
+    RequestWindowBound bound;
     if (ts_gen >= 0) {
-        start = (ts_gen + window_range.start_offset_) < 0
-                    ? 0
-                    : (ts_gen + window_range.start_offset_);
+        bound.start = (ts_gen + window_range.start_offset_) < 0 ? 0 : (ts_gen + window_range.start_offset_);
         if (exclude_current_time && 0 == window_range.end_offset_) {
             if (ts_gen == 0) {
-                end = {};
+                bound.end = {};
             } else {
-                end = ts_gen - 1;
+                bound.end = ts_gen - 1;
             }
         } else {
-            end = (ts_gen + window_range.end_offset_) < 0
-                      ? 0
-                      : (ts_gen + window_range.end_offset_);
+            bound.end = (ts_gen + window_range.end_offset_) < 0 ? 0 : (ts_gen + window_range.end_offset_);
         }
-        rows_start_preceding = window_range.start_row_;
-        max_size = window_range.max_size_;
+        bound.rows_start_preceding = window_range.start_row_;
+        bound.max_size = window_range.max_size_;
 
         // HACK: window ... maxsize sz exclude current_row
         // due to the implementation, current row should always present in the returned table
@@ -3258,77 +3593,23 @@ std::shared_ptr<TableHandler> RequestUnionRunner::RequestUnionWindow(
         // the proper window list will generated for exclude current_row in codegen
         //
         // see `Runner::GroupbyProject` when `exclude_current_row` is true
-        if (exclude_current_row && max_size > 0) {
-            max_size++;
-        }
-    }
-    uint64_t request_key = ts_gen > 0 ? static_cast<uint64_t>(ts_gen) : 0;
-
-    auto window_table = std::make_shared<MemTimeTableHandler>();
-
-    size_t unions_cnt = union_segments.size();
-    // Prepare Union Segment Iterators
-    std::vector<std::unique_ptr<RowIterator>> union_segment_iters(unions_cnt);
-    std::vector<IteratorStatus> union_segment_status(unions_cnt);
-
-    for (size_t i = 0; i < unions_cnt; i++) {
-        if (!union_segments[i]) {
-            union_segment_status[i] = IteratorStatus();
-            continue;
+        if (exclude_current_row && bound.max_size > 0) {
+            bound.max_size++;
         }
-        union_segment_iters[i] = union_segments[i]->GetIterator();
-        if (!union_segment_iters[i]) {
-            union_segment_status[i] = IteratorStatus();
-            continue;
-        }
-        union_segment_iters[i]->Seek(end.value_or(0));
-        if (!union_segment_iters[i]->Valid()) {
-            union_segment_status[i] = IteratorStatus();
-            continue;
-        }
-        uint64_t ts = union_segment_iters[i]->GetKey();
-        union_segment_status[i] = IteratorStatus(ts);
     }
-    int32_t max_union_pos = IteratorStatus::FindFirstIteratorWithMaximizeKey(union_segment_status);
+    bound.request_key = ts_gen > 0 ? static_cast<uint64_t>(ts_gen) : 0;
 
-    uint64_t cnt = 0;
-    auto range_status = window_range.GetWindowPositionStatus(
-        cnt > rows_start_preceding, window_range.end_offset_ < 0,
-        request_key < start);
-    if (output_request_row) {
-        window_table->AddRow(request_key, request);
+    // the window reads the rows of union segments when it is iterated
+    auto window = std::make_shared<RequestUnionWindowHandler>(request, output_request_row, union_segments,
+                                                              window_range, bound);
+    if (FLAGS_enable_lazy_request_window) {
+        return window;
     }
-    if (WindowRange::kInWindow == range_status) {
-        cnt++;
-    }
-
-    while (-1 != max_union_pos) {
-        if (max_size > 0 && cnt >= max_size) {
-            break;
-        }
-        auto range_status = window_range.GetWindowPositionStatus(
-            cnt > rows_start_preceding,
-            union_segment_status[max_union_pos].key_ > end,
-            union_segment_status[max_union_pos].key_ < start);
-        if (WindowRange::kExceedWindow == range_status) {
-            break;
-        }
-        if (WindowRange::kInWindow == range_status) {
-            window_table->AddRow(
-                union_segment_status[max_union_pos].key_,
-                union_segment_iters[max_union_pos]->GetValue());
-            cnt++;
-        }
-        // Update Iterator Status
-        union_segment_iters[max_union_pos]->Next();
-        if (!union_segment_iters[max_union_pos]->Valid()) {
-            union_segment_status[max_union_pos].MarkInValid();
-        } else {
-            union_segment_status[max_union_pos].set_key(
-                union_segment_iters[max_union_pos]->GetKey());
-        }
-        // Pick new mininum union pos
-        max_union_pos = IteratorStatus::FindFirstIteratorWithMaximizeKey(union_segment_status);
+    auto window_table = std::make_shared<MemTimeTableHandler>();
+    auto iter = window->GetIterator();
+    while (iter->Valid()) {
+        window_table->AddRow(iter->GetKey(), iter->GetValue());
+        iter->Next();
     }
     DLOG(INFO) << "REQUEST UNION cnt = " << window_table->GetCount();
     return window_table;
@@ -3384,17 +3665,43 @@ std::shared_ptr<DataHandler> AggRunner::Run(
     if (having_condition_.Valid() && !having_condition_.Gen(table, parameter)) {
         return std::shared_ptr<DataHandler>();
     }
+    if (window_state_cache_) {
+        Row output;
+        if (RunWithWindowStateCache(ctx, table, &output)) {
+            return std::make_shared<MemRowHandler>(output);
+        }
+    }
     auto row_handler = std::shared_ptr<RowHandler>(new MemRowHandler(agg_gen_.Gen(parameter, table)));
     return row_handler;
 }
+bool AggRunner::RunWithWindowStateCache(RunnerContext& ctx, const std::shared_ptr<TableHandler>& table,
+                                        Row* output) {
+    // the window isn't lazy if FLAGS_enable_lazy_request_window is off
+    auto window = std::dynamic_pointer_cast<RequestUnionWindowHandler>(table);
+    if (!window || !window->output_request_row() || window->union_segments().size() != 1) {
+        return false;
+    }
+    auto& window_gen = window_input_->windows_union_gen_.windows_gen_[0];
+    std::string key = window_gen.index_seek_gen_.index_key_gen_.Gen(window->request(), ctx.GetParameterRow());
+    return window_state_cache_->Compute(key, window->request(), window->union_segments()[0], window->bound(),
+                                        output);
+}
+std::shared_ptr<DataHandler> ProxyRequestRunner::RunWithCache(
+    RunnerContext& ctx) {
+    // the cache holds the issued subquery even if cache isn't enabled
+    auto cached = ctx.GetCache(id_);
+    if (cached != nullptr) {
+        DLOG(INFO) << "RUNNER ID " << id_ << " HIT CACHE!";
+        return cached;
+    }
+    return Runner::RunWithCache(ctx);
+}
 std::shared_ptr<DataHandlerList> ProxyRequestRunner::BatchRequestRun(
     RunnerContext& ctx) {
-    if (need_cache_) {
-        auto cached = ctx.GetBatchCache(id_);
-        if (cached != nullptr) {
-            DLOG(INFO) << "RUNNER ID " << id_ << " HIT CACHE!";
-            return cached;
-        }
+    auto cached = ctx.GetBatchCache(id_);
+    if (cached != nullptr) {
+        DLOG(INFO) << "RUNNER ID " << id_ << " HIT CACHE!";
+        return cached;
     }
     std::shared_ptr<DataHandlerList> proxy_batch_input =
         producers_[0]->BatchRequestRun(ctx);
@@ -4101,6 +4408,21 @@ std::shared_ptr<TableHandler> IndexSeekGenerator::SegmentOfKey(
     }
 }
 
+void IndexSeekGenerator::PrefetchSegments(const std::vector<Row>& rows, const Row& parameter,
+                                          std::shared_ptr<DataHandler> input) {
+    if (!input || !index_key_gen_.Valid() || kPartitionHandler != input->GetHandlerType()) {
+        return;
+    }
+    std::vector<std::string> keys;
+    keys.reserve(rows.size());
+    for (const auto& row : rows) {
+        if (!row.empty()) {
+            keys.push_back(index_key_gen_.Gen(row, parameter));
+        }
+    }
+    std::dynamic_pointer_cast<PartitionHandler>(input)->Prefetch(keys);
+}
+
 std::shared_ptr<DataHandler> FilterGenerator::Filter(std::shared_ptr<PartitionHandler> partition, const Row& parameter,
                                                      std::optional<int32_t> limit) {
     if (!partition) {
@@ -4156,6 +4478,80 @@ void RunnerContext::SetBatchCache(int64_t id,
     batch_cache_[id] = data;
 }
 
+// return true if the output of runner depends on any remote subquery
+static bool CollectSubQueryRunners(Runner* runner, std::map<int32_t, bool>* visited,
+                                   std::vector<Runner*>* subquery_runners) {
+    if (nullptr == runner) {
+        return false;
+    }
+    auto iter = visited->find(runner->id_);
+    if (iter != visited->end()) {
+        return iter->second;
+    }
+    bool depend_subquery = false;
+    for (auto producer : runner->GetProducers()) {
+        if (CollectSubQueryRunners(producer, visited, subquery_runners)) {
+            depend_subquery = true;
+        }
+    }
+    if (kRunnerRequestRunProxy == runner->type_) {
+        auto proxy = dynamic_cast<ProxyRequestRunner*>(runner);
+        if (nullptr != proxy && CollectSubQueryRunners(proxy->index_input(), visited, subquery_runners)) {
+            depend_subquery = true;
+        }
+        if (!depend_subquery) {
+            subquery_runners->push_back(runner);
+        }
+        depend_subquery = true;
+    }
+    visited->insert(std::make_pair(runner->id_, depend_subquery));
+    return depend_subquery;
+}
+
+void ClusterJob::ScheduleSubQueries() {
+    subquery_runners_.clear();
+    subquery_runners_.resize(tasks_.size());
+    if (!FLAGS_enable_async_subquery) {
+        return;
+    }
+    for (size_t i = 0; i < tasks_.size(); i++) {
+        auto root = tasks_[i].GetRoot();
+        std::map<int32_t, bool> visited;
+        std::vector<Runner*> runners;
+        CollectSubQueryRunners(root, &visited, &runners);
+        // the root is pulled first anyway
+        if (!runners.empty() && runners.back() == root) {
+            runners.pop_back();
+        }
+        subquery_runners_[i] = runners;
+    }
+}
+
+const std::vector<Runner*>& ClusterJob::GetSubQueryRunners(int32_t task_id) const {
+    static const std::vector<Runner*> empty;
+    if (task_id < 0 || task_id >= static_cast<int32_t>(subquery_runners_.size())) {
+        return empty;
+    }
+    return subquery_runners_[task_id];
+}
+
+void ClusterJob::IssueSubQueries(int32_t task_id, RunnerContext& ctx, bool is_batch_request) const {
+    // the subquery returns the async handler, the response is joined when the handler is read
+    for (auto runner : GetSubQueryRunners(task_id)) {
+        if (is_batch_request) {
+            auto res = runner->BatchRequestRun(ctx);
+            if (res) {
+                ctx.SetBatchCache(runner->id_, res);
+            }
+        } else {
+            auto res = runner->RunWithCache(ctx);
+            if (res) {
+                ctx.SetCache(runner->id_, res);
+            }
+        }
+    }
+}
+
 std::shared_ptr<DataHandler> RunnerContext::GetCache(int64_t id) const {
     auto iter = cache_.find(id);
     if (iter == cache_.end()) {
@@ -34,8 +34,10 @@
 #include "vm/catalog.h"
 #include "vm/catalog_wrapper.h"
 #include "vm/core_api.h"
+#include "vm/incremental_window.h"
 #include "vm/mem_catalog.h"
 #include "vm/physical_op.h"
+#include "vm/window_state_cache.h"
 namespace hybridse {
 namespace vm {
 
@@ -50,6 +52,7 @@ using vm::Window;
 
 class Runner;
 class RunnerContext;
+class RequestUnionRunner;
 class FnGenerator {
  public:
     explicit FnGenerator(const FnInfo& info)
@@ -249,6 +252,9 @@ class IndexSeekGenerator {
         std::shared_ptr<DataHandler> input);
     std::shared_ptr<TableHandler> SegmentOfKey(
         const Row& row, const Row& parameter, std::shared_ptr<DataHandler> input);
+    // hint the partition input to load the segments of the keys of rows in batch
+    void PrefetchSegments(const std::vector<Row>& rows, const Row& parameter,
+                          std::shared_ptr<DataHandler> input);
     const bool Valid() const { return index_key_gen_.Valid(); }
 
     KeyGenerator index_key_gen_;
@@ -495,6 +501,9 @@ class Runner : public node::NodeBase<Runner> {
         const std::vector<std::shared_ptr<DataHandler>>& inputs) = 0;
     virtual std::shared_ptr<DataHandlerList> BatchRequestRun(
         RunnerContext& ctx);  // NOLINT
+    // called by BatchRequestRun with the inputs of all request rows before they run one by one
+    virtual void PrepareBatch(RunnerContext& ctx,  // NOLINT
+                              const std::vector<std::shared_ptr<DataHandlerList>>& batch_inputs) {}
     virtual std::shared_ptr<DataHandler> RunWithCache(
         RunnerContext& ctx);  // NOLINT
 
@@ -651,6 +660,14 @@ class RequestWindowUnionGenerator : public InputsGenerator {
         }
         return union_segments;
     }
+    void PrefetchRequestWindows(const std::vector<Row>& rows, const Row& parameter,
+                                const std::vector<std::shared_ptr<DataHandler>>& union_inputs) {
+        if (!windows_gen_.empty()) {
+            for (size_t i = 0; i < union_inputs.size(); i++) {
+                windows_gen_[i].index_seek_gen_.PrefetchSegments(rows, parameter, union_inputs[i]);
+            }
+        }
+    }
     std::vector<RequestWindowGenertor> windows_gen_;
 };
 class JoinGenerator {
@@ -880,9 +897,15 @@ class GroupAggRunner : public Runner {
         RunnerContext& ctx,  // NOLINT
         const std::vector<std::shared_ptr<DataHandler>>& inputs)
         override;  // NOLINT
+    // aggregate the groups of partition input by `parallelism` threads
+    void SetParallelism(uint32_t parallelism) { parallelism_ = parallelism; }
+    uint32_t GetParallelism() const { return parallelism_; }
     KeyGenerator group_;
     ConditionGenerator having_condition_;
     AggGenerator agg_gen_;
+
+ private:
+    uint32_t parallelism_ = 1;
 };
 class AggRunner : public Runner {
  public:
@@ -898,8 +921,25 @@ class AggRunner : public Runner {
         RunnerContext& ctx,  // NOLINT
         const std::vector<std::shared_ptr<DataHandler>>& inputs)
         override;  // NOLINT
+    // keep the window states across requests for the window of request union
+    void SetWindowStateCache(RequestUnionRunner* window_input,
+                             std::unique_ptr<RequestWindowStateCache> cache) {
+        window_input_ = window_input;
+        window_state_cache_ = std::move(cache);
+    }
+    RequestWindowStateCache* window_state_cache() const {
+        return window_state_cache_.get();
+    }
     ConditionGenerator having_condition_;
     AggGenerator agg_gen_;
+
+ private:
+    bool RunWithWindowStateCache(RunnerContext& ctx,  // NOLINT
+                                 const std::shared_ptr<TableHandler>& table,
+                                 Row* output);
+
+    RequestUnionRunner* window_input_ = nullptr;
+    std::unique_ptr<RequestWindowStateCache> window_state_cache_;
 };
 
 class ReduceRunner : public Runner {
@@ -941,6 +981,14 @@ class WindowAggRunner : public Runner {
     void AddWindowUnion(const WindowOp& window, Runner* runner) {
         windows_union_gen_.AddWindowUnion(window, runner);
     }
+    // compute the window project by the incremental window if `agg` is not null
+    void SetIncrementalAgg(std::unique_ptr<IncrementalWindowAgg> agg) {
+        incremental_agg_ = std::move(agg);
+    }
+    bool IsIncremental() const { return incremental_agg_ != nullptr; }
+    // compute the windows of partition keys by `parallelism` threads
+    void SetParallelism(uint32_t parallelism) { parallelism_ = parallelism; }
+    uint32_t GetParallelism() const { return parallelism_; }
     std::shared_ptr<DataHandler> Run(
         RunnerContext& ctx,  // NOLINT
         const std::vector<std::shared_ptr<DataHandler>>& inputs)
@@ -962,6 +1010,13 @@ class WindowAggRunner : public Runner {
     WindowUnionGenerator windows_union_gen_;
     WindowJoinGenerator windows_join_gen_;
     WindowProjectGenerator window_project_gen_;
+
+ private:
+    Row WindowProject(const uint64_t key, const Row& row, const Row& parameter, const bool is_instance,
+                      HistoryWindow* window);
+
+    std::unique_ptr<IncrementalWindowAgg> incremental_agg_;
+    uint32_t parallelism_ = 1;
 };
 
 class RequestUnionRunner : public Runner {
@@ -978,6 +1033,8 @@ class RequestUnionRunner : public Runner {
         RunnerContext& ctx,  // NOLINT
         const std::vector<std::shared_ptr<DataHandler>>& inputs)
         override;  // NOLINT
+    void PrepareBatch(RunnerContext& ctx,  // NOLINT
+                      const std::vector<std::shared_ptr<DataHandlerList>>& batch_inputs) override;
     static std::shared_ptr<TableHandler> RequestUnionWindow(const Row& request,
                                                             std::vector<std::shared_ptr<TableHandler>> union_segments,
                                                             int64_t request_ts, const WindowRange& window_range,
@@ -1041,8 +1098,16 @@ class RequestAggUnionRunner : public Runner {
         kAvgWhere,
         kMinWhere,
         kMaxWhere,
+        kCountCate,
+        kSumCate,
+        kAvgCate,
+        kMinCate,
+        kMaxCate,
+        kApproxDistinctCount,
     };
 
+    bool IsCate() const { return agg_type_ >= kCountCate && agg_type_ <= kMaxCate; }
+
     RequestWindowUnionGenerator windows_union_gen_;
     RangeGenerator range_gen_;
     bool exclude_current_time_;
@@ -1061,7 +1126,12 @@ class RequestAggUnionRunner : public Runner {
     // simple compassion binary expr like col < 0 is supported
     node::ExprNode* cond_ = nullptr;
 
+    // the category column for *_cate, kept as the filter key of pre-aggr rows
+    std::string cate_col_name_;
+    type::Type cate_col_type_;
+
     std::unique_ptr<BaseAggregator> CreateAggregator() const;
+    std::unique_ptr<BaseAggregator> CreateValueAggregator(AggType agg_type) const;
 
     static inline const absl::flat_hash_map<absl::string_view, AggType> agg_type_map_ = {
         {"sum", kSum},
@@ -1073,7 +1143,13 @@ class RequestAggUnionRunner : public Runner {
         {"sum_where", kSumWhere},
         {"avg_where", kAvgWhere},
         {"min_where", kMinWhere},
-        {"max_where", kMaxWhere}};
+        {"max_where", kMaxWhere},
+        {"count_cate", kCountCate},
+        {"sum_cate", kSumCate},
+        {"avg_cate", kAvgCate},
+        {"min_cate", kMinCate},
+        {"max_cate", kMaxCate},
+        {"approx_distinct_count", kApproxDistinctCount}};
 };
 
 class PostRequestUnionRunner : public Runner {
@@ -1173,11 +1249,15 @@ class ProxyRequestRunner : public Runner {
         is_lazy_ = true;
     }
     ~ProxyRequestRunner() {}
+    // the subquery may be issued ahead by ClusterJob::IssueSubQueries
+    std::shared_ptr<DataHandler> RunWithCache(
+        RunnerContext& ctx) override;  // NOLINT
     std::shared_ptr<DataHandler> Run(
         RunnerContext& ctx,  // NOLINT
         const std::vector<std::shared_ptr<DataHandler>>& inputs) override;
     std::shared_ptr<DataHandlerList> BatchRequestRun(
         RunnerContext& ctx) override;  // NOLINT
+    Runner* index_input() const { return index_input_; }
     virtual void PrintRunnerInfo(std::ostream& output,
                                  const std::string& tab) const {
         output << tab << "[" << id_ << "]" << RunnerTypeName(type_)
@@ -1437,7 +1517,19 @@ class ClusterJob {
     }
 
     void AddMainTask(const ClusterTask& task) { main_task_id_ = AddTask(task); }
-    void Reset() { tasks_.clear(); }
+    void Reset() {
+        tasks_.clear();
+        subquery_runners_.clear();
+    }
+
+    // find the remote subqueries of every task whose inputs don't depend on
+    // any other subquery, so they can be issued before the runner tree is pulled
+    void ScheduleSubQueries();
+    // issue the scheduled subqueries of task, they are in flight concurrently
+    // while the runner tree is pulled and read from the context cache
+    void IssueSubQueries(int32_t task_id, RunnerContext& ctx,  // NOLINT
+                         bool is_batch_request) const;
+    const std::vector<Runner*>& GetSubQueryRunners(int32_t task_id) const;
     const size_t GetTaskSize() const { return tasks_.size(); }
     const bool IsValid() const { return !tasks_.empty(); }
     const int32_t main_task_id() const { return main_task_id_; }
@@ -1465,6 +1557,8 @@ class ClusterJob {
 
  private:
     std::vector<ClusterTask> tasks_;
+    // the scheduled subquery runners of every task
+    std::vector<std::vector<Runner*>> subquery_runners_;
     int32_t main_task_id_;
     std::string sql_;
     std::string db_;
@@ -1497,6 +1591,8 @@ class RunnerBuilder {
     }
     ClusterTask Build(PhysicalOpNode* node,  // NOLINT
                       Status& status);       // NOLINT
+    // the max partitions of the window states kept across requests, 0 disables it
+    void SetWindowStateCacheSize(size_t size) { window_state_cache_size_ = size; }
     ClusterJob BuildClusterJob(PhysicalOpNode* node,
                                Status& status) {  // NOLINT
         id_ = 0;
@@ -1526,6 +1622,7 @@ class RunnerBuilder {
         } else {
             cluster_job_.AddMainTask(task);
         }
+        cluster_job_.ScheduleSubQueries();
         return cluster_job_;
     }
 
@@ -1548,6 +1645,7 @@ class RunnerBuilder {
     std::unordered_map<hybridse::vm::Runner*, ::hybridse::vm::Runner*>
         proxy_runner_map_;
     std::set<size_t> batch_common_node_set_;
+    size_t window_state_cache_size_ = 0;
     ClusterTask MultipleInherit(const std::vector<const ClusterTask*>& children, Runner* runner,
                                                 const Key& index_key, const TaskBiasType bias);
     ClusterTask BinaryInherit(const ClusterTask& left, const ClusterTask& right,
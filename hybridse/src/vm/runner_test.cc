@@ -15,7 +15,11 @@
  */
 
 #include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/strings/match.h"
 #include "boost/algorithm/string.hpp"
@@ -43,6 +47,9 @@ using namespace llvm::orc;  // NOLINT
 
 ExitOnError ExitOnErr;
 
+DECLARE_bool(enable_async_subquery);
+DECLARE_bool(enable_incremental_window_agg);
+
 namespace hybridse {
 namespace vm {
 using hybridse::sqlcase::SqlCase;
@@ -377,6 +384,305 @@ TEST_F(RunnerTest, KeyGeneratorTest) {
     ASSERT_EQ("5|55", group_runner->partition_gen_.GetKey(rows[4], empty_parameter));
 }
 
+TEST_F(RunnerTest, WindowAggIncrementalTest) {
+    hybridse::type::TableDef table_def;
+    BuildTableDef(table_def);
+    table_def.set_name("t1");
+    ::hybridse::type::IndexDef* index = table_def.add_indexes();
+    index->set_name("index1");
+    index->add_first_keys("col1");
+    index->set_second_key("col5");
+    hybridse::type::Database db;
+    db.set_name("db");
+    AddTable(db, table_def);
+    auto catalog = BuildSimpleCatalog(db);
+    FLAGS_enable_incremental_window_agg = true;
+
+    auto is_incremental = [&](const std::string& sql) {
+        SqlCompiler sql_compiler(catalog);
+        SqlContext sql_context;
+        sql_context.sql = sql;
+        sql_context.db = "db";
+        sql_context.engine_mode = kBatchMode;
+        base::Status compile_status;
+        EXPECT_TRUE(sql_compiler.Compile(sql_context, compile_status)) << compile_status;
+        EXPECT_TRUE(sql_compiler.BuildClusterJob(sql_context, compile_status)) << compile_status;
+        auto runner = dynamic_cast<WindowAggRunner*>(
+            GetFirstRunnerOfType(sql_context.cluster_job.GetTask(0).GetRoot(), kRunnerWindowAgg));
+        EXPECT_TRUE(runner != nullptr) << sql;
+        return runner != nullptr && runner->IsIncremental();
+    };
+    ASSERT_TRUE(is_incremental(
+        "select col1, col0, sum(col2) over w, count(col3) over w, avg(col1) over w, min(col5) over w, "
+        "max(col3) over w, sum_where(col5, col2 > 1) over w, count_where(col0, col1 = 3) over w, "
+        "avg_where(col2, col3 < 1.0) over w, min_where(col4, col4 >= 2.0) over w from t1 "
+        "window w as (partition by col1 order by col5 rows_range between 3s preceding and current row);"));
+    ASSERT_TRUE(is_incremental(
+        "select sum(col5) over w, max(col1) over w from t1 "
+        "window w as (partition by col1 order by col5 rows between 10 preceding and current row "
+        "exclude current_time);"));
+    ASSERT_FALSE(is_incremental(
+        "select sum(col5) over w + 1 from t1 "
+        "window w as (partition by col1 order by col5 rows between 10 preceding and current row);"));
+    // the float point sums and the avg of int64 are not exact by adding and subtracting
+    ASSERT_FALSE(is_incremental(
+        "select sum(col4) over w from t1 "
+        "window w as (partition by col1 order by col5 rows between 10 preceding and current row);"));
+    ASSERT_FALSE(is_incremental(
+        "select avg_where(col3, col2 > 1) over w from t1 "
+        "window w as (partition by col1 order by col5 rows between 10 preceding and current row);"));
+    ASSERT_FALSE(is_incremental(
+        "select avg(col5) over w from t1 "
+        "window w as (partition by col1 order by col5 rows between 10 preceding and current row);"));
+    ASSERT_FALSE(is_incremental(
+        "select distinct_count(col2) over w from t1 "
+        "window w as (partition by col1 order by col5 rows between 10 preceding and current row);"));
+    ASSERT_FALSE(is_incremental(
+        "select sum_where(col5, col2 + 1 > 1) over w from t1 "
+        "window w as (partition by col1 order by col5 rows between 10 preceding and current row);"));
+
+    FLAGS_enable_incremental_window_agg = false;
+    ASSERT_FALSE(is_incremental(
+        "select sum(col5) over w from t1 "
+        "window w as (partition by col1 order by col5 rows between 10 preceding and current row);"));
+}
+
+TEST_F(RunnerTest, RequestUnionWindowTest) {
+    auto seg1 = std::make_shared<MemTimeTableHandler>();
+    auto seg2 = std::make_shared<MemTimeTableHandler>();
+    // the rows refer the strings
+    std::vector<std::string> values;
+    for (uint64_t key = 0; key <= 10; key++) {
+        values.push_back(std::to_string(key));
+    }
+    for (uint64_t key = 10; key > 0; key--) {
+        (key % 2 == 0 ? seg1 : seg2)->AddRow(key, Row(values[key]));
+    }
+    std::vector<std::shared_ptr<TableHandler>> segments = {seg1, nullptr, seg2};
+    std::string request_value = "r";
+    Row request(request_value);
+    auto get_window = [&](const WindowRange& range, bool exclude_current_time) {
+        auto window =
+            RequestUnionRunner::RequestUnionWindow(request, segments, 9, range, true, exclude_current_time, false);
+        std::vector<std::string> rows;
+        auto iter = window->GetIterator();
+        while (iter->Valid()) {
+            rows.push_back(std::to_string(iter->GetKey()) + ":" +
+                           std::string(reinterpret_cast<char*>(iter->GetValue().buf()), iter->GetValue().size()));
+            iter->Next();
+        }
+        EXPECT_EQ(rows.size(), window->GetCount());
+        return rows;
+    };
+    std::vector<std::string> expect = {"9:r", "9:9", "8:8", "7:7", "6:6", "5:5", "4:4"};
+    ASSERT_EQ(expect, get_window(WindowRange::CreateRowsRangeWindow(-5, 0), false));
+    expect = {"9:r", "9:9", "8:8"};
+    ASSERT_EQ(expect, get_window(WindowRange::CreateRowsRangeWindow(-5, 0, 3), false));
+    expect = {"9:r", "8:8", "7:7", "6:6", "5:5", "4:4"};
+    ASSERT_EQ(expect, get_window(WindowRange::CreateRowsRangeWindow(-5, 0), true));
+
+    auto window = RequestUnionRunner::RequestUnionWindow(request, segments, 9,
+                                                         WindowRange::CreateRowsRangeWindow(-5, 0), true, false, false);
+    auto iter = window->GetIterator();
+    iter->Seek(6);
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(6u, iter->GetKey());
+    ASSERT_EQ("5", window->At(5).ToString());
+}
+
+TEST_F(RunnerTest, SubQueryScheduleTest) {
+    hybridse::type::TableDef table_def;
+    BuildTableDef(table_def);
+    table_def.set_name("t1");
+    {
+        ::hybridse::type::IndexDef* index = table_def.add_indexes();
+        index->set_name("index1");
+        index->add_first_keys("col1");
+        index->set_second_key("col5");
+    }
+    {
+        ::hybridse::type::IndexDef* index = table_def.add_indexes();
+        index->set_name("index2");
+        index->add_first_keys("col2");
+        index->set_second_key("col5");
+    }
+    hybridse::type::Database db;
+    db.set_name("db");
+    AddTable(db, table_def);
+    auto catalog = BuildSimpleCatalog(db);
+
+    auto build = [&](const std::string& sql) {
+        SqlCompiler sql_compiler(catalog);
+        SqlContext sql_context;
+        sql_context.sql = sql;
+        sql_context.db = "db";
+        sql_context.engine_mode = kRequestMode;
+        sql_context.is_cluster_optimized = true;
+        base::Status status;
+        EXPECT_TRUE(sql_compiler.Compile(sql_context, status)) << status;
+        std::ostringstream oss;
+        sql_context.cluster_job.Print(oss, "");
+        LOG(INFO) << "runner:\n" << oss.str();
+        return sql_context.cluster_job;
+    };
+    // the windows are routed by different keys of request row, both subqueries can be issued up front
+    std::string sql =
+        "select col1, sum(col2) over w1 as w1_sum, sum(col3) over w2 as w2_sum from t1 "
+        "window w1 as (partition by col1 order by col5 rows between 2 preceding and current row), "
+        "w2 as (partition by col2 order by col5 rows between 2 preceding and current row);";
+    auto job = build(sql);
+    auto runners = job.GetSubQueryRunners(job.main_task_id());
+    ASSERT_EQ(2u, runners.size());
+    for (auto runner : runners) {
+        ASSERT_EQ(kRunnerRequestRunProxy, runner->type_);
+        ASSERT_NE(job.GetMainTask().GetRoot(), runner);
+    }
+
+    FLAGS_enable_async_subquery = false;
+    job = build(sql);
+    FLAGS_enable_async_subquery = true;
+    ASSERT_TRUE(job.GetSubQueryRunners(job.main_task_id()).empty());
+}
+
+TEST_F(RunnerTest, WindowStateCacheTest) {
+    hybridse::type::TableDef table_def;
+    BuildTableDef(table_def);
+    table_def.set_name("t1");
+    ::hybridse::type::IndexDef* index = table_def.add_indexes();
+    index->set_name("index1");
+    index->add_first_keys("col1");
+    index->set_second_key("col5");
+    hybridse::type::Database db;
+    db.set_name("db");
+    AddTable(db, table_def);
+    auto catalog = BuildSimpleCatalog(db);
+
+    // the rows of t1 with col1 = 1, col2 = ts % 10, col4 = ts * 1.5, col5 = ts
+    codec::RowBuilder builder(table_def.columns());
+    auto make_row = [&](int64_t ts) {
+        uint32_t size = builder.CalTotalLength(2);
+        int8_t* buf = static_cast<int8_t*>(malloc(size));
+        builder.SetBuffer(buf, size);
+        builder.AppendString("a", 1);
+        builder.AppendInt32(1);
+        builder.AppendInt16(static_cast<int16_t>(ts % 10));
+        builder.AppendFloat(1.0f);
+        builder.AppendDouble(ts * 1.5);
+        builder.AppendInt64(ts);
+        builder.AppendString("b", 1);
+        return Row(base::RefCountedSlice::CreateManaged(buf, size));
+    };
+    // the segment whose version is tracked like the segments of memory table
+    class VersionedSegment : public MemTimeTableHandler {
+     public:
+        explicit VersionedSegment(uint64_t version) : MemTimeTableHandler(), version_(version) {}
+        std::optional<uint64_t> GetVersion() override { return version_; }
+
+     private:
+        uint64_t version_;
+    };
+    auto make_segment = [&](const std::vector<int64_t>& keys, uint64_t version) {
+        // the rows are in descending order of key
+        auto segment = std::make_shared<VersionedSegment>(version);
+        for (auto it = keys.rbegin(); it != keys.rend(); ++it) {
+            segment->AddRow(*it, make_row(*it));
+        }
+        return segment;
+    };
+
+    auto check = [&](const std::string& sql) {
+        SqlCompiler sql_compiler(catalog);
+        SqlContext sql_context;
+        sql_context.sql = sql;
+        sql_context.db = "db";
+        sql_context.engine_mode = kRequestMode;
+        sql_context.options = std::make_shared<std::unordered_map<std::string, std::string>>(
+            std::unordered_map<std::string, std::string>{{WINDOW_STATE_CACHE, "100"}});
+        base::Status status;
+        ASSERT_TRUE(sql_compiler.Compile(sql_context, status)) << status;
+        auto root = sql_context.cluster_job.GetMainTask().GetRoot();
+        auto agg = dynamic_cast<AggRunner*>(GetFirstRunnerOfType(root, kRunnerAgg));
+        auto union_runner = dynamic_cast<RequestUnionRunner*>(GetFirstRunnerOfType(root, kRunnerRequestUnion));
+        ASSERT_TRUE(agg != nullptr && union_runner != nullptr) << sql;
+        auto cache = agg->window_state_cache();
+        ASSERT_TRUE(cache != nullptr) << sql;
+        codec::RowView view(*agg->output_schemas()->GetOutputSchema());
+        auto to_string = [&](const Row& row) {
+            view.Reset(row.buf(), row.size());
+            return view.GetRowString();
+        };
+
+        // the request ts, the rows and the version of segment when the request comes
+        struct Request {
+            int64_t ts;
+            std::vector<int64_t> keys;
+            uint64_t version;
+        };
+        std::vector<Request> requests = {
+            {5, {1, 2, 3, 4, 5}, 0},
+            {8, {1, 2, 3, 4, 5, 6, 7}, 0},
+            {8, {1, 2, 3, 4, 5, 6, 7}, 0},
+            // a row is put at the watermark
+            {9, {1, 2, 3, 4, 5, 6, 7, 7, 8}, 1},
+            // the newest rows are deleted
+            {9, {1, 2, 3, 4, 5, 6, 7}, 2},
+            // the oldest rows are expired by ttl without changing the version
+            {9, {2, 3, 4, 5, 6, 7}, 2},
+            {30, {2, 3, 4, 5, 6, 7, 25, 26}, 2},
+            {31, {2, 3, 4, 5, 6, 7, 25, 26, 27, 28, 29, 30}, 2},
+            // a row is put older than the watermark
+            {32, {2, 3, 4, 5, 6, 7, 24, 25, 26, 27, 28, 29, 30}, 3},
+            // a row in the middle of window is deleted
+            {33, {2, 3, 4, 5, 6, 7, 24, 25, 27, 28, 29, 30}, 4},
+            {34, {2, 3, 4, 5, 6, 7, 24, 25, 27, 28, 29, 30, 33}, 4},
+        };
+        for (auto& request : requests) {
+            auto request_row = make_row(request.ts);
+            auto window = RequestUnionRunner::RequestUnionWindow(
+                request_row, {make_segment(request.keys, request.version)}, request.ts,
+                union_runner->range_gen_.window_range_, true, false, false);
+            auto lazy_window = std::dynamic_pointer_cast<RequestUnionWindowHandler>(window);
+            ASSERT_TRUE(lazy_window != nullptr);
+            Row output;
+            ASSERT_TRUE(cache->Compute("1", request_row, lazy_window->union_segments()[0], lazy_window->bound(),
+                                       &output));
+            Row expect = agg->agg_gen_.Gen(Row(), window);
+            ASSERT_EQ(to_string(expect), to_string(output)) << sql << " at " << request.ts;
+        }
+        ASSERT_GE(cache->hit_cnt(), 2u) << sql;
+        ASSERT_EQ(1u, cache->GetSize());
+
+        // the segment whose version isn't tracked can't be cached
+        {
+            auto request_row = make_row(35);
+            auto segment = std::make_shared<MemTimeTableHandler>();
+            segment->AddRow(30, make_row(30));
+            auto window = RequestUnionRunner::RequestUnionWindow(request_row, {segment}, 35,
+                                                                 union_runner->range_gen_.window_range_, true, false,
+                                                                 false);
+            auto lazy_window = std::dynamic_pointer_cast<RequestUnionWindowHandler>(window);
+            ASSERT_TRUE(lazy_window != nullptr);
+            Row output;
+            ASSERT_FALSE(cache->Compute("1", request_row, lazy_window->union_segments()[0], lazy_window->bound(),
+                                        &output));
+        }
+
+        // no cache if option isn't set
+        SqlContext plain_context;
+        plain_context.sql = sql;
+        plain_context.db = "db";
+        plain_context.engine_mode = kRequestMode;
+        ASSERT_TRUE(sql_compiler.Compile(plain_context, status)) << status;
+        agg = dynamic_cast<AggRunner*>(GetFirstRunnerOfType(plain_context.cluster_job.GetMainTask().GetRoot(),
+                                                            kRunnerAgg));
+        ASSERT_TRUE(agg != nullptr && agg->window_state_cache() == nullptr);
+    };
+    check("select col1, sum(col2) over w as w_sum, count(col5) over w as w_cnt, max(col4) over w as w_max from t1 "
+          "window w as (partition by col1 order by col5 rows_range between 10 preceding and current row);");
+    check("select col1, sum(col5) over w as w_sum, min(col2) over w as w_min, avg(col2) over w as w_avg from t1 "
+          "window w as (partition by col1 order by col5 rows between 3 preceding and current row);");
+}
+
 TEST_F(RunnerTest, RunnerPrintDataTest) {
     hybridse::type::TableDef table_def;
     BuildTableDef(table_def);
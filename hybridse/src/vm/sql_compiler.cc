@@ -18,6 +18,7 @@
 #include <memory>
 #include <utility>
 #include <vector>
+#include "absl/strings/numbers.h"
 #include "boost/filesystem.hpp"
 #include "boost/filesystem/string_file.hpp"
 #include "codec/fe_schema_codec.h"
@@ -33,6 +34,7 @@
 #include "vm/runner.h"
 #include "vm/transform.h"
 #include "vm/engine.h"
+#include "vm/jit_object_cache.h"
 
 using ::hybridse::base::Status;
 using hybridse::common::kPlanError;
@@ -125,7 +127,17 @@ bool SqlCompiler::Compile(SqlContext& ctx, Status& status) {  // NOLINT
     }
     InitBuiltinJitSymbols(jit.get());
     ctx.udf_library->InitJITSymbols(jit.get());
-    if (!jit->OptModule(m.get())) {
+    bool cached = false;
+    if (!ctx.jit_options.IsEnableMcjit()) {
+        auto object_cache = JitObjectCache::Get(ctx.jit_options.GetObjectCachePath(),
+                                                ctx.jit_options.GetObjectCacheCapacity());
+        if (object_cache != nullptr) {
+            m->setModuleIdentifier(JitObjectCache::GenModuleKey(*m));
+            // the cached object will be loaded instead of compiling the module
+            cached = object_cache->Contains(m->getModuleIdentifier());
+        }
+    }
+    if (!cached && !jit->OptModule(m.get())) {
         LOG(WARNING) << "fail to opt ir module for sql " << ctx.sql;
         return false;
     }
@@ -159,6 +171,24 @@ std::string EngineModeName(EngineMode mode) {
     }
 }
 
+// set the parallelism of the window and group aggregations in the plan
+static void SetBatchAggParallelism(PhysicalOpNode* node, uint32_t parallelism, std::set<PhysicalOpNode*>* visited) {
+    if (node == nullptr || !visited->insert(node).second) {
+        return;
+    }
+    if (node->GetOpType() == kPhysicalOpProject) {
+        auto project_op = dynamic_cast<PhysicalProjectNode*>(node);
+        if (project_op->project_type_ == kWindowAggregation) {
+            dynamic_cast<PhysicalWindowAggrerationNode*>(node)->set_parallelism(parallelism);
+        } else if (project_op->project_type_ == kGroupAggregation) {
+            dynamic_cast<PhysicalGroupAggrerationNode*>(node)->set_parallelism(parallelism);
+        }
+    }
+    for (auto producer : node->GetProducers()) {
+        SetBatchAggParallelism(producer, parallelism, visited);
+    }
+}
+
 Status SqlCompiler::BuildBatchModePhysicalPlan(SqlContext* ctx, const ::hybridse::node::PlanNodeList& plan_list,
                                                ::llvm::Module* llvm_module, udf::UdfLibrary* library,
                                                PhysicalOpNode** output) {
@@ -168,6 +198,10 @@ Status SqlCompiler::BuildBatchModePhysicalPlan(SqlContext* ctx, const ::hybridse
                                          ctx->options.get());
     transformer.AddDefaultPasses();
     CHECK_STATUS(transformer.TransformPhysicalPlan(plan_list, output), "Fail to generate physical plan batch mode");
+    if (ctx->batch_agg_parallelism > 1) {
+        std::set<PhysicalOpNode*> visited;
+        SetBatchAggParallelism(*output, ctx->batch_agg_parallelism, &visited);
+    }
     ctx->schema = *(*output)->GetOutputSchema();
     return Status::OK();
 }
@@ -308,6 +342,15 @@ bool SqlCompiler::BuildClusterJob(SqlContext& ctx, Status& status) {  // NOLINT
                                  ctx.is_cluster_optimized && is_request_mode,
                                  ctx.batch_request_info.common_column_indices,
                                  ctx.batch_request_info.common_node_set);
+    if (is_request_mode && ctx.options && ctx.options->count(WINDOW_STATE_CACHE)) {
+        uint64_t size = 0;
+        if (!absl::SimpleAtoi(ctx.options->at(WINDOW_STATE_CACHE), &size)) {
+            status.msg = "invalid window_state_cache option: " + ctx.options->at(WINDOW_STATE_CACHE);
+            status.code = common::kPlanError;
+            return false;
+        }
+        runner_builder.SetWindowStateCacheSize(size);
+    }
     ctx.cluster_job = runner_builder.BuildClusterJob(ctx.physical_plan, status);
     return status.isOK();
 }
@@ -45,6 +45,8 @@ struct SqlContext {
     bool enable_expr_optimize = false;
     bool enable_batch_window_parallelization = true;
     bool enable_window_column_pruning = false;
+    // the number of threads to run batch window and group aggregations
+    uint32_t batch_agg_parallelism = 1;
 
     // the sql content
     std::string sql;
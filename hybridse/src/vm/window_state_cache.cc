@@ -0,0 +1,195 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vm/window_state_cache.h"
+
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "glog/logging.h"
+
+DECLARE_uint64(window_state_cache_max_rows);
+
+namespace hybridse {
+namespace vm {
+
+// log the hit rate once every such lookups
+static constexpr uint64_t kStatsLogInterval = 100000;
+
+RequestWindowStateCache::RequestWindowStateCache(std::unique_ptr<IncrementalWindowAgg> agg,
+                                                 const WindowRange& window_range, size_t capacity)
+    : agg_(std::move(agg)), window_range_(window_range), capacity_(capacity), hit_cnt_(0), miss_cnt_(0) {}
+
+bool RequestWindowStateCache::IsSupported(const WindowRange& window_range) {
+    if (window_range.end_offset_ != 0 || window_range.max_size_ > 0) {
+        return false;
+    }
+    return window_range.frame_type_ == Window::kFrameRows || window_range.frame_type_ == Window::kFrameRowsRange;
+}
+
+bool RequestWindowStateCache::Compute(const std::string& key, const Row& request,
+                                      const std::shared_ptr<TableHandler>& segment, const RequestWindowBound& bound,
+                                      Row* output) {
+    // the window should end at the request key
+    if (!segment || !bound.end.has_value() || bound.end.value() != bound.request_key || bound.max_size > 0) {
+        return false;
+    }
+    // the version is read before the rows, so a change while they are read makes the next request rebuild
+    auto version = segment->GetVersion();
+    if (!version.has_value()) {
+        return false;
+    }
+    auto state = Take(key);
+    bool hit = state != nullptr && state->version == version.value() && Update(state.get(), segment, bound);
+    if (!hit) {
+        state = std::make_unique<State>(window_range_, agg_.get());
+        if (!Update(state.get(), segment, bound)) {
+            return false;
+        }
+        state->version = version.value();
+    }
+    (hit ? hit_cnt_ : miss_cnt_).fetch_add(1, std::memory_order_relaxed);
+    if ((hit_cnt() + miss_cnt()) % kStatsLogInterval == 0) {
+        LOG(INFO) << "window state cache hit rate " << HitRate() << ", hit " << hit_cnt() << ", miss "
+                  << miss_cnt() << ", partitions " << GetSize();
+    }
+
+    // the request row is the newest row of window
+    state->window.AddFrontRowValues(bound.request_key, request);
+    *output = state->window.Output(request);
+    state->window.PopFrontRow();
+    if (state->window.GetCount() <= FLAGS_window_state_cache_max_rows) {
+        Put(key, std::move(state));
+    }
+    return true;
+}
+
+bool RequestWindowStateCache::Update(State* state, const std::shared_ptr<TableHandler>& segment,
+                                     const RequestWindowBound& bound) {
+    const bool is_rows = window_range_.frame_type_ == Window::kFrameRows;
+    const uint64_t end = bound.end.value();
+    const bool is_cached = state->has_watermark;
+    if (state->has_watermark) {
+        if (end < state->watermark) {
+            return false;
+        }
+        if (!is_rows && (bound.start < state->start || bound.start > state->watermark)) {
+            return false;
+        }
+    }
+    auto iter = segment->GetIterator();
+    if (!iter) {
+        return false;
+    }
+    // the rows newer than watermark, the newest at front
+    std::vector<std::pair<uint64_t, Row>> rows;
+    iter->Seek(end);
+    while (iter->Valid()) {
+        uint64_t key = iter->GetKey();
+        if (state->has_watermark && key <= state->watermark) {
+            break;
+        }
+        if (!is_rows && key < bound.start) {
+            break;
+        }
+        if (is_rows && rows.size() >= window_range_.start_row_) {
+            // the new rows fill the window, it is cheaper to rebuild
+            if (state->has_watermark) {
+                return false;
+            }
+            break;
+        }
+        rows.emplace_back(key, iter->GetValue());
+        iter->Next();
+    }
+    if (!rows.empty()) {
+        state->has_watermark = true;
+        state->watermark = rows.front().first;
+    }
+    for (auto it = rows.rbegin(); it != rows.rend(); ++it) {
+        state->window.AddFrontRowValues(it->first, it->second);
+    }
+    if (is_rows) {
+        while (state->window.GetCount() > window_range_.start_row_) {
+            state->window.PopBackRow();
+        }
+    } else {
+        while (state->window.GetCount() > 0 && state->window.GetBackRow().first < bound.start) {
+            state->window.PopBackRow();
+        }
+        state->start = bound.start;
+    }
+    // the rows expired by ttl are hidden before they are removed by gc without changing the version,
+    // they are the oldest rows of segment, so it's enough to check the rows of the oldest key in state
+    if (is_cached && state->window.GetCount() > 0) {
+        const uint64_t oldest = state->window.GetBackRow().first;
+        uint64_t cnt = 0;
+        iter->Seek(oldest);
+        while (iter->Valid() && iter->GetKey() == oldest) {
+            cnt++;
+            iter->Next();
+        }
+        if (cnt < state->window.GetBackKeyCount()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::unique_ptr<RequestWindowStateCache::State> RequestWindowStateCache::Take(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        return nullptr;
+    }
+    auto state = std::move(it->second->second);
+    lru_.erase(it->second);
+    index_.erase(it);
+    return state;
+}
+
+void RequestWindowStateCache::Put(const std::string& key, std::unique_ptr<State> state) {
+    if (capacity_ == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        // the state put by another request of the same partition
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+    lru_.emplace_front(key, std::move(state));
+    index_.emplace(key, lru_.begin());
+    while (lru_.size() > capacity_) {
+        index_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+}
+
+double RequestWindowStateCache::HitRate() const {
+    uint64_t hit = hit_cnt();
+    uint64_t total = hit + miss_cnt();
+    return total == 0 ? 0 : static_cast<double>(hit) / total;
+}
+
+size_t RequestWindowStateCache::GetSize() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return lru_.size();
+}
+
+}  // namespace vm
+}  // namespace hybridse
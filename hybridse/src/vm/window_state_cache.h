@@ -0,0 +1,103 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HYBRIDSE_SRC_VM_WINDOW_STATE_CACHE_H_
+#define HYBRIDSE_SRC_VM_WINDOW_STATE_CACHE_H_
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "vm/incremental_window.h"
+#include "vm/request_union_window.h"
+
+namespace hybridse {
+namespace vm {
+
+// RequestWindowStateCache keeps the states of an IncrementalWindowAgg over the
+// rows of request window across requests, keyed by the partition key. The state
+// remembers the version of segment and the newest key of rows it has seen (the
+// watermark), so a later request of the same partition only folds in the rows
+// newer than the watermark and subtracts the rows out of window.
+// The state is rebuilt from the segment if
+// * the request is older than the watermark, or the window starts before the state
+// * the version of segment is changed, i.e. a row is put not newer than all the rows,
+//   or the rows are deleted or removed by gc
+// * the rows at the oldest key of state are hidden by ttl, e.g. the ttl is shorter
+//   than window
+// The segments whose versions aren't tracked, e.g. of disk tables or remote tablets,
+// are not cached. The states are exact since IncrementalWindowAgg only keeps the
+// integer sums and the extremes, so they don't drift however long they are cached.
+//
+// Only ROWS and ROWS_RANGE windows ending at the current row are supported.
+class RequestWindowStateCache {
+ public:
+    // `capacity` is the max count of partitions whose states are kept
+    RequestWindowStateCache(std::unique_ptr<IncrementalWindowAgg> agg, const WindowRange& window_range,
+                            size_t capacity);
+
+    static bool IsSupported(const WindowRange& window_range);
+
+    // compute the output row of request in window of `segment`, return false if
+    // the window can't be computed by cache
+    bool Compute(const std::string& key, const Row& request, const std::shared_ptr<TableHandler>& segment,
+                 const RequestWindowBound& bound, Row* output);
+
+    uint64_t hit_cnt() const { return hit_cnt_.load(std::memory_order_relaxed); }
+    uint64_t miss_cnt() const { return miss_cnt_.load(std::memory_order_relaxed); }
+    double HitRate() const;
+    size_t GetSize();
+
+ private:
+    struct State {
+        State(const WindowRange& window_range, const IncrementalWindowAgg* agg) : window(window_range, agg) {}
+        IncrementalWindow window;
+        // the version of segment the state is built on
+        uint64_t version = 0;
+        bool has_watermark = false;
+        uint64_t watermark = 0;
+        // the start key of ROWS_RANGE window
+        uint64_t start = 0;
+    };
+
+    // fold in the rows of segment into state, return false if the state is stale
+    bool Update(State* state, const std::shared_ptr<TableHandler>& segment, const RequestWindowBound& bound);
+
+    // the state is taken out of cache while it is updated, so the requests of
+    // the same partition running concurrently don't share it
+    std::unique_ptr<State> Take(const std::string& key);
+    void Put(const std::string& key, std::unique_ptr<State> state);
+
+    const std::unique_ptr<IncrementalWindowAgg> agg_;
+    const WindowRange window_range_;
+    const size_t capacity_;
+
+    std::mutex mu_;
+    // the most recently used at front
+    std::list<std::pair<std::string, std::unique_ptr<State>>> lru_;
+    std::unordered_map<std::string, decltype(lru_)::iterator> index_;
+
+    std::atomic<uint64_t> hit_cnt_;
+    std::atomic<uint64_t> miss_cnt_;
+};
+
+}  // namespace vm
+}  // namespace hybridse
+#endif  // HYBRIDSE_SRC_VM_WINDOW_STATE_CACHE_H_
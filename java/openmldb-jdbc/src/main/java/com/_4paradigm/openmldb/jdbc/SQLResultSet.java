@@ -508,7 +508,8 @@ public class SQLResultSet implements ResultSet {
     public int getFetchSize() throws SQLException {
         checkClosed();
         checkResultSetNull();
-        return this.resultSet.Size();
+        // the rows of a large result are fetched in pages, the total count is unknown, 0 means no hint
+        return 0;
     }
 
     @Override
@@ -44,6 +44,7 @@ public class SdkOption {
     private int glogLevel = 0;
     private String glogDir = "";
     private int maxSqlCacheSize = 50;
+    private Boolean enableBatchRequestFanOut = false;
 
     private void buildBaseOptions(BasicRouterOptions opt) {
         opt.setEnable_debug(getEnableDebug());
@@ -51,6 +52,7 @@ public class SdkOption {
         opt.setGlog_level(getGlogLevel());
         opt.setGlog_dir(getGlogDir());
         opt.setMax_sql_cache_size(getMaxSqlCacheSize());
+        opt.setEnable_batch_request_fan_out(getEnableBatchRequestFanOut());
     }
 
     public SQLRouterOptions buildSQLRouterOptions() throws SqlException {
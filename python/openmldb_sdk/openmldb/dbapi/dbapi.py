@@ -190,7 +190,9 @@ class Cursor(object):
         if rs is None:
             self.rowcount = 0
             return
-        self.rowcount = rs.Size()
+        # the rows of a large result are fetched in pages, so the count is
+        # unknown until all the rows are fetched
+        self.rowcount = -1
         self._resultSet = rs
         self.__schema = rs.GetSchema()
         self.__getMap = {
@@ -428,6 +430,7 @@ class Cursor(object):
             raise DatabaseError("query data failed")
         ok = self._resultSet.Next()
         if not ok:
+            self.rowcount = self._resultSet.Size()
             return None
         values = []
         for i in range(self.__schema.GetColumnCnt()):
@@ -445,10 +448,15 @@ class Cursor(object):
             size = self.arraysize
         elif size < 0:
             raise Exception(f"Given size should greater than zero")
+        return self._fetch(size)
+
+    def _fetch(self, size):
+        """Fetch at most size rows, all the rows if size is None"""
         values = []
-        for k in range(size):
+        while size is None or len(values) < size:
             ok = self._resultSet.Next()
             if not ok:
+                self.rowcount = self._resultSet.Size()
                 break
             row = []
             for i in range(self.__schema.GetColumnCnt()):
@@ -471,7 +479,9 @@ class Cursor(object):
 
     @connected
     def fetchall(self):
-        return self.fetchmany(size=self.rowcount)
+        if self._resultSet is None:
+            raise DatabaseError("query data failed")
+        return self._fetch(None)
 
     @staticmethod
     def substitute_in_query(string_query, parameters):
@@ -64,6 +64,8 @@ class OpenMLDBSdk(object):
             options.glog_dir = self.options_map['glogDir']
         if 'maxSqlCacheSize' in self.options_map:
             options.max_sql_cache_size = int(self.options_map['maxSqlCacheSize'])
+        if 'enableBatchRequestFanOut' in self.options_map:
+            options.enable_batch_request_fan_out = str(self.options_map['enableBatchRequestFanOut']).lower() == 'true'
 
         self.sdk = sql_router_sdk.NewClusterSQLRouter(
             options) if is_cluster_mode else sql_router_sdk.NewStandaloneSQLRouter(options)
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_BASE_CLOCK_CACHE_H_
+#define SRC_BASE_CLOCK_CACHE_H_
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+namespace openmldb::base {
+
+// a concurrent cache split into shards by the hash of key, every shard keeps at most `shard_capacity` items and
+// evicts them by CLOCK, an approximate LRU: the clock hand skips an item once if it was read since the hand passed
+// it. Reading an item only takes the shared lock of its shard, so the readers don't block each other.
+template <class Key, class Value, class Hash = std::hash<Key>>
+class ShardedClockCache {
+ public:
+    ShardedClockCache(size_t shard_capacity, uint32_t shard_num)
+        : shard_capacity_(shard_capacity), shards_(shard_num > 0 ? shard_num : 1) {}
+
+    ShardedClockCache(const ShardedClockCache&) = delete;
+    ShardedClockCache& operator=(const ShardedClockCache&) = delete;
+
+    bool Get(const Key& key, Value* value) {
+        auto& shard = GetShard(key);
+        std::shared_lock<std::shared_mutex> lock(shard.mu);
+        auto it = shard.index.find(key);
+        if (it == shard.index.end()) {
+            return false;
+        }
+        auto& slot = shard.slots[it->second];
+        slot.referenced.store(true, std::memory_order_relaxed);
+        *value = slot.value;
+        return true;
+    }
+
+    // insert the item or update the value of existed key
+    void Upsert(const Key& key, const Value& value) {
+        if (shard_capacity_ == 0) {
+            return;
+        }
+        auto& shard = GetShard(key);
+        std::unique_lock<std::shared_mutex> lock(shard.mu);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            auto& slot = shard.slots[it->second];
+            slot.value = value;
+            slot.referenced.store(true, std::memory_order_relaxed);
+            return;
+        }
+        if (shard.slots.size() < shard_capacity_) {
+            shard.slots.emplace_back(key, value);
+            shard.index.emplace(key, shard.slots.size() - 1);
+            return;
+        }
+        // the hand clears the reference bits until it finds an item not read in the last round
+        while (shard.slots[shard.hand].referenced.exchange(false, std::memory_order_relaxed)) {
+            shard.hand = (shard.hand + 1) % shard.slots.size();
+        }
+        auto& slot = shard.slots[shard.hand];
+        shard.index.erase(slot.key);
+        slot.key = key;
+        slot.value = value;
+        shard.index.emplace(key, shard.hand);
+        shard.hand = (shard.hand + 1) % shard.slots.size();
+    }
+
+    bool Contains(const Key& key) {
+        auto& shard = GetShard(key);
+        std::shared_lock<std::shared_mutex> lock(shard.mu);
+        return shard.index.find(key) != shard.index.end();
+    }
+
+    size_t Size() {
+        size_t size = 0;
+        for (auto& shard : shards_) {
+            std::shared_lock<std::shared_mutex> lock(shard.mu);
+            size += shard.slots.size();
+        }
+        return size;
+    }
+
+ private:
+    struct Slot {
+        Slot(const Key& k, const Value& v) : key(k), value(v), referenced(false) {}
+        Key key;
+        Value value;
+        std::atomic<bool> referenced;
+    };
+
+    struct Shard {
+        std::shared_mutex mu;
+        // the slots never move, so the atomic reference bits can stay in them
+        std::deque<Slot> slots;
+        std::unordered_map<Key, size_t, Hash> index;
+        size_t hand = 0;
+    };
+
+    Shard& GetShard(const Key& key) { return shards_[hasher_(key) % shards_.size()]; }
+
+    const size_t shard_capacity_;
+    Hash hasher_;
+    std::vector<Shard> shards_;
+};
+
+}  // namespace openmldb::base
+#endif  // SRC_BASE_CLOCK_CACHE_H_
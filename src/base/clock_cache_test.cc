@@ -0,0 +1,89 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "base/clock_cache.h"
+
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openmldb::base {
+class ClockCacheTest : public ::testing::Test {};
+
+TEST_F(ClockCacheTest, Evict) {
+    ShardedClockCache<int, int> cache(2, 1);
+    cache.Upsert(0, 0);
+    cache.Upsert(1, 1);
+    // update key 0
+    cache.Upsert(0, -1);
+    int value = 0;
+    ASSERT_TRUE(cache.Get(0, &value));
+    ASSERT_EQ(-1, value);
+    // key 0 is referenced, so key 1 will be evicted
+    cache.Upsert(2, 2);
+    ASSERT_FALSE(cache.Contains(1));
+    ASSERT_TRUE(cache.Get(0, &value));
+    ASSERT_EQ(-1, value);
+    ASSERT_TRUE(cache.Get(2, &value));
+    ASSERT_EQ(2, value);
+    // both are referenced, the hand evicts key 0 after a round
+    cache.Upsert(3, 3);
+    ASSERT_FALSE(cache.Contains(0));
+    ASSERT_TRUE(cache.Contains(2));
+    ASSERT_EQ(2u, cache.Size());
+
+    ShardedClockCache<int, int> empty(0, 1);
+    empty.Upsert(0, 0);
+    ASSERT_FALSE(empty.Get(0, &value));
+}
+
+TEST_F(ClockCacheTest, Shards) {
+    ShardedClockCache<std::string, int> cache(4, 8);
+    for (int i = 0; i < 100; i++) {
+        cache.Upsert(std::to_string(i), i);
+    }
+    ASSERT_LE(cache.Size(), 32u);
+    ASSERT_GT(cache.Size(), 4u);
+}
+
+TEST_F(ClockCacheTest, Concurrent) {
+    ShardedClockCache<int, int> cache(16, 4);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; t++) {
+        threads.emplace_back([&cache, t] {
+            for (int i = 0; i < 10000; i++) {
+                int key = (i * 7 + t) % 100;
+                int value = 0;
+                if (cache.Get(key, &value)) {
+                    ASSERT_EQ(key, value);
+                } else {
+                    cache.Upsert(key, key);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    ASSERT_LE(cache.Size(), 64u);
+}
+
+}  // namespace openmldb::base
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -344,7 +344,15 @@ bool DDLParser::ExtractInfosFromProjectPlan(hybridse::node::ProjectPlanNode* pro
 
             // extract filter column from condition expr
             std::string filter_col;
-            if (agg_expr->GetChildNum() == 2) {
+            if (agg_expr->GetChildNum() == 2 && absl::EndsWithIgnoreCase(aggr_name, "_cate")) {
+                // the category column of *_cate is kept as filter column
+                auto cate_expr = agg_expr->GetChild(1);
+                if (cate_expr->GetExprType() != hybridse::node::kExprColumnRef) {
+                    DLOG(ERROR) << "long window only support column as category";
+                    return false;
+                }
+                filter_col = dynamic_cast<const hybridse::node::ColumnRefNode*>(cate_expr)->GetColumnName();
+            } else if (agg_expr->GetChildNum() == 2) {
                 auto cond_expr = agg_expr->GetChild(1);
                 if (cond_expr->GetExprType() != hybridse::node::kExprBinary) {
                     DLOG(ERROR) << "long window only support binary expr on single column";
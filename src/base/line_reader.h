@@ -0,0 +1,171 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_BASE_LINE_READER_H_
+#define SRC_BASE_LINE_READER_H_
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace openmldb {
+namespace base {
+
+// LineReader reads the lines of a file range block by block. A line belongs to the range
+// [begin, end) if it starts in it, so the ranges split at any offsets read every line once.
+// The line returned is terminated by '\0' in place of '\n' and is valid until the next read.
+class LineReader {
+ public:
+    static constexpr uint32_t kDefaultBlockSize = 4 * 1024 * 1024;
+
+    explicit LineReader(uint32_t block_size = kDefaultBlockSize)
+        : fd_(-1),
+          buf_(block_size + 1),
+          buf_offset_(0),
+          pos_(0),
+          len_(0),
+          end_(0),
+          line_offset_(0),
+          eof_(false),
+          error_(false) {}
+
+    ~LineReader() {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+    bool Open(const std::string& path, uint64_t begin, uint64_t end) {
+        fd_ = open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) {
+            error_ = true;
+            return false;
+        }
+        end_ = end;
+        if (begin == 0) {
+            return true;
+        }
+        // the line starting at begin is in range only if the char before it is '\n',
+        // so read from begin - 1 and skip the partial line
+        buf_offset_ = begin - 1;
+        while (true) {
+            if (pos_ == len_ && !Fill()) {
+                return !error_;
+            }
+            const char* nl = static_cast<const char*>(memchr(buf_.data() + pos_, '\n', len_ - pos_));
+            if (nl != nullptr) {
+                pos_ = nl - buf_.data() + 1;
+                return true;
+            }
+            pos_ = len_;
+        }
+    }
+
+    // return false if there is no line left in range or reading is failed
+    bool ReadLine(char** line, uint32_t* size) {
+        if (error_ || buf_offset_ + pos_ >= end_) {
+            return false;
+        }
+        uint32_t scan_pos = pos_;
+        while (true) {
+            char* start = buf_.data() + pos_;
+            char* nl = static_cast<char*>(memchr(buf_.data() + scan_pos, '\n', len_ - scan_pos));
+            if (nl != nullptr) {
+                *nl = '\0';
+                return Output(start, nl - start, nl - buf_.data() + 1, line, size);
+            }
+            scan_pos = len_ - pos_;
+            if (!Fill()) {
+                if (error_ || len_ == pos_) {
+                    return false;
+                }
+                // the last line without '\n'
+                start = buf_.data() + pos_;
+                buf_[len_] = '\0';
+                return Output(start, len_ - pos_, len_, line, size);
+            }
+        }
+    }
+
+    // the offset in file of the line returned by the last ReadLine
+    uint64_t GetLineOffset() const { return line_offset_; }
+
+    // the bytes of range consumed
+    uint64_t GetOffset() const { return buf_offset_ + pos_; }
+
+    bool HasError() const { return error_; }
+
+    LineReader(const LineReader&) = delete;
+    LineReader& operator=(const LineReader&) = delete;
+
+ private:
+    bool Output(char* start, uint32_t len, uint32_t next_pos, char** line, uint32_t* size) {
+        line_offset_ = buf_offset_ + pos_;
+        pos_ = next_pos;
+        *line = start;
+        *size = len;
+        return true;
+    }
+
+    // move the unconsumed bytes to the front and append one block, the buffer grows if
+    // the line is longer than it. return false at the end of file or on error
+    bool Fill() {
+        if (eof_) {
+            return false;
+        }
+        if (pos_ > 0) {
+            memmove(buf_.data(), buf_.data() + pos_, len_ - pos_);
+            buf_offset_ += pos_;
+            len_ -= pos_;
+            pos_ = 0;
+        }
+        if (len_ + 1 >= buf_.size()) {
+            buf_.resize(buf_.size() * 2);
+        }
+        ssize_t cnt = pread(fd_, buf_.data() + len_, buf_.size() - 1 - len_, buf_offset_ + len_);
+        if (cnt < 0) {
+            error_ = true;
+            return false;
+        }
+        if (cnt == 0) {
+            eof_ = true;
+            return false;
+        }
+        len_ += cnt;
+        return true;
+    }
+
+ private:
+    int fd_;
+    std::vector<char> buf_;
+    // the offset in file of buf_[0]
+    uint64_t buf_offset_;
+    uint32_t pos_;
+    uint32_t len_;
+    uint64_t end_;
+    uint64_t line_offset_;
+    bool eof_;
+    bool error_;
+};
+
+}  // namespace base
+}  // namespace openmldb
+
+#endif  // SRC_BASE_LINE_READER_H_
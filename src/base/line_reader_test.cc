@@ -0,0 +1,119 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/line_reader.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace base {
+
+class LineReaderTest : public ::testing::Test {
+ public:
+    LineReaderTest() {}
+    ~LineReaderTest() {}
+};
+
+static void WriteFile(const std::string& path, const std::string& content) {
+    FILE* f = fopen(path.c_str(), "w");
+    ASSERT_TRUE(f != nullptr);
+    fwrite(content.data(), 1, content.size(), f);
+    fclose(f);
+}
+
+static std::vector<std::string> ReadRanges(const std::string& path, uint64_t size, uint32_t range_cnt,
+                                           uint32_t block_size) {
+    std::vector<std::string> lines;
+    for (uint32_t i = 0; i < range_cnt; i++) {
+        LineReader reader(block_size);
+        EXPECT_TRUE(reader.Open(path, size * i / range_cnt, size * (i + 1) / range_cnt));
+        char* line = nullptr;
+        uint32_t len = 0;
+        while (reader.ReadLine(&line, &len)) {
+            EXPECT_EQ(len, strlen(line));
+            lines.emplace_back(line, len);
+        }
+        EXPECT_FALSE(reader.HasError());
+    }
+    return lines;
+}
+
+TEST_F(LineReaderTest, ReadRanges) {
+    std::string path = "/tmp/line_reader_test.txt";
+    std::vector<std::string> expect;
+    std::string content;
+    for (int i = 0; i < 1000; i++) {
+        std::string line = std::to_string(i) + "," + std::string(i % 37, 'a' + i % 26);
+        expect.push_back(line);
+        content += line + "\n";
+    }
+    WriteFile(path, content);
+    for (uint32_t range_cnt : {1, 2, 3, 7, 64, 2000}) {
+        for (uint32_t block_size : {1, 16, 1024, 1024 * 1024}) {
+            ASSERT_EQ(expect, ReadRanges(path, content.size(), range_cnt, block_size))
+                << "range cnt " << range_cnt << " block size " << block_size;
+        }
+    }
+    // the last line without '\n'
+    content.pop_back();
+    WriteFile(path, content);
+    for (uint32_t range_cnt : {1, 5, 64}) {
+        ASSERT_EQ(expect, ReadRanges(path, content.size(), range_cnt, 16));
+    }
+    remove(path.c_str());
+}
+
+TEST_F(LineReaderTest, LineOffset) {
+    std::string path = "/tmp/line_reader_test_offset.txt";
+    WriteFile(path, "a,b\n\nccc\n");
+    LineReader reader(2);
+    ASSERT_TRUE(reader.Open(path, 0, 100));
+    char* line = nullptr;
+    uint32_t len = 0;
+    ASSERT_TRUE(reader.ReadLine(&line, &len));
+    ASSERT_EQ("a,b", std::string(line, len));
+    ASSERT_EQ(0u, reader.GetLineOffset());
+    ASSERT_TRUE(reader.ReadLine(&line, &len));
+    ASSERT_EQ(0u, len);
+    ASSERT_EQ(4u, reader.GetLineOffset());
+    ASSERT_TRUE(reader.ReadLine(&line, &len));
+    ASSERT_EQ("ccc", std::string(line, len));
+    ASSERT_EQ(5u, reader.GetLineOffset());
+    ASSERT_FALSE(reader.ReadLine(&line, &len));
+    ASSERT_EQ(9u, reader.GetOffset());
+    remove(path.c_str());
+}
+
+TEST_F(LineReaderTest, OpenFailed) {
+    LineReader reader;
+    ASSERT_FALSE(reader.Open("/tmp/line_reader_test_not_exist.txt", 0, 100));
+    char* line = nullptr;
+    uint32_t len = 0;
+    ASSERT_FALSE(reader.ReadLine(&line, &len));
+    ASSERT_TRUE(reader.HasError());
+}
+
+}  // namespace base
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
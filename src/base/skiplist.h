@@ -22,8 +22,10 @@
 
 #include <atomic>
 #include <iostream>
+#include <new>
 
 #include "base/random.h"
+#include "base/slab_allocator.h"
 
 namespace openmldb {
 namespace base {
@@ -53,6 +55,43 @@ class Node {
         nexts_ = new std::atomic<Node<K, V>*>[height];
     }
 
+    // Allocate node and its next pointers in one object from slab, use heap if slab is NULL
+    static Node<K, V>* New(const K& key, V& value, uint8_t height, SlabAllocator* slab) {  // NOLINT
+        if (slab == NULL) {
+            return new Node<K, V>(key, value, height);
+        }
+        char* buf = reinterpret_cast<char*>(slab->Allocate(ByteSize(height)));
+        auto* nexts = reinterpret_cast<std::atomic<Node<K, V>*>*>(buf + sizeof(Node<K, V>));
+        for (uint8_t i = 0; i < height; i++) {
+            new (nexts + i) std::atomic<Node<K, V>*>(NULL);
+        }
+        return new (buf) Node<K, V>(key, value, height, nexts);
+    }
+
+    // Free the node created by New with the same slab
+    static void Delete(Node<K, V>* node, SlabAllocator* slab) {
+        if (!node->inline_nexts_) {
+            delete node;
+            return;
+        }
+        uint32_t size = ByteSize(node->Height());
+        node->~Node();
+        slab->Free(node, size);
+    }
+
+    static void Delete(Node<K, V>* node, SlabAllocator::FreeBatch* batch) {
+        if (!node->inline_nexts_) {
+            delete node;
+            return;
+        }
+        uint32_t size = ByteSize(node->Height());
+        node->~Node();
+        batch->Free(node, size);
+    }
+
+    // the byte size of the node with inline next pointers
+    static uint32_t ByteSize(uint8_t height) { return sizeof(Node<K, V>) + height * sizeof(std::atomic<Node<K, V>*>); }
+
     // Set the next node with memory barrier
     void SetNext(uint8_t level, Node<K, V>* node) {
         assert(level < height_ && level >= 0);
@@ -81,10 +120,20 @@ class Node {
 
     const K& GetKey() const { return key_; }
 
-    ~Node() { delete[] nexts_; }
+    ~Node() {
+        if (!inline_nexts_) {
+            delete[] nexts_;
+        }
+    }
+
+ private:
+    Node(const K& key, V& value, uint8_t height, std::atomic<Node<K, V>*>* nexts)  // NOLINT
+        : height_(height), inline_nexts_(true), key_(key), value_(value), nexts_(nexts) {}
 
  private:
     uint8_t const height_;
+    // the next pointers are placed right after the node in the same slab object
+    bool inline_nexts_ = false;
     K const key_;
     V value_;
     std::atomic<Node<K, V>*>* nexts_;
@@ -111,6 +160,11 @@ class Skiplist {
 
     // Insert need external synchronized
     uint8_t Insert(const K& key, V& value) {  // NOLINT
+        return Insert(key, value, NULL);
+    }
+
+    // Insert the node allocated from slab, the removed nodes must be freed by Node::Delete with it
+    uint8_t Insert(const K& key, V& value, SlabAllocator* slab) {  // NOLINT
         uint8_t height = RandomHeight();
         Node<K, V>* pre[MaxHeight];
         FindLessOrEqual(key, pre);
@@ -120,7 +174,7 @@ class Skiplist {
             }
             max_height_.store(height, std::memory_order_relaxed);
         }
-        Node<K, V>* node = NewNode(key, value, height);
+        Node<K, V>* node = Node<K, V>::New(key, value, height, slab);
         if (pre[0]->GetNext(0) == NULL) {
             tail_.store(node, std::memory_order_release);
         }
@@ -251,6 +305,8 @@ class Skiplist {
         return -1;
     }
 
+    Node<K, V>* GetFirst() { return head_->GetNext(0); }
+
     Node<K, V>* GetLast() { return tail_.load(std::memory_order_acquire); }
 
     uint32_t GetSize() {
@@ -269,7 +325,19 @@ class Skiplist {
     }
 
     // Need external synchronized
-    uint64_t Clear() {
+    uint64_t Clear() { return Clear(static_cast<SlabAllocator::FreeBatch*>(NULL)); }
+
+    // Need external synchronized, slab is the one the nodes are inserted with
+    uint64_t Clear(SlabAllocator* slab) {
+        if (slab != NULL) {
+            SlabAllocator::FreeBatch batch(slab);
+            return Clear(&batch);
+        }
+        return Clear(static_cast<SlabAllocator::FreeBatch*>(NULL));
+    }
+
+    // Need external synchronized
+    uint64_t Clear(SlabAllocator::FreeBatch* batch) {
         uint64_t cnt = 0;
         Node<K, V>* node = head_->GetNext(0);
         // Unlink all next node
@@ -286,7 +354,11 @@ class Skiplist {
             for (uint8_t i = 0; i < tmp->Height(); i++) {
                 tmp->SetNextNoBarrier(i, NULL);
             }
-            delete tmp;
+            if (batch == NULL) {
+                delete tmp;
+            } else {
+                Node<K, V>::Delete(tmp, batch);
+            }
         }
         return cnt;
     }
@@ -663,6 +663,48 @@ TEST_F(SkiplistTest, Duplicate) {
     ASSERT_FALSE(it->Valid());
 }
 
+TEST_F(SkiplistTest, SlabNode) {
+    DescComparator cmp;
+    SlabAllocator slab(1024);
+    Skiplist<uint32_t, uint32_t, DescComparator> sl(12, 4, cmp);
+    for (uint32_t key = 0; key < 100; key++) {
+        uint32_t value = key * 2;
+        uint8_t height = sl.Insert(key, value, &slab);
+        uint32_t byte_size = Node<uint32_t, uint32_t>::ByteSize(height);
+        ASSERT_LE(byte_size, SlabAllocator::kMaxObjectSize);
+    }
+    ASSERT_GT(slab.GetUsedByteSize(), 0u);
+    ASSERT_GE(slab.GetReservedByteSize(), slab.GetUsedByteSize());
+    Skiplist<uint32_t, uint32_t, DescComparator>::Iterator* it = sl.NewIterator();
+    it->SeekToFirst();
+    for (uint32_t key = 100; key > 0; key--) {
+        ASSERT_TRUE(it->Valid());
+        ASSERT_EQ(key - 1, it->GetKey());
+        ASSERT_EQ((key - 1) * 2, it->GetValue());
+        it->Next();
+    }
+    ASSERT_FALSE(it->Valid());
+    delete it;
+    uint32_t split_key = 50;
+    Node<uint32_t, uint32_t>* node = sl.Split(split_key);
+    uint64_t used = slab.GetUsedByteSize();
+    while (node != NULL) {
+        Node<uint32_t, uint32_t>* tmp = node;
+        node = node->GetNextNoBarrier(0);
+        Node<uint32_t, uint32_t>::Delete(tmp, &slab);
+    }
+    ASSERT_LT(slab.GetUsedByteSize(), used);
+    uint64_t reserved = slab.GetReservedByteSize();
+    // reuse the freed nodes
+    for (uint32_t key = 0; key < 10; key++) {
+        uint32_t value = key;
+        sl.Insert(key, value, &slab);
+    }
+    ASSERT_EQ(reserved, slab.GetReservedByteSize());
+    ASSERT_EQ(59u, sl.Clear(&slab));
+    ASSERT_EQ(0u, slab.GetUsedByteSize());
+}
+
 }  // namespace base
 }  // namespace openmldb
 
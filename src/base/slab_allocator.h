@@ -0,0 +1,188 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_BASE_SLAB_ALLOCATOR_H_
+#define SRC_BASE_SLAB_ALLOCATOR_H_
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <new>
+#include <vector>
+
+#include "base/spinlock.h"
+
+namespace openmldb {
+namespace base {
+
+// SlabAllocator carves small objects out of big chunks. The freed objects are kept
+// in a free list per size class and reused by the later allocations, the chunks are
+// returned to the system only when the allocator is destroyed.
+// The objects larger than kMaxObjectSize are allocated from heap directly.
+// It is thread safe.
+class SlabAllocator {
+ public:
+    static constexpr uint32_t kAlign = 8;
+    static constexpr uint32_t kMaxObjectSize = 256;
+    static constexpr uint32_t kClassCnt = kMaxObjectSize / kAlign + 1;
+
+    // FreeBatch collects the freed objects and gives them back to the allocator
+    // under one lock when it is flushed or destroyed
+    class FreeBatch {
+     public:
+        explicit FreeBatch(SlabAllocator* slab) : slab_(slab), heads_(), tails_() {
+            heads_.fill(nullptr);
+            tails_.fill(nullptr);
+        }
+        ~FreeBatch() { Flush(); }
+
+        void Free(void* ptr, uint32_t size) {
+            uint32_t cls = SizeClass(size);
+            if (cls == 0) {
+                ::operator delete(ptr);
+                return;
+            }
+            FreeObject* obj = reinterpret_cast<FreeObject*>(ptr);
+            obj->next = heads_[cls];
+            heads_[cls] = obj;
+            if (tails_[cls] == nullptr) {
+                tails_[cls] = obj;
+            }
+        }
+
+        void Flush() {
+            std::lock_guard<SpinMutex> lock(slab_->mu_);
+            for (uint32_t cls = 1; cls < kClassCnt; cls++) {
+                if (heads_[cls] == nullptr) {
+                    continue;
+                }
+                uint64_t cnt = 0;
+                for (FreeObject* obj = heads_[cls]; obj != nullptr; obj = obj->next) {
+                    cnt++;
+                }
+                tails_[cls]->next = slab_->free_lists_[cls];
+                slab_->free_lists_[cls] = heads_[cls];
+                slab_->used_byte_size_.fetch_sub(cnt * cls * kAlign, std::memory_order_relaxed);
+                heads_[cls] = nullptr;
+                tails_[cls] = nullptr;
+            }
+        }
+
+        FreeBatch(const FreeBatch&) = delete;
+        FreeBatch& operator=(const FreeBatch&) = delete;
+
+     private:
+        friend class SlabAllocator;
+        struct FreeObject {
+            FreeObject* next;
+        };
+        SlabAllocator* slab_;
+        std::array<FreeObject*, kClassCnt> heads_;
+        std::array<FreeObject*, kClassCnt> tails_;
+    };
+
+    explicit SlabAllocator(uint32_t chunk_size)
+        : chunk_size_(std::max(chunk_size, kMaxObjectSize)),
+          mu_(),
+          free_lists_(),
+          chunks_(),
+          cur_(nullptr),
+          remain_(0),
+          reserved_byte_size_(0),
+          used_byte_size_(0) {
+        free_lists_.fill(nullptr);
+    }
+
+    ~SlabAllocator() {
+        for (char* chunk : chunks_) {
+            delete[] chunk;
+        }
+    }
+
+    void* Allocate(uint32_t size) {
+        uint32_t cls = SizeClass(size);
+        if (cls == 0) {
+            return ::operator new(size);
+        }
+        uint32_t real_size = cls * kAlign;
+        used_byte_size_.fetch_add(real_size, std::memory_order_relaxed);
+        std::lock_guard<SpinMutex> lock(mu_);
+        FreeBatch::FreeObject* obj = free_lists_[cls];
+        if (obj != nullptr) {
+            free_lists_[cls] = obj->next;
+            return obj;
+        }
+        if (remain_ < real_size) {
+            // the tail of the old chunk is wasted, it is smaller than kMaxObjectSize
+            cur_ = new char[chunk_size_];
+            remain_ = chunk_size_;
+            chunks_.push_back(cur_);
+            reserved_byte_size_.fetch_add(chunk_size_, std::memory_order_relaxed);
+        }
+        void* ptr = cur_;
+        cur_ += real_size;
+        remain_ -= real_size;
+        return ptr;
+    }
+
+    void Free(void* ptr, uint32_t size) {
+        FreeBatch batch(this);
+        batch.Free(ptr, size);
+    }
+
+    // the bytes of chunks allocated from system
+    uint64_t GetReservedByteSize() const { return reserved_byte_size_.load(std::memory_order_relaxed); }
+
+    // the bytes of objects in use
+    uint64_t GetUsedByteSize() const { return used_byte_size_.load(std::memory_order_relaxed); }
+
+    // the bytes reserved but not in use, includes the free lists and the unused tail of chunks
+    uint64_t GetFragByteSize() const {
+        uint64_t reserved = GetReservedByteSize();
+        uint64_t used = GetUsedByteSize();
+        return reserved > used ? reserved - used : 0;
+    }
+
+    SlabAllocator(const SlabAllocator&) = delete;
+    SlabAllocator& operator=(const SlabAllocator&) = delete;
+
+ private:
+    // 0 means the size is not handled by slab
+    static uint32_t SizeClass(uint32_t size) {
+        if (size == 0 || size > kMaxObjectSize) {
+            return 0;
+        }
+        return (size + kAlign - 1) / kAlign;
+    }
+
+ private:
+    const uint32_t chunk_size_;
+    SpinMutex mu_;
+    std::array<FreeBatch::FreeObject*, kClassCnt> free_lists_;
+    std::vector<char*> chunks_;
+    char* cur_;
+    uint32_t remain_;
+    std::atomic<uint64_t> reserved_byte_size_;
+    std::atomic<uint64_t> used_byte_size_;
+};
+
+}  // namespace base
+}  // namespace openmldb
+
+#endif  // SRC_BASE_SLAB_ALLOCATOR_H_
@@ -15,11 +15,16 @@
  */
 
 #include "catalog/distribute_iterator.h"
+
+#include <algorithm>
+
+#include "codec/dict_codec.h"
 #include "gflags/gflags.h"
 
 DECLARE_uint32(traverse_cnt_limit);
 DECLARE_uint32(max_traverse_cnt);
 DECLARE_uint32(max_traverse_pk_cnt);
+DECLARE_uint32(traverse_prefetch_parallelism);
 
 namespace openmldb {
 namespace catalog {
@@ -30,6 +35,7 @@ FullTableIterator::FullTableIterator(uint32_t tid, std::shared_ptr<Tables> table
         const std::map<uint32_t, std::shared_ptr<::openmldb::client::TabletClient>>& tablet_clients)
     : tid_(tid), tables_(tables), tablet_clients_(tablet_clients), in_local_(true), cur_pid_(INVALID_PID),
     it_(), kv_it_(), key_(0), last_ts_(0), last_pk_(), value_() {
+    next_remote_ = tablet_clients_.begin();
 }
 
 void FullTableIterator::SeekToFirst() {
@@ -64,6 +70,10 @@ void FullTableIterator::Reset() {
     in_local_ = true;
     ResetValue();
     cnt_ = 0;
+    // wait the pages in flight
+    next_page_ = TraverseFuture();
+    pending_pages_.clear();
+    next_remote_ = tablet_clients_.begin();
 }
 
 void FullTableIterator::EndLocal() {
@@ -102,6 +112,7 @@ bool FullTableIterator::NextFromLocal() {
         }
         cur_pid_ = iter->first;
         it_.reset(iter->second->NewTraverseIterator(0));
+        dict_codec_ = iter->second->GetDictCodec();
         it_->SeekToFirst();
         if (it_->Valid()) {
             break;
@@ -127,46 +138,56 @@ bool FullTableIterator::NextFromRemote() {
             return true;
         }
     }
-    auto iter = tablet_clients_.begin();
-    if (cur_pid_ == INVALID_PID) {
-        cur_pid_ = iter->first;
-    } else {
-        iter = tablet_clients_.find(cur_pid_);
-    }
     do {
-        if (iter == tablet_clients_.end()) {
+        if (next_page_.valid()) {
+            kv_it_ = next_page_.get();
+            DLOG(INFO) << "pid " << cur_pid_ << " last pk " << last_pk_ << " key " << last_ts_;
+        } else if (!NextRemotePartition()) {
+            kv_it_.reset();
             return false;
         }
-        cur_pid_ = iter->first;
-        uint32_t count = 0;
-        if (kv_it_) {
-            if (!kv_it_->IsFinish()) {
-                kv_it_ = iter->second->Traverse(tid_, cur_pid_, "", last_pk_, last_ts_,
-                            FLAGS_traverse_cnt_limit, false, kv_it_->GetTSPos(), count);
-                DLOG(INFO) << "pid " << cur_pid_ << " last pk " << last_pk_ <<
-                    " key " << last_ts_ << " ts_pos " << kv_it_->GetTSPos() << " count " << count;
-            } else {
-                iter++;
-                kv_it_.reset();
-                continue;
-            }
-        } else {
-            kv_it_ = iter->second->Traverse(tid_, cur_pid_, "", "", 0, FLAGS_traverse_cnt_limit, false, 0, count);
-            DLOG(INFO) << "count " << count;
-        }
         if (kv_it_ && kv_it_->Valid()) {
             last_pk_ = kv_it_->GetLastPK();
             last_ts_ = kv_it_->GetLastTS();
             response_vec_.emplace_back(kv_it_->GetResponse());
             key_ = kv_it_->GetKey();
-            break;
+            if (!kv_it_->IsFinish()) {
+                next_page_ = FetchPage(cur_pid_, last_pk_, last_ts_, kv_it_->GetTSPos());
+            }
+            return true;
         }
-        iter++;
         kv_it_.reset();
     } while (true);
+}
+
+bool FullTableIterator::NextRemotePartition() {
+    uint32_t parallelism = std::max(FLAGS_traverse_prefetch_parallelism, 1u);
+    // keep `parallelism` partitions in flight, the first one becomes the current partition
+    while (pending_pages_.size() < parallelism && next_remote_ != tablet_clients_.end()) {
+        pending_pages_.emplace_back(next_remote_->first, FetchPage(next_remote_->first, "", 0, 0));
+        next_remote_++;
+    }
+    if (pending_pages_.empty()) {
+        return false;
+    }
+    cur_pid_ = pending_pages_.front().first;
+    kv_it_ = pending_pages_.front().second.get();
+    pending_pages_.pop_front();
     return true;
 }
 
+FullTableIterator::TraverseFuture FullTableIterator::FetchPage(uint32_t pid, const std::string& pk, uint64_t ts,
+                                                               uint32_t ts_pos) {
+    auto client = tablet_clients_.at(pid);
+    uint32_t tid = tid_;
+    // the page is fetched when it is got if not prefetching
+    auto policy = FLAGS_traverse_prefetch_parallelism > 1 ? std::launch::async : std::launch::deferred;
+    return std::async(policy, [client, tid, pid, pk, ts, ts_pos]() {
+        uint32_t count = 0;
+        return client->Traverse(tid, pid, "", pk, ts, FLAGS_traverse_cnt_limit, false, ts_pos, count);
+    });
+}
+
 const ::hybridse::codec::Row& FullTableIterator::GetValue() {
     if (ValidValue()) {
         return value_;
@@ -174,8 +195,17 @@ const ::hybridse::codec::Row& FullTableIterator::GetValue() {
 
     valid_value_ = true;
     if (it_ && it_->Valid()) {
-        value_ = ::hybridse::codec::Row(
-            ::hybridse::base::RefCountedSlice::Create(it_->GetValue().data(), it_->GetValue().size()));
+        auto slice_row = it_->GetValue();
+        const auto* row_ptr = reinterpret_cast<const int8_t*>(slice_row.data());
+        // the engine only reads the plain format, so an encoded row is decoded into a malloc-ed copy
+        int8_t* decoded = nullptr;
+        uint32_t decoded_size = 0;
+        if (dict_codec_ != nullptr && ::openmldb::codec::DictRowCodec::IsEncoded(row_ptr) &&
+            dict_codec_->Decode(row_ptr, slice_row.size(), &decoded, &decoded_size)) {
+            value_ = ::hybridse::codec::Row(::hybridse::base::RefCountedSlice::CreateManaged(decoded, decoded_size));
+            return value_;
+        }
+        value_ = ::hybridse::codec::Row(::hybridse::base::RefCountedSlice::Create(slice_row.data(), slice_row.size()));
         return value_;
     } else {
         auto slice_row = kv_it_->GetValue();
@@ -402,6 +432,13 @@ std::unique_ptr<::hybridse::codec::RowIterator> DistributeWindowIterator::GetVal
     }
 }
 
+std::optional<uint64_t> DistributeWindowIterator::GetVersion() {
+    if (it_ && it_->Valid()) {
+        return it_->GetVersion();
+    }
+    return std::nullopt;
+}
+
 const ::hybridse::codec::Row DistributeWindowIterator::GetKey() {
     if (it_ && it_->Valid()) {
         return it_->GetKey();
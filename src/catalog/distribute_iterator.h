@@ -17,9 +17,13 @@
 #ifndef SRC_CATALOG_DISTRIBUTE_ITERATOR_H_
 #define SRC_CATALOG_DISTRIBUTE_ITERATOR_H_
 
+#include <deque>
+#include <future>  // NOLINT
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "base/hash.h"
@@ -33,6 +37,10 @@ namespace catalog {
 
 using Tables = std::map<uint32_t, std::shared_ptr<::openmldb::storage::Table>>;
 
+// FullTableIterator traverses the local partitions and then the remote ones in the order of pid.
+// The pages of remote partitions are fetched by `Traverse`, if FLAGS_traverse_prefetch_parallelism > 1,
+// the next page of the current partition and the first pages of the following partitions are
+// fetched asynchronously while the current page is consumed. The order of rows is not changed.
 class FullTableIterator : public ::hybridse::codec::ConstIterator<uint64_t, ::hybridse::codec::Row> {
  public:
     FullTableIterator(uint32_t tid, std::shared_ptr<Tables> tables,
@@ -50,8 +58,13 @@ class FullTableIterator : public ::hybridse::codec::ConstIterator<uint64_t, ::hy
     const uint64_t& GetKey() const override { return key_; }
 
  private:
+    using TraverseFuture = std::future<std::shared_ptr<::openmldb::base::TraverseKvIterator>>;
+
     bool NextFromLocal();
     bool NextFromRemote();
+    // move to the first page of the next remote partition
+    bool NextRemotePartition();
+    TraverseFuture FetchPage(uint32_t pid, const std::string& pk, uint64_t ts, uint32_t ts_pos);
     void Reset();
     void EndLocal();
     inline void ResetValue() {
@@ -69,6 +82,8 @@ class FullTableIterator : public ::hybridse::codec::ConstIterator<uint64_t, ::hy
     bool in_local_;
     uint32_t cur_pid_;
     std::unique_ptr<::openmldb::storage::TableIterator> it_;
+    // the codec of the table of it_, if its rows are encoded by dictionaries
+    const ::openmldb::codec::DictRowCodec* dict_codec_ = nullptr;
     std::shared_ptr<::openmldb::base::TraverseKvIterator> kv_it_;
     uint64_t key_;
     uint64_t last_ts_;
@@ -83,6 +98,12 @@ class FullTableIterator : public ::hybridse::codec::ConstIterator<uint64_t, ::hy
     bool valid_value_ = false;
     std::vector<std::shared_ptr<::google::protobuf::Message>> response_vec_;
     int64_t cnt_ = 0;
+    // the next page of the current remote partition
+    TraverseFuture next_page_;
+    // the first pages of the following remote partitions
+    std::deque<std::pair<uint32_t, TraverseFuture>> pending_pages_;
+    // the next remote partition not in `pending_pages_`
+    std::map<uint32_t, std::shared_ptr<openmldb::client::TabletClient>>::const_iterator next_remote_;
 };
 
 class RemoteWindowIterator : public ::hybridse::vm::RowIterator {
@@ -151,6 +172,8 @@ class DistributeWindowIterator : public ::hybridse::codec::WindowIterator {
     std::unique_ptr<::hybridse::codec::RowIterator> GetValue() override;
     ::hybridse::codec::RowIterator* GetRawValue() override;
     const ::hybridse::codec::Row GetKey() override;
+    // the version of the segments in remote tablets isn't tracked
+    std::optional<uint64_t> GetVersion() override;
 
  public:
     using IT = std::unique_ptr<::hybridse::codec::WindowIterator>;
@@ -34,6 +34,7 @@ DECLARE_string(db_root_path);
 DECLARE_uint32(traverse_cnt_limit);
 DECLARE_uint32(max_traverse_cnt);
 DECLARE_uint32(max_traverse_pk_cnt);
+DECLARE_uint32(traverse_prefetch_parallelism);
 
 namespace openmldb {
 namespace catalog {
@@ -375,6 +376,61 @@ TEST_F(DistributeIteratorTest, TraverseLimit) {
     FLAGS_traverse_cnt_limit = old_limit;
 }
 
+TEST_F(DistributeIteratorTest, TraverseLimitPrefetch) {
+    uint32_t old_limit = FLAGS_traverse_cnt_limit;
+    FLAGS_traverse_cnt_limit = 7;
+    uint32_t tid = 3;
+    FLAGS_db_root_path = "/tmp/" + ::openmldb::test::GenRand();
+    auto tables = std::make_shared<Tables>();
+    tables->emplace(0, CreateTable(tid, 0));
+    std::vector<std::string> endpoints = {"127.0.0.1:9230", "127.0.0.1:9231"};
+    brpc::Server tablet1;
+    ASSERT_TRUE(::openmldb::test::StartTablet(endpoints[0], &tablet1));
+    brpc::Server tablet2;
+    ASSERT_TRUE(::openmldb::test::StartTablet(endpoints[1], &tablet2));
+    auto client1 = std::make_shared<openmldb::client::TabletClient>(endpoints[0], endpoints[0]);
+    ASSERT_EQ(client1->Init(), 0);
+    auto client2 = std::make_shared<openmldb::client::TabletClient>(endpoints[1], endpoints[1]);
+    ASSERT_EQ(client2->Init(), 0);
+    std::vector<::openmldb::api::TableMeta> metas = {CreateTableMeta(tid, 1), CreateTableMeta(tid, 2),
+                                                     CreateTableMeta(tid, 3), CreateTableMeta(tid, 4)};
+    std::map<uint32_t, std::shared_ptr<openmldb::client::TabletClient>> tablet_clients;
+    for (uint32_t pid = 1; pid <= 4; pid++) {
+        auto client = pid % 2 == 0 ? client2 : client1;
+        ASSERT_TRUE(client->CreateTable(metas[pid - 1]));
+        tablet_clients.emplace(pid, client);
+    }
+    for (int i = 0; i < 100; i++) {
+        std::string key = "card" + std::to_string(i);
+        uint32_t pid = static_cast<uint32_t>(::openmldb::base::hash64(key)) % 5;
+        if (pid == 0) {
+            PutKey(key, (*tables)[pid]);
+        } else {
+            PutKey(key, metas[pid - 1], tablet_clients[pid]);
+        }
+    }
+    auto traverse = [&]() {
+        std::vector<std::string> rows;
+        FullTableIterator it(tid, tables, tablet_clients);
+        it.SeekToFirst();
+        while (it.Valid()) {
+            rows.push_back(it.GetValue().ToString());
+            it.Next();
+        }
+        return rows;
+    };
+    auto rows = traverse();
+    ASSERT_EQ(1000u, rows.size());
+    // the rows are in the same order with prefetching
+    uint32_t old_parallelism = FLAGS_traverse_prefetch_parallelism;
+    for (uint32_t parallelism : {2, 4, 8}) {
+        FLAGS_traverse_prefetch_parallelism = parallelism;
+        ASSERT_EQ(rows, traverse()) << parallelism;
+    }
+    FLAGS_traverse_prefetch_parallelism = old_parallelism;
+    FLAGS_traverse_cnt_limit = old_limit;
+}
+
 TEST_F(DistributeIteratorTest, WindowIterator) {
     uint32_t tid = 3;
     FLAGS_db_root_path = "/tmp/" + ::openmldb::test::GenRand();
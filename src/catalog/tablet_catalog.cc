@@ -21,7 +21,9 @@
 #include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "base/hash.h"
 #include "catalog/distribute_iterator.h"
 #include "codec/list_iterator_codec.h"
 #include "glog/logging.h"
@@ -154,6 +156,29 @@ std::unique_ptr<::hybridse::codec::WindowIterator> TabletTableHandler::GetWindow
             iter->second.index, idx_name, tablet_clients);
 }
 
+void TabletTableHandler::Prefetch(const std::string& idx_name, const std::vector<std::string>& keys) {
+    const auto& index_hint = GetIndex();
+    auto iter = index_hint.find(idx_name);
+    if (iter == index_hint.end() || partition_num_ == 0) {
+        return;
+    }
+    auto tables = std::atomic_load_explicit(&tables_, std::memory_order_acquire);
+    if (!tables) {
+        return;
+    }
+    // the same partition as DistributeWindowIterator seeks, the keys of remote partitions are skipped
+    std::map<uint32_t, std::vector<std::string>> pid_keys;
+    for (const auto& key : keys) {
+        uint32_t pid = static_cast<uint32_t>(::openmldb::base::hash64(key) % partition_num_);
+        if (tables->count(pid) > 0) {
+            pid_keys[pid].push_back(key);
+        }
+    }
+    for (const auto& kv : pid_keys) {
+        tables->at(kv.first)->Prefetch(iter->second.index, kv.second);
+    }
+}
+
 // TODO(chenjing): optimize Get(int pos) base segment
 const ::hybridse::codec::Row TabletTableHandler::Get(int32_t pos) {
     auto iter = GetIterator();
@@ -571,6 +596,13 @@ std::unique_ptr<::hybridse::vm::RowIterator> TabletSegmentHandler::GetIterator()
     return std::unique_ptr<::hybridse::vm::RowIterator>();
 }
 
+void TabletPartitionHandler::Prefetch(const std::vector<std::string>& keys) {
+    auto table_handler = std::dynamic_pointer_cast<TabletTableHandler>(table_handler_);
+    if (table_handler) {
+        table_handler->Prefetch(index_name_, keys);
+    }
+}
+
 ::hybridse::vm::RowIterator* TabletSegmentHandler::GetRawIterator() {
     auto iter = partition_handler_->GetWindowIterator();
     if (iter) {
@@ -585,6 +617,17 @@ std::unique_ptr<::hybridse::vm::RowIterator> TabletSegmentHandler::GetIterator()
     return nullptr;
 }
 
+std::optional<uint64_t> TabletSegmentHandler::GetVersion() {
+    auto iter = partition_handler_->GetWindowIterator();
+    if (iter) {
+        iter->Seek(key_);
+        if (iter->Valid() && 0 == iter->GetKey().compare(hybridse::codec::Row(key_))) {
+            return iter->GetVersion();
+        }
+    }
+    return std::nullopt;
+}
+
 const uint64_t TabletSegmentHandler::GetCount() {
     auto iter = GetIterator();
     if (!iter) return 0;
@@ -19,6 +19,7 @@
 
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -79,6 +80,8 @@ class TabletSegmentHandler : public ::hybridse::vm::TableHandler {
     }
     const std::string GetHandlerTypeName() override { return "TabletSegmentHandler"; }
 
+    std::optional<uint64_t> GetVersion() override;
+
  private:
     std::shared_ptr<::hybridse::vm::PartitionHandler> partition_handler_;
     std::string key_;
@@ -124,6 +127,9 @@ class TabletPartitionHandler : public ::hybridse::vm::PartitionHandler,
     std::shared_ptr<::hybridse::vm::TableHandler> GetSegment(const std::string &key) override {
         return std::make_shared<TabletSegmentHandler>(shared_from_this(), key);
     }
+
+    void Prefetch(const std::vector<std::string> &keys) override;
+
     const std::string GetHandlerTypeName() override { return "TabletPartitionHandler"; }
 
  private:
@@ -163,6 +169,9 @@ class TabletTableHandler : public ::hybridse::vm::TableHandler,
 
     std::unique_ptr<::hybridse::codec::WindowIterator> GetWindowIterator(const std::string &idx_name) override;
 
+    // prefetch the keys of index in the local partitions they belong to
+    void Prefetch(const std::string &idx_name, const std::vector<std::string> &keys);
+
     const uint64_t GetCount() override;
 
     ::hybridse::codec::Row At(uint64_t pos) override;
@@ -77,6 +77,7 @@ bool TabletClient::Query(const std::string& db, const std::string& sql,
     request.set_sql(sql);
     request.set_db(db);
     request.set_is_batch(true);
+    request.set_is_stream(true);
     request.set_is_debug(is_debug);
     request.set_parameter_row_size(parameter_row.size());
     request.set_parameter_row_slices(1);
@@ -97,6 +98,20 @@ bool TabletClient::Query(const std::string& db, const std::string& sql,
     return true;
 }
 
+bool TabletClient::QueryNext(uint64_t query_id, brpc::Controller* cntl, ::openmldb::api::QueryResponse* response) {
+    if (cntl == NULL || response == NULL) return false;
+    ::openmldb::api::QueryRequest request;
+    request.set_is_batch(true);
+    request.set_is_stream(true);
+    request.set_query_id(query_id);
+    bool ok = client_.SendRequest(&::openmldb::api::TabletServer_Stub::Query, cntl, &request, response);
+    if (!ok || response->code() != 0) {
+        LOG(WARNING) << "fail to fetch the next page of query " << query_id;
+        return false;
+    }
+    return true;
+}
+
 /**
  * Utility function to encode row batch data into rpc attachment buffer
  */
@@ -283,6 +298,29 @@ bool TabletClient::Put(uint32_t tid, uint32_t pid, const std::string& pk, uint64
     return false;
 }
 
+bool TabletClient::PutBatch(const ::openmldb::api::PutBatchRequest& request, std::string* msg) {
+    ::openmldb::api::PutBatchResponse response;
+    bool ok = client_.SendRequest(&::openmldb::api::TabletServer_Stub::PutBatch, &request, &response,
+                                  FLAGS_request_timeout_ms, 1);
+    if (ok && response.code() == 0) {
+        return true;
+    }
+    LOG(WARNING) << "fail to put batch for error " << response.msg() << " and error code " << response.code();
+    if (msg != nullptr) {
+        *msg = response.msg();
+    }
+    return false;
+}
+
+bool TabletClient::AsyncPutBatch(const ::openmldb::api::PutBatchRequest& request,
+                                 openmldb::RpcCallback<openmldb::api::PutBatchResponse>* callback) {
+    if (callback == nullptr) {
+        return false;
+    }
+    return client_.SendRequest(&::openmldb::api::TabletServer_Stub::PutBatch, callback->GetController().get(),
+                               &request, callback->GetResponse().get(), callback);
+}
+
 bool TabletClient::MakeSnapshot(uint32_t tid, uint32_t pid, uint64_t offset, std::shared_ptr<TaskInfo> task_info) {
     ::openmldb::api::GeneralRequest request;
     request.set_tid(tid);
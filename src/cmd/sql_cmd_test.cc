@@ -426,7 +426,7 @@ TEST_P(DBSDKTest, LoadDataMultipleFiles) {
         ofile.close();
     }
     std::string load_sql = "LOAD DATA INFILE 'file://" + (tmp_path / "myfile*").string() +
-                           "' INTO TABLE trans options(load_mode='local', thread=10);";
+                           "' INTO TABLE trans options(load_mode='local', thread=10, batch_size=3);";
     hybridse::sdk::Status status;
     sr->ExecuteSQL(load_sql, &status);
     ASSERT_TRUE(status.IsOK()) << status.msg;
@@ -476,6 +476,50 @@ TEST_P(DBSDKTest, LoadData) {
     unlink(file_name.c_str());
 }
 
+TEST_P(DBSDKTest, LoadDataHeader) {
+    auto cli = GetParam();
+    cs = cli->cs;
+    sr = cli->sr;
+    HandleSQL("SET @@execute_mode='online';");
+    HandleSQL("create database test1;");
+    HandleSQL("use test1;");
+    HandleSQL("create table trans (name string, age int, city string);");
+    std::string file_name = "./myfile_header.csv";
+    absl::Cleanup clean = [&file_name]() { unlink(file_name.c_str()); };
+    auto write_file = [&file_name](const std::string& header) {
+        std::ofstream ofile;
+        ofile.open(file_name);
+        ofile << header << std::endl;
+        for (int i = 0; i < 10; i++) {
+            ofile << "name" << i << "," << i << ",city" << i << std::endl;
+        }
+        ofile.close();
+    };
+    // the column names of header are checked against the schema after the header reader is released
+    write_file("name,age,city");
+    std::string load_sql =
+        "LOAD DATA INFILE '" + file_name + "' INTO TABLE trans options(header=true, load_mode='local', thread=2);";
+    hybridse::sdk::Status status;
+    sr->ExecuteSQL(load_sql, &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    ASSERT_EQ(status.msg, "Load 10 rows");
+    auto result = sr->ExecuteSQL("select * from trans;", &status);
+    ASSERT_TRUE(status.IsOK()) << status.msg;
+    ASSERT_EQ(10, result->Size());
+    while (result->Next()) {
+        int age = result->GetInt32Unsafe(1);
+        ASSERT_EQ(result->GetStringUnsafe(0), absl::StrCat("name", age));
+        ASSERT_EQ(result->GetStringUnsafe(2), absl::StrCat("city", age));
+    }
+
+    write_file("name,city,age");
+    sr->ExecuteSQL(load_sql, &status);
+    ASSERT_FALSE(status.IsOK());
+    ASSERT_TRUE(status.msg.find("mismatch column name") != std::string::npos) << status.msg;
+    HandleSQL("drop table trans;");
+    HandleSQL("drop database test1;");
+}
+
 TEST_P(DBSDKTest, LoadDataError) {
     auto cli = GetParam();
     cs = cli->cs;
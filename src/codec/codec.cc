@@ -22,6 +22,7 @@
 
 #include "base/glog_wrapper.h"
 #include "boost/lexical_cast.hpp"
+#include "codec/dict_codec.h"
 
 namespace openmldb {
 namespace codec {
@@ -840,6 +841,12 @@ int32_t RowView::GetValue(const int8_t* row, uint32_t idx, char** val, uint32_t*
         return 1;
     }
     uint32_t field_offset = offset_vec_.at(idx);
+    if (dict_codec_ != nullptr && DictRowCodec::IsEncoded(row)) {
+        const char* data = nullptr;
+        int32_t ret = dict_codec_->GetStrField(row, size, field_offset, &data, length);
+        *val = const_cast<char*>(data);
+        return ret;
+    }
     uint32_t next_str_field_offset = 0;
     if (offset_vec_.at(idx) < string_field_cnt_ - 1) {
         next_str_field_offset = field_offset + 1;
@@ -860,6 +867,12 @@ int32_t RowView::GetString(uint32_t idx, char** val, uint32_t* length) const {
         return 1;
     }
     uint32_t field_offset = offset_vec_.at(idx);
+    if (dict_codec_ != nullptr && DictRowCodec::IsEncoded(row_)) {
+        const char* data = nullptr;
+        int32_t ret = dict_codec_->GetStrField(row_, size_, field_offset, &data, length);
+        *val = const_cast<char*>(data);
+        return ret;
+    }
     uint32_t next_str_field_offset = 0;
     if (offset_vec_.at(idx) < string_field_cnt_ - 1) {
         next_str_field_offset = field_offset + 1;
@@ -1050,6 +1063,12 @@ bool RowProject::Init() {
     return true;
 }
 
+void RowProject::SetDictCodec(const DictRowCodec* dict_codec) {
+    for (auto& kv : vers_views_) {
+        kv.second->SetDictCodec(dict_codec);
+    }
+}
+
 bool RowProject::Project(const int8_t* row_ptr, uint32_t size, int8_t** output_ptr, uint32_t* out_size) {
     if (row_ptr == NULL || output_ptr == NULL || out_size == NULL) return false;
     uint8_t version = openmldb::codec::RowView::GetSchemaVersion(row_ptr);
@@ -39,6 +39,7 @@ static constexpr uint32_t UINT24_MAX = (1 << 24) - 1;
 class RowBuilder;
 class RowView;
 class RowProject;
+class DictRowCodec;
 
 class RowProject {
  public:
@@ -48,6 +49,9 @@ class RowProject {
 
     bool Init();
 
+    // read the string fields of the rows encoded by `dict_codec` without decoding the whole rows
+    void SetDictCodec(const DictRowCodec* dict_codec);
+
     bool Project(const int8_t* row_ptr, uint32_t row_size, int8_t** out_ptr, uint32_t* out_size);
 
     uint32_t GetMaxIdx() { return max_idx_; }
@@ -145,6 +149,9 @@ class RowView {
     bool Reset(const int8_t* row, uint32_t size);
     bool Reset(const int8_t* row);
 
+    // the string fields of the rows encoded by `dict_codec` are read from its dictionaries
+    void SetDictCodec(const DictRowCodec* dict_codec) { dict_codec_ = dict_codec; }
+
     static uint8_t GetSchemaVersion(const int8_t* row) { return *(reinterpret_cast<const uint8_t*>(row + 1)); }
 
     int32_t GetBool(uint32_t idx, bool* val) const;
@@ -190,6 +197,7 @@ class RowView {
     const int8_t* row_;
     const Schema& schema_;
     std::vector<uint32_t> offset_vec_;
+    const DictRowCodec* dict_codec_ = nullptr;
 };
 
 namespace v1 {
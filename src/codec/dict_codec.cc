@@ -0,0 +1,371 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "codec/dict_codec.h"
+
+#include <cstring>
+#include <mutex>  // NOLINT
+
+namespace openmldb {
+namespace codec {
+
+#define BitMapSize(size) (((size) >> 3) + !!((size)&0x07))
+
+static uint32_t GetFixedSize(::openmldb::type::DataType type) {
+    switch (type) {
+        case ::openmldb::type::kBool:
+            return sizeof(bool);
+        case ::openmldb::type::kSmallInt:
+            return sizeof(int16_t);
+        case ::openmldb::type::kInt:
+        case ::openmldb::type::kDate:
+            return sizeof(int32_t);
+        case ::openmldb::type::kFloat:
+            return sizeof(float);
+        case ::openmldb::type::kBigInt:
+        case ::openmldb::type::kTimestamp:
+            return sizeof(int64_t);
+        case ::openmldb::type::kDouble:
+            return sizeof(double);
+        default:
+            return 0;
+    }
+}
+
+// the same as RowBuilder
+static uint8_t GetAddrLength(uint32_t size) {
+    if (size <= UINT8_MAX) {
+        return 1;
+    } else if (size <= UINT16_MAX) {
+        return 2;
+    } else if (size <= UINT24_MAX) {
+        return 3;
+    }
+    return 4;
+}
+
+static void PutVarint32(uint32_t value, std::string* output) {
+    while (value >= 0x80) {
+        output->push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    output->push_back(static_cast<char>(value));
+}
+
+static const char* GetVarint32(const char* ptr, const char* limit, uint32_t* value) {
+    uint32_t result = 0;
+    for (uint32_t shift = 0; shift <= 28 && ptr < limit; shift += 7) {
+        uint32_t byte = static_cast<uint8_t>(*ptr++);
+        result |= (byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return ptr;
+        }
+    }
+    return nullptr;
+}
+
+bool StringDict::GetOrAdd(const char* data, uint32_t size, uint32_t* id) {
+    std::string_view value(data, size);
+    {
+        std::shared_lock<std::shared_mutex> lock(mu_);
+        auto it = ids_.find(value);
+        if (it != ids_.end()) {
+            *id = it->second;
+            return true;
+        }
+        if (values_.size() >= max_size_) {
+            return false;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(mu_);
+    auto it = ids_.find(value);
+    if (it != ids_.end()) {
+        *id = it->second;
+        return true;
+    }
+    if (values_.size() >= max_size_) {
+        return false;
+    }
+    *id = values_.size();
+    values_.emplace_back(data, size);
+    ids_.emplace(values_.back(), *id);
+    byte_size_ += size;
+    return true;
+}
+
+bool StringDict::Get(uint32_t id, const char** data, uint32_t* size) const {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    if (id >= values_.size()) {
+        return false;
+    }
+    const auto& value = values_[id];
+    *data = value.data();
+    *size = value.size();
+    return true;
+}
+
+uint32_t StringDict::Size() const {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    return values_.size();
+}
+
+uint64_t StringDict::GetByteSize() const {
+    std::shared_lock<std::shared_mutex> lock(mu_);
+    return byte_size_;
+}
+
+DictRowCodec::DictRowCodec(uint32_t str_field_cnt, uint32_t max_dict_size, uint32_t max_value_size)
+    : max_value_size_(max_value_size) {
+    for (uint32_t i = 0; i < str_field_cnt; i++) {
+        dicts_.emplace_back(std::make_unique<StringDict>(max_dict_size));
+    }
+    for (auto& layout : layouts_) {
+        layout.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+DictRowCodec::~DictRowCodec() {
+    for (auto& layout : layouts_) {
+        delete layout.load(std::memory_order_relaxed);
+    }
+}
+
+const DictRowCodec::Layout* DictRowCodec::GetLayout(const Schema& schema, uint8_t version) {
+    Layout* layout = layouts_[version].load(std::memory_order_acquire);
+    if (layout != nullptr) {
+        return layout;
+    }
+    auto new_layout = std::make_unique<Layout>();
+    new_layout->str_field_start_offset = HEADER_LENGTH + BitMapSize(schema.size());
+    new_layout->str_field_cnt = 0;
+    for (const auto& column : schema) {
+        if (column.data_type() == ::openmldb::type::kVarchar || column.data_type() == ::openmldb::type::kString) {
+            new_layout->str_field_cnt++;
+            continue;
+        }
+        uint32_t size = GetFixedSize(column.data_type());
+        if (size == 0) {
+            return nullptr;
+        }
+        new_layout->str_field_start_offset += size;
+    }
+    if (layouts_[version].compare_exchange_strong(layout, new_layout.get(), std::memory_order_acq_rel)) {
+        return new_layout.release();
+    }
+    // set by another thread
+    return layout;
+}
+
+const DictRowCodec::Layout* DictRowCodec::GetLayout(const int8_t* row, uint32_t size) const {
+    if (row == nullptr || size <= HEADER_LENGTH || !IsEncoded(row) || RowView::GetSize(row) != size) {
+        return nullptr;
+    }
+    const Layout* layout = layouts_[RowView::GetSchemaVersion(row)].load(std::memory_order_acquire);
+    if (layout == nullptr || size < layout->str_field_start_offset) {
+        return nullptr;
+    }
+    return layout;
+}
+
+bool DictRowCodec::Encode(const Schema& schema, const int8_t* row, uint32_t size, std::string* output) {
+    if (row == nullptr || size <= HEADER_LENGTH || IsEncoded(row) || RowView::GetSize(row) != size) {
+        return false;
+    }
+    const Layout* layout = GetLayout(schema, RowView::GetSchemaVersion(row));
+    if (layout == nullptr || layout->str_field_cnt == 0) {
+        return false;
+    }
+    uint8_t addr_length = GetAddrLength(size);
+    if (size < layout->str_field_start_offset + addr_length * layout->str_field_cnt) {
+        return false;
+    }
+    output->clear();
+    output->reserve(size);
+    output->append(reinterpret_cast<const char*>(row), layout->str_field_start_offset);
+    for (uint32_t i = 0; i < layout->str_field_cnt; i++) {
+        int8_t* data = nullptr;
+        uint32_t length = 0;
+        uint32_t next_str_pos = i + 1 < layout->str_field_cnt ? i + 1 : 0;
+        if (v1::GetStrField(row, i, next_str_pos, layout->str_field_start_offset, addr_length, &data, &length) != 0 ||
+            data < row || data + length > row + size) {
+            return false;
+        }
+        uint32_t id = 0;
+        if (i < dicts_.size() && length <= max_value_size_ &&
+            dicts_[i]->GetOrAdd(reinterpret_cast<const char*>(data), length, &id)) {
+            PutVarint32(id << 1 | 1, output);
+        } else {
+            PutVarint32(length << 1, output);
+            output->append(reinterpret_cast<const char*>(data), length);
+        }
+        if (output->size() >= size) {
+            return false;
+        }
+    }
+    (*output)[0] = static_cast<char>(DICT_ROW_FVERSION);
+    uint32_t encoded_size = output->size();
+    memcpy(&(*output)[VERSION_LENGTH], &encoded_size, SIZE_LENGTH);
+    return true;
+}
+
+bool DictRowCodec::DecodeFields(const int8_t* row, uint32_t size, const Layout* layout, std::vector<Field>* fields,
+                                uint32_t* total_size) const {
+    const char* ptr = reinterpret_cast<const char*>(row) + layout->str_field_start_offset;
+    const char* limit = reinterpret_cast<const char*>(row) + size;
+    uint64_t str_size = 0;
+    fields->resize(layout->str_field_cnt);
+    for (uint32_t i = 0; i < layout->str_field_cnt; i++) {
+        uint32_t value = 0;
+        ptr = GetVarint32(ptr, limit, &value);
+        if (ptr == nullptr) {
+            return false;
+        }
+        auto& field = (*fields)[i];
+        if (value & 1) {
+            if (i >= dicts_.size() || !dicts_[i]->Get(value >> 1, &field.data, &field.size)) {
+                return false;
+            }
+        } else {
+            field.data = ptr;
+            field.size = value >> 1;
+            if (field.size > static_cast<uint64_t>(limit - ptr)) {
+                return false;
+            }
+            ptr += field.size;
+        }
+        str_size += field.size;
+    }
+    // the same as RowBuilder::CalTotalLength
+    uint64_t length = layout->str_field_start_offset + str_size;
+    uint64_t cnt = layout->str_field_cnt;
+    if (length + cnt <= UINT8_MAX) {
+        length += cnt;
+    } else if (length + cnt * 2 <= UINT16_MAX) {
+        length += cnt * 2;
+    } else if (length + cnt * 3 <= UINT24_MAX) {
+        length += cnt * 3;
+    } else if (length + cnt * 4 <= UINT32_MAX) {
+        length += cnt * 4;
+    } else {
+        return false;
+    }
+    *total_size = length;
+    return true;
+}
+
+void DictRowCodec::WriteRow(const int8_t* row, const Layout* layout, const std::vector<Field>& fields,
+                            uint32_t total_size, int8_t* buf) const {
+    memcpy(buf, row, layout->str_field_start_offset);
+    *buf = 1;  // FVersion
+    memcpy(buf + VERSION_LENGTH, &total_size, SIZE_LENGTH);
+    uint8_t addr_length = GetAddrLength(total_size);
+    uint32_t str_offset = layout->str_field_start_offset + addr_length * layout->str_field_cnt;
+    for (uint32_t i = 0; i < fields.size(); i++) {
+        uint8_t* ptr = reinterpret_cast<uint8_t*>(buf + layout->str_field_start_offset + addr_length * i);
+        // the same as RowBuilder::SetStrOffset
+        if (addr_length == 1) {
+            *ptr = static_cast<uint8_t>(str_offset);
+        } else if (addr_length == 2) {
+            *(reinterpret_cast<uint16_t*>(ptr)) = static_cast<uint16_t>(str_offset);
+        } else if (addr_length == 3) {
+            *ptr = str_offset >> 16;
+            *(ptr + 1) = (str_offset & 0xFF00) >> 8;
+            *(ptr + 2) = str_offset & 0x00FF;
+        } else {
+            *(reinterpret_cast<uint32_t*>(ptr)) = str_offset;
+        }
+        memcpy(buf + str_offset, fields[i].data, fields[i].size);
+        str_offset += fields[i].size;
+    }
+}
+
+bool DictRowCodec::Decode(const int8_t* row, uint32_t size, std::string* output) const {
+    const Layout* layout = GetLayout(row, size);
+    if (layout == nullptr) {
+        return false;
+    }
+    std::vector<Field> fields;
+    uint32_t total_size = 0;
+    if (!DecodeFields(row, size, layout, &fields, &total_size)) {
+        return false;
+    }
+    output->resize(total_size);
+    WriteRow(row, layout, fields, total_size, reinterpret_cast<int8_t*>(output->data()));
+    return true;
+}
+
+bool DictRowCodec::Decode(const int8_t* row, uint32_t size, int8_t** output, uint32_t* output_size) const {
+    const Layout* layout = GetLayout(row, size);
+    if (layout == nullptr) {
+        return false;
+    }
+    std::vector<Field> fields;
+    uint32_t total_size = 0;
+    if (!DecodeFields(row, size, layout, &fields, &total_size)) {
+        return false;
+    }
+    int8_t* buf = static_cast<int8_t*>(malloc(total_size));
+    WriteRow(row, layout, fields, total_size, buf);
+    *output = buf;
+    *output_size = total_size;
+    return true;
+}
+
+int32_t DictRowCodec::GetStrField(const int8_t* row, uint32_t size, uint32_t str_pos, const char** data,
+                                  uint32_t* length) const {
+    const Layout* layout = GetLayout(row, size);
+    if (layout == nullptr || str_pos >= layout->str_field_cnt || data == nullptr || length == nullptr) {
+        return -1;
+    }
+    const char* ptr = reinterpret_cast<const char*>(row) + layout->str_field_start_offset;
+    const char* limit = reinterpret_cast<const char*>(row) + size;
+    for (uint32_t i = 0; i <= str_pos; i++) {
+        uint32_t value = 0;
+        ptr = GetVarint32(ptr, limit, &value);
+        if (ptr == nullptr) {
+            return -1;
+        }
+        if (value & 1) {
+            if (i == str_pos) {
+                return i < dicts_.size() && dicts_[i]->Get(value >> 1, data, length) ? 0 : -1;
+            }
+            continue;
+        }
+        uint32_t field_size = value >> 1;
+        if (field_size > static_cast<uint64_t>(limit - ptr)) {
+            return -1;
+        }
+        if (i == str_pos) {
+            *data = ptr;
+            *length = field_size;
+            return 0;
+        }
+        ptr += field_size;
+    }
+    return -1;
+}
+
+uint64_t DictRowCodec::GetByteSize() const {
+    uint64_t size = 0;
+    for (const auto& dict : dicts_) {
+        size += dict->GetByteSize();
+    }
+    return size;
+}
+
+}  // namespace codec
+}  // namespace openmldb
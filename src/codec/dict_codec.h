@@ -0,0 +1,129 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_CODEC_DICT_CODEC_H_
+#define SRC_CODEC_DICT_CODEC_H_
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <shared_mutex>  // NOLINT
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "codec/codec.h"
+
+namespace openmldb {
+namespace codec {
+
+// the FVersion of the rows encoded by DictRowCodec, the rows of RowBuilder have FVersion 1
+static constexpr uint8_t DICT_ROW_FVERSION = 0x81;
+
+// the dictionary of the values of a string column. The ids are assigned in order of insertion and never
+// reused, so the values referred by the encoded rows live as long as the dictionary.
+class StringDict {
+ public:
+    explicit StringDict(uint32_t max_size) : max_size_(max_size), byte_size_(0) {}
+
+    StringDict(const StringDict&) = delete;
+    StringDict& operator=(const StringDict&) = delete;
+
+    // get the id of value and add it if absent, return false if it is absent and the dictionary is full
+    bool GetOrAdd(const char* data, uint32_t size, uint32_t* id);
+
+    bool Get(uint32_t id, const char** data, uint32_t* size) const;
+
+    uint32_t Size() const;
+
+    uint64_t GetByteSize() const;
+
+ private:
+    const uint32_t max_size_;
+    mutable std::shared_mutex mu_;
+    // the values never move, so the keys of ids_ can refer them
+    std::deque<std::string> values_;
+    std::unordered_map<std::string_view, uint32_t> ids_;
+    uint64_t byte_size_;
+};
+
+// DictRowCodec encodes the rows of a table by replacing the string fields with the ids of the dictionaries
+// of their columns. The header, the null bitmap and the fixed size fields stay at their offsets and only the
+// FVersion is changed to DICT_ROW_FVERSION, so the fixed size fields of an encoded row are read by RowView as
+// they are, and a string field is read by skipping the string fields before it, without decoding the whole row.
+// A string field is encoded as
+//   varint(id << 1 | 1)          the value is in the dictionary
+//   varint(size << 1), bytes     the value is inline, as it is too long or the dictionary is full
+// The dictionaries keep the values seen first, so they fit the columns of low cardinality.
+class DictRowCodec {
+ public:
+    // the dictionaries are made for the first `str_field_cnt` string fields, the string fields added
+    // to the schema later are always inline
+    DictRowCodec(uint32_t str_field_cnt, uint32_t max_dict_size, uint32_t max_value_size);
+    ~DictRowCodec();
+
+    DictRowCodec(const DictRowCodec&) = delete;
+    DictRowCodec& operator=(const DictRowCodec&) = delete;
+
+    static bool IsEncoded(const int8_t* row) { return *reinterpret_cast<const uint8_t*>(row) == DICT_ROW_FVERSION; }
+
+    // return false if the row has no string field or the encoded row isn't smaller, the row should be kept
+    // as it is then. `schema` is the schema of the version of row
+    bool Encode(const Schema& schema, const int8_t* row, uint32_t size, std::string* output);
+
+    // decode an encoded row into the format of RowBuilder
+    bool Decode(const int8_t* row, uint32_t size, std::string* output) const;
+
+    // the same as above, the output is allocated by malloc and owned by the caller
+    bool Decode(const int8_t* row, uint32_t size, int8_t** output, uint32_t* output_size) const;
+
+    // get the `str_pos`-th string field of an encoded row, the value refers the row or the dictionary
+    int32_t GetStrField(const int8_t* row, uint32_t size, uint32_t str_pos, const char** data,
+                        uint32_t* length) const;
+
+    // the bytes of values kept by the dictionaries
+    uint64_t GetByteSize() const;
+
+ private:
+    struct Layout {
+        uint32_t str_field_start_offset;
+        uint32_t str_field_cnt;
+    };
+
+    struct Field {
+        const char* data;
+        uint32_t size;
+    };
+
+    const Layout* GetLayout(const Schema& schema, uint8_t version);
+    const Layout* GetLayout(const int8_t* row, uint32_t size) const;
+
+    bool DecodeFields(const int8_t* row, uint32_t size, const Layout* layout, std::vector<Field>* fields,
+                      uint32_t* total_size) const;
+    void WriteRow(const int8_t* row, const Layout* layout, const std::vector<Field>& fields, uint32_t total_size,
+                  int8_t* buf) const;
+
+    const uint32_t max_value_size_;
+    std::vector<std::unique_ptr<StringDict>> dicts_;
+    // indexed by schema version, the layout is set before the first row of its version is encoded
+    std::array<std::atomic<Layout*>, 256> layouts_;
+};
+
+}  // namespace codec
+}  // namespace openmldb
+#endif  // SRC_CODEC_DICT_CODEC_H_
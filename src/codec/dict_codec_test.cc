@@ -0,0 +1,261 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "codec/dict_codec.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openmldb {
+namespace codec {
+
+class DictCodecTest : public ::testing::Test {
+ public:
+    DictCodecTest() {
+        AddColumn("card", type::kString);
+        AddColumn("amt", type::kInt);
+        AddColumn("city", type::kString);
+        AddColumn("ts", type::kTimestamp);
+        AddColumn("memo", type::kVarchar);
+    }
+
+    void AddColumn(const std::string& name, type::DataType type) {
+        auto column = schema_.Add();
+        column->set_name(name);
+        column->set_data_type(type);
+    }
+
+    std::string MakeRow(const std::string& card, int32_t amt, const std::string& city, int64_t ts,
+                        const std::string* memo) {
+        RowBuilder builder(schema_);
+        uint32_t size = builder.CalTotalLength(card.size() + city.size() + (memo ? memo->size() : 0));
+        std::string row(size, '\0');
+        builder.SetBuffer(reinterpret_cast<int8_t*>(row.data()), size);
+        builder.AppendString(card.data(), card.size());
+        builder.AppendInt32(amt);
+        builder.AppendString(city.data(), city.size());
+        builder.AppendTimestamp(ts);
+        if (memo) {
+            builder.AppendString(memo->data(), memo->size());
+        } else {
+            builder.AppendNULL();
+        }
+        return row;
+    }
+
+    static const int8_t* Data(const std::string& row) { return reinterpret_cast<const int8_t*>(row.data()); }
+
+    Schema schema_;
+};
+
+TEST_F(DictCodecTest, EncodeDecode) {
+    DictRowCodec codec(3, 100, 16);
+    std::string memo = "a memo longer than the max value size";
+    std::vector<std::string> rows = {MakeRow("card0", 1, "beijing", 1000, nullptr),
+                                     MakeRow("card1", 2, "beijing", 1001, &memo),
+                                     MakeRow("card0", 3, "shanghai", 1002, &memo),
+                                     MakeRow("card0", 4, "beijing", 1003, nullptr)};
+    std::vector<std::string> encoded_rows;
+    for (const auto& row : rows) {
+        std::string encoded;
+        ASSERT_TRUE(codec.Encode(schema_, Data(row), row.size(), &encoded));
+        ASSERT_TRUE(DictRowCodec::IsEncoded(Data(encoded)));
+        ASSERT_LT(encoded.size(), row.size());
+        ASSERT_EQ(encoded.size(), RowView::GetSize(Data(encoded)));
+        encoded_rows.push_back(encoded);
+    }
+    // the decoded row is the same as the row built by RowBuilder
+    for (size_t i = 0; i < rows.size(); i++) {
+        std::string decoded;
+        ASSERT_TRUE(codec.Decode(Data(encoded_rows[i]), encoded_rows[i].size(), &decoded));
+        ASSERT_EQ(rows[i], decoded);
+        int8_t* buf = nullptr;
+        uint32_t size = 0;
+        ASSERT_TRUE(codec.Decode(Data(encoded_rows[i]), encoded_rows[i].size(), &buf, &size));
+        ASSERT_EQ(rows[i], std::string(reinterpret_cast<char*>(buf), size));
+        free(buf);
+    }
+    // the row is kept as it is if it is encoded already
+    std::string output;
+    ASSERT_FALSE(codec.Encode(schema_, Data(encoded_rows[0]), encoded_rows[0].size(), &output));
+    ASSERT_FALSE(codec.Decode(Data(rows[0]), rows[0].size(), &output));
+    // the memo is too long for the dictionary, and the null memo is an empty value in it
+    ASSERT_EQ(5u + 5 + 7 + 8, codec.GetByteSize());
+}
+
+TEST_F(DictCodecTest, RowView) {
+    DictRowCodec codec(3, 100, 16);
+    std::string memo = "memo";
+    std::string row = MakeRow("card0", 7, "beijing", 1000, &memo);
+    std::string encoded;
+    ASSERT_TRUE(codec.Encode(schema_, Data(row), row.size(), &encoded));
+
+    RowView view(schema_);
+    view.SetDictCodec(&codec);
+    ASSERT_TRUE(view.Reset(Data(encoded), encoded.size()));
+    int32_t amt = 0;
+    ASSERT_EQ(0, view.GetInt32(1, &amt));
+    ASSERT_EQ(7, amt);
+    int64_t ts = 0;
+    ASSERT_EQ(0, view.GetTimestamp(3, &ts));
+    ASSERT_EQ(1000, ts);
+    char* ch = nullptr;
+    uint32_t length = 0;
+    ASSERT_EQ(0, view.GetString(2, &ch, &length));
+    ASSERT_EQ("beijing", std::string(ch, length));
+    ASSERT_EQ(0, view.GetString(4, &ch, &length));
+    ASSERT_EQ("memo", std::string(ch, length));
+    ASSERT_EQ(0, view.GetValue(Data(encoded), 0, &ch, &length));
+    ASSERT_EQ("card0", std::string(ch, length));
+    std::string value;
+    ASSERT_EQ(0, view.GetStrValue(2, &value));
+    ASSERT_EQ("beijing", value);
+
+    row = MakeRow("card1", 8, "shanghai", 1001, nullptr);
+    ASSERT_TRUE(codec.Encode(schema_, Data(row), row.size(), &encoded));
+    ASSERT_TRUE(view.Reset(Data(encoded), encoded.size()));
+    ASSERT_TRUE(view.IsNULL(4));
+    ASSERT_EQ(1, view.GetString(4, &ch, &length));
+    ASSERT_EQ(0, view.GetString(0, &ch, &length));
+    ASSERT_EQ("card1", std::string(ch, length));
+}
+
+TEST_F(DictCodecTest, FullDict) {
+    // two values in the dictionary of the first string column, and the other string columns have no dictionary
+    DictRowCodec codec(1, 2, 16);
+    RowView view(schema_);
+    view.SetDictCodec(&codec);
+    for (int i = 0; i < 10; i++) {
+        std::string card = "card" + std::to_string(i % 3);
+        std::string city = "city" + std::to_string(i);
+        std::string row = MakeRow(card, i, city, i, nullptr);
+        std::string encoded;
+        // card2 is inline as the dictionary is full, so the encoded row isn't smaller
+        if (i % 3 == 2) {
+            ASSERT_FALSE(codec.Encode(schema_, Data(row), row.size(), &encoded));
+            continue;
+        }
+        ASSERT_TRUE(codec.Encode(schema_, Data(row), row.size(), &encoded));
+        std::string decoded;
+        ASSERT_TRUE(codec.Decode(Data(encoded), encoded.size(), &decoded));
+        ASSERT_EQ(row, decoded);
+        ASSERT_TRUE(view.Reset(Data(encoded), encoded.size()));
+        char* ch = nullptr;
+        uint32_t length = 0;
+        ASSERT_EQ(0, view.GetString(0, &ch, &length));
+        ASSERT_EQ(card, std::string(ch, length));
+        ASSERT_EQ(0, view.GetString(2, &ch, &length));
+        ASSERT_EQ(city, std::string(ch, length));
+    }
+    ASSERT_EQ(10u, codec.GetByteSize());
+}
+
+TEST_F(DictCodecTest, SchemaVersion) {
+    DictRowCodec codec(3, 100, 16);
+    Schema schema_v2 = schema_;
+    auto column = schema_v2.Add();
+    column->set_name("tag");
+    column->set_data_type(type::kString);
+    RowBuilder builder(schema_v2);
+    builder.SetSchemaVersion(2);
+    uint32_t size = builder.CalTotalLength(5 + 7 + 3);
+    std::string row(size, '\0');
+    builder.SetBuffer(reinterpret_cast<int8_t*>(row.data()), size);
+    builder.AppendString("card0", 5);
+    builder.AppendInt32(1);
+    builder.AppendString("beijing", 7);
+    builder.AppendTimestamp(1000);
+    builder.AppendNULL();
+    builder.AppendString("new", 3);
+
+    std::string encoded;
+    ASSERT_TRUE(codec.Encode(schema_v2, Data(row), row.size(), &encoded));
+    std::string decoded;
+    ASSERT_TRUE(codec.Decode(Data(encoded), encoded.size(), &decoded));
+    ASSERT_EQ(row, decoded);
+    const char* data = nullptr;
+    uint32_t length = 0;
+    ASSERT_EQ(0, codec.GetStrField(Data(encoded), encoded.size(), 3, &data, &length));
+    ASSERT_EQ("new", std::string(data, length));
+    ASSERT_EQ(-1, codec.GetStrField(Data(encoded), encoded.size(), 4, &data, &length));
+
+    // the rows of version 1 are decoded by their own layout
+    std::string row_v1 = MakeRow("card1", 2, "beijing", 1001, nullptr);
+    ASSERT_TRUE(codec.Encode(schema_, Data(row_v1), row_v1.size(), &encoded));
+    ASSERT_TRUE(codec.Decode(Data(encoded), encoded.size(), &decoded));
+    ASSERT_EQ(row_v1, decoded);
+}
+
+TEST_F(DictCodecTest, Project) {
+    DictRowCodec codec(3, 100, 16);
+    std::string memo = "memo";
+    std::string row = MakeRow("card0", 7, "beijing", 1000, &memo);
+    std::string encoded;
+    ASSERT_TRUE(codec.Encode(schema_, Data(row), row.size(), &encoded));
+
+    std::map<int32_t, std::shared_ptr<Schema>> vers_schema = {{1, std::make_shared<Schema>(schema_)}};
+    ProjectList plist;
+    plist.Add(2);
+    plist.Add(1);
+    plist.Add(4);
+    RowProject project(vers_schema, plist);
+    ASSERT_TRUE(project.Init());
+    int8_t* expect = nullptr;
+    uint32_t expect_size = 0;
+    ASSERT_TRUE(project.Project(Data(row), row.size(), &expect, &expect_size));
+    project.SetDictCodec(&codec);
+    int8_t* output = nullptr;
+    uint32_t output_size = 0;
+    ASSERT_TRUE(project.Project(Data(encoded), encoded.size(), &output, &output_size));
+    ASSERT_EQ(std::string(reinterpret_cast<char*>(expect), expect_size),
+              std::string(reinterpret_cast<char*>(output), output_size));
+    delete[] expect;
+    delete[] output;
+}
+
+TEST_F(DictCodecTest, Concurrent) {
+    DictRowCodec codec(3, 50, 16);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([this, &codec, t] {
+            for (int i = 0; i < 1000; i++) {
+                std::string row =
+                    MakeRow("card" + std::to_string((i + t) % 100), i, "city" + std::to_string(i % 10), i, nullptr);
+                std::string encoded;
+                ASSERT_TRUE(codec.Encode(schema_, Data(row), row.size(), &encoded));
+                std::string decoded;
+                ASSERT_TRUE(codec.Decode(Data(encoded), encoded.size(), &decoded));
+                ASSERT_EQ(row, decoded);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+}  // namespace codec
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -70,11 +70,23 @@ DEFINE_bool(use_name, false, "enable or disable use server name");
 DEFINE_string(data_dir, "./data", "the path of data dir");
 DEFINE_bool(enable_distsql, false, "enable or disable distribute sql");
 DEFINE_bool(enable_localtablet, true, "enable or disable local tablet opt when distribute sql circumstance");
+DEFINE_string(jit_object_cache_path, "",
+              "the directory to keep the objects compiled by jit, the sql compiled before skips codegen. "
+              "empty means disabled");
+DEFINE_uint32(jit_object_cache_capacity, 1000,
+              "the max number of objects kept in jit_object_cache_path, the least recently used are removed. "
+              "0 means unlimited");
+DEFINE_uint32(batch_agg_parallelism, 1,
+              "the number of threads to run the window and group aggregations of a batch query on partition keys");
 DEFINE_string(bucket_size, "1d", "the default bucket size in pre-aggr table");
 
 // scan configuration
 DEFINE_uint32(scan_max_bytes_size, 2 * 1024 * 1024, "config the max size of scan bytes size");
 DEFINE_uint32(scan_reserve_size, 1024, "config the size of vec reserve");
+DEFINE_uint32(scan_zero_copy_row_size, 1024,
+              "the rows of memory table not less than it are attached to scan response without copy, 0 means disabled");
+DEFINE_uint32(batch_query_cursor_timeout_ms, 60 * 1000,
+              "the cursor of streaming batch query is released if the next page is not fetched in time");
 DEFINE_uint32(preview_limit_max_num, 1000, "config the max num of preview limit");
 DEFINE_uint32(preview_default_limit, 100, "config the default limit of preview");
 // binlog configuration
@@ -86,6 +98,14 @@ DEFINE_int32(binlog_coffee_time, 1000, "config the coffee time. unit is millisec
 DEFINE_int32(binlog_sync_wait_time, 100, "config the sync log wait time. unit is milliseconds");
 DEFINE_int32(binlog_sync_to_disk_interval, 20000,
              "config the interval of sync binlog to disk time. unit is milliseconds");
+DEFINE_bool(binlog_group_commit, false,
+            "sync the binlog of all partitions on a tablet by one group commit syncer instead of per table timer");
+DEFINE_bool(binlog_group_commit_wait_sync, false,
+            "put returns after its binlog is synced to disk. only works when binlog_group_commit is true");
+DEFINE_uint32(binlog_tail_cache_size, 0,
+              "the count of latest binlog entries cached in memory for replication of every partition, 0 is disabled");
+DEFINE_bool(binlog_sync_with_attachment, true,
+            "send the cached binlog entries to follower as rpc attachment without parsing them");
 DEFINE_int32(binlog_delete_interval, 60000, "config the interval of delete binlog. unit is milliseconds");
 DEFINE_int32(binlog_match_logoffset_interval, 1000, "config the interval of match log offset. unit is milliseconds");
 DEFINE_int32(binlog_name_length, 8, "binlog name length");
@@ -110,6 +130,9 @@ DEFINE_int32(request_sleep_time, 1000, "the sleep time when request error. unit
 DEFINE_uint32(max_traverse_pk_cnt, 5000, "max traverse iter pk cnt");
 DEFINE_uint32(max_traverse_cnt, 50000, "max traverse iter loop cnt");
 DEFINE_uint32(traverse_cnt_limit, 1000, "limit traverse cnt");
+DEFINE_uint32(traverse_prefetch_parallelism, 1,
+              "the number of traverse requests a full table scan sends ahead to the remote partitions, 1 means "
+              "the pages are fetched one by one");
 DEFINE_string(ssd_root_path, "", "the root ssd path of db");
 DEFINE_string(hdd_root_path, "", "the root hdd path of db");
 
@@ -148,6 +171,12 @@ DEFINE_uint32(skiplist_max_height, 12, "the max height of skiplist");
 DEFINE_uint32(key_entry_max_height, 8, "the max height of key entry");
 DEFINE_uint32(latest_default_skiplist_height, 1, "the default height of skiplist for latest table");
 DEFINE_uint32(absolute_default_skiplist_height, 4, "the default height of skiplist for absolute table");
+DEFINE_uint32(segment_slab_chunk_size, 0,
+              "the chunk size of the slab allocating the time entry nodes per segment, 0 means allocating from heap");
+DEFINE_uint32(dict_compress_max_values, 65536,
+              "the max count of values in the dictionary of a string column of the table with dictionary compress_type");
+DEFINE_uint32(dict_compress_max_value_length, 256,
+              "the max length of the string values kept by the dictionaries, the longer values are stored inline");
 DEFINE_uint32(max_col_display_length, 256, "config the max length of column display");
 
 // rocksdb
@@ -159,6 +188,10 @@ DEFINE_uint32(block_cache_mb, 4096,
 DEFINE_uint32(write_buffer_mb, 128, "Memtable size");
 DEFINE_uint32(block_cache_shardbits, 8, "Divide block cache into 2^8 shards to avoid cache contention");
 DEFINE_bool(verify_compression, false, "For debug");
+DEFINE_uint32(disk_bloom_bits_per_key, 10,
+              "Bits per key of the prefix bloom filter of disk tables, the filters are partitioned and cached in "
+              "block cache. 0 means disabled");
+DEFINE_uint32(ssd_block_size_kb, 16, "Block size of ssd tables in KB, smaller blocks read less for the point lookups");
 
 // load table resouce control
 DEFINE_uint32(load_table_batch, 30, "set laod table batch size");
@@ -162,6 +162,8 @@ class LogReader {
     int GetEndLogIndex();
     uint64_t GetLastRecordEndOffset();
     bool SetOffset(uint64_t start_offset);
+    // close the current log part, the next read starts from the part which contains start_offset
+    void Reset(uint64_t start_offset);
     uint64_t GetMinOffset() const {
         return min_offset_;
     }
@@ -2308,6 +2308,8 @@ int NameServerImpl::CreateTableOnTablet(const std::shared_ptr<::openmldb::namese
     ::openmldb::type::CompressType compress_type = ::openmldb::type::CompressType::kNoCompress;
     if (table_info->compress_type() == ::openmldb::type::kSnappy) {
         compress_type = ::openmldb::type::CompressType::kSnappy;
+    } else if (table_info->compress_type() == ::openmldb::type::kDictionary) {
+        compress_type = ::openmldb::type::CompressType::kDictionary;
     }
     ::openmldb::api::TableMeta table_meta;
     table_meta.set_db(table_info->db());
@@ -2317,6 +2319,7 @@ int NameServerImpl::CreateTableOnTablet(const std::shared_ptr<::openmldb::namese
     table_meta.set_compress_type(compress_type);
     table_meta.set_storage_mode(table_info->storage_mode());
     table_meta.set_base_table_tid(table_info->base_table_tid());
+    table_meta.set_disk_row_layout(table_info->disk_row_layout());
     if (table_info->has_key_entry_max_height()) {
         table_meta.set_key_entry_max_height(table_info->key_entry_max_height());
     }
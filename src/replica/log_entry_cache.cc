@@ -0,0 +1,101 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "replica/log_entry_cache.h"
+
+#include <algorithm>
+
+namespace openmldb {
+namespace replica {
+
+LogEntryCache::LogEntryCache(uint32_t capacity)
+    : capacity_(std::max(capacity, 1u)), mu_(), entries_(capacity_), min_index_(0), size_(0), head_(0) {}
+
+void LogEntryCache::Append(uint64_t log_index, const std::string& entry) {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (size_ > 0 && log_index != min_index_ + size_) {
+        // the log is not continuous, e.g. the offset is reset after changing role
+        size_ = 0;
+    }
+    if (size_ == 0) {
+        min_index_ = log_index;
+        head_ = 0;
+    }
+    uint32_t pos = 0;
+    if (size_ < capacity_) {
+        pos = (head_ + size_) % capacity_;
+        size_++;
+    } else {
+        // overwrite the oldest one
+        pos = head_;
+        head_ = (head_ + 1) % capacity_;
+        min_index_++;
+    }
+    entries_[pos].clear();
+    entries_[pos].append(entry);
+}
+
+uint32_t LogEntryCache::Get(uint64_t start_index, uint32_t max_cnt, butil::IOBuf* buf) {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (size_ == 0 || start_index < min_index_ || start_index >= min_index_ + size_) {
+        return 0;
+    }
+    uint32_t cnt = std::min(static_cast<uint64_t>(max_cnt), min_index_ + size_ - start_index);
+    uint32_t pos = (head_ + (start_index - min_index_)) % capacity_;
+    for (uint32_t i = 0; i < cnt; i++) {
+        const butil::IOBuf& entry = entries_[pos];
+        uint32_t len = entry.size();
+        buf->append(&len, sizeof(len));
+        // share the blocks of entry, no copy
+        buf->append(entry);
+        pos = (pos + 1) % capacity_;
+    }
+    return cnt;
+}
+
+bool LogEntryCache::DecodeEntry(butil::IOBuf* buf, std::string* entry) {
+    uint32_t len = 0;
+    if (buf->copy_to(&len, sizeof(len)) != sizeof(len) || buf->size() < sizeof(len) + len) {
+        return false;
+    }
+    buf->pop_front(sizeof(len));
+    entry->clear();
+    buf->cutn(entry, len);
+    return true;
+}
+
+void LogEntryCache::Clear() {
+    std::lock_guard<std::mutex> lock(mu_);
+    for (auto& entry : entries_) {
+        entry.clear();
+    }
+    size_ = 0;
+    head_ = 0;
+    min_index_ = 0;
+}
+
+uint64_t LogEntryCache::GetMinIndex() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return size_ == 0 ? 0 : min_index_;
+}
+
+uint64_t LogEntryCache::GetMaxIndex() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return size_ == 0 ? 0 : min_index_ + size_ - 1;
+}
+
+}  // namespace replica
+}  // namespace openmldb
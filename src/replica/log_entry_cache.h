@@ -0,0 +1,72 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_REPLICA_LOG_ENTRY_CACHE_H_
+#define SRC_REPLICA_LOG_ENTRY_CACHE_H_
+
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "butil/iobuf.h"
+
+namespace openmldb {
+namespace replica {
+
+// LogEntryCache is a bounded ring buffer of the latest serialized log entries of a leader.
+// The replicate nodes of followers that are caught up read entries from it
+// instead of reading the binlog files back.
+class LogEntryCache {
+ public:
+    explicit LogEntryCache(uint32_t capacity);
+
+    // append the serialized entry, log_index must be the next of the last appended one,
+    // otherwise the cache is restarted from log_index
+    void Append(uint64_t log_index, const std::string& entry);
+
+    // append at most max_cnt entries starting from start_index to buf,
+    // every entry is encoded as a uint32 length followed by the serialized entry.
+    // return the count of entries appended, 0 if start_index is not in the cache
+    uint32_t Get(uint64_t start_index, uint32_t max_cnt, butil::IOBuf* buf);
+
+    // decode the next entry encoded by Get, return false if buf has no complete entry
+    static bool DecodeEntry(butil::IOBuf* buf, std::string* entry);
+
+    void Clear();
+
+    // the log index of the oldest entry, 0 if the cache is empty
+    uint64_t GetMinIndex();
+    // the log index of the latest entry, 0 if the cache is empty
+    uint64_t GetMaxIndex();
+
+    LogEntryCache(const LogEntryCache&) = delete;
+    LogEntryCache& operator=(const LogEntryCache&) = delete;
+
+ private:
+    const uint32_t capacity_;
+    std::mutex mu_;
+    std::vector<butil::IOBuf> entries_;
+    // the log index of the oldest entry
+    uint64_t min_index_;
+    uint32_t size_;
+    // the position of the oldest entry in entries_
+    uint32_t head_;
+};
+
+}  // namespace replica
+}  // namespace openmldb
+
+#endif  // SRC_REPLICA_LOG_ENTRY_CACHE_H_
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "replica/log_entry_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "proto/tablet.pb.h"
+
+namespace openmldb {
+namespace replica {
+
+class LogEntryCacheTest : public ::testing::Test {
+ public:
+    LogEntryCacheTest() {}
+    ~LogEntryCacheTest() {}
+};
+
+TEST_F(LogEntryCacheTest, AppendAndGet) {
+    LogEntryCache cache(4);
+    butil::IOBuf buf;
+    ASSERT_EQ(0u, cache.Get(1, 10, &buf));
+    for (uint64_t i = 1; i <= 3; i++) {
+        cache.Append(i, "entry" + std::to_string(i));
+    }
+    ASSERT_EQ(1u, cache.GetMinIndex());
+    ASSERT_EQ(3u, cache.GetMaxIndex());
+    ASSERT_EQ(2u, cache.Get(2, 10, &buf));
+    std::string entry;
+    ASSERT_TRUE(LogEntryCache::DecodeEntry(&buf, &entry));
+    ASSERT_EQ("entry2", entry);
+    ASSERT_TRUE(LogEntryCache::DecodeEntry(&buf, &entry));
+    ASSERT_EQ("entry3", entry);
+    ASSERT_FALSE(LogEntryCache::DecodeEntry(&buf, &entry));
+    ASSERT_EQ(0u, cache.Get(4, 10, &buf));
+
+    // the oldest entries are overwritten
+    for (uint64_t i = 4; i <= 6; i++) {
+        cache.Append(i, "entry" + std::to_string(i));
+    }
+    ASSERT_EQ(3u, cache.GetMinIndex());
+    ASSERT_EQ(6u, cache.GetMaxIndex());
+    ASSERT_EQ(0u, cache.Get(2, 10, &buf));
+    ASSERT_EQ(2u, cache.Get(3, 2, &buf));
+    ASSERT_TRUE(LogEntryCache::DecodeEntry(&buf, &entry));
+    ASSERT_EQ("entry3", entry);
+    ASSERT_TRUE(LogEntryCache::DecodeEntry(&buf, &entry));
+    ASSERT_EQ("entry4", entry);
+    ASSERT_TRUE(buf.empty());
+
+    // the log is not continuous
+    cache.Append(10, "entry10");
+    ASSERT_EQ(10u, cache.GetMinIndex());
+    ASSERT_EQ(10u, cache.GetMaxIndex());
+    ASSERT_EQ(0u, cache.Get(6, 10, &buf));
+    cache.Clear();
+    ASSERT_EQ(0u, cache.GetMaxIndex());
+    ASSERT_EQ(0u, cache.Get(10, 10, &buf));
+}
+
+TEST_F(LogEntryCacheTest, LogEntry) {
+    LogEntryCache cache(16);
+    for (uint64_t i = 1; i <= 8; i++) {
+        ::openmldb::api::LogEntry entry;
+        entry.set_log_index(i);
+        entry.set_ts(9527 + i);
+        entry.set_value("value" + std::to_string(i));
+        entry.set_term(1);
+        std::string buffer;
+        entry.SerializeToString(&buffer);
+        cache.Append(i, buffer);
+    }
+    butil::IOBuf buf;
+    ASSERT_EQ(8u, cache.Get(1, 32, &buf));
+    std::string buffer;
+    for (uint64_t i = 1; i <= 8; i++) {
+        ASSERT_TRUE(LogEntryCache::DecodeEntry(&buf, &buffer));
+        ::openmldb::api::LogEntry entry;
+        ASSERT_TRUE(entry.ParseFromString(buffer));
+        ASSERT_EQ(i, entry.log_index());
+        ASSERT_EQ(9527 + i, entry.ts());
+        ASSERT_EQ("value" + std::to_string(i), entry.value());
+    }
+}
+
+}  // namespace replica
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -36,6 +36,7 @@
 DECLARE_int32(binlog_single_file_max_size);
 DECLARE_int32(binlog_name_length);
 DECLARE_string(zk_cluster);
+DECLARE_uint32(binlog_tail_cache_size);
 
 namespace openmldb {
 namespace replica {
@@ -59,7 +60,10 @@ LogReplicator::LogReplicator(uint32_t tid, uint32_t pid, const std::string& path
       term_(0),
       mu_(),
       cv_(),
-      wmu_() {
+      wmu_(),
+      log_syncer_(),
+      sync_pending_(false),
+      entry_cache_() {
     binlog_index_ = 0;
     snapshot_log_part_index_.store(-1, std::memory_order_relaxed);
     snapshot_last_offset_.store(0, std::memory_order_relaxed);
@@ -67,6 +71,9 @@ LogReplicator::LogReplicator(uint32_t tid, uint32_t pid, const std::string& path
 }
 
 LogReplicator::~LogReplicator() {
+    if (log_syncer_) {
+        log_syncer_->Unregister(this);
+    }
     DelAllReplicateNode();
     if (logs_ != NULL) {
         logs_->Clear();
@@ -98,9 +105,25 @@ void LogReplicator::SyncToDisk() {
     }
 }
 
+uint64_t LogReplicator::MarkLogDirty() {
+    if (!log_syncer_) {
+        return 0;
+    }
+    return log_syncer_->MarkDirty(this);
+}
+
+void LogReplicator::WaitLogSynced(uint64_t group) {
+    if (log_syncer_) {
+        log_syncer_->WaitSynced(group);
+    }
+}
+
 bool LogReplicator::Init() {
     logs_ = new LogParts(12, 4, scmp);
     log_path_ = path_ + "/binlog/";
+    if (FLAGS_binlog_tail_cache_size > 0) {
+        entry_cache_ = std::make_shared<LogEntryCache>(FLAGS_binlog_tail_cache_size);
+    }
     if (!::openmldb::base::MkdirRecur(log_path_)) {
         PDLOG(WARNING, "fail to log dir %s", log_path_.c_str());
         return false;
@@ -109,7 +132,8 @@ bool LogReplicator::Init() {
         for (const auto& kv : real_ep_map_) {
             std::shared_ptr<ReplicateNode> replicate_node =
                 std::make_shared<ReplicateNode>(kv.first, logs_, log_path_, tid_, pid_, &term_,
-                                                &log_offset_, &mu_, &cv_, false, &follower_offset_, kv.second);
+                                                &log_offset_, &mu_, &cv_, false, &follower_offset_, kv.second,
+                                                entry_cache_);
             if (replicate_node->Init() < 0) {
                 PDLOG(WARNING, "init replicate node %s error", kv.first.c_str());
                 return false;
@@ -312,6 +336,7 @@ bool LogReplicator::ApplyEntry(const LogEntry& entry) {
         return false;
     }
     log_offset_.store(entry.log_index(), std::memory_order_relaxed);
+    MarkLogDirty();
     DEBUGLOG("sync log entry to offset %lu for %s", GetOffset(), path_.c_str());
     return true;
 }
@@ -343,11 +368,12 @@ int LogReplicator::AddReplicateNode(const std::map<std::string, std::string>& re
         if (tid == UINT32_MAX) {
             replicate_node =
                 std::make_shared<ReplicateNode>(endpoint, logs_, log_path_, tid_, pid_, &term_,
-                                                &log_offset_, &mu_, &cv_, false, &follower_offset_, kv.second);
+                                                &log_offset_, &mu_, &cv_, false, &follower_offset_, kv.second,
+                                                entry_cache_);
         } else {
             replicate_node =
                 std::make_shared<ReplicateNode>(endpoint, logs_, log_path_, tid, pid_, &term_, &log_offset_,
-                                                &mu_, &cv_, true, &follower_offset_, kv.second);
+                                                &mu_, &cv_, true, &follower_offset_, kv.second, entry_cache_);
         }
         if (replicate_node->Init() < 0) {
             PDLOG(WARNING, "init replicate node %s error", endpoint.c_str());
@@ -434,31 +460,80 @@ bool LogReplicator::DelAllReplicateNode() {
 }
 
 bool LogReplicator::AppendEntry(LogEntry& entry, ::google::protobuf::Closure* done) {
-    std::lock_guard<std::mutex> lock(wmu_);
-    if (wh_ == NULL || wh_->GetSize() / (1024 * 1024) > (uint32_t)FLAGS_binlog_single_file_max_size) {
-        bool ok = RollWLogFile();
-        if (!ok) {
+    uint64_t sync_group = 0;
+    {
+        std::lock_guard<std::mutex> lock(wmu_);
+        if (wh_ == NULL || wh_->GetSize() / (1024 * 1024) > (uint32_t)FLAGS_binlog_single_file_max_size) {
+            bool ok = RollWLogFile();
+            if (!ok) {
+                return false;
+            }
+        }
+        uint64_t cur_offset = log_offset_.load(std::memory_order_relaxed);
+        entry.set_log_index(1 + cur_offset);
+        std::string buffer;
+        entry.SerializeToString(&buffer);
+        ::openmldb::base::Slice slice(buffer);
+        ::openmldb::log::Status status = wh_->Write(slice);
+        if (!status.ok()) {
+            PDLOG(WARNING, "fail to write replication log in dir %s for %s", path_.c_str(),
+                  status.ToString().c_str());
             return false;
         }
+        log_offset_.fetch_add(1, std::memory_order_relaxed);
+        if (entry_cache_) {
+            entry_cache_->Append(entry.log_index(), buffer);
+        }
+        if (local_endpoints_.empty()) {  // if local replica are dead, leader direct
+                                         // sync to remote replica
+            follower_offset_.store(cur_offset + 1, std::memory_order_relaxed);
+        }
+        sync_group = MarkLogDirty();
+        if (done) {
+            done->Run();
+        }
     }
-    uint64_t cur_offset = log_offset_.load(std::memory_order_relaxed);
-    entry.set_log_index(1 + cur_offset);
-    std::string buffer;
-    entry.SerializeToString(&buffer);
-    ::openmldb::base::Slice slice(buffer);
-    ::openmldb::log::Status status = wh_->Write(slice);
-    if (!status.ok()) {
-        PDLOG(WARNING, "fail to write replication log in dir %s for %s", path_.c_str(), status.ToString().c_str());
-        return false;
-    }
-    log_offset_.fetch_add(1, std::memory_order_relaxed);
-    if (local_endpoints_.empty()) {  // if local replica are dead, leader direct
-                                     // sync to remote replica
-        follower_offset_.store(cur_offset + 1, std::memory_order_relaxed);
-    }
-    if (done) {
-        done->Run();
+    WaitLogSynced(sync_group);
+    return true;
+}
+
+bool LogReplicator::AppendEntryBatch(std::vector<LogEntry>* entries, ::google::protobuf::Closure* done) {
+    uint64_t sync_group = 0;
+    {
+        std::lock_guard<std::mutex> lock(wmu_);
+        std::string buffer;
+        for (auto& entry : *entries) {
+            if (wh_ == NULL || wh_->GetSize() / (1024 * 1024) > (uint32_t)FLAGS_binlog_single_file_max_size) {
+                bool ok = RollWLogFile();
+                if (!ok) {
+                    return false;
+                }
+            }
+            uint64_t cur_offset = log_offset_.load(std::memory_order_relaxed);
+            entry.set_log_index(1 + cur_offset);
+            buffer.clear();
+            entry.SerializeToString(&buffer);
+            ::openmldb::base::Slice slice(buffer);
+            ::openmldb::log::Status status = wh_->Write(slice);
+            if (!status.ok()) {
+                PDLOG(WARNING, "fail to write replication log in dir %s for %s", path_.c_str(),
+                      status.ToString().c_str());
+                return false;
+            }
+            log_offset_.fetch_add(1, std::memory_order_relaxed);
+            if (entry_cache_) {
+                entry_cache_->Append(entry.log_index(), buffer);
+            }
+        }
+        if (local_endpoints_.empty()) {
+            follower_offset_.store(log_offset_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        sync_group = MarkLogDirty();
+        if (done) {
+            done->Run();
+        }
     }
+    WaitLogSynced(sync_group);
     return true;
 }
 
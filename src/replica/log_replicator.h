@@ -33,6 +33,8 @@
 #include "log/log_writer.h"
 #include "log/sequential_file.h"
 #include "proto/tablet.pb.h"
+#include "replica/log_entry_cache.h"
+#include "replica/log_syncer.h"
 #include "replica/replicate_node.h"
 #include "storage/table.h"
 
@@ -66,6 +68,11 @@ class LogReplicator {
     // the master node append entry
     bool AppendEntry(::openmldb::api::LogEntry& entry, ::google::protobuf::Closure* done = nullptr);  // NOLINT
 
+    // the master node append a batch of entries under one write lock,
+    // the log index of the entries is continuous
+    bool AppendEntryBatch(std::vector<::openmldb::api::LogEntry>* entries,
+                          ::google::protobuf::Closure* done = nullptr);
+
     //  data to slave nodes
     void Notify();
     // recover logs meta
@@ -110,9 +117,20 @@ class LogReplicator {
 
     const std::string& GetLogPath() {return log_path_;}
 
+    // sync binlog by the tablet-wide log syncer instead of the per table timer.
+    // it must be set before Init
+    void SetLogSyncer(const std::shared_ptr<LogSyncer>& log_syncer) { log_syncer_ = log_syncer; }
+
  private:
     bool OpenSeqFile(const std::string& path, SequentialFile** sf);
 
+    // mark binlog dirty in log syncer, return the sync group. must be called with wmu_ held
+    uint64_t MarkLogDirty();
+    // wait the sync group outside of wmu_
+    void WaitLogSynced(uint64_t group);
+
+    friend class LogSyncer;
+
  private:
     // the replicator root data path
     uint32_t tid_;
@@ -139,6 +157,12 @@ class LogReplicator {
     std::atomic<uint64_t> snapshot_last_offset_;
 
     std::mutex wmu_;
+
+    std::shared_ptr<LogSyncer> log_syncer_;
+    // the binlog is in the dirty list of log syncer
+    std::atomic<bool> sync_pending_;
+    // the latest appended entries for replicate nodes, it is null if binlog_tail_cache_size is 0
+    std::shared_ptr<LogEntryCache> entry_cache_;
 };
 
 }  // namespace replica
@@ -150,6 +150,35 @@ TEST_F(LogReplicatorTest, BenchMark) {
     ASSERT_TRUE(ok);
 }
 
+TEST_F(LogReplicatorTest, AppendEntryBatch) {
+    std::map<std::string, std::string> map;
+    std::string folder = "/tmp/" + GenRand() + "/";
+    LogReplicator replicator(1, 1, folder, map, kLeaderNode);
+    bool ok = replicator.Init();
+    ASSERT_TRUE(ok);
+    std::vector<::openmldb::api::LogEntry> entries(10);
+    for (size_t i = 0; i < entries.size(); i++) {
+        entries[i].set_term(1);
+        entries[i].set_pk("test" + std::to_string(i));
+        entries[i].set_value("value" + std::to_string(i));
+        entries[i].set_ts(9527 + i);
+    }
+    ok = replicator.AppendEntryBatch(&entries);
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(10u, replicator.GetOffset());
+    for (size_t i = 0; i < entries.size(); i++) {
+        ASSERT_EQ(i + 1, entries[i].log_index());
+    }
+    ::openmldb::api::LogEntry entry;
+    entry.set_term(1);
+    entry.set_pk("test");
+    entry.set_value("test");
+    entry.set_ts(9527);
+    ok = replicator.AppendEntry(entry);
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(11u, entry.log_index());
+}
+
 TEST_F(LogReplicatorTest, LogReader) {
     // set to 1 MB, every binlog file will be a little larger than 2 MB
     // as the checking logic is: (wh_->GetSize() / (1024 * 1024)) > (uint32_t)FLAGS_binlog_single_file_max_size
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "replica/log_syncer.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+
+#include "base/glog_wrapper.h"
+#include "common/timer.h"
+#include "replica/log_replicator.h"
+
+namespace openmldb {
+namespace replica {
+
+LogSyncer::LogSyncer(uint32_t sync_interval_ms, bool wait_synced)
+    : sync_interval_ms_(sync_interval_ms),
+      wait_synced_(wait_synced),
+      running_(false),
+      worker_(),
+      mu_(),
+      cv_(),
+      synced_cv_(),
+      dirty_(),
+      next_group_(1),
+      synced_group_(0),
+      synced_cnt_(0),
+      sync_mu_() {}
+
+LogSyncer::~LogSyncer() { Stop(); }
+
+void LogSyncer::Start() {
+    if (running_.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    worker_ = std::thread(&LogSyncer::Run, this);
+    PDLOG(INFO, "start log syncer. sync interval %u ms, wait synced %d", sync_interval_ms_, wait_synced_);
+}
+
+void LogSyncer::Stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        cv_.notify_all();
+    }
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    // sync the rest and wake up all waiters
+    SyncGroup();
+    synced_cv_.notify_all();
+}
+
+uint64_t LogSyncer::MarkDirty(LogReplicator* replicator) {
+    if (!wait_synced_) {
+        // fast path, only the first append after a sync takes the lock
+        if (!replicator->sync_pending_.exchange(true, std::memory_order_acq_rel)) {
+            std::lock_guard<std::mutex> lock(mu_);
+            dirty_.push_back(replicator);
+        }
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(mu_);
+    if (!replicator->sync_pending_.exchange(true, std::memory_order_acq_rel)) {
+        dirty_.push_back(replicator);
+    }
+    cv_.notify_one();
+    return next_group_;
+}
+
+void LogSyncer::WaitSynced(uint64_t group) {
+    if (!wait_synced_ || group == 0) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mu_);
+    synced_cv_.wait(lock, [this, group] {
+        return synced_group_.load(std::memory_order_relaxed) >= group || !running_.load(std::memory_order_relaxed);
+    });
+}
+
+void LogSyncer::Unregister(LogReplicator* replicator) {
+    std::lock_guard<std::mutex> sync_lock(sync_mu_);
+    std::lock_guard<std::mutex> lock(mu_);
+    dirty_.erase(std::remove(dirty_.begin(), dirty_.end(), replicator), dirty_.end());
+}
+
+void LogSyncer::Run() {
+    while (running_.load(std::memory_order_relaxed)) {
+        {
+            std::unique_lock<std::mutex> lock(mu_);
+            // in wait synced mode the group is synced as soon as there is dirty binlog,
+            // the appends arriving during a sync are collected into the next group
+            cv_.wait_for(lock, std::chrono::milliseconds(sync_interval_ms_), [this] {
+                return !running_.load(std::memory_order_relaxed) || (wait_synced_ && !dirty_.empty());
+            });
+        }
+        SyncGroup();
+    }
+}
+
+void LogSyncer::SyncGroup() {
+    std::lock_guard<std::mutex> sync_lock(sync_mu_);
+    std::vector<LogReplicator*> group;
+    uint64_t group_id = 0;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        group.swap(dirty_);
+        group_id = next_group_++;
+        for (auto replicator : group) {
+            replicator->sync_pending_.store(false, std::memory_order_release);
+        }
+    }
+    uint64_t consumed = ::baidu::common::timer::get_micros();
+    for (auto replicator : group) {
+        replicator->SyncToDisk();
+    }
+    consumed = ::baidu::common::timer::get_micros() - consumed;
+    if (consumed > 20000) {
+        PDLOG(INFO, "sync group %lu with %lu binlogs consumed %lu ms", group_id, group.size(), consumed / 1000);
+    }
+    synced_cnt_.fetch_add(group.size(), std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        synced_group_.store(group_id, std::memory_order_relaxed);
+    }
+    synced_cv_.notify_all();
+}
+
+}  // namespace replica
+}  // namespace openmldb
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_REPLICA_LOG_SYNCER_H_
+#define SRC_REPLICA_LOG_SYNCER_H_
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <thread>              // NOLINT
+#include <vector>
+
+namespace openmldb {
+namespace replica {
+
+class LogReplicator;
+
+// LogSyncer is the tablet-wide group commit stage of binlog.
+// The replicators of all partitions mark themselves dirty after appending entries,
+// and one syncer thread flushes and syncs all the dirty binlogs in one group.
+// Every partition still writes its own binlog files, so the log offsets of
+// ReplicateNode and snapshot are not affected.
+class LogSyncer {
+ public:
+    // sync_interval_ms is the max delay of syncing a dirty binlog.
+    // if wait_synced is true, the append returns after the group it belongs to is synced
+    LogSyncer(uint32_t sync_interval_ms, bool wait_synced);
+    ~LogSyncer();
+
+    void Start();
+    void Stop();
+
+    // mark the binlog of replicator as dirty, the binlog will be synced in the returned group
+    uint64_t MarkDirty(LogReplicator* replicator);
+
+    // block until the group is synced, return immediately if wait_synced is false
+    void WaitSynced(uint64_t group);
+
+    // remove the replicator from the dirty list. the replicator must call it before destroyed
+    void Unregister(LogReplicator* replicator);
+
+    inline bool IsWaitSynced() const { return wait_synced_; }
+    inline uint64_t GetSyncedGroup() const { return synced_group_.load(std::memory_order_relaxed); }
+    inline uint64_t GetSyncedCnt() const { return synced_cnt_.load(std::memory_order_relaxed); }
+
+ private:
+    void Run();
+    void SyncGroup();
+
+ private:
+    const uint32_t sync_interval_ms_;
+    const bool wait_synced_;
+    std::atomic<bool> running_;
+    std::thread worker_;
+    // protect dirty_ and next_group_
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::condition_variable synced_cv_;
+    std::vector<LogReplicator*> dirty_;
+    uint64_t next_group_;
+    std::atomic<uint64_t> synced_group_;
+    // the count of binlog syncs
+    std::atomic<uint64_t> synced_cnt_;
+    // held during a group sync, so a replicator is not destroyed while it is synced
+    std::mutex sync_mu_;
+};
+
+}  // namespace replica
+}  // namespace openmldb
+
+#endif  // SRC_REPLICA_LOG_SYNCER_H_
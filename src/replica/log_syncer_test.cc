@@ -0,0 +1,175 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "replica/log_syncer.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "base/glog_wrapper.h"
+#include "common/timer.h"
+#include "proto/tablet.pb.h"
+#include "replica/log_replicator.h"
+
+namespace openmldb {
+namespace replica {
+
+class LogSyncerTest : public ::testing::Test {
+ public:
+    LogSyncerTest() {}
+    ~LogSyncerTest() {}
+};
+
+inline std::string GenRand() { return std::to_string(rand() % 10000000 + 1); }  // NOLINT
+
+std::vector<std::shared_ptr<LogReplicator>> CreateReplicators(uint32_t cnt,
+                                                              const std::shared_ptr<LogSyncer>& syncer) {
+    std::vector<std::shared_ptr<LogReplicator>> replicators;
+    std::map<std::string, std::string> map;
+    std::string folder = "/tmp/" + GenRand() + "/";
+    for (uint32_t pid = 0; pid < cnt; pid++) {
+        auto replicator = std::make_shared<LogReplicator>(1, pid, folder + std::to_string(pid), map, kLeaderNode);
+        if (syncer) {
+            replicator->SetLogSyncer(syncer);
+        }
+        if (!replicator->Init()) {
+            return {};
+        }
+        replicators.push_back(replicator);
+    }
+    return replicators;
+}
+
+bool AppendOne(const std::shared_ptr<LogReplicator>& replicator, uint64_t ts) {
+    ::openmldb::api::LogEntry entry;
+    entry.set_term(1);
+    entry.set_pk("key" + std::to_string(ts % 100));
+    entry.set_value(std::string(128, 'v'));
+    entry.set_ts(ts);
+    return replicator->AppendEntry(entry);
+}
+
+TEST_F(LogSyncerTest, WaitSynced) {
+    auto syncer = std::make_shared<LogSyncer>(1000, true);
+    syncer->Start();
+    auto replicators = CreateReplicators(4, syncer);
+    ASSERT_EQ(4u, replicators.size());
+    for (uint64_t i = 0; i < 10; i++) {
+        for (auto& replicator : replicators) {
+            uint64_t group = syncer->GetSyncedGroup();
+            ASSERT_TRUE(AppendOne(replicator, i));
+            // the append returns after its group is synced
+            ASSERT_GT(syncer->GetSyncedGroup(), group);
+        }
+    }
+    for (auto& replicator : replicators) {
+        ASSERT_EQ(10u, replicator->GetOffset());
+    }
+    ASSERT_GE(syncer->GetSyncedCnt(), 40u);
+    // replicator unregisters itself from syncer
+    replicators.clear();
+    syncer->Stop();
+}
+
+TEST_F(LogSyncerTest, AsyncSync) {
+    auto syncer = std::make_shared<LogSyncer>(10, false);
+    syncer->Start();
+    auto replicators = CreateReplicators(4, syncer);
+    ASSERT_EQ(4u, replicators.size());
+    for (uint64_t i = 0; i < 10; i++) {
+        for (auto& replicator : replicators) {
+            ASSERT_TRUE(AppendOne(replicator, i));
+        }
+    }
+    uint64_t group = syncer->GetSyncedGroup();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_GT(syncer->GetSyncedGroup(), group);
+    // the dirty binlog of a partition is synced once per group
+    ASSERT_GE(syncer->GetSyncedCnt(), 4u);
+    ASSERT_LE(syncer->GetSyncedCnt(), 40u);
+    uint64_t synced_cnt = syncer->GetSyncedCnt();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    // nothing is synced without new appends
+    ASSERT_EQ(synced_cnt, syncer->GetSyncedCnt());
+    syncer->Stop();
+}
+
+// mode 0: per partition writer, sync on timer (the put is not durable)
+// mode 1: per partition writer, sync on every put
+// mode 2: group commit, the put returns after its group is synced
+void RunBenchmark(int mode, uint32_t partition_cnt, uint32_t thread_cnt, uint32_t put_cnt) {
+    std::shared_ptr<LogSyncer> syncer;
+    if (mode == 2) {
+        syncer = std::make_shared<LogSyncer>(1000, true);
+        syncer->Start();
+    }
+    auto replicators = CreateReplicators(partition_cnt, syncer);
+    ASSERT_EQ(partition_cnt, replicators.size());
+    std::vector<std::vector<uint64_t>> latencies(thread_cnt);
+    std::vector<std::thread> threads;
+    uint64_t start = ::baidu::common::timer::get_micros();
+    for (uint32_t t = 0; t < thread_cnt; t++) {
+        threads.emplace_back([&, t] {
+            latencies[t].reserve(put_cnt);
+            for (uint32_t i = 0; i < put_cnt; i++) {
+                auto& replicator = replicators[(t + i * thread_cnt) % partition_cnt];
+                uint64_t begin = ::baidu::common::timer::get_micros();
+                AppendOne(replicator, i);
+                if (mode == 1) {
+                    replicator->SyncToDisk();
+                }
+                latencies[t].push_back(::baidu::common::timer::get_micros() - begin);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    uint64_t consumed = ::baidu::common::timer::get_micros() - start;
+    std::vector<uint64_t> all;
+    for (const auto& latency : latencies) {
+        all.insert(all.end(), latency.begin(), latency.end());
+    }
+    std::sort(all.begin(), all.end());
+    uint64_t total = all.size();
+    std::cout << "mode " << mode << " partition " << partition_cnt << " thread " << thread_cnt << " put " << total
+              << " qps " << total * 1000000 / std::max(consumed, (uint64_t)1) << " p99 "
+              << all[total * 99 / 100] << "us" << std::endl;
+    if (syncer) {
+        syncer->Stop();
+    }
+}
+
+TEST_F(LogSyncerTest, BenchMark) {
+    for (int mode = 0; mode < 3; mode++) {
+        RunBenchmark(mode, 64, 16, 200);
+    }
+}
+
+}  // namespace replica
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    srand(time(NULL));
+    ::testing::InitGoogleTest(&argc, argv);
+    ::openmldb::base::SetLogLevel(INFO);
+    return RUN_ALL_TESTS();
+}
@@ -31,6 +31,7 @@ DECLARE_int32(request_max_retry);
 DECLARE_int32(request_timeout_ms);
 DECLARE_string(zk_cluster);
 DECLARE_uint32(go_back_max_try_cnt);
+DECLARE_bool(binlog_sync_with_attachment);
 
 namespace openmldb {
 namespace replica {
@@ -49,7 +50,8 @@ static void* RunSyncTask(void* args) {
 ReplicateNode::ReplicateNode(const std::string& point, LogParts* logs, const std::string& log_path, uint32_t tid,
                              uint32_t pid, std::atomic<uint64_t>* term, std::atomic<uint64_t>* leader_log_offset,
                              bthread::Mutex* mu, bthread::ConditionVariable* cv, bool rep_follower,
-                             std::atomic<uint64_t>* follower_offset, const std::string& real_point)
+                             std::atomic<uint64_t>* follower_offset, const std::string& real_point,
+                             const std::shared_ptr<LogEntryCache>& entry_cache)
     : log_reader_(logs, log_path, false),
       cache_(),
       endpoint_(point),
@@ -66,7 +68,10 @@ ReplicateNode::ReplicateNode(const std::string& point, LogParts* logs, const std
       cv_(cv),
       go_back_cnt_(0),
       rep_node_(rep_follower),
-      follower_offset_(follower_offset) {
+      follower_offset_(follower_offset),
+      entry_cache_(entry_cache),
+      use_attachment_(FLAGS_binlog_sync_with_attachment),
+      reader_need_reset_(false) {
     if (!real_point.empty()) {
         rpc_client_ = openmldb::RpcClient<::openmldb::api::TabletServer_Stub>(real_point);
     }
@@ -178,6 +183,20 @@ int ReplicateNode::SyncData(uint64_t log_offset) {
         PDLOG(WARNING, "log offset [%lu] le last sync offset [%lu], do nothing", log_offset, last_sync_offset_);
         return 1;
     }
+    if (cache_.empty() && entry_cache_) {
+        int ret = SyncDataFromCache(log_offset);
+        if (ret >= 0) {
+            return ret;
+        }
+    }
+    if (reader_need_reset_) {
+        // the node lags past the entry cache, read the entries from binlog files
+        PDLOG(INFO, "read binlog from offset %lu for node %s. tid %u pid %u", last_sync_offset_, endpoint_.c_str(),
+              tid_, pid_);
+        log_reader_.Reset(last_sync_offset_);
+        reader_need_reset_ = false;
+        go_back_cnt_ = 0;
+    }
     ::openmldb::api::AppendEntriesRequest request;
     ::openmldb::api::AppendEntriesResponse response;
     uint64_t sync_log_offset = last_sync_offset_;
@@ -296,6 +315,60 @@ int ReplicateNode::SyncData(uint64_t log_offset) {
     return 0;
 }
 
+int ReplicateNode::SyncDataFromCache(uint64_t log_offset) {
+    uint32_t batch_size = std::min(log_offset - last_sync_offset_, (uint64_t)FLAGS_binlog_sync_batch_size);
+    butil::IOBuf entries;
+    uint32_t cnt = entry_cache_->Get(last_sync_offset_ + 1, batch_size, &entries);
+    if (cnt == 0) {
+        return -1;
+    }
+    ::openmldb::api::AppendEntriesRequest request;
+    ::openmldb::api::AppendEntriesResponse response;
+    request.set_tid(tid_);
+    request.set_pid(pid_);
+    request.set_pre_log_index(last_sync_offset_);
+    if (!FLAGS_zk_cluster.empty()) {
+        request.set_term(term_->load(std::memory_order_relaxed));
+    }
+    brpc::Controller cntl;
+    cntl.set_timeout_ms(FLAGS_request_timeout_ms);
+    cntl.set_max_retry(FLAGS_request_max_retry);
+    if (use_attachment_) {
+        request.set_attachment_entry_cnt(cnt);
+        cntl.request_attachment().swap(entries);
+    } else {
+        std::string buffer;
+        while (LogEntryCache::DecodeEntry(&entries, &buffer)) {
+            if (!request.add_entries()->ParseFromString(buffer)) {
+                PDLOG(WARNING, "bad protobuf format in entry cache. tid %u pid %u", tid_, pid_);
+                return -1;
+            }
+        }
+    }
+    uint64_t sync_log_offset = last_sync_offset_ + cnt;
+    bool ret = rpc_client_.SendRequest(&::openmldb::api::TabletServer_Stub::AppendEntries, &cntl, &request,
+                                       &response);
+    if (!ret || response.code() != 0) {
+        PDLOG(WARNING, "fail to sync log to node %s. tid %u pid %u", endpoint_.c_str(), tid_, pid_);
+        return 1;
+    }
+    if (use_attachment_ && response.log_offset() < sync_log_offset) {
+        // the node of old version ignores the entries in attachment
+        PDLOG(WARNING, "node %s does not support entries in attachment, fall back to entries. tid %u pid %u",
+              endpoint_.c_str(), tid_, pid_);
+        use_attachment_ = false;
+        return 0;
+    }
+    DEBUGLOG("sync log to node[%s] to offset %lu from entry cache", endpoint_.c_str(), sync_log_offset);
+    last_sync_offset_ = sync_log_offset;
+    if (!rep_node_.load(std::memory_order_relaxed) &&
+        (last_sync_offset_ > follower_offset_->load(std::memory_order_relaxed))) {
+        follower_offset_->store(last_sync_offset_, std::memory_order_relaxed);
+    }
+    reader_need_reset_ = true;
+    return 0;
+}
+
 void ReplicateNode::Stop() {
     is_running_.store(false, std::memory_order_relaxed);
     if (worker_ == 0) {
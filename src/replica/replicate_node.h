@@ -18,6 +18,7 @@
 #define SRC_REPLICA_REPLICATE_NODE_H_
 
 #include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -28,6 +29,7 @@
 #include "log/log_writer.h"
 #include "log/sequential_file.h"
 #include "proto/tablet.pb.h"
+#include "replica/log_entry_cache.h"
 #include "rpc/rpc_client.h"
 
 namespace openmldb {
@@ -41,7 +43,8 @@ class ReplicateNode {
     ReplicateNode(const std::string& point, LogParts* logs, const std::string& log_path, uint32_t tid, uint32_t pid,
                   std::atomic<uint64_t>* term, std::atomic<uint64_t>* leader_log_offset, bthread::Mutex* mu,
                   bthread::ConditionVariable* cv, bool rep_follower, std::atomic<uint64_t>* follower_offset,
-                  const std::string& real_point);
+                  const std::string& real_point,
+                  const std::shared_ptr<LogEntryCache>& entry_cache = std::shared_ptr<LogEntryCache>());
     int Init();
 
     int Start();
@@ -72,6 +75,9 @@ class ReplicateNode {
  private:
     int MatchLogOffsetFromNode();
 
+    // sync the entries in entry cache to node. return -1 if the entries are not in cache
+    int SyncDataFromCache(uint64_t log_offset);
+
  private:
     LogReader log_reader_;
     std::vector<::openmldb::api::AppendEntriesRequest> cache_;
@@ -90,6 +96,11 @@ class ReplicateNode {
     uint32_t go_back_cnt_;
     std::atomic<bool> rep_node_;
     std::atomic<uint64_t>* follower_offset_;  // max local cluster follower offset
+    std::shared_ptr<LogEntryCache> entry_cache_;
+    // the node supports entries in attachment, it is false if the node is an old version
+    bool use_attachment_;
+    // the entries are synced from entry cache, the log reader should seek to last sync offset
+    bool reader_need_reset_;
 };
 
 }  // namespace replica
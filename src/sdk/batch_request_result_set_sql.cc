@@ -342,5 +342,28 @@ bool SQLBatchRequestResultSet::GetTime(uint32_t index, int64_t* mills) {
     return ret == 0;
 }
 
+bool MergedSQLBatchRequestResultSet::Reset() {
+    index_ = -1;
+    cur_ = nullptr;
+    for (auto& part : parts_) {
+        part->Reset();
+    }
+    return true;
+}
+
+bool MergedSQLBatchRequestResultSet::Next() {
+    index_++;
+    if (index_ >= static_cast<int32_t>(row_parts_.size())) {
+        return false;
+    }
+    uint32_t part = row_parts_[index_];
+    if (part >= parts_.size() || !parts_[part]->Next()) {
+        LOG(WARNING) << "no result row of sub batch " << part << " for row " << index_;
+        return false;
+    }
+    cur_ = parts_[part].get();
+    return true;
+}
+
 }  // namespace sdk
 }  // namespace openmldb
@@ -100,6 +100,57 @@ class SQLBatchRequestResultSet : public ::hybridse::sdk::ResultSet {
     std::shared_ptr<brpc::Controller> cntl_;
 };
 
+// MergedSQLBatchRequestResultSet merges the result sets of sub batches split from one batch, the rows are
+// returned in the order of the original batch. `row_parts[i]` is the index of the sub batch the i-th row was
+// sent with, and the rows of each sub batch keep their relative order.
+class MergedSQLBatchRequestResultSet : public ::hybridse::sdk::ResultSet {
+ public:
+    MergedSQLBatchRequestResultSet(const std::vector<std::shared_ptr<SQLBatchRequestResultSet>>& parts,
+                                   const std::vector<uint32_t>& row_parts)
+        : parts_(parts), row_parts_(row_parts), index_(-1) {}
+    ~MergedSQLBatchRequestResultSet() {}
+
+    bool Reset();
+
+    bool Next();
+
+    bool IsNULL(int index) { return cur_->IsNULL(index); }
+
+    bool GetString(uint32_t index, std::string* str) { return cur_->GetString(index, str); }
+
+    bool GetBool(uint32_t index, bool* result) { return cur_->GetBool(index, result); }
+
+    bool GetChar(uint32_t index, char* result) { return cur_->GetChar(index, result); }
+
+    bool GetInt16(uint32_t index, int16_t* result) { return cur_->GetInt16(index, result); }
+
+    bool GetInt32(uint32_t index, int32_t* result) { return cur_->GetInt32(index, result); }
+
+    bool GetInt64(uint32_t index, int64_t* result) { return cur_->GetInt64(index, result); }
+
+    bool GetFloat(uint32_t index, float* result) { return cur_->GetFloat(index, result); }
+
+    bool GetDouble(uint32_t index, double* result) { return cur_->GetDouble(index, result); }
+
+    bool GetDate(uint32_t index, int32_t* date) { return cur_->GetDate(index, date); }
+
+    bool GetDate(uint32_t index, int32_t* year, int32_t* month, int32_t* day) {
+        return cur_->GetDate(index, year, month, day);
+    }
+
+    bool GetTime(uint32_t index, int64_t* mills) { return cur_->GetTime(index, mills); }
+
+    const ::hybridse::sdk::Schema* GetSchema() { return parts_.front()->GetSchema(); }
+
+    int32_t Size() { return row_parts_.size(); }
+
+ private:
+    std::vector<std::shared_ptr<SQLBatchRequestResultSet>> parts_;
+    std::vector<uint32_t> row_parts_;
+    int32_t index_;
+    SQLBatchRequestResultSet* cur_ = nullptr;
+};
+
 }  // namespace sdk
 }  // namespace openmldb
 #endif  // SRC_SDK_BATCH_REQUEST_RESULT_SET_SQL_H_
@@ -371,6 +371,7 @@ bool ClusterSDK::UpdateCatalog(const std::vector<std::string>& table_datas, cons
         std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
         table_to_tablets_ = mapping;
         catalog_ = new_catalog;
+        cluster_version_.fetch_add(1, std::memory_order_release);
     }
     engine_->UpdateCatalog(new_catalog);
     return true;
@@ -689,6 +690,7 @@ bool StandAloneSDK::BuildCatalog() {
         std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
         table_to_tablets_ = mapping;
         catalog_ = new_catalog;
+        cluster_version_.fetch_add(1, std::memory_order_release);
     }
     engine_->UpdateCatalog(new_catalog);
     return true;
@@ -65,7 +65,8 @@ class DBSDK {
 
     bool Refresh() { return BuildCatalog(); }
 
-    inline uint64_t GetClusterVersion() { return cluster_version_.load(std::memory_order_relaxed); }
+    // the version is increased every time the catalog is rebuilt
+    inline uint64_t GetClusterVersion() { return cluster_version_.load(std::memory_order_acquire); }
 
     inline std::shared_ptr<::openmldb::catalog::SDKCatalog> GetCatalog() {
         std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
@@ -165,17 +165,20 @@ class ReadFileOptionsParser : public FileOptionsParser {
         check_map_.emplace("load_mode", std::make_pair(CheckLoadMode(), hybridse::node::kVarchar));
         check_map_.emplace("thread", std::make_pair(CheckThread(), hybridse::node::kInt32));
         check_map_.emplace("deep_copy", std::make_pair(CheckDeepCopy(), hybridse::node::kBool));
+        check_map_.emplace("batch_size", std::make_pair(CheckBatchSize(), hybridse::node::kInt32));
     }
 
     const std::string& GetLoadMode() const { return load_mode_; }
     int GetThread() const { return thread_; }
     void SetThread(int thread) { thread_ = thread; }
     bool GetDeepCopy() const { return deep_copy_; }
+    int GetBatchSize() const { return batch_size_; }
 
  private:
     std::string load_mode_ = "cluster";
     int thread_ = 1;
     bool deep_copy_ = true;
+    int batch_size_ = 1000;
 
     std::function<bool(const hybridse::node::ConstNode* node)> CheckLoadMode() {
         return [this](const hybridse::node::ConstNode* node) {
@@ -204,6 +207,16 @@ class ReadFileOptionsParser : public FileOptionsParser {
             return true;
         };
     }
+
+    std::function<bool(const hybridse::node::ConstNode* node)> CheckBatchSize() {
+        return [this](const hybridse::node::ConstNode* node) {
+            batch_size_ = node->GetAsInt32();
+            if (batch_size_ <= 0) {
+                return false;
+            }
+            return true;
+        };
+    }
 };
 
 class WriteFileOptionsParser : public FileOptionsParser {
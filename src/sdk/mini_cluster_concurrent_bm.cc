@@ -0,0 +1,150 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// the benchmarks of many threads sharing one sql router, most of the time is spent in the rpc and the engine, so
+// the contention on the router, e.g. the sql cache, shows up when the threads increase
+
+#include <gflags/gflags.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "sdk/mini_cluster.h"
+#include "sdk/sql_router.h"
+
+DECLARE_bool(enable_distsql);
+DECLARE_bool(enable_localtablet);
+
+namespace {
+
+const char* DB = "concurrent_bm_db";
+const char* SP_NAME = "concurrent_bm_sp";
+const int KEY_NUM = 100;
+std::shared_ptr<::openmldb::sdk::SQLRouter> router;
+
+bool Prepare() {
+    ::hybridse::sdk::Status status;
+    router->ExecuteSQL("SET @@execute_mode='online';", &status);
+    if (!router->CreateDB(DB, &status)) {
+        return false;
+    }
+    std::string ddl = "create table t1(c1 string, c2 int, c3 bigint, c4 double, index(key=c1, ts=c3));";
+    if (!router->ExecuteDDL(DB, ddl, &status) || !router->RefreshCatalog()) {
+        return false;
+    }
+    for (int i = 0; i < KEY_NUM; i++) {
+        for (int j = 0; j < 10; j++) {
+            std::string insert = "insert into t1 values('key" + std::to_string(i) + "', " + std::to_string(j) +
+                                 ", " + std::to_string(1000 + j) + ", 1.0);";
+            if (!router->ExecuteInsert(DB, insert, &status)) {
+                return false;
+            }
+        }
+    }
+    std::string deploy = std::string("deploy ") + SP_NAME +
+                         " select c1, sum(c2) over w1 as w1_sum, max(c4) over w1 as w1_max from t1"
+                         " window w1 as (partition by c1 order by c3 rows_range between 1h preceding and current row);";
+    router->ExecuteSQL(DB, deploy, &status);
+    return status.IsOK() && router->RefreshCatalog();
+}
+
+void BM_ExecuteSQL(benchmark::State& state) {  // NOLINT
+    ::hybridse::sdk::Status status;
+    std::string sql = "select c1, c2, c3 from t1;";
+    for (auto _ : state) {
+        auto rs = router->ExecuteSQL(DB, sql, &status);
+        if (!rs) {
+            state.SkipWithError(status.msg.c_str());
+            break;
+        }
+        benchmark::DoNotOptimize(rs);
+    }
+}
+
+// only make the request row, it reads the cached router and schema of the deployment
+void BM_GetRequestRow(benchmark::State& state) {  // NOLINT
+    ::hybridse::sdk::Status status;
+    for (auto _ : state) {
+        auto row = router->GetRequestRowByProcedure(DB, SP_NAME, &status);
+        if (!row) {
+            state.SkipWithError(status.msg.c_str());
+            break;
+        }
+        benchmark::DoNotOptimize(row);
+    }
+}
+
+void BM_CallProcedure(benchmark::State& state) {  // NOLINT
+    static std::atomic<int> thread_seq{0};
+    ::hybridse::sdk::Status status;
+    // every thread starts from a different key
+    int i = thread_seq.fetch_add(1, std::memory_order_relaxed);
+    for (auto _ : state) {
+        auto row = router->GetRequestRowByProcedure(DB, SP_NAME, &status);
+        if (!row) {
+            state.SkipWithError(status.msg.c_str());
+            break;
+        }
+        std::string key = "key" + std::to_string(i++ % KEY_NUM);
+        row->Init(key.size());
+        row->AppendString(key);
+        row->AppendInt32(1);
+        row->AppendInt64(2000);
+        row->AppendDouble(2.0);
+        row->Build();
+        auto rs = router->CallProcedure(DB, SP_NAME, row, &status);
+        if (!rs) {
+            state.SkipWithError(status.msg.c_str());
+            break;
+        }
+        benchmark::DoNotOptimize(rs);
+    }
+}
+
+}  // namespace
+
+BENCHMARK(BM_ExecuteSQL)->ThreadRange(1, 64)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_GetRequestRow)->ThreadRange(1, 64)->UseRealTime()->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_CallProcedure)->ThreadRange(1, 64)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+int main(int argc, char** argv) {
+    ::google::ParseCommandLineFlags(&argc, &argv, true);
+    ::openmldb::base::SetupGlog(true);
+    ::hybridse::vm::Engine::InitializeGlobalLLVM();
+    FLAGS_enable_distsql = true;
+    FLAGS_enable_localtablet = false;
+    ::benchmark::Initialize(&argc, argv);
+    if (::benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+    ::openmldb::sdk::MiniCluster mini_cluster(6181);
+    if (!mini_cluster.SetUp()) {
+        return 1;
+    }
+    sleep(2);
+    ::openmldb::sdk::SQLRouterOptions sql_opt;
+    sql_opt.zk_cluster = mini_cluster.GetZkCluster();
+    sql_opt.zk_path = mini_cluster.GetZkPath();
+    router = ::openmldb::sdk::NewClusterSQLRouter(sql_opt);
+    if (!router || !Prepare()) {
+        LOG(WARNING) << "fail to prepare the benchmark";
+        mini_cluster.Close();
+        return 1;
+    }
+    ::benchmark::RunSpecifiedBenchmarks();
+    router.reset();
+    mini_cluster.Close();
+}
@@ -46,6 +46,8 @@ bool NodeAdapter::TransformToTableDef(::hybridse::node::CreatePlanNode* create_n
     hybridse::node::NodePointVector distribution_list;
 
     hybridse::node::StorageMode storage_mode = hybridse::node::kMemory;
+    hybridse::node::DiskRowLayout disk_row_layout = hybridse::node::kRowPerIndex;
+    hybridse::node::CompressType compress_type = hybridse::node::kNoCompress;
     // different default value for cluster and standalone mode
     int replica_num = 1;
     int partition_num = 1;
@@ -74,6 +76,15 @@ bool NodeAdapter::TransformToTableDef(::hybridse::node::CreatePlanNode* create_n
                     storage_mode = dynamic_cast<hybridse::node::StorageModeNode *>(table_option)->GetStorageMode();
                     break;
                 }
+                case hybridse::node::kDiskRowLayout: {
+                    disk_row_layout = dynamic_cast<hybridse::node::DiskRowLayoutNode *>(table_option)->GetLayout();
+                    break;
+                }
+                case hybridse::node::kCompressType: {
+                    compress_type =
+                        dynamic_cast<hybridse::node::CompressTypeNode *>(table_option)->GetCompressType();
+                    break;
+                }
                 case hybridse::node::kDistributions: {
                     distribution_list =
                         dynamic_cast<hybridse::node::DistributionsNode*>(table_option)->GetDistributionList();
@@ -109,7 +120,17 @@ bool NodeAdapter::TransformToTableDef(::hybridse::node::CreatePlanNode* create_n
     }
     table->set_replica_num(replica_num);
     table->set_partition_num(partition_num);
+    if (disk_row_layout != hybridse::node::kRowPerIndex && storage_mode == hybridse::node::kMemory) {
+        *status = {hybridse::common::kUnsupportSql, "disk_row_layout only works with ssd or hdd storage_mode"};
+        return false;
+    }
     table->set_storage_mode(static_cast<common::StorageMode>(storage_mode));
+    table->set_disk_row_layout(static_cast<common::DiskRowLayout>(disk_row_layout));
+    if (compress_type == hybridse::node::kDictionary && storage_mode != hybridse::node::kMemory) {
+        *status = {hybridse::common::kUnsupportSql, "compress_type dictionary only works with memory storage_mode"};
+        return false;
+    }
+    table->set_compress_type(static_cast<type::CompressType>(compress_type));
     bool has_generate_index = false;
     std::set<std::string> index_names;
     std::map<std::string, ::openmldb::common::ColumnDesc*> column_names;
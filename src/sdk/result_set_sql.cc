@@ -85,6 +85,82 @@ std::shared_ptr<::hybridse::sdk::ResultSet> ResultSetSQL::MakeResultSet(
     return rs;
 }
 
+StreamResultSetSQL::StreamResultSetSQL(const ::hybridse::vm::Schema& schema, const std::shared_ptr<ResultSetSQL>& rs,
+                                       uint32_t record_cnt, uint64_t query_id,
+                                       const std::shared_ptr<::openmldb::client::TabletClient>& client,
+                                       uint64_t timeout_ms)
+    : schema_(schema),
+      rs_(rs),
+      record_cnt_(record_cnt),
+      query_id_(query_id),
+      is_finish_(false),
+      page_idx_(0),
+      client_(client),
+      timeout_ms_(timeout_ms) {}
+
+std::shared_ptr<::hybridse::sdk::ResultSet> StreamResultSetSQL::MakeResultSet(
+    const std::shared_ptr<::openmldb::api::QueryResponse>& response, const std::shared_ptr<brpc::Controller>& cntl,
+    const std::shared_ptr<::openmldb::client::TabletClient>& client, uint64_t timeout_ms,
+    ::hybridse::sdk::Status* status) {
+    if (!status || !response || !cntl || !client) {
+        return {};
+    }
+    ::hybridse::vm::Schema schema;
+    bool ok = ::hybridse::codec::SchemaCodec::Decode(response->schema(), &schema);
+    if (!ok) {
+        *status = {::hybridse::common::StatusCode::kCmdError, "request error, fail to decodec schema"};
+        return {};
+    }
+    auto rs = std::make_shared<openmldb::sdk::ResultSetSQL>(schema, response->count(), response->byte_size(), cntl);
+    if (!rs->Init()) {
+        *status = {::hybridse::common::StatusCode::kCmdError, "request error, ResultSetSQL init failed"};
+        return {};
+    }
+    return std::make_shared<StreamResultSetSQL>(schema, rs, response->count(), response->query_id(), client,
+                                                timeout_ms);
+}
+
+bool StreamResultSetSQL::Reset() {
+    if (page_idx_ != 0) {
+        LOG(WARNING) << "fail to reset stream result set, the first page has been dropped";
+        return false;
+    }
+    return rs_->Reset();
+}
+
+bool StreamResultSetSQL::Next() {
+    while (!rs_->Next()) {
+        if (is_finish_ || !FetchNextPage()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool StreamResultSetSQL::FetchNextPage() {
+    auto cntl = std::make_shared<::brpc::Controller>();
+    cntl->set_timeout_ms(timeout_ms_);
+    auto response = std::make_shared<::openmldb::api::QueryResponse>();
+    // the result set is finished if the page is failed to fetch, it is unable to retry since
+    // the cursor on tablet may be moved
+    is_finish_ = true;
+    if (!client_->QueryNext(query_id_, cntl.get(), response.get())) {
+        LOG(WARNING) << "fail to fetch page " << page_idx_ + 1 << " of query " << query_id_ << ": "
+                     << (cntl->Failed() ? cntl->ErrorText() : response->msg());
+        return false;
+    }
+    auto rs = std::make_shared<ResultSetSQL>(schema_, response->count(), response->byte_size(), cntl);
+    if (!rs->Init()) {
+        LOG(WARNING) << "fail to init page " << page_idx_ + 1 << " of query " << query_id_;
+        return false;
+    }
+    rs_ = rs;
+    record_cnt_ += response->count();
+    is_finish_ = response->is_finish();
+    page_idx_++;
+    return true;
+}
+
 std::shared_ptr<::hybridse::sdk::ResultSet> ResultSetSQL::MakeResultSet(
     const std::shared_ptr<::openmldb::api::ScanResponse>& response,
     const ::google::protobuf::RepeatedField<uint32_t>& projection, const std::shared_ptr<brpc::Controller>& cntl,
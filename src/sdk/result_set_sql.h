@@ -23,6 +23,7 @@
 
 #include "brpc/controller.h"
 #include "butil/iobuf.h"
+#include "client/tablet_client.h"
 #include "schema/index_util.h"
 #include "proto/tablet.pb.h"
 #include "sdk/base_impl.h"
@@ -105,6 +106,74 @@ class ResultSetSQL : public ::hybridse::sdk::ResultSet {
     std::shared_ptr<butil::IOBuf> io_buf_;
 };
 
+// StreamResultSetSQL iterates the result of a streaming batch query. Only one page of
+// rows is kept in memory, the next page is fetched from tablet when the current one
+// is consumed. Size() returns the count of rows fetched so far, it is the total count
+// only after Next() returns false, so the callers should iterate the rows instead of
+// taking Size() as the total. As every page has one row at least, Size() is 0 only if
+// the result is empty.
+class StreamResultSetSQL : public ::hybridse::sdk::ResultSet {
+ public:
+    StreamResultSetSQL(const ::hybridse::vm::Schema& schema, const std::shared_ptr<ResultSetSQL>& rs,
+                       uint32_t record_cnt, uint64_t query_id,
+                       const std::shared_ptr<::openmldb::client::TabletClient>& client, uint64_t timeout_ms);
+
+    ~StreamResultSetSQL() {}
+
+    static std::shared_ptr<::hybridse::sdk::ResultSet> MakeResultSet(
+        const std::shared_ptr<::openmldb::api::QueryResponse>& response, const std::shared_ptr<brpc::Controller>& cntl,
+        const std::shared_ptr<::openmldb::client::TabletClient>& client, uint64_t timeout_ms,
+        ::hybridse::sdk::Status* status);
+
+    // it is unable to reset after the first page is dropped
+    bool Reset() override;
+
+    bool Next() override;
+
+    bool IsNULL(int index) override { return rs_->IsNULL(index); }
+
+    bool GetString(uint32_t index, std::string* str) override { return rs_->GetString(index, str); }
+
+    bool GetBool(uint32_t index, bool* result) override { return rs_->GetBool(index, result); }
+
+    bool GetChar(uint32_t index, char* result) override { return rs_->GetChar(index, result); }
+
+    bool GetInt16(uint32_t index, int16_t* result) override { return rs_->GetInt16(index, result); }
+
+    bool GetInt32(uint32_t index, int32_t* result) override { return rs_->GetInt32(index, result); }
+
+    bool GetInt64(uint32_t index, int64_t* result) override { return rs_->GetInt64(index, result); }
+
+    bool GetFloat(uint32_t index, float* result) override { return rs_->GetFloat(index, result); }
+
+    bool GetDouble(uint32_t index, double* result) override { return rs_->GetDouble(index, result); }
+
+    bool GetDate(uint32_t index, int32_t* date) override { return rs_->GetDate(index, date); }
+
+    bool GetDate(uint32_t index, int32_t* year, int32_t* month, int32_t* day) override {
+        return rs_->GetDate(index, year, month, day);
+    }
+
+    bool GetTime(uint32_t index, int64_t* mills) override { return rs_->GetTime(index, mills); }
+
+    const ::hybridse::sdk::Schema* GetSchema() override { return rs_->GetSchema(); }
+
+    int32_t Size() override { return static_cast<int32_t>(record_cnt_); }
+
+ private:
+    bool FetchNextPage();
+
+ private:
+    ::hybridse::vm::Schema schema_;
+    std::shared_ptr<ResultSetSQL> rs_;
+    uint64_t record_cnt_;
+    uint64_t query_id_;
+    bool is_finish_;
+    uint32_t page_idx_;
+    std::shared_ptr<::openmldb::client::TabletClient> client_;
+    uint64_t timeout_ms_;
+};
+
 class MultipleResultSetSQL : public ::hybridse::sdk::ResultSet {
  public:
     explicit MultipleResultSetSQL(const std::vector<std::shared_ptr<ResultSetSQL>>& result_set_list,
@@ -17,6 +17,8 @@
 #ifndef SRC_SDK_SQL_CACHE_H_
 #define SRC_SDK_SQL_CACHE_H_
 
+#include <atomic>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
@@ -42,10 +44,15 @@ class SQLCache {
     const std::string& GetTableName() const { return table_name_; }
     const std::string& GetDatabase() const { return db_; }
 
+    // the version of catalog the tid was checked with
+    bool IsCheckedAt(uint64_t version) const { return checked_version_.load(std::memory_order_relaxed) == version; }
+    void SetCheckedVersion(uint64_t version) { checked_version_.store(version, std::memory_order_relaxed); }
+
  private:
     const std::string db_;
     uint32_t tid_;
     const std::string table_name_;
+    std::atomic<uint64_t> checked_version_{UINT64_MAX};
 };
 
 class InsertSQLCache : public SQLCache {
@@ -17,6 +17,7 @@
 #include "sdk/sql_cluster_router.h"
 
 #include <algorithm>
+#include <chrono>  // NOLINT
 #include <fstream>
 #include <future>
 #include <memory>
@@ -26,11 +27,13 @@
 
 #include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/strip.h"
 #include "absl/strings/substitute.h"
 #include "base/ddl_parser.h"
 #include "base/file_util.h"
 #include "base/glog_wrapper.h"
+#include "base/line_reader.h"
 #include "base/status_util.h"
 #include "boost/none.hpp"
 #include "boost/property_tree/ini_parser.hpp"
@@ -64,6 +67,11 @@ namespace sdk {
 using hybridse::common::StatusCode;
 using hybridse::plan::PlanAPI;
 
+// the interval in second to log the progress of load data
+static constexpr uint32_t kLoadDataProgressInterval = 10;
+// the first line of file is read with a small buffer to check the schema
+static constexpr uint32_t kLoadDataHeaderBlockSize = 64 * 1024;
+
 class ExplainInfoImpl : public ExplainInfo {
  public:
     ExplainInfoImpl(const ::hybridse::sdk::SchemaImpl& input_schema, const ::hybridse::sdk::SchemaImpl& output_schema,
@@ -200,6 +208,7 @@ SQLClusterRouter::SQLClusterRouter(const SQLRouterOptions& options)
       is_cluster_mode_(true),
       interactive_(false),
       cluster_sdk_(nullptr),
+      input_cache_(GetSqlCacheShardCapacity(options.max_sql_cache_size), SQL_CACHE_SHARD_NUM),
       mu_(),
       rand_(::baidu::common::timer::now_time()) {}
 
@@ -208,6 +217,7 @@ SQLClusterRouter::SQLClusterRouter(const StandaloneOptions& options)
       is_cluster_mode_(false),
       interactive_(false),
       cluster_sdk_(nullptr),
+      input_cache_(GetSqlCacheShardCapacity(options.max_sql_cache_size), SQL_CACHE_SHARD_NUM),
       mu_(),
       rand_(::baidu::common::timer::now_time()) {}
 
@@ -216,6 +226,7 @@ SQLClusterRouter::SQLClusterRouter(DBSDK* sdk)
       is_cluster_mode_(sdk->IsClusterMode()),
       interactive_(false),
       cluster_sdk_(sdk),
+      input_cache_(GetSqlCacheShardCapacity(BasicRouterOptions().max_sql_cache_size), SQL_CACHE_SHARD_NUM),
       mu_(),
       rand_(::baidu::common::timer::now_time()) {
     if (is_cluster_mode_) {
@@ -712,56 +723,44 @@ DefaultValueMap SQLClusterRouter::GetDefaultMap(const std::shared_ptr<::openmldb
     return default_map;
 }
 // Get Cache with given db, sql and engine mode
+static std::string SQLCacheKey(const std::string& db, const std::string& sql,
+                               const hybridse::vm::EngineMode engine_mode) {
+    std::string key;
+    key.reserve(db.size() + sql.size() + 2);
+    key.append(db).push_back('\0');
+    key.push_back(static_cast<char>(engine_mode));
+    key.append(sql);
+    return key;
+}
+
 std::shared_ptr<SQLCache> SQLClusterRouter::GetCache(const std::string& db, const std::string& sql,
                                                      const hybridse::vm::EngineMode engine_mode) {
-    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
-    auto mode_cache_it = input_lru_cache_.find(db);
-    if (mode_cache_it == input_lru_cache_.end()) {
+    std::shared_ptr<SQLCache> cached_info;
+    if (!input_cache_.Get(SQLCacheKey(db, sql, engine_mode), &cached_info) || !cached_info) {
         return {};
     }
-
-    auto it = mode_cache_it->second.find(engine_mode);
-    if (it != mode_cache_it->second.end()) {
-        auto value = it->second.get(sql);
-        if (value != boost::none) {
-            // Check cache validation, the name is the same, but the tid may be different.
-            // Notice that we won't check it when table_info is disabled and router is enabled.
-            //  invalid router info doesn't have tid, so it won't get confused.
-            auto cached_info = value.value();
-            if (cached_info) {
-                if (!cached_info->GetTableName().empty()) {
-                    auto current_info =
-                        cluster_sdk_->GetTableInfo(cached_info->GetDatabase(), cached_info->GetTableName());
-                    if (!current_info || cached_info->GetTableId() != current_info->tid()) {
-                        // just leave, this invalid value will be updated by SetCache()
-                        return {};
-                    }
-                }
-                return cached_info;
+    // Check cache validation, the name is the same, but the tid may be different.
+    // Notice that we won't check it when table_info is disabled and router is enabled.
+    //  invalid router info doesn't have tid, so it won't get confused.
+    // The tid is checked once for every version of catalog.
+    if (!cached_info->GetTableName().empty()) {
+        uint64_t version = cluster_sdk_->GetClusterVersion();
+        if (!cached_info->IsCheckedAt(version)) {
+            auto current_info = cluster_sdk_->GetTableInfo(cached_info->GetDatabase(), cached_info->GetTableName());
+            if (!current_info || cached_info->GetTableId() != current_info->tid()) {
+                // just leave, this invalid value will be updated by SetCache()
+                return {};
             }
+            cached_info->SetCheckedVersion(version);
         }
     }
-    return {};
+    return cached_info;
 }
 
 void SQLClusterRouter::SetCache(const std::string& db, const std::string& sql,
                                 const hybridse::vm::EngineMode engine_mode,
                                 const std::shared_ptr<SQLCache>& router_cache) {
-    std::lock_guard<::openmldb::base::SpinMutex> lock(mu_);
-    auto it = input_lru_cache_.find(db);
-    if (it == input_lru_cache_.end()) {
-        decltype(input_lru_cache_)::mapped_type db_value;
-        input_lru_cache_.insert(std::make_pair(db, db_value));
-        it = input_lru_cache_.find(db);
-    }
-
-    auto cache_it = it->second.find(engine_mode);
-    if (cache_it == it->second.end()) {
-        decltype(it->second)::mapped_type value(options_->max_sql_cache_size);
-        auto pair = it->second.emplace(engine_mode, value);
-        cache_it = pair.first;
-    }
-    cache_it->second.upsert(sql, router_cache);
+    input_cache_.Upsert(SQLCacheKey(db, sql, engine_mode), router_cache);
 }
 
 std::shared_ptr<SQLInsertRows> SQLClusterRouter::GetInsertRows(const std::string& db, const std::string& sql,
@@ -919,11 +918,6 @@ bool SQLClusterRouter::DropTable(const std::string& db, const std::string& table
                          meta_db, ".", meta_table, " where aggr_table = '", tableInfo.name(), "';");
         auto rs = ExecuteSQL("", select_aggr_info, true, true, 0, status);
         WARN_NOT_OK_AND_RET(status, "get aggr info failed", false);
-        if (rs->Size() != 1) {
-            SET_STATUS_AND_WARN(status, StatusCode::kCmdError,
-                                "duplicate records generate with aggr table name: " + tableInfo.name());
-            return false;
-        }
         std::string idx_key;
         if (rs->Next()) {
             for (int i = 0; i < rs->GetSchema()->GetColumnCnt(); i++) {
@@ -941,6 +935,12 @@ bool SQLClusterRouter::DropTable(const std::string& db, const std::string& table
             SET_STATUS_AND_WARN(status, StatusCode::kCmdError, "access ResultSet failed");
             return false;
         }
+        // Size() of a streaming result set is the count of rows fetched so far, check the rows by iterating
+        if (rs->Next()) {
+            SET_STATUS_AND_WARN(status, StatusCode::kCmdError,
+                                "duplicate records generate with aggr table name: " + tableInfo.name());
+            return false;
+        }
         auto tablet_accessor = cluster_sdk_->GetTablet(meta_db, meta_table, (uint32_t)0);
         if (!tablet_accessor) {
             SET_STATUS_AND_WARN(status, StatusCode::kCmdError, "get tablet accessor failed");
@@ -1239,6 +1239,10 @@ std::shared_ptr<::hybridse::sdk::ResultSet> SQLClusterRouter::ExecuteSQLParamete
         RPC_STATUS_AND_WARN(status, cntl, response, "Query rpc failed");
         return {};
     }
+    if (!response->is_finish()) {
+        // the rows are too many to return in one response, fetch the rest on demand
+        return StreamResultSetSQL::MakeResultSet(response, cntl, client, options_->request_timeout, status);
+    }
     return ResultSetSQL::MakeResultSet(response, cntl, status);
 }
 
@@ -1357,6 +1361,81 @@ bool SQLClusterRouter::PutRow(uint32_t tid, const std::shared_ptr<SQLInsertRow>&
     return true;
 }
 
+bool SQLClusterRouter::PutRows(uint32_t tid, const std::shared_ptr<SQLInsertRows>& rows,
+                               const std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>>& tablets,
+                               ::hybridse::sdk::Status* status) {
+    RET_FALSE_IF_NULL_AND_WARN(status, "output status is nullptr");
+    uint64_t cur_ts = ::baidu::common::timer::get_micros() / 1000;
+    std::map<uint32_t, ::openmldb::api::PutBatchRequest> requests;
+    for (uint32_t i = 0; i < rows->GetCnt(); ++i) {
+        std::shared_ptr<SQLInsertRow> row = rows->GetRow(i);
+        for (const auto& kv : row->GetDimensions()) {
+            auto& request = requests[kv.first];
+            auto batch_row = request.add_rows();
+            batch_row->set_time(cur_ts);
+            batch_row->set_value(row->GetRow());
+            for (const auto& dim : kv.second) {
+                auto dimension = batch_row->add_dimensions();
+                dimension->set_key(dim.first);
+                dimension->set_idx(dim.second);
+            }
+        }
+    }
+    bool ok = true;
+    std::vector<std::pair<uint32_t, openmldb::RpcCallback<openmldb::api::PutBatchResponse>*>> callbacks;
+    for (auto& kv : requests) {
+        uint32_t pid = kv.first;
+        std::shared_ptr<::openmldb::client::TabletClient> client;
+        if (pid < tablets.size() && tablets[pid]) {
+            client = tablets[pid]->GetClient();
+        }
+        if (!client) {
+            SET_STATUS_AND_WARN(status, StatusCode::kCmdError, "fail to get tablet client. pid " + std::to_string(pid));
+            ok = false;
+            break;
+        }
+        kv.second.set_tid(tid);
+        kv.second.set_pid(pid);
+        DLOG(INFO) << "put batch to endpoint " << client->GetEndpoint() << " pid " << pid << " with rows size "
+                   << kv.second.rows_size();
+        auto response = std::make_shared<openmldb::api::PutBatchResponse>();
+        auto cntl = std::make_shared<brpc::Controller>();
+        cntl->set_timeout_ms(options_->request_timeout);
+        auto callback = new openmldb::RpcCallback<openmldb::api::PutBatchResponse>(response, cntl);
+        // hold the callback until the rpc is joined
+        callback->Ref();
+        callbacks.emplace_back(pid, callback);
+        if (!client->AsyncPutBatch(kv.second, callback)) {
+            // the rpc is not sent, so the closure will never run
+            callback->UnRef();
+            SET_STATUS_AND_WARN(status, StatusCode::kCmdError,
+                                "fail to send put batch request. pid " + std::to_string(pid));
+            ok = false;
+            break;
+        }
+    }
+    for (auto& kv : callbacks) {
+        auto callback = kv.second;
+        brpc::Join(callback->GetController()->call_id());
+        if (ok) {
+            if (callback->GetController()->Failed()) {
+                SET_STATUS_AND_WARN(status, StatusCode::kCmdError,
+                                    "fail to make a put batch request to table. tid " + std::to_string(tid) +
+                                        " pid " + std::to_string(kv.first) + ", " +
+                                        callback->GetController()->ErrorText());
+                ok = false;
+            } else if (callback->GetResponse()->code() != ::openmldb::base::kOk) {
+                SET_STATUS_AND_WARN(status, StatusCode::kCmdError,
+                                    "fail to put batch to table. tid " + std::to_string(tid) + " pid " +
+                                        std::to_string(kv.first) + ", " + callback->GetResponse()->msg());
+                ok = false;
+            }
+        }
+        callback->UnRef();
+    }
+    return ok;
+}
+
 bool SQLClusterRouter::ExecuteInsert(const std::string& db, const std::string& sql, std::shared_ptr<SQLInsertRows> rows,
                                      hybridse::sdk::Status* status) {
     RET_FALSE_IF_NULL_AND_WARN(status, "output status is nullptr");
@@ -1372,13 +1451,7 @@ bool SQLClusterRouter::ExecuteInsert(const std::string& db, const std::string& s
             status->msg = "fail to get table " + cache->GetTableName() + " tablet";
             return false;
         }
-        for (uint32_t i = 0; i < rows->GetCnt(); ++i) {
-            std::shared_ptr<SQLInsertRow> row = rows->GetRow(i);
-            if (!PutRow(cache->GetTableId(), row, tablets, status)) {
-                return false;
-            }
-        }
-        return true;
+        return PutRows(cache->GetTableId(), rows, tablets, status);
     } else {
         status->msg = "please use getInsertRow with " + sql + " first";
         return false;
@@ -1482,6 +1555,12 @@ std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::CallSQLBatchRequestP
     if (!tablet) {
         return nullptr;
     }
+    if (options_->enable_batch_request_fan_out && row_batch->Size() > 1) {
+        auto rs = FanOutSQLBatchRequestProcedure(db, sp_name, row_batch, tablet, status);
+        if (rs || !status->IsOK()) {
+            return rs;
+        }
+    }
 
     auto cntl = std::make_shared<::brpc::Controller>();
     auto response = std::make_shared<::openmldb::api::SQLBatchRequestQueryResponse>();
@@ -1499,6 +1578,110 @@ std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::CallSQLBatchRequestP
     return rs;
 }
 
+std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::FanOutSQLBatchRequestProcedure(
+    const std::string& db, const std::string& sp_name, const std::shared_ptr<SQLRequestRowBatch>& row_batch,
+    const std::shared_ptr<openmldb::client::TabletClient>& default_tablet, hybridse::sdk::Status* status) {
+    std::shared_ptr<hybridse::sdk::ProcedureInfo> sp_info = cluster_sdk_->GetProcedureInfo(db, sp_name, &status->msg);
+    if (!sp_info) {
+        CODE_PREPEND_AND_WARN(status, StatusCode::kProcedureNotFound, db + "-" + sp_name);
+        return {};
+    }
+    // the router is cached when the request row is made by GetRequestRowByProcedure
+    auto router_cache =
+        std::dynamic_pointer_cast<RouterSQLCache>(GetCache(db, sp_info->GetSql(), hybridse::vm::kRequestMode));
+    if (!router_cache) {
+        return {};
+    }
+    const auto& router = router_cache->GetRouter();
+    const std::string& col = router.GetRouterCol();
+    const std::string& main_table = router.GetMainTable();
+    const std::string main_db = router.GetMainDb().empty() ? db : router.GetMainDb();
+    if (col.empty() || main_table.empty()) {
+        return {};
+    }
+    // group the rows by the tablet owning the key, the rows without key go to the default tablet
+    std::vector<std::shared_ptr<openmldb::client::TabletClient>> clients;
+    std::map<openmldb::client::TabletClient*, uint32_t> client_parts;
+    std::vector<std::vector<uint32_t>> part_rows;
+    std::vector<uint32_t> row_parts;
+    row_parts.reserve(row_batch->Size());
+    std::string val;
+    for (int i = 0; i < row_batch->Size(); i++) {
+        std::shared_ptr<openmldb::client::TabletClient> client;
+        if (row_batch->GetRecordVal(i, col, &val)) {
+            auto tablet = cluster_sdk_->GetTablet(main_db, main_table, val);
+            if (tablet) {
+                client = tablet->GetClient();
+            }
+        }
+        if (!client) {
+            client = default_tablet;
+        }
+        auto iter = client_parts.find(client.get());
+        if (iter == client_parts.end()) {
+            iter = client_parts.emplace(client.get(), clients.size()).first;
+            clients.push_back(client);
+            part_rows.emplace_back();
+        }
+        part_rows[iter->second].push_back(i);
+        row_parts.push_back(iter->second);
+    }
+    if (clients.size() <= 1) {
+        return {};
+    }
+    bool ok = true;
+    std::vector<openmldb::RpcCallback<openmldb::api::SQLBatchRequestQueryResponse>*> callbacks;
+    for (size_t part = 0; part < clients.size(); part++) {
+        auto sub_batch = row_batch->SubBatch(part_rows[part]);
+        if (!sub_batch) {
+            SET_STATUS_AND_WARN(status, StatusCode::kCmdError, "fail to split the row batch");
+            ok = false;
+            break;
+        }
+        DLOG(INFO) << "call " << sp_name << " on endpoint " << clients[part]->GetEndpoint() << " with rows size "
+                   << sub_batch->Size();
+        auto response = std::make_shared<openmldb::api::SQLBatchRequestQueryResponse>();
+        auto cntl = std::make_shared<brpc::Controller>();
+        auto callback = new openmldb::RpcCallback<openmldb::api::SQLBatchRequestQueryResponse>(response, cntl);
+        // hold the callback until the rpc is joined
+        callback->Ref();
+        callbacks.push_back(callback);
+        if (!clients[part]->CallSQLBatchRequestProcedure(db, sp_name, sub_batch, options_->enable_debug,
+                                                         options_->request_timeout, callback)) {
+            // the rpc is not sent, so the closure will never run
+            callback->UnRef();
+            SET_STATUS_AND_WARN(status, StatusCode::kConnError,
+                                "fail to send batch request to " + clients[part]->GetEndpoint());
+            ok = false;
+            break;
+        }
+    }
+    std::vector<std::shared_ptr<SQLBatchRequestResultSet>> parts;
+    for (auto callback : callbacks) {
+        brpc::Join(callback->GetController()->call_id());
+        if (ok) {
+            auto& cntl = callback->GetController();
+            auto& response = callback->GetResponse();
+            if (cntl->Failed() || response->code() != ::openmldb::base::kOk) {
+                RPC_STATUS_AND_WARN(status, cntl, response, "CallSQLBatchRequestProcedure failed");
+                ok = false;
+            } else {
+                auto rs = std::make_shared<SQLBatchRequestResultSet>(response, cntl);
+                if (!rs->Init()) {
+                    SET_STATUS_AND_WARN(status, StatusCode::kCmdError, "SQLBatchRequestResultSet init failed");
+                    ok = false;
+                }
+                parts.push_back(rs);
+            }
+        }
+        callback->UnRef();
+    }
+    if (!ok) {
+        return {};
+    }
+    return std::make_shared<MergedSQLBatchRequestResultSet>(parts, row_parts);
+}
+
 std::shared_ptr<hybridse::sdk::ProcedureInfo> SQLClusterRouter::ShowProcedure(const std::string& db,
                                                                               const std::string& sp_name,
                                                                               hybridse::sdk::Status* status) {
@@ -1596,6 +1779,12 @@ std::shared_ptr<hybridse::sdk::ResultSet> SQLClusterRouter::HandleSQLCmd(const h
             options["storage_mode"] = StorageMode_Name(table->storage_mode());
             // remove the prefix 'k', i.e., change kMemory to Memory
             options["storage_mode"] = options["storage_mode"].substr(1, options["storage_mode"].size() - 1);
+            if (table->disk_row_layout() == common::kSingleRow) {
+                options["disk_row_layout"] = "single_row";
+            }
+            if (table->compress_type() == type::kDictionary) {
+                options["compress_type"] = "dictionary";
+            }
             ::openmldb::cmd::PrintTableOptions(options, ss);
             result.emplace_back(std::vector{ss.str()});
             return ResultSetSQL::MakeResultSet({FORMAT_STRING_KEY}, result, status);
@@ -2875,12 +3064,32 @@ hybridse::sdk::Status SQLClusterRouter::HandleLoadDataInfile(
         return {StatusCode::kCmdError, "file not exist"};
     }
 
+    uint64_t total_byte_size = 0;
+    for (const auto& file : file_list) {
+        uint64_t size = 0;
+        if (base::GetFileSize(file, size)) {
+            total_byte_size += size;
+        }
+    }
     int thread_num = options_parser.GetThread();
     std::vector<uint64_t> counts(thread_num);
+    LoadDataProgress progress;
     std::vector<std::future<hybridse::sdk::Status>> future_statuses;
     for (int i = 0; i < thread_num; i++) {
-        future_statuses.emplace_back(std::async(&SQLClusterRouter::LoadDataMultipleFile, this, i, thread_num, database,
-                                                table, file_list, options_parser, &(counts[i])));
+        future_statuses.emplace_back(std::async(std::launch::async, &SQLClusterRouter::LoadDataMultipleFile, this, i,
+                                                thread_num, database, table, file_list, options_parser, &progress,
+                                                &(counts[i])));
+    }
+    uint64_t start_time = ::baidu::common::timer::get_micros() / 1000;
+    for (int i = 0; i < thread_num; i++) {
+        while (future_statuses[i].wait_for(std::chrono::seconds(kLoadDataProgressInterval)) !=
+               std::future_status::ready) {
+            uint64_t cost_time = ::baidu::common::timer::get_micros() / 1000 - start_time;
+            LOG(INFO) << "Load data into " << database << "." << table << " progress: "
+                      << progress.row_cnt.load(std::memory_order_relaxed) << " rows, "
+                      << progress.byte_size.load(std::memory_order_relaxed) << "/" << total_byte_size
+                      << " bytes, cost " << cost_time << "ms";
+        }
     }
     uint64_t total_count = 0;
     hybridse::sdk::Status status;
@@ -2911,57 +3120,63 @@ hybridse::sdk::Status SQLClusterRouter::LoadDataMultipleFile(int id, int step, c
                                                              const std::string& table,
                                                              const std::vector<std::string>& file_list,
                                                              const openmldb::sdk::ReadFileOptionsParser& options_parser,
-                                                             uint64_t* count) {
+                                                             LoadDataProgress* progress, uint64_t* count) {
     for (const auto& file : file_list) {
         uint64_t cur_count = 0;
-        auto status = LoadDataSingleFile(id, step, database, table, file, options_parser, &cur_count);
-        DLOG(INFO) << "[thread " << id << "] Loaded " << count << " rows in " << file;
+        auto status = LoadDataSingleFile(id, step, database, table, file, options_parser, progress, &cur_count);
+        DLOG(INFO) << "[thread " << id << "] Loaded " << cur_count << " rows in " << file;
+        (*count) += cur_count;
         if (!status.IsOK()) {
             return status;
         }
-        (*count) += cur_count;
     }
     return {0, absl::StrCat("Load ", std::to_string(*count), " rows")};
 }
 
+// every thread loads the lines of its own range in file, and puts the rows by batch.
+// the rows of a batch are grouped by partition and sent in parallel
 hybridse::sdk::Status SQLClusterRouter::LoadDataSingleFile(int id, int step, const std::string& database,
                                                            const std::string& table, const std::string& file_path,
                                                            const openmldb::sdk::ReadFileOptionsParser& options_parser,
-                                                           uint64_t* count) {
+                                                           LoadDataProgress* progress, uint64_t* count) {
     *count = 0;
     // read csv
-    if (!base::IsExists(file_path)) {
+    uint64_t file_size = 0;
+    if (!base::IsExists(file_path) || !base::GetFileSize(file_path, file_size)) {
         return {StatusCode::kCmdError, "file not exist"};
     }
-    std::ifstream file(file_path);
-    if (!file.is_open()) {
-        return {StatusCode::kCmdError, "open file failed"};
-    }
-
-    std::string line;
-    if (!std::getline(file, line)) {
-        return {StatusCode::kCmdError, "read from file failed"};
+    char* line = nullptr;
+    uint32_t len = 0;
+    std::vector<char*> cols;
+    // the fields of the first line are copied, as the line is owned by the reader
+    std::vector<std::string> first_cols;
+    const std::string& delimiter = options_parser.GetDelimiter();
+    {
+        base::LineReader reader(kLoadDataHeaderBlockSize);
+        if (!reader.Open(file_path, 0, 1)) {
+            return {StatusCode::kCmdError, "open file failed"};
+        }
+        if (!reader.ReadLine(&line, &len)) {
+            return {StatusCode::kCmdError, "read from file failed"};
+        }
+        ::openmldb::sdk::SplitLineWithDelimiter(line, delimiter.c_str(), &cols, options_parser.GetQuote());
+        first_cols.assign(cols.begin(), cols.end());
     }
-    std::vector<std::string> cols;
-    ::openmldb::sdk::SplitLineWithDelimiterForStrings(line, options_parser.GetDelimiter(), &cols,
-                                                      options_parser.GetQuote());
     auto schema = GetTableSchema(database, table);
     if (!schema) {
         return {StatusCode::kCmdError, "table does not exist"};
     }
-    if (static_cast<int>(cols.size()) != schema->GetColumnCnt()) {
+    if (static_cast<int>(first_cols.size()) != schema->GetColumnCnt()) {
         return {StatusCode::kCmdError, "mismatch column size"};
     }
 
     if (options_parser.GetHeader()) {
         // the first line is the column names, check if equal with table schema
         for (int i = 0; i < schema->GetColumnCnt(); ++i) {
-            if (cols[i] != schema->GetColumnName(i)) {
+            if (first_cols[i] != schema->GetColumnName(i)) {
                 return {StatusCode::kCmdError, "mismatch column name"};
             }
         }
-        // then read the first row of data
-        std::getline(file, line);
     }
 
     // build placeholder
@@ -2977,40 +3192,74 @@ hybridse::sdk::Status SQLClusterRouter::LoadDataSingleFile(int id, int step, con
             str_cols_idx.emplace_back(i);
         }
     }
-    int64_t i = 0;
-    do {
-        // only process the line assigned to its own id
-        if (i % step == id) {
-            cols.clear();
-            std::string error;
-            ::openmldb::sdk::SplitLineWithDelimiterForStrings(line, options_parser.GetDelimiter(), &cols,
-                                                              options_parser.GetQuote());
-            auto ret = InsertOneRow(database, insert_placeholder, str_cols_idx, options_parser.GetNullValue(), cols);
-            if (!ret.IsOK()) {
-                return {StatusCode::kCmdError, absl::StrCat("file [", file_path, "] line [lineno=", i, ": ", line,
-                                                            "] insert failed, ", ret.msg)};
-            } else {
-                (*count)++;
+    uint64_t begin = file_size * id / step;
+    uint64_t end = file_size * (id + 1) / step;
+    base::LineReader reader;
+    if (!reader.Open(file_path, begin, end)) {
+        return {StatusCode::kCmdError, "open file failed"};
+    }
+    uint32_t batch_size = options_parser.GetBatchSize();
+    uint64_t batch_offset = begin;
+    uint64_t reported_offset = begin;
+    std::shared_ptr<SQLInsertRows> rows;
+    auto put_rows = [&]() -> hybridse::sdk::Status {
+        if (rows && rows->GetCnt() > 0) {
+            hybridse::sdk::Status put_status;
+            if (!ExecuteInsert(database, insert_placeholder, rows, &put_status)) {
+                return {StatusCode::kCmdError, absl::StrCat("file [", file_path, "] lines from [offset=",
+                                                            batch_offset, "] insert failed, ", put_status.msg)};
             }
+            (*count) += rows->GetCnt();
+            progress->row_cnt.fetch_add(rows->GetCnt(), std::memory_order_relaxed);
+            rows.reset();
         }
-        ++i;
-    } while (std::getline(file, line));
-    return {StatusCode::kOk, "Load " + std::to_string(i) + " rows"};
+        uint64_t offset = reader.GetOffset();
+        progress->byte_size.fetch_add(offset - reported_offset, std::memory_order_relaxed);
+        reported_offset = offset;
+        return {};
+    };
+    while (reader.ReadLine(&line, &len)) {
+        // skip the header, it is read by the thread whose range begins at 0
+        if (options_parser.GetHeader() && reader.GetLineOffset() == 0) {
+            continue;
+        }
+        if (!rows) {
+            rows = GetInsertRows(database, insert_placeholder, &status);
+            if (!rows) {
+                return status;
+            }
+            batch_offset = reader.GetLineOffset();
+        }
+        cols.clear();
+        ::openmldb::sdk::SplitLineWithDelimiter(line, delimiter.c_str(), &cols, options_parser.GetQuote());
+        auto ret = AppendLoadDataRow(rows->NewRow(), str_cols_idx, options_parser.GetNullValue(), cols);
+        if (!ret.IsOK()) {
+            return {StatusCode::kCmdError,
+                    absl::StrCat("file [", file_path, "] line [offset=", reader.GetLineOffset(), ": ",
+                                 absl::StrJoin(cols, delimiter), "] insert failed, ", ret.msg)};
+        }
+        if (rows->GetCnt() >= batch_size) {
+            auto put_status = put_rows();
+            if (!put_status.IsOK()) {
+                return put_status;
+            }
+        }
+    }
+    if (reader.HasError()) {
+        return {StatusCode::kCmdError, absl::StrCat("read file [", file_path, "] failed")};
+    }
+    return put_rows();
 }
 
-hybridse::sdk::Status SQLClusterRouter::InsertOneRow(const std::string& database, const std::string& insert_placeholder,
-                                                     const std::vector<int>& str_col_idx, const std::string& null_value,
-                                                     const std::vector<std::string>& cols) {
+hybridse::sdk::Status SQLClusterRouter::AppendLoadDataRow(const std::shared_ptr<SQLInsertRow>& row,
+                                                          const std::vector<int>& str_col_idx,
+                                                          const std::string& null_value,
+                                                          const std::vector<char*>& cols) {
     if (cols.empty()) {
         return {StatusCode::kCmdError, "cols is empty"};
     }
-    if (database.empty()) {
-        return {StatusCode::kCmdError, "database is empty"};
-    }
-    hybridse::sdk::Status status;
-    auto row = GetInsertRow(database, insert_placeholder, &status);
     if (!row) {
-        return status;
+        return {StatusCode::kCmdError, "fail to create insert row"};
     }
     // build row from cols
     auto& schema = row->GetSchema();
@@ -3022,7 +3271,7 @@ hybridse::sdk::Status SQLClusterRouter::InsertOneRow(const std::string& database
     std::string::size_type str_len_sum = 0;
     for (auto idx : str_col_idx) {
         if (cols[idx] != null_value) {
-            str_len_sum += cols[idx].length();
+            str_len_sum += strlen(cols[idx]);
         }
     }
     row->Init(static_cast<int>(str_len_sum));
@@ -3033,9 +3282,6 @@ hybridse::sdk::Status SQLClusterRouter::InsertOneRow(const std::string& database
             return {StatusCode::kCmdError, "translate to insert row failed"};
         }
     }
-    if (!ExecuteInsert(database, insert_placeholder, row, &status)) {
-        return {StatusCode::kCmdError, "insert row failed"};
-    }
     return {};
 }
 
@@ -3563,7 +3809,8 @@ hybridse::sdk::Status SQLClusterRouter::HandleLongWindows(
         }
 
         for (const auto& lw : long_window_infos) {
-            if (absl::EndsWithIgnoreCase(lw.aggr_func_, "_where")) {
+            // *_cate ops keep the category as the filter key, the same restrictions as *_where
+            if (absl::EndsWithIgnoreCase(lw.aggr_func_, "_where") || absl::EndsWithIgnoreCase(lw.aggr_func_, "_cate")) {
                 // TOOD(ace): *_where op only support for memory base table
                 if (tables[0].storage_mode() != common::StorageMode::kMemory) {
                     return {StatusCode::kUnSupport,
@@ -17,6 +17,7 @@
 #ifndef SRC_SDK_SQL_CLUSTER_ROUTER_H_
 #define SRC_SDK_SQL_CLUSTER_ROUTER_H_
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <set>
@@ -27,7 +28,7 @@
 #include <vector>
 
 #include "base/ddl_parser.h"
-#include "base/lru_cache.h"
+#include "base/clock_cache.h"
 #include "base/random.h"
 #include "base/spinlock.h"
 #include "client/tablet_client.h"
@@ -43,6 +44,18 @@ namespace openmldb::sdk {
 typedef ::google::protobuf::RepeatedPtrField<::openmldb::common::ColumnDesc> PBSchema;
 
 constexpr const char* FORMAT_STRING_KEY = "!%$FORMAT_STRING_KEY";
+// the sql cache is split into shards to reduce the lock contention, max_sql_cache_size is divided among them
+constexpr uint32_t SQL_CACHE_SHARD_NUM = 16;
+
+constexpr size_t GetSqlCacheShardCapacity(uint32_t max_sql_cache_size) {
+    return (static_cast<size_t>(max_sql_cache_size) + SQL_CACHE_SHARD_NUM - 1) / SQL_CACHE_SHARD_NUM;
+}
+
+// the progress of load data, it is shared by all the loading threads
+struct LoadDataProgress {
+    std::atomic<uint64_t> row_cnt{0};
+    std::atomic<uint64_t> byte_size{0};
+};
 
 class SQLClusterRouter : public SQLRouter {
  public:
@@ -263,7 +276,19 @@ class SQLClusterRouter : public SQLRouter {
                 const std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>>& tablets,
                 ::hybridse::sdk::Status* status);
 
+    // group rows by partition and put every group with one PutBatch rpc, the rpcs are sent in parallel
+    bool PutRows(uint32_t tid, const std::shared_ptr<SQLInsertRows>& rows,
+                 const std::vector<std::shared_ptr<::openmldb::catalog::TabletAccessor>>& tablets,
+                 ::hybridse::sdk::Status* status);
+
     bool IsConstQuery(::hybridse::vm::PhysicalOpNode* node);
+
+    // split the batch by the router column of the deployment and call the tablets owning the keys in parallel,
+    // return nullptr and keep status ok if all rows go to one tablet
+    std::shared_ptr<hybridse::sdk::ResultSet> FanOutSQLBatchRequestProcedure(
+        const std::string& db, const std::string& sp_name, const std::shared_ptr<SQLRequestRowBatch>& row_batch,
+        const std::shared_ptr<openmldb::client::TabletClient>& default_tablet, hybridse::sdk::Status* status);
+
     std::shared_ptr<SQLCache> GetCache(const std::string& db, const std::string& sql,
                                        hybridse::vm::EngineMode engine_mode);
 
@@ -311,16 +336,16 @@ class SQLClusterRouter : public SQLRouter {
     hybridse::sdk::Status LoadDataMultipleFile(int id, int step, const std::string& database,
                                                const std::string& table, const std::vector<std::string>& file_list,
                                                const openmldb::sdk::ReadFileOptionsParser& options_parser,
-                                               uint64_t* count);
+                                               LoadDataProgress* progress, uint64_t* count);
 
     hybridse::sdk::Status LoadDataSingleFile(int id, int step, const std::string& database,
                                              const std::string& table, const std::string& file_path,
                                              const openmldb::sdk::ReadFileOptionsParser& options_parser,
-                                             uint64_t* count);
+                                             LoadDataProgress* progress, uint64_t* count);
 
-    hybridse::sdk::Status InsertOneRow(const std::string& database, const std::string& insert_placeholder,
-                                       const std::vector<int>& str_col_idx, const std::string& null_value,
-                                       const std::vector<std::string>& cols);
+    hybridse::sdk::Status AppendLoadDataRow(const std::shared_ptr<SQLInsertRow>& row,
+                                            const std::vector<int>& str_col_idx, const std::string& null_value,
+                                            const std::vector<char*>& cols);
 
     hybridse::sdk::Status HandleDeploy(const std::string& db, const hybridse::node::DeployPlanNode* deploy_node);
 
@@ -375,8 +400,8 @@ class SQLClusterRouter : public SQLRouter {
     bool is_cluster_mode_;
     bool interactive_;
     DBSDK* cluster_sdk_;
-    std::map<std::string, std::map<hybridse::vm::EngineMode, base::lru_cache<std::string, std::shared_ptr<SQLCache>>>>
-        input_lru_cache_;
+    // (db, engine mode, sql) -> cache
+    base::ShardedClockCache<std::string, std::shared_ptr<SQLCache>> input_cache_;
     ::openmldb::base::SpinMutex mu_;
     ::openmldb::base::Random rand_;
 };
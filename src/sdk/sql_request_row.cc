@@ -409,20 +409,25 @@ SQLRequestRowBatch::SQLRequestRowBatch(std::shared_ptr<hybridse::sdk::Schema> sc
     }
     common_column_indices_ = indices->common_column_indices_;
 
-    std::vector<size_t> common_indices_vec;
-    std::vector<size_t> non_common_indices_vec;
     for (int i = 0; i < schema->GetColumnCnt(); ++i) {
         auto col_ref = request_schema_.Add();
         col_ref->set_name(schema->GetColumnName(i));
         col_ref->set_is_not_null(schema->IsColumnNotNull(i));
         col_ref->set_type(ProtoTypeFromDataType(schema->GetColumnType(i)));
+    }
+    InitSelectors();
+}
+
+void SQLRequestRowBatch::InitSelectors() {
+    std::vector<size_t> common_indices_vec;
+    std::vector<size_t> non_common_indices_vec;
+    for (int i = 0; i < request_schema_.size(); ++i) {
         if (common_column_indices_.find(i) != common_column_indices_.end()) {
             common_indices_vec.push_back(i);
         } else {
             non_common_indices_vec.push_back(i);
         }
     }
-
     if (!common_column_indices_.empty()) {
         common_selector_ = std::unique_ptr<::hybridse::codec::RowSelector>(
             new ::hybridse::codec::RowSelector(&request_schema_, common_indices_vec));
@@ -444,6 +449,7 @@ bool SQLRequestRowBatch::AddRow(std::shared_ptr<SQLRequestRow> row) {
     if (common_column_indices_.empty() ||
         common_column_indices_.size() == static_cast<size_t>(request_schema_.size())) {
         non_common_slices_.emplace_back(std::string(reinterpret_cast<char*>(input_buf), input_size));
+        record_values_.emplace_back(row->record_value_);
         return true;
     }
 
@@ -465,8 +471,38 @@ bool SQLRequestRowBatch::AddRow(std::shared_ptr<SQLRequestRow> row) {
     }
     non_common_slices_.emplace_back(std::string(reinterpret_cast<char*>(non_common_buf), non_common_size));
     free(non_common_buf);
+    record_values_.emplace_back(row->record_value_);
     return true;
 }
 
+bool SQLRequestRowBatch::GetRecordVal(uint32_t idx, const std::string& col, std::string* val) const {
+    if (val == nullptr || idx >= record_values_.size()) {
+        return false;
+    }
+    auto iter = record_values_[idx].find(col);
+    if (iter == record_values_[idx].end()) {
+        return false;
+    }
+    val->assign(iter->second);
+    return true;
+}
+
+std::shared_ptr<SQLRequestRowBatch> SQLRequestRowBatch::SubBatch(const std::vector<uint32_t>& indices) const {
+    std::shared_ptr<SQLRequestRowBatch> batch(new SQLRequestRowBatch());
+    batch->request_schema_ = request_schema_;
+    batch->common_column_indices_ = common_column_indices_;
+    batch->InitSelectors();
+    batch->common_slice_ = common_slice_;
+    for (auto idx : indices) {
+        if (idx >= non_common_slices_.size()) {
+            LOG(WARNING) << "row idx out of bound " << idx;
+            return {};
+        }
+        batch->non_common_slices_.push_back(non_common_slices_[idx]);
+        batch->record_values_.push_back(record_values_[idx]);
+    }
+    return batch;
+}
+
 }  // namespace sdk
 }  // namespace openmldb
@@ -58,6 +58,7 @@ class SQLRequestRow {
         std::shared_ptr<hybridse::sdk::ColumnTypes> types);
 
  private:
+    friend class SQLRequestRowBatch;
     bool Check(hybridse::sdk::DataType type);
 
  private:
@@ -101,12 +102,22 @@ class SQLRequestRowBatch {
         return &non_common_slices_[idx];
     }
 
+    // get the value of record column `col` of the row at `idx`, see SQLRequestRow::GetRecordVal
+    bool GetRecordVal(uint32_t idx, const std::string& col, std::string* val) const;
+
+    // make a batch of the rows at `indices` in order, the common slice is shared with this batch
+    std::shared_ptr<SQLRequestRowBatch> SubBatch(const std::vector<uint32_t>& indices) const;
+
     void Clear() {
         common_slice_.clear();
         non_common_slices_.clear();
+        record_values_.clear();
     }
 
  private:
+    SQLRequestRowBatch() {}
+    void InitSelectors();
+
     ::hybridse::codec::Schema request_schema_;
     std::set<size_t> common_column_indices_;
 
@@ -115,6 +126,8 @@ class SQLRequestRowBatch {
 
     std::string common_slice_;
     std::vector<std::string> non_common_slices_;
+    // the values of record columns of rows, used to route the rows
+    std::vector<std::map<std::string, std::string>> record_values_;
 };
 
 class ColumnIndicesSet {
@@ -272,6 +272,42 @@ TEST_F(SQLRequestRowBatchTest, batch_test_all_common) {
     ASSERT_EQ(non_common_view.GetStringUnsafe(1), "world");
 }
 
+TEST_F(SQLRequestRowBatchTest, sub_batch) {
+    ::hybridse::vm::Schema schema;
+    InitSimpleSchema(&schema);
+    std::shared_ptr<::hybridse::sdk::Schema> schema_shared = std::make_shared<::hybridse::sdk::SchemaImpl>(schema);
+    auto indice_set = std::make_shared<ColumnIndicesSet>(schema_shared);
+    indice_set->AddCommonColumnIdx(0);
+    indice_set->AddCommonColumnIdx(2);
+    SQLRequestRowBatch batch(schema_shared, indice_set);
+    std::vector<std::string> keys = {"k0", "k1", "k2", "k3"};
+    for (const auto& key : keys) {
+        auto row = std::make_shared<SQLRequestRow>(schema_shared, std::set<std::string>{"col1"});
+        ASSERT_TRUE(row->Init(key.size()));
+        ASSERT_TRUE(row->AppendInt32(32));
+        ASSERT_TRUE(row->AppendString(key));
+        ASSERT_TRUE(row->AppendInt64(64));
+        ASSERT_TRUE(row->Build());
+        ASSERT_TRUE(batch.AddRow(row));
+    }
+    std::string val;
+    ASSERT_TRUE(batch.GetRecordVal(2, "col1", &val));
+    ASSERT_EQ("k2", val);
+    ASSERT_FALSE(batch.GetRecordVal(2, "col0", &val));
+    ASSERT_FALSE(batch.GetRecordVal(4, "col1", &val));
+
+    auto sub_batch = batch.SubBatch({3, 1});
+    ASSERT_TRUE(sub_batch);
+    ASSERT_EQ(2, sub_batch->Size());
+    ASSERT_EQ(*batch.GetCommonSlice(), *sub_batch->GetCommonSlice());
+    ASSERT_EQ(batch.common_column_indices(), sub_batch->common_column_indices());
+    ASSERT_EQ(*batch.GetNonCommonSlice(3), *sub_batch->GetNonCommonSlice(0));
+    ASSERT_EQ(*batch.GetNonCommonSlice(1), *sub_batch->GetNonCommonSlice(1));
+    ASSERT_TRUE(sub_batch->GetRecordVal(0, "col1", &val));
+    ASSERT_EQ("k3", val);
+    ASSERT_FALSE(batch.SubBatch({0, 4}));
+}
+
 }  // namespace sdk
 }  // namespace openmldb
 
@@ -47,6 +47,9 @@ struct BasicRouterOptions {
     int glog_level = 0;
     // empty means to stderr
     std::string glog_dir = "";
+    // split the rows of a batch request to a deployment by its router column, and send the sub batches in
+    // parallel to the tablets owning the keys
+    bool enable_batch_request_fan_out = false;
 };
 
 struct SQLRouterOptions : BasicRouterOptions {
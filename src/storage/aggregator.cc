@@ -74,8 +74,7 @@ Aggregator::Aggregator(const ::openmldb::api::TableMeta& base_meta, const ::open
       window_type_(window_tpye),
       window_size_(window_size),
       base_row_view_(base_table_schema_),
-      aggr_row_view_(aggr_table_schema_),
-      row_builder_(aggr_table_schema_) {
+      aggr_row_view_(aggr_table_schema_) {
     for (int i = 0; i < base_meta.column_desc().size(); i++) {
         if (base_meta.column_desc(i).name() == aggr_col_) {
             aggr_col_idx_ = i;
@@ -122,8 +121,14 @@ bool Aggregator::Update(const std::string& key, const std::string& row, const ui
     if (filter_col_idx_ != -1) {
         if (!base_row_view_.IsNULL(row_ptr, filter_col_idx_)) {
             base_row_view_.GetStrValue(row_ptr, filter_col_idx_, &filter_key);
+        } else if (is_cate_) {
+            // *_cate ops skip the null category
+            return true;
         }
     }
+    if (is_cate_ && base_row_view_.IsNULL(row_ptr, aggr_col_idx_)) {
+        return true;
+    }
 
     if (!filter_key.empty() && window_type_ != WindowType::kRowsRange) {
         LOG(ERROR) << "unsupport rows bucket window for *_where agg op";
@@ -132,10 +137,11 @@ bool Aggregator::Update(const std::string& key, const std::string& row, const ui
 
     AggrBufferLocked* aggr_buffer_lock;
     {
-        std::lock_guard<std::mutex> lock(mu_);
-        auto it = aggr_buffer_map_.find(key);
-        if (it == aggr_buffer_map_.end()) {
-            auto insert_pair = aggr_buffer_map_[key].emplace(filter_key, AggrBufferLocked{});
+        auto& shard = GetShard(key);
+        std::lock_guard<std::mutex> lock(shard.mu);
+        auto it = shard.buffer_map.find(key);
+        if (it == shard.buffer_map.end()) {
+            auto insert_pair = shard.buffer_map[key].emplace(filter_key, AggrBufferLocked{});
             aggr_buffer_lock = &insert_pair.first->second;
         } else {
             auto& filter_map = it->second;
@@ -213,11 +219,37 @@ bool Aggregator::Update(const std::string& key, const std::string& row, const ui
     return true;
 }
 
+Aggregator::UpdateTicket Aggregator::ReserveUpdate(const std::string& key) {
+    UpdateTicket ticket;
+    ticket.shard_idx = GetShardIdx(key);
+    auto& shard = buffer_shards_[ticket.shard_idx];
+    std::lock_guard<std::mutex> lock(shard.mu);
+    ticket.seq = shard.reserved_seq++;
+    return ticket;
+}
+
+bool Aggregator::Update(const std::string& key, const std::string& row, const uint64_t& offset,
+                        const UpdateTicket& ticket) {
+    auto& shard = buffer_shards_[ticket.shard_idx];
+    {
+        std::unique_lock<std::mutex> lock(shard.mu);
+        shard.update_cv.wait(lock, [&shard, &ticket] { return shard.applied_seq == ticket.seq; });
+    }
+    bool ok = Update(key, row, offset);
+    {
+        std::lock_guard<std::mutex> lock(shard.mu);
+        shard.applied_seq++;
+    }
+    shard.update_cv.notify_all();
+    return ok;
+}
+
 bool Aggregator::Delete(const std::string& key) {
     {
-        std::lock_guard<std::mutex> lock(mu_);
-        // erase from the aggr_buffer_map_
-        aggr_buffer_map_.erase(key);
+        auto& shard = GetShard(key);
+        std::lock_guard<std::mutex> lock(shard.mu);
+        // erase from the buffer map
+        shard.buffer_map.erase(key);
     }
 
     // delete the entries from the pre-aggr table
@@ -247,23 +279,27 @@ bool Aggregator::Delete(const std::string& key) {
 }
 
 bool Aggregator::FlushAll() {
-    // TODO(nauta): optimize the flush process
-    std::unique_lock<std::mutex> lock(mu_);
-    std::unordered_map<std::string, std::unordered_map<std::string, AggrBuffer>> flushed_buffer_map;
-    for (auto& it : aggr_buffer_map_) {
-        for (auto& filter_it : it.second) {
-            auto& aggr_buffer = filter_it.second.buffer_;
-            if (aggr_buffer.aggr_cnt_ == 0) {
-                continue;
+    // copy the buffers shard by shard, so the updates of other shards are not blocked
+    for (auto& shard : buffer_shards_) {
+        std::unordered_map<std::string, std::unordered_map<std::string, AggrBuffer>> flushed_buffer_map;
+        {
+            std::lock_guard<std::mutex> lock(shard.mu);
+            for (auto& it : shard.buffer_map) {
+                for (auto& filter_it : it.second) {
+                    std::lock_guard<std::mutex> buffer_lock(*filter_it.second.mu_);
+                    auto& aggr_buffer = filter_it.second.buffer_;
+                    if (aggr_buffer.aggr_cnt_ == 0) {
+                        continue;
+                    }
+                    flushed_buffer_map[it.first].emplace(filter_it.first, aggr_buffer);
+                }
             }
-            flushed_buffer_map[it.first].emplace(filter_it.first, aggr_buffer);
         }
-    }
-    lock.unlock();
-    for (auto& it : flushed_buffer_map) {
-        for (auto& filter_it : it.second) {
-            if (!FlushAggrBuffer(it.first, filter_it.first, filter_it.second)) {
-                return false;
+        for (auto& it : flushed_buffer_map) {
+            for (auto& filter_it : it.second) {
+                if (!FlushAggrBuffer(it.first, filter_it.first, filter_it.second)) {
+                    return false;
+                }
             }
         }
     }
@@ -301,7 +337,7 @@ bool Aggregator::Init(std::shared_ptr<LogReplicator> base_replicator) {
         if (!aggr_row_view_.IsNULL(data_ptr, 6)) {
             aggr_row_view_.GetStrValue(data_ptr, 6, &filter_key);
         }
-        auto insert_pair = aggr_buffer_map_[pk].insert(std::make_pair(filter_key, AggrBufferLocked{}));
+        auto insert_pair = GetShard(pk).buffer_map[pk].insert(std::make_pair(filter_key, AggrBufferLocked{}));
         auto& buffer = insert_pair.first->second.buffer_;
         auto val = it->GetValue();
         int8_t* aggr_row_ptr = reinterpret_cast<int8_t*>(const_cast<char*>(val.data()));
@@ -395,12 +431,13 @@ bool Aggregator::Init(std::shared_ptr<LogReplicator> base_replicator) {
 bool Aggregator::GetAggrBuffer(const std::string& key, AggrBuffer** buffer) { return GetAggrBuffer(key, "", buffer); }
 
 bool Aggregator::GetAggrBuffer(const std::string& key, const std::string& filter_key, AggrBuffer** buffer) {
-    std::lock_guard<std::mutex> lock(mu_);
-    auto it = aggr_buffer_map_.find(key);
-    if (it == aggr_buffer_map_.end()) {
+    auto& shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.mu);
+    auto it = shard.buffer_map.find(key);
+    if (it == shard.buffer_map.end()) {
         return false;
     }
-    *buffer = &aggr_buffer_map_[key][filter_key].buffer_;
+    *buffer = &it->second[filter_key].buffer_;
     return true;
 }
 
@@ -416,6 +453,14 @@ bool Aggregator::SetFilter(absl::string_view filter_col) {
     return false;
 }
 
+bool Aggregator::SetCategory(absl::string_view cate_col) {
+    if (aggr_col_idx_ == -1 || !SetFilter(cate_col)) {
+        return false;
+    }
+    is_cate_ = true;
+    return true;
+}
+
 bool Aggregator::GetAggrBufferFromRowView(const codec::RowView& row_view, const int8_t* row_ptr, AggrBuffer* buffer) {
     if (buffer == nullptr) {
         return false;
@@ -438,25 +483,27 @@ bool Aggregator::FlushAggrBuffer(const std::string& key, const std::string& filt
         PDLOG(ERROR, "Enocde aggr value to row failed");
         return false;
     }
+    // the buffers of different shards are flushed concurrently, so the builder isn't shared
+    codec::RowBuilder row_builder(aggr_table_schema_);
     int str_length = key.size() + aggr_val.size() + filter_key.size();
-    uint32_t row_size = row_builder_.CalTotalLength(str_length);
+    uint32_t row_size = row_builder.CalTotalLength(str_length);
     encoded_row.resize(row_size);
     int8_t* row_ptr = reinterpret_cast<int8_t*>(&(encoded_row[0]));
-    row_builder_.InitBuffer(row_ptr, row_size, true);
-    row_builder_.SetString(row_ptr, row_size, 0, key.c_str(), key.size());
-    row_builder_.SetTimestamp(row_ptr, 1, buffer.ts_begin_);
-    row_builder_.SetTimestamp(row_ptr, 2, buffer.ts_end_);
-    row_builder_.SetInt32(row_ptr, 3, buffer.aggr_cnt_);
+    row_builder.InitBuffer(row_ptr, row_size, true);
+    row_builder.SetString(row_ptr, row_size, 0, key.c_str(), key.size());
+    row_builder.SetTimestamp(row_ptr, 1, buffer.ts_begin_);
+    row_builder.SetTimestamp(row_ptr, 2, buffer.ts_end_);
+    row_builder.SetInt32(row_ptr, 3, buffer.aggr_cnt_);
     if ((aggr_type_ == AggrType::kMax || aggr_type_ == AggrType::kMin) && buffer.AggrValEmpty()) {
-        row_builder_.SetNULL(row_ptr, row_size, 4);
+        row_builder.SetNULL(row_ptr, row_size, 4);
     } else {
-        row_builder_.SetString(row_ptr, row_size, 4, aggr_val.c_str(), aggr_val.size());
+        row_builder.SetString(row_ptr, row_size, 4, aggr_val.c_str(), aggr_val.size());
     }
-    row_builder_.SetInt64(row_ptr, 5, buffer.binlog_offset_);
+    row_builder.SetInt64(row_ptr, 5, buffer.binlog_offset_);
     if (!filter_key.empty()) {
-        row_builder_.SetString(row_ptr, row_size, 6, filter_key.c_str(), filter_key.size());
+        row_builder.SetString(row_ptr, row_size, 6, filter_key.c_str(), filter_key.size());
     } else {
-        row_builder_.SetNULL(row_ptr, row_size, 6);
+        row_builder.SetNULL(row_ptr, row_size, 6);
     }
 
     int64_t time = ::baidu::common::timer::get_micros() / 1000;
@@ -1055,6 +1102,110 @@ bool AvgAggregator::DecodeAggrVal(const int8_t* row_ptr, AggrBuffer* buffer) {
     return true;
 }
 
+ApproxDistinctCountAggregator::ApproxDistinctCountAggregator(
+    const ::openmldb::api::TableMeta& base_meta, const ::openmldb::api::TableMeta& aggr_meta,
+    std::shared_ptr<Table> aggr_table, std::shared_ptr<LogReplicator> aggr_replicator, const uint32_t& index_pos,
+    const std::string& aggr_col, const AggrType& aggr_type, const std::string& ts_col, WindowType window_tpye,
+    uint32_t window_size)
+    : Aggregator(base_meta, aggr_meta, aggr_table, aggr_replicator, index_pos, aggr_col, aggr_type, ts_col, window_tpye,
+                 window_size) {}
+
+// the values are hashed by the bytes of their storage types, the same as the approx_distinct_count udaf
+bool ApproxDistinctCountAggregator::UpdateAggrVal(const codec::RowView& row_view, const int8_t* row_ptr,
+                                                  AggrBuffer* aggr_buffer) {
+    if (row_view.IsNULL(row_ptr, aggr_col_idx_)) {
+        return true;
+    }
+    if (!aggr_buffer->sketch_) {
+        aggr_buffer->sketch_ = std::make_unique<hybridse::udf::sketch::HyperLogLog>();
+    }
+    auto& sketch = *aggr_buffer->sketch_;
+    switch (aggr_col_type_) {
+        case DataType::kBool: {
+            bool val;
+            row_view.GetValue(row_ptr, aggr_col_idx_, aggr_col_type_, &val);
+            sketch.Add(&val, sizeof(bool));
+            break;
+        }
+        case DataType::kSmallInt: {
+            int16_t val;
+            row_view.GetValue(row_ptr, aggr_col_idx_, aggr_col_type_, &val);
+            sketch.Add(&val, sizeof(int16_t));
+            break;
+        }
+        case DataType::kDate:
+        case DataType::kInt: {
+            int32_t val;
+            row_view.GetValue(row_ptr, aggr_col_idx_, aggr_col_type_, &val);
+            sketch.Add(&val, sizeof(int32_t));
+            break;
+        }
+        case DataType::kTimestamp:
+        case DataType::kBigInt: {
+            int64_t val;
+            row_view.GetValue(row_ptr, aggr_col_idx_, aggr_col_type_, &val);
+            sketch.Add(&val, sizeof(int64_t));
+            break;
+        }
+        case DataType::kFloat: {
+            float val;
+            row_view.GetValue(row_ptr, aggr_col_idx_, aggr_col_type_, &val);
+            // -0.0 and 0.0 are the same value
+            if (val == 0) {
+                val = 0;
+            }
+            sketch.Add(&val, sizeof(float));
+            break;
+        }
+        case DataType::kDouble: {
+            double val;
+            row_view.GetValue(row_ptr, aggr_col_idx_, aggr_col_type_, &val);
+            if (val == 0) {
+                val = 0;
+            }
+            sketch.Add(&val, sizeof(double));
+            break;
+        }
+        case DataType::kString:
+        case DataType::kVarchar: {
+            char* ch = NULL;
+            uint32_t ch_length = 0;
+            row_view.GetValue(row_ptr, aggr_col_idx_, &ch, &ch_length);
+            sketch.Add(ch, ch_length);
+            break;
+        }
+        default: {
+            PDLOG(ERROR, "Unsupported data type");
+            return false;
+        }
+    }
+    aggr_buffer->non_null_cnt_++;
+    return true;
+}
+
+bool ApproxDistinctCountAggregator::EncodeAggrVal(const AggrBuffer& buffer, std::string* aggr_val) {
+    if (buffer.sketch_) {
+        buffer.sketch_->Serialize(aggr_val);
+    } else {
+        hybridse::udf::sketch::HyperLogLog().Serialize(aggr_val);
+    }
+    return true;
+}
+
+bool ApproxDistinctCountAggregator::DecodeAggrVal(const int8_t* row_ptr, AggrBuffer* buffer) {
+    char* aggr_val = NULL;
+    uint32_t ch_length = 0;
+    if (aggr_row_view_.GetValue(row_ptr, 4, &aggr_val, &ch_length) == 1) {
+        return true;
+    }
+    buffer->sketch_ = std::make_unique<hybridse::udf::sketch::HyperLogLog>();
+    if (!buffer->sketch_->Deserialize(aggr_val, ch_length)) {
+        PDLOG(ERROR, "Decode sketch failed");
+        return false;
+    }
+    return true;
+}
+
 std::shared_ptr<Aggregator> CreateAggregator(const ::openmldb::api::TableMeta& base_meta,
                                              const ::openmldb::api::TableMeta& aggr_meta,
                                              std::shared_ptr<Table> aggr_table,
@@ -1102,26 +1253,42 @@ std::shared_ptr<Aggregator> CreateAggregator(const ::openmldb::api::TableMeta& b
     }
 
     std::shared_ptr<Aggregator> agg;
-    if (aggr_type == "sum" || aggr_type == "sum_where") {
+    if (aggr_type == "sum" || aggr_type == "sum_where" || aggr_type == "sum_cate") {
         agg = std::make_shared<SumAggregator>(base_meta, aggr_meta, aggr_table, aggr_replicator, index_pos, aggr_col,
                                                AggrType::kSum, ts_col, window_type, window_size);
-    } else if (aggr_type == "min" || aggr_type == "min_where") {
+    } else if (aggr_type == "min" || aggr_type == "min_where" || aggr_type == "min_cate") {
         agg = std::make_shared<MinAggregator>(base_meta, aggr_meta, aggr_table, aggr_replicator, index_pos, aggr_col,
                                                AggrType::kMin, ts_col, window_type, window_size);
-    } else if (aggr_type == "max" || aggr_type == "max_where") {
+    } else if (aggr_type == "max" || aggr_type == "max_where" || aggr_type == "max_cate") {
         agg = std::make_shared<MaxAggregator>(base_meta, aggr_meta, aggr_table, aggr_replicator, index_pos, aggr_col,
                                               AggrType::kMax, ts_col, window_type, window_size);
-    } else if (aggr_type == "count" || aggr_type == "count_where") {
+    } else if (aggr_type == "count" || aggr_type == "count_where" || aggr_type == "count_cate") {
         agg = std::make_shared<CountAggregator>(base_meta, aggr_meta, aggr_table, aggr_replicator, index_pos, aggr_col,
                                                 AggrType::kCount, ts_col, window_type, window_size);
-    } else if (aggr_type == "avg" || aggr_type == "avg_where") {
+    } else if (aggr_type == "avg" || aggr_type == "avg_where" || aggr_type == "avg_cate") {
         agg = std::make_shared<AvgAggregator>(base_meta, aggr_meta, aggr_table, aggr_replicator, index_pos, aggr_col,
                                               AggrType::kAvg, ts_col, window_type, window_size);
+    } else if (aggr_type == "approx_distinct_count") {
+        agg = std::make_shared<ApproxDistinctCountAggregator>(base_meta, aggr_meta, aggr_table, aggr_replicator,
+                                                              index_pos, aggr_col, AggrType::kApproxDistinctCount,
+                                                              ts_col, window_type, window_size);
     } else {
         PDLOG(ERROR, "Unsupported aggregate function type");
         return {};
     }
 
+    if (absl::EndsWithIgnoreCase(aggr_type, "_cate")) {
+        if (filter_col.empty()) {
+            PDLOG(ERROR, "no category column specified for %s", aggr_type);
+            return {};
+        }
+        if (!agg->SetCategory(filter_col)) {
+            PDLOG(ERROR, "can not find category column '%s' or value column for %s", filter_col, aggr_type);
+            return {};
+        }
+        return agg;
+    }
+
     if (filter_col.empty() || !absl::EndsWithIgnoreCase(aggr_type, "_where")) {
         // min/max/count/avg/sum ops
         return agg;
@@ -17,6 +17,8 @@
 #ifndef SRC_STORAGE_AGGREGATOR_H_
 #define SRC_STORAGE_AGGREGATOR_H_
 
+#include <array>
+#include <condition_variable>  // NOLINT
 #include <memory>
 #include <mutex>
 #include <string>
@@ -28,6 +30,7 @@
 #include "proto/type.pb.h"
 #include "replica/log_replicator.h"
 #include "storage/table.h"
+#include "udf/sketch.h"
 
 namespace openmldb {
 namespace storage {
@@ -43,6 +46,7 @@ enum class AggrType {
     kMax = 3,
     kCount = 4,
     kAvg = 5,
+    kApproxDistinctCount = 6,
 };
 
 enum class WindowType {
@@ -75,6 +79,8 @@ class AggrBuffer {
     int64_t non_null_cnt_;
     int32_t aggr_cnt_;
     DataType data_type_;
+    // the sketch of values for sketch based aggregators, e.g. approx_distinct_count
+    std::unique_ptr<hybridse::udf::sketch::HyperLogLog> sketch_;
     AggrBuffer() : aggr_val_(), ts_begin_(-1), ts_end_(0), binlog_offset_(0), non_null_cnt_(0), aggr_cnt_(0) {}
     AggrBuffer(const AggrBuffer& buffer) {
         memcpy(&aggr_val_, &buffer.aggr_val_, sizeof(aggr_val_));
@@ -90,6 +96,9 @@ class AggrBuffer {
                 memcpy(aggr_val_.vstring.data, buffer.aggr_val_.vstring.data, buffer.aggr_val_.vstring.len);
             }
         }
+        if (buffer.sketch_) {
+            sketch_ = std::make_unique<hybridse::udf::sketch::HyperLogLog>(*buffer.sketch_);
+        }
     }
     AggrBuffer& operator=(const AggrBuffer& buffer) = delete;
     ~AggrBuffer() { clear(); }
@@ -100,6 +109,7 @@ class AggrBuffer {
             }
         }
         memset(&aggr_val_, 0, sizeof(aggr_val_));
+        sketch_.reset();
         ts_begin_ = -1;
         ts_end_ = 0;
         aggr_cnt_ = 0;
@@ -129,6 +139,21 @@ class Aggregator {
 
     bool Update(const std::string& key, const std::string& row, const uint64_t& offset, bool recover = false);
 
+    // the position of a row in the update order of the buffer shard of its key
+    struct UpdateTicket {
+        uint32_t shard_idx = 0;
+        uint64_t seq = 0;
+    };
+
+    // reserve the update order of a row. It should be called within the lock that assigns the binlog
+    // offsets, so the rows of a key are updated in order of offset
+    UpdateTicket ReserveUpdate(const std::string& key);
+
+    // update a reserved row out of the binlog lock. It waits for the rows reserved before it in the same
+    // shard, and the rows of different shards are updated in parallel. Every reserved ticket must be
+    // updated exactly once, otherwise the later rows of the shard wait forever
+    bool Update(const std::string& key, const std::string& row, const uint64_t& offset, const UpdateTicket& ticket);
+
     bool Delete(const std::string& key);
 
     bool FlushAll();
@@ -156,12 +181,31 @@ class Aggregator {
     // set the filter column info that not initialized in constructor
     bool SetFilter(absl::string_view filter_col);
 
+    // set the category column of *_cate ops, the buffers are split by the category like the filter key
+    // of *_where ops, and the rows whose value or category is null are skipped
+    bool SetCategory(absl::string_view cate_col);
+
  protected:
     codec::Schema base_table_schema_;
     codec::Schema aggr_table_schema_;
 
     using FilterMap = std::unordered_map<std::string, AggrBufferLocked>;  // filter_column -> aggregator buffer
-    std::unordered_map<std::string, FilterMap> aggr_buffer_map_;          // key -> filter_map
+    // the buffers are striped by the hash of key, so the updates, flushes and deletes of
+    // different keys don't contend on a single lock
+    struct BufferShard {
+        std::mutex mu;
+        std::unordered_map<std::string, FilterMap> buffer_map;  // key -> filter_map
+        // the reserved updates of the shard are applied in order of seq, see ReserveUpdate
+        std::condition_variable update_cv;
+        uint64_t reserved_seq = 0;
+        uint64_t applied_seq = 0;
+    };
+    static constexpr uint32_t kBufferShardNum = 64;
+    std::array<BufferShard, kBufferShardNum> buffer_shards_;
+    static uint32_t GetShardIdx(const std::string& key) {
+        return std::hash<std::string>{}(key) % kBufferShardNum;
+    }
+    BufferShard& GetShard(const std::string& key) { return buffer_shards_[GetShardIdx(key)]; }
     std::mutex mu_;
     DataType aggr_col_type_;
     DataType ts_col_type_;
@@ -199,6 +243,7 @@ class Aggregator {
     int ts_col_idx_;
     std::string filter_col_;
     int filter_col_idx_;
+    bool is_cate_ = false;
     WindowType window_type_;
 
     // for kRowsNum, window_size_ is the rows num in mini window
@@ -207,7 +252,6 @@ class Aggregator {
 
     codec::RowView base_row_view_;
     codec::RowView aggr_row_view_;
-    codec::RowBuilder row_builder_;
 };
 
 class SumAggregator : public Aggregator {
@@ -303,6 +347,26 @@ class AvgAggregator : public Aggregator {
     bool DecodeAggrVal(const int8_t* row_ptr, AggrBuffer* buffer) override;
 };
 
+// ApproxDistinctCountAggregator keeps a HyperLogLog sketch of the values in the buffer, the sketches of
+// buckets are merged to estimate the distinct count of the whole window
+class ApproxDistinctCountAggregator : public Aggregator {
+ public:
+    ApproxDistinctCountAggregator(const ::openmldb::api::TableMeta& base_meta,
+                                  const ::openmldb::api::TableMeta& aggr_meta, std::shared_ptr<Table> aggr_table,
+                                  std::shared_ptr<LogReplicator> aggr_replicator, const uint32_t& index_pos,
+                                  const std::string& aggr_col, const AggrType& aggr_type, const std::string& ts_col,
+                                  WindowType window_tpye, uint32_t window_size);
+
+    ~ApproxDistinctCountAggregator() = default;
+
+ private:
+    bool UpdateAggrVal(const codec::RowView& row_view, const int8_t* row_ptr, AggrBuffer* aggr_buffer) override;
+
+    bool EncodeAggrVal(const AggrBuffer& buffer, std::string* aggr_val) override;
+
+    bool DecodeAggrVal(const int8_t* row_ptr, AggrBuffer* buffer) override;
+};
+
 std::shared_ptr<Aggregator> CreateAggregator(const ::openmldb::api::TableMeta& base_meta,
                                              const ::openmldb::api::TableMeta& aggr_meta,
                                              std::shared_ptr<Table> aggr_table,
@@ -14,11 +14,17 @@
  * limitations under the License.
  */
 
+#include <atomic>
 #include <map>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
 #include <utility>
+#include <vector>
 #include "gtest/gtest.h"
 
+#include "absl/strings/str_cat.h"
 #include "base/file_util.h"
+#include "base/glog_wrapper.h"
 #include "codec/schema_codec.h"
 #include "common/timer.h"
 #include "storage/aggregator.h"
@@ -720,6 +726,182 @@ TEST_F(AggregatorTest, CountWhereAggregatorUpdate) {
     ASSERT_EQ(last_buffer->non_null_cnt_, 0);
 }
 
+TEST_F(AggregatorTest, SumCateAggregatorUpdate) {
+    std::shared_ptr<Aggregator> aggregator;
+    AggrBuffer* last_buffer;
+    std::shared_ptr<Table> aggr_table;
+    ASSERT_TRUE(GetUpdatedResult(counter, "col3", "sum_cate", "1s", aggregator, aggr_table, &last_buffer));
+    // the buffers are split by the category low_card, the same as the filter key of count_where
+    ASSERT_EQ(aggr_table->GetRecordCnt(), 99);
+    auto it = aggr_table->NewTraverseIterator(0);
+    it->SeekToFirst();
+    while (it->Valid()) {
+        auto val = it->GetValue();
+        codec::RowView row_view(aggr_table->GetTableMeta()->column_desc(),
+                                reinterpret_cast<int8_t*>(const_cast<char*>(val.data())), val.size());
+        int64_t ts_start;
+        std::string fk;
+        char* ch = NULL;
+        uint32_t ch_length = 0;
+        row_view.GetTimestamp(1, &ts_start);
+        row_view.GetString(4, &ch, &ch_length);
+        row_view.GetStrValue(6, &fk);
+        // the bucket k has the row 2k of category 0 and the row 2k + 1 of category 1
+        ASSERT_EQ(ts_start / aggregator->GetWindowSize() * 2 + std::stoi(fk), *reinterpret_cast<int64_t*>(ch));
+        it->Next();
+    }
+    ASSERT_TRUE(aggregator->GetAggrBuffer("id1|id2", "0", &last_buffer));
+    ASSERT_EQ(last_buffer->aggr_val_.vlong, 100);
+    ASSERT_TRUE(aggregator->GetAggrBuffer("id1|id2", "1", &last_buffer));
+    ASSERT_EQ(last_buffer->aggr_val_.vlong, 99);
+    counter += 2;
+    // the rows of null value are skipped
+    ASSERT_TRUE(GetUpdatedResult(counter, "col_null", "sum_cate", "1s", aggregator, aggr_table, &last_buffer));
+    ASSERT_EQ(aggr_table->GetRecordCnt(), 0);
+    ASSERT_FALSE(aggregator->GetAggrBuffer("id1|id2", "0", &last_buffer));
+}
+
+TEST_F(AggregatorTest, ApproxDistinctCountAggregatorUpdate) {
+    auto check = [](std::shared_ptr<Table> aggr_table, uint64_t bucket_cnt, uint64_t total_cnt) {
+        ASSERT_EQ(aggr_table->GetRecordCnt(), 50);
+        hybridse::udf::sketch::HyperLogLog merged;
+        auto it = aggr_table->NewTraverseIterator(0);
+        it->SeekToFirst();
+        while (it->Valid()) {
+            auto val = it->GetValue();
+            codec::RowView row_view(aggr_table->GetTableMeta()->column_desc(),
+                                    reinterpret_cast<int8_t*>(const_cast<char*>(val.data())), val.size());
+            char* ch = NULL;
+            uint32_t ch_length = 0;
+            row_view.GetString(4, &ch, &ch_length);
+            hybridse::udf::sketch::HyperLogLog sketch;
+            ASSERT_TRUE(sketch.Deserialize(ch, ch_length));
+            ASSERT_EQ(bucket_cnt, sketch.Estimate());
+            merged.Merge(sketch);
+            it->Next();
+        }
+        ASSERT_NEAR(total_cnt, merged.Estimate(), total_cnt * 0.05);
+    };
+    std::shared_ptr<Aggregator> aggregator;
+    AggrBuffer* last_buffer;
+    std::shared_ptr<Table> aggr_table;
+    // every bucket has "abc" and "hello"
+    ASSERT_TRUE(GetUpdatedResult(counter, "col9", "approx_distinct_count", "1s", aggregator, aggr_table,
+                                 &last_buffer));
+    check(aggr_table, 2, 2);
+    ASSERT_EQ(last_buffer->sketch_->Estimate(), 1u);
+    ASSERT_EQ(last_buffer->non_null_cnt_, 1);
+    counter += 2;
+    ASSERT_TRUE(GetUpdatedResult(counter, "col3", "approx_distinct_count", "1m", aggregator, aggr_table,
+                                 &last_buffer));
+    check(aggr_table, 2, 100);
+    counter += 2;
+    ASSERT_TRUE(GetUpdatedResult(counter, "col_null", "approx_distinct_count", "1s", aggregator, aggr_table,
+                                 &last_buffer));
+    check(aggr_table, 0, 0);
+    ASSERT_EQ(last_buffer->non_null_cnt_, 0);
+}
+
+// benchmark of updates from 64 writers following the put path of tablet: the binlog offset is assigned
+// under a lock like the replicator lock, and the writers share the keys. The rows are either updated
+// within the lock, or only reserved within it and updated out of it
+TEST_F(AggregatorTest, ConcurrentUpdate) {
+    const int thread_num = 64;
+    const int key_num = 64;
+    const int row_num = 200;
+    auto run = [&](bool reserve) {
+        uint32_t id = counter;
+        counter += 2;
+        ::openmldb::api::TableMeta base_table_meta;
+        base_table_meta.set_tid(id);
+        AddDefaultAggregatorBaseSchema(&base_table_meta);
+        ::openmldb::api::TableMeta aggr_table_meta;
+        aggr_table_meta.set_tid(id + 1);
+        AddDefaultAggregatorSchema(&aggr_table_meta);
+        std::shared_ptr<Table> aggr_table = std::make_shared<MemTable>(aggr_table_meta);
+        aggr_table->Init();
+        std::map<std::string, std::string> map;
+        std::string folder = "/tmp/" + GenRand() + "/";
+        std::shared_ptr<LogReplicator> replicator = std::make_shared<LogReplicator>(
+            aggr_table->GetId(), aggr_table->GetPid(), folder, map, ::openmldb::replica::kLeaderNode);
+        replicator->Init();
+        auto aggr = CreateAggregator(base_table_meta, aggr_table_meta, aggr_table, replicator, 0, "col3", "sum",
+                                     "ts_col", "1h");
+        std::shared_ptr<LogReplicator> base_replicator = std::make_shared<LogReplicator>(
+            base_table_meta.tid(), base_table_meta.pid(), folder, map, ::openmldb::replica::kLeaderNode);
+        base_replicator->Init();
+        ASSERT_TRUE(aggr->Init(base_replicator));
+
+        codec::RowBuilder row_builder(base_table_meta.column_desc());
+        std::vector<std::string> rows(row_num);
+        for (int i = 0; i < row_num; i++) {
+            uint32_t row_size = row_builder.CalTotalLength(9);
+            rows[i].resize(row_size);
+            row_builder.SetBuffer(reinterpret_cast<int8_t*>(&(rows[i][0])), row_size);
+            row_builder.AppendString("id1", 3);
+            row_builder.AppendString("id2", 3);
+            row_builder.AppendTimestamp(i);
+            row_builder.AppendInt32(1);
+            row_builder.AppendInt16(i);
+            row_builder.AppendInt64(i);
+            row_builder.AppendFloat(static_cast<float>(i));
+            row_builder.AppendDouble(static_cast<double>(i));
+            row_builder.AppendDate(i);
+            row_builder.AppendString("abc", 3);
+            row_builder.AppendNULL();
+            row_builder.AppendInt32(i % 2);
+        }
+        std::mutex binlog_mu;
+        uint64_t binlog_offset = 0;
+        std::vector<uint64_t> last_offset(key_num, 0);
+        std::atomic<bool> ok{true};
+        std::vector<std::thread> threads;
+        uint64_t start = ::baidu::common::timer::get_micros();
+        for (int t = 0; t < thread_num; t++) {
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < row_num; i++) {
+                    for (int k = 0; k < key_num; k++) {
+                        int key_idx = (t + k) % key_num;
+                        std::string key = absl::StrCat("key_", key_idx);
+                        std::unique_lock<std::mutex> lock(binlog_mu);
+                        uint64_t offset = ++binlog_offset;
+                        last_offset[key_idx] = offset;
+                        bool updated = true;
+                        if (reserve) {
+                            auto ticket = aggr->ReserveUpdate(key);
+                            lock.unlock();
+                            updated = aggr->Update(key, rows[i], offset, ticket);
+                        } else {
+                            updated = aggr->Update(key, rows[i], offset);
+                        }
+                        if (!updated) {
+                            ok = false;
+                        }
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        uint64_t elapsed = ::baidu::common::timer::get_micros() - start;
+        ASSERT_TRUE(ok);
+        PDLOG(INFO, "%d writers updated %d rows %s the binlog lock in %lu us", thread_num,
+              thread_num * key_num * row_num, reserve ? "out of" : "within", elapsed);
+        for (int k = 0; k < key_num; k++) {
+            AggrBuffer* buffer;
+            ASSERT_TRUE(aggr->GetAggrBuffer(absl::StrCat("key_", k), &buffer));
+            ASSERT_EQ(buffer->aggr_cnt_, thread_num * row_num);
+            ASSERT_EQ(buffer->aggr_val_.vlong, thread_num * row_num);
+            // the rows of a key are applied in order of offset
+            ASSERT_EQ(buffer->binlog_offset_, last_offset[k]);
+        }
+        ::openmldb::base::RemoveDirRecursive(folder);
+    };
+    run(false);
+    run(true);
+}
+
 TEST_F(AggregatorTest, OutOfOrder) {
     std::map<std::string, std::string> map;
     std::string folder = "/tmp/" + GenRand() + "/";
@@ -21,6 +21,7 @@
 #include "base/glog_wrapper.h"
 #include "base/hash.h"
 #include "config.h"  // NOLINT
+#include "rocksdb/convenience.h"
 
 DECLARE_bool(disable_wal);
 DECLARE_uint32(max_traverse_cnt);
@@ -30,6 +31,8 @@ DECLARE_uint32(block_cache_mb);
 DECLARE_uint32(write_buffer_mb);
 DECLARE_uint32(block_cache_shardbits);
 DECLARE_bool(verify_compression);
+DECLARE_uint32(disk_bloom_bits_per_key);
+DECLARE_uint32(ssd_block_size_kb);
 
 namespace openmldb {
 namespace storage {
@@ -45,7 +48,10 @@ DiskTable::DiskTable(const std::string& name, uint32_t id, uint32_t pid, const s
             ::openmldb::type::CompressType::kNoCompress),
       write_opts_(),
       offset_(0),
-      table_path_(table_path) {
+      table_path_(table_path),
+      row_layout_(::openmldb::common::kRowPerIndex),
+      next_row_id_(0),
+      opened_(false) {
     if (!options_template_initialized) {
         initOptionTemplate();
     }
@@ -59,7 +65,10 @@ DiskTable::DiskTable(const ::openmldb::api::TableMeta& table_meta, const std::st
             ::openmldb::type::CompressType::kNoCompress),
       write_opts_(),
       offset_(0),
-      table_path_(table_path) {
+      table_path_(table_path),
+      row_layout_(table_meta.disk_row_layout()),
+      next_row_id_(0),
+      opened_(false) {
     if (!options_template_initialized) {
         initOptionTemplate();
     }
@@ -70,6 +79,10 @@ DiskTable::DiskTable(const ::openmldb::api::TableMeta& table_meta, const std::st
 }
 
 DiskTable::~DiskTable() {
+    if (db_ != nullptr) {
+        // the compaction filter of rows refers to the column families
+        rocksdb::CancelAllBackgroundWork(db_, true);
+    }
     for (auto handle : cf_hs_) {
         delete handle;
     }
@@ -99,13 +112,22 @@ void DiskTable::initOptionTemplate() {
         ssd_option_template.max_bytes_for_level_base >> 4;  // number of L1 files = 16
 
     rocksdb::BlockBasedTableOptions table_options;
-    // table_options.cache_index_and_filter_blocks = true;
-    // table_options.pin_l0_filter_and_index_blocks_in_cache = true;
     table_options.block_cache = cache;
-    // table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10,
-    // false));
+    if (FLAGS_disk_bloom_bits_per_key > 0) {
+        // the filter is built on the prefix of KeyTsPrefixTransform, i.e. the pk, so the point
+        // lookups of a pk skip the files without it. The index and filters are partitioned and
+        // cached in block cache with the top level pinned, so they don't occupy the memory out of
+        // block cache and the lookups only load the partitions they need
+        table_options.filter_policy.reset(rocksdb::NewBloomFilterPolicy(FLAGS_disk_bloom_bits_per_key, false));
+        table_options.index_type = rocksdb::BlockBasedTableOptions::kTwoLevelIndexSearch;
+        table_options.partition_filters = true;
+        table_options.cache_index_and_filter_blocks = true;
+        table_options.cache_index_and_filter_blocks_with_high_priority = true;
+        table_options.pin_top_level_index_and_filter = true;
+        table_options.pin_l0_filter_and_index_blocks_in_cache = true;
+    }
     table_options.whole_key_filtering = false;
-    table_options.block_size = 256 << 10;
+    table_options.block_size = FLAGS_ssd_block_size_kb << 10;
     table_options.use_delta_encoding = false;
 #ifdef PZFPGA_ENABLE
     if (FLAGS_file_compression.compare("pz") == 0) {
@@ -142,6 +164,8 @@ void DiskTable::initOptionTemplate() {
     hdd_option_template.write_buffer_size = 256 << 20;
     hdd_option_template.target_file_size_base = 256 << 20;
     hdd_option_template.max_bytes_for_level_base = 1024 << 20;
+    // the seeks are expensive on hdd, keep the large blocks for the scans
+    table_options.block_size = 256 << 10;
     hdd_option_template.table_factory.reset(rocksdb::NewBlockBasedTableFactory(table_options));
 
     options_template_initialized = true;
@@ -149,8 +173,22 @@ void DiskTable::initOptionTemplate() {
 
 bool DiskTable::InitColumnFamilyDescriptor() {
     cf_ds_.clear();
-    cf_ds_.push_back(
-        rocksdb::ColumnFamilyDescriptor(rocksdb::kDefaultColumnFamilyName, rocksdb::ColumnFamilyOptions()));
+    if (row_layout_ == ::openmldb::common::kSingleRow) {
+        rocksdb::ColumnFamilyOptions cfo;
+        if (storage_mode_ == ::openmldb::common::StorageMode::kSSD) {
+            cfo = rocksdb::ColumnFamilyOptions(ssd_option_template);
+        } else {
+            cfo = rocksdb::ColumnFamilyOptions(hdd_option_template);
+        }
+        cfo.compaction_filter_factory = std::make_shared<RowRefFilterFactory>(this);
+        // the rows are dropped only by compaction after the index entries are gone,
+        // so compact the files not compacted for a day
+        cfo.periodic_compaction_seconds = 24 * 60 * 60;
+        cf_ds_.push_back(rocksdb::ColumnFamilyDescriptor(rocksdb::kDefaultColumnFamilyName, cfo));
+    } else {
+        cf_ds_.push_back(
+            rocksdb::ColumnFamilyDescriptor(rocksdb::kDefaultColumnFamilyName, rocksdb::ColumnFamilyOptions()));
+    }
     auto inner_indexs = table_index_.GetAllInnerIndex();
     for (const auto& inner_index : *inner_indexs) {
         rocksdb::ColumnFamilyOptions cfo;
@@ -165,9 +203,14 @@ bool DiskTable::InitColumnFamilyDescriptor() {
         cfo.prefix_extractor.reset(new KeyTsPrefixTransform());
         const auto& indexs = inner_index->GetIndex();
         auto index_def = indexs.front();
-        if (index_def->GetTTLType() == ::openmldb::storage::TTLType::kAbsoluteTime ||
-            index_def->GetTTLType() == ::openmldb::storage::TTLType::kAbsOrLat) {
-            cfo.compaction_filter_factory = std::make_shared<AbsoluteTTLFilterFactory>(inner_index);
+        // the expired entries are dropped by compaction, compact the files not compacted for
+        // a day if any ttl is set, so the entries of cold pks are dropped too
+        cfo.compaction_filter_factory = std::make_shared<TTLFilterFactory>(inner_index);
+        for (const auto& index : indexs) {
+            if (index->GetTTL()->NeedGc()) {
+                cfo.periodic_compaction_seconds = 24 * 60 * 60;
+                break;
+            }
         }
         cf_ds_.push_back(rocksdb::ColumnFamilyDescriptor(index_def->GetName(), cfo));
         DEBUGLOG("add cf_name %s. tid %u pid %u", index_def->GetName().c_str(), id_, pid_);
@@ -197,16 +240,168 @@ bool DiskTable::Init() {
         PDLOG(WARNING, "rocksdb open failed. tid %u pid %u error %s", id_, pid_, s.ToString().c_str());
         return false;
     }
-    PDLOG(INFO, "Open DB. tid %u pid %u ColumnFamilyHandle size %u with data path %s", id_, pid_, GetIdxCnt(),
-          path.c_str());
+    if (row_layout_ == ::openmldb::common::kSingleRow) {
+        // continue the row ids after the last row
+        rocksdb::Iterator* it = db_->NewIterator(rocksdb::ReadOptions(), cf_hs_[0]);
+        it->SeekToLast();
+        if (it->Valid()) {
+            next_row_id_.store(DecodeRowId(it->key()) + 1, std::memory_order_relaxed);
+        }
+        delete it;
+    }
+    opened_.store(true, std::memory_order_release);
+    PDLOG(INFO, "Open DB. tid %u pid %u ColumnFamilyHandle size %u with data path %s row layout %s", id_, pid_,
+          GetIdxCnt(), path.c_str(), ::openmldb::common::DiskRowLayout_Name(row_layout_).c_str());
     return true;
 }
 
+void DiskTable::PutRow(const std::string& row_id, const std::string& refs, const rocksdb::Slice& value,
+                       rocksdb::WriteBatch* batch) {
+    // the row value is | refs size | refs | row |, and every ref is | inner pos | key size | key |
+    uint32_t refs_size = refs.size();
+    rocksdb::Slice parts[3] = {rocksdb::Slice(reinterpret_cast<const char*>(&refs_size), sizeof(uint32_t)),
+                               rocksdb::Slice(refs), value};
+    rocksdb::Slice key(row_id);
+    batch->Put(cf_hs_[0], rocksdb::SliceParts(&key, 1), rocksdb::SliceParts(parts, 3));
+}
+
+static void AppendRowRef(uint32_t inner_pos, const std::string& key, std::string* refs) {
+    uint32_t key_size = key.size();
+    refs->append(reinterpret_cast<const char*>(&inner_pos), sizeof(uint32_t));
+    refs->append(reinterpret_cast<const char*>(&key_size), sizeof(uint32_t));
+    refs->append(key);
+}
+
+bool DiskTable::IsRowReferenced(const rocksdb::Slice& row_id, const rocksdb::Slice& row_value) {
+    if (!opened_.load(std::memory_order_acquire) || row_value.size() < sizeof(uint32_t)) {
+        return true;
+    }
+    uint32_t refs_size = 0;
+    memcpy(&refs_size, row_value.data(), sizeof(uint32_t));
+    if (row_value.size() < sizeof(uint32_t) + refs_size) {
+        return true;
+    }
+    const char* ptr = row_value.data() + sizeof(uint32_t);
+    const char* end = ptr + refs_size;
+    std::string ref;
+    while (ptr + 2 * sizeof(uint32_t) <= end) {
+        uint32_t inner_pos = 0;
+        uint32_t key_size = 0;
+        memcpy(&inner_pos, ptr, sizeof(uint32_t));
+        memcpy(&key_size, ptr + sizeof(uint32_t), sizeof(uint32_t));
+        ptr += 2 * sizeof(uint32_t);
+        if (inner_pos + 1 >= cf_hs_.size() || ptr + key_size > end) {
+            return true;
+        }
+        rocksdb::Status s = db_->Get(rocksdb::ReadOptions(), cf_hs_[inner_pos + 1], rocksdb::Slice(ptr, key_size), &ref);
+        ptr += key_size;
+        if (s.ok() && rocksdb::Slice(ref) == row_id) {
+            return true;
+        } else if (!s.ok() && !s.IsNotFound()) {
+            // keep the row if it's unknown
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RowRefCompactionFilter::Filter(int /*level*/, const rocksdb::Slice& key, const rocksdb::Slice& existing_value,
+                                    std::string* /*new_value*/, bool* /*value_changed*/) const {
+    return !table_->IsRowReferenced(key, existing_value);
+}
+
+RowRefResolver* DiskTable::NewRowRefResolver(uint32_t inner_pos, const rocksdb::Snapshot* snapshot) {
+    if (row_layout_ != ::openmldb::common::kSingleRow) {
+        return nullptr;
+    }
+    return new RowRefResolver(db_, snapshot, cf_hs_[inner_pos + 1], cf_hs_[0]);
+}
+
+RowRefResolver::RowRefResolver(rocksdb::DB* db, const rocksdb::Snapshot* snapshot,
+                               rocksdb::ColumnFamilyHandle* index_cf, rocksdb::ColumnFamilyHandle* row_cf)
+    : db_(db), ro_(), index_cf_(index_cf), row_cf_(row_cf), ahead_(nullptr), rows_(nullptr), pos_(0) {
+    ro_.snapshot = snapshot;
+    ro_.prefix_same_as_start = true;
+}
+
+RowRefResolver::~RowRefResolver() { delete ahead_; }
+
+rocksdb::Slice RowRefResolver::Resolve(const rocksdb::Iterator* it) {
+    rocksdb::Slice id = it->value();
+    // the entries are visited in order mostly, so the id is at or after pos_
+    for (size_t i = pos_; i < ids_.size(); i++) {
+        if (rocksdb::Slice(ids_[i]) == id) {
+            pos_ = i;
+            return GetRow(i);
+        }
+    }
+    Fetch(it->key());
+    if (ids_.empty() || rocksdb::Slice(ids_[0]) != id) {
+        PDLOG(WARNING, "fail to read ahead the row of entry");
+        return rocksdb::Slice();
+    }
+    return GetRow(0);
+}
+
+void RowRefResolver::Fetch(const rocksdb::Slice& key) {
+    ids_.clear();
+    rows_ = nullptr;
+    statuses_.clear();
+    pos_ = 0;
+    if (ahead_ == nullptr) {
+        ahead_ = db_->NewIterator(ro_, index_cf_);
+    }
+    if (key.size() < TS_LEN) {
+        return;
+    }
+    // the entries of the same key and ts column share the prefix
+    rocksdb::Slice prefix(key.data(), key.size() - TS_LEN);
+    for (ahead_->Seek(key); ahead_->Valid() && ids_.size() < kBatchSize; ahead_->Next()) {
+        if (!ahead_->key().starts_with(prefix) || ahead_->key().size() != key.size()) {
+            break;
+        }
+        ids_.emplace_back(ahead_->value().ToString());
+    }
+    if (ids_.empty()) {
+        return;
+    }
+    std::vector<rocksdb::Slice> keys(ids_.begin(), ids_.end());
+    // keep the rows of previous batches, they may be still referenced by the callers
+    batches_.emplace_back(new rocksdb::PinnableSlice[ids_.size()]);
+    rows_ = batches_.back().get();
+    statuses_.resize(ids_.size());
+    db_->MultiGet(ro_, row_cf_, keys.size(), keys.data(), rows_, statuses_.data());
+}
+
+rocksdb::Slice RowRefResolver::GetRow(size_t pos) const {
+    const auto& row = rows_[pos];
+    uint32_t refs_size = 0;
+    if (!statuses_[pos].ok() || row.size() < sizeof(uint32_t)) {
+        PDLOG(WARNING, "fail to get row. status %s", statuses_[pos].ToString().c_str());
+        return rocksdb::Slice();
+    }
+    memcpy(&refs_size, row.data(), sizeof(uint32_t));
+    if (row.size() < sizeof(uint32_t) + refs_size) {
+        return rocksdb::Slice();
+    }
+    return rocksdb::Slice(row.data() + sizeof(uint32_t) + refs_size, row.size() - sizeof(uint32_t) - refs_size);
+}
+
 bool DiskTable::Put(const std::string& pk, uint64_t time, const char* data, uint32_t size) {
     rocksdb::Status s;
     std::string combine_key = CombineKeyTs(pk, time);
     rocksdb::Slice spk = rocksdb::Slice(combine_key);
-    s = db_->Put(write_opts_, cf_hs_[1], spk, rocksdb::Slice(data, size));
+    if (row_layout_ == ::openmldb::common::kSingleRow) {
+        rocksdb::WriteBatch batch;
+        std::string row_id = EncodeRowId(next_row_id_.fetch_add(1, std::memory_order_relaxed));
+        std::string refs;
+        AppendRowRef(0, combine_key, &refs);
+        batch.Put(cf_hs_[1], spk, row_id);
+        PutRow(row_id, refs, rocksdb::Slice(data, size), &batch);
+        s = db_->Write(write_opts_, &batch);
+    } else {
+        s = db_->Put(write_opts_, cf_hs_[1], spk, rocksdb::Slice(data, size));
+    }
     if (s.ok()) {
         offset_.fetch_add(1, std::memory_order_relaxed);
         return true;
@@ -230,6 +425,11 @@ bool DiskTable::Put(uint64_t time, const std::string& value, const Dimensions& d
         return false;
     }
     rocksdb::WriteBatch batch;
+    std::string row_id;
+    std::string refs;
+    if (row_layout_ == ::openmldb::common::kSingleRow) {
+        row_id = EncodeRowId(next_row_id_.fetch_add(1, std::memory_order_relaxed));
+    }
     for (auto it = dimensions.begin(); it != dimensions.end(); ++it) {
         auto index_def = table_index_.GetIndex(it->idx());
         if (!index_def || !index_def->IsReady()) {
@@ -254,9 +454,17 @@ bool DiskTable::Put(uint64_t time, const std::string& value, const Dimensions& d
                 combine_key = CombineKeyTs(it->key(), ts);
             }
             rocksdb::Slice spk = rocksdb::Slice(combine_key);
-            batch.Put(cf_hs_[inner_pos + 1], spk, value);
+            if (row_id.empty()) {
+                batch.Put(cf_hs_[inner_pos + 1], spk, value);
+            } else {
+                batch.Put(cf_hs_[inner_pos + 1], spk, row_id);
+                AppendRowRef(inner_pos, combine_key, &refs);
+            }
         }
     }
+    if (!refs.empty()) {
+        PutRow(row_id, refs, value, &batch);
+    }
     auto s = db_->Write(write_opts_, &batch);
     if (s.ok()) {
         offset_.fetch_add(1, std::memory_order_relaxed);
@@ -317,132 +525,10 @@ bool DiskTable::Get(uint32_t idx, const std::string& pk, uint64_t ts, std::strin
 bool DiskTable::Get(const std::string& pk, uint64_t ts, std::string& value) { return Get(0, pk, ts, value); }
 
 void DiskTable::SchedGc() {
-    GcHead();
+    // the expired entries are dropped by TTLCompactionFilter, no scan is needed
     UpdateTTL();
 }
 
-void DiskTable::GcHead() {
-    uint64_t start_time = ::baidu::common::timer::get_micros() / 1000;
-    auto inner_indexs = table_index_.GetAllInnerIndex();
-    for (const auto& inner_index : *inner_indexs) {
-        uint32_t idx = inner_index->GetId();
-        rocksdb::ReadOptions ro = rocksdb::ReadOptions();
-        const rocksdb::Snapshot* snapshot = db_->GetSnapshot();
-        ro.snapshot = snapshot;
-        // ro.prefix_same_as_start = true;
-        ro.pin_data = true;
-        rocksdb::Iterator* it = db_->NewIterator(ro, cf_hs_[idx + 1]);
-        it->SeekToFirst();
-        const auto& indexs = inner_index->GetIndex();
-        if (indexs.size() > 1) {
-            bool need_ttl = false;
-            std::map<uint32_t, uint64_t> ttl_map;
-            for (const auto& index : indexs) {
-                auto ts_col = index->GetTsColumn();
-                if (ts_col) {
-                    auto lat_ttl = index->GetTTL()->lat_ttl;
-                    if (lat_ttl > 0) {
-                        ttl_map.emplace(ts_col->GetId(), lat_ttl);
-                        need_ttl = true;
-                    }
-                }
-            }
-            if (!need_ttl) {
-                continue;
-            }
-            std::map<uint32_t, uint32_t> key_cnt;
-            std::map<uint32_t, uint64_t> delete_key_map;
-            std::string last_pk;
-            while (it->Valid()) {
-                std::string cur_pk;
-                uint64_t ts = 0;
-                uint32_t ts_idx = 0;
-                ParseKeyAndTs(true, it->key(), cur_pk, ts, ts_idx);
-                if (!last_pk.empty() && cur_pk == last_pk) {
-                    auto ttl_iter = ttl_map.find(ts_idx);
-                    if (ttl_iter != ttl_map.end() && ttl_iter->second > 0) {
-                        auto key_cnt_iter = key_cnt.find(ts_idx);
-                        if (key_cnt_iter == key_cnt.end()) {
-                            key_cnt.insert(std::make_pair(ts_idx, 1));
-                        } else {
-                            key_cnt_iter->second++;
-                        }
-                        if (key_cnt_iter->second > ttl_iter->second &&
-                            delete_key_map.find(ts_idx) == delete_key_map.end()) {
-                            delete_key_map.insert(std::make_pair(ts_idx, ts));
-                        }
-                    }
-                } else {
-                    for (const auto& kv : delete_key_map) {
-                        std::string combine_key1 = CombineKeyTs(last_pk, kv.second, kv.first);
-                        std::string combine_key2 = CombineKeyTs(last_pk, 0, kv.first);
-                        rocksdb::Status s = db_->DeleteRange(write_opts_, cf_hs_[idx + 1], rocksdb::Slice(combine_key1),
-                                                             rocksdb::Slice(combine_key2));
-                        if (!s.ok()) {
-                            PDLOG(WARNING, "Delete failed. tid %u pid %u msg %s", id_, pid_, s.ToString().c_str());
-                        }
-                    }
-                    delete_key_map.clear();
-                    key_cnt.clear();
-                    key_cnt.insert(std::make_pair(ts_idx, 1));
-                    last_pk = cur_pk;
-                }
-                it->Next();
-            }
-            for (const auto& kv : delete_key_map) {
-                std::string combine_key1 = CombineKeyTs(last_pk, kv.second, kv.first);
-                std::string combine_key2 = CombineKeyTs(last_pk, 0, kv.first);
-                rocksdb::Status s = db_->DeleteRange(write_opts_, cf_hs_[idx + 1], rocksdb::Slice(combine_key1),
-                                                     rocksdb::Slice(combine_key2));
-                if (!s.ok()) {
-                    PDLOG(WARNING, "Delete failed. tid %u pid %u msg %s", id_, pid_, s.ToString().c_str());
-                }
-            }
-        } else {
-            auto index = indexs.front();
-            auto ttl_num = index->GetTTL()->lat_ttl;
-            if (ttl_num < 1) {
-                continue;
-            }
-            std::string last_pk;
-            uint64_t count = 0;
-            while (it->Valid()) {
-                std::string cur_pk;
-                uint64_t ts = 0;
-                ParseKeyAndTs(it->key(), cur_pk, ts);
-                if (!last_pk.empty() && cur_pk == last_pk) {
-                    if (ts == 0 || count < ttl_num) {
-                        it->Next();
-                        count++;
-                        continue;
-                    } else {
-                        std::string combine_key1 = CombineKeyTs(cur_pk, ts);
-                        std::string combine_key2 = CombineKeyTs(cur_pk, 0);
-                        rocksdb::Status s = db_->DeleteRange(write_opts_, cf_hs_[idx + 1], rocksdb::Slice(combine_key1),
-                                                             rocksdb::Slice(combine_key2));
-                        if (!s.ok()) {
-                            PDLOG(WARNING, "Delete failed. tid %u pid %u msg %s", id_, pid_, s.ToString().c_str());
-                        }
-                        it->Seek(rocksdb::Slice(combine_key2));
-                    }
-                } else {
-                    count = 1;
-                    last_pk = cur_pk;
-                    it->Next();
-                }
-            }
-        }
-        delete it;
-        db_->ReleaseSnapshot(snapshot);
-    }
-    uint64_t time_used = ::baidu::common::timer::get_micros() / 1000 - start_time;
-    PDLOG(INFO, "Gc used %lu second. tid %u pid %u", time_used / 1000, id_, pid_);
-}
-
-void DiskTable::GcTTLOrHead() {}
-
-void DiskTable::GcTTLAndHead() {}
-
 // ttl as ms
 uint64_t DiskTable::GetExpireTime(const TTLSt& ttl_st) {
     if (ttl_st.abs_ttl == 0 || ttl_st.ttl_type == ::openmldb::storage::TTLType::kLatestTime) {
@@ -491,13 +577,14 @@ TableIterator* DiskTable::NewIterator(uint32_t idx, const std::string& pk, Ticke
     ro.prefix_same_as_start = true;
     ro.pin_data = true;
     rocksdb::Iterator* it = db_->NewIterator(ro, cf_hs_[inner_pos + 1]);
+    RowRefResolver* resolver = NewRowRefResolver(inner_pos, snapshot);
     if (inner_index && inner_index->GetIndex().size() > 1) {
         auto ts_col = index_def->GetTsColumn();
         if (ts_col) {
-            return new DiskTableIterator(db_, it, snapshot, pk, ts_col->GetId());
+            return new DiskTableIterator(db_, it, snapshot, pk, ts_col->GetId(), resolver);
         }
     }
-    return new DiskTableIterator(db_, it, snapshot, pk);
+    return new DiskTableIterator(db_, it, snapshot, pk, resolver);
 }
 
 TraverseIterator* DiskTable::NewTraverseIterator(uint32_t index) {
@@ -513,30 +600,33 @@ TraverseIterator* DiskTable::NewTraverseIterator(uint32_t index) {
     rocksdb::ReadOptions ro = rocksdb::ReadOptions();
     const rocksdb::Snapshot* snapshot = db_->GetSnapshot();
     ro.snapshot = snapshot;
-    // ro.prefix_same_as_start = true;
+    // the iterator moves across pks, the prefix bloom filter can't be used
+    ro.total_order_seek = true;
     ro.pin_data = true;
     rocksdb::Iterator* it = db_->NewIterator(ro, cf_hs_[inner_pos + 1]);
+    RowRefResolver* resolver = NewRowRefResolver(inner_pos, snapshot);
     if (inner_index && inner_index->GetIndex().size() > 1) {
         auto ts_col = index_def->GetTsColumn();
         if (ts_col) {
             return new DiskTableTraverseIterator(db_, it, snapshot, ttl->ttl_type, expire_time, expire_cnt,
-                                                 ts_col->GetId());
+                                                 ts_col->GetId(), resolver);
         }
     }
-    return new DiskTableTraverseIterator(db_, it, snapshot, ttl->ttl_type, expire_time, expire_cnt);
+    return new DiskTableTraverseIterator(db_, it, snapshot, ttl->ttl_type, expire_time, expire_cnt, resolver);
 }
 
 DiskTableIterator::DiskTableIterator(rocksdb::DB* db, rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot,
-                                     const std::string& pk)
-    : db_(db), it_(it), snapshot_(snapshot), pk_(pk), ts_(0) {}
+                                     const std::string& pk, RowRefResolver* resolver)
+    : db_(db), it_(it), snapshot_(snapshot), pk_(pk), ts_(0), resolver_(resolver) {}
 
 DiskTableIterator::DiskTableIterator(rocksdb::DB* db, rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot,
-                                     const std::string& pk, uint32_t ts_idx)
-    : db_(db), it_(it), snapshot_(snapshot), pk_(pk), ts_(0), ts_idx_(ts_idx) {
+                                     const std::string& pk, uint32_t ts_idx, RowRefResolver* resolver)
+    : db_(db), it_(it), snapshot_(snapshot), pk_(pk), ts_(0), ts_idx_(ts_idx), resolver_(resolver) {
     has_ts_idx_ = true;
 }
 
 DiskTableIterator::~DiskTableIterator() {
+    delete resolver_;
     delete it_;
     db_->ReleaseSnapshot(snapshot_);
 }
@@ -554,7 +644,7 @@ bool DiskTableIterator::Valid() {
 void DiskTableIterator::Next() { return it_->Next(); }
 
 openmldb::base::Slice DiskTableIterator::GetValue() const {
-    rocksdb::Slice value = it_->value();
+    rocksdb::Slice value = resolver_ == nullptr ? it_->value() : resolver_->Resolve(it_);
     return openmldb::base::Slice(value.data(), value.size());
 }
 
@@ -585,7 +675,7 @@ void DiskTableIterator::Seek(const uint64_t ts) {
 DiskTableTraverseIterator::DiskTableTraverseIterator(rocksdb::DB* db, rocksdb::Iterator* it,
                                                      const rocksdb::Snapshot* snapshot,
                                                      ::openmldb::storage::TTLType ttl_type, const uint64_t& expire_time,
-                                                     const uint64_t& expire_cnt)
+                                                     const uint64_t& expire_cnt, RowRefResolver* resolver)
     : db_(db),
       it_(it),
       snapshot_(snapshot),
@@ -593,12 +683,14 @@ DiskTableTraverseIterator::DiskTableTraverseIterator(rocksdb::DB* db, rocksdb::I
       expire_value_(expire_time, expire_cnt, ttl_type),
       has_ts_idx_(false),
       ts_idx_(0),
-      traverse_cnt_(0) {}
+      traverse_cnt_(0),
+      resolver_(resolver) {}
 
 DiskTableTraverseIterator::DiskTableTraverseIterator(rocksdb::DB* db, rocksdb::Iterator* it,
                                                      const rocksdb::Snapshot* snapshot,
                                                      ::openmldb::storage::TTLType ttl_type, const uint64_t& expire_time,
-                                                     const uint64_t& expire_cnt, int32_t ts_idx)
+                                                     const uint64_t& expire_cnt, int32_t ts_idx,
+                                                     RowRefResolver* resolver)
     : db_(db),
       it_(it),
       snapshot_(snapshot),
@@ -606,9 +698,11 @@ DiskTableTraverseIterator::DiskTableTraverseIterator(rocksdb::DB* db, rocksdb::I
       expire_value_(expire_time, expire_cnt, ttl_type),
       has_ts_idx_(true),
       ts_idx_(ts_idx),
-      traverse_cnt_(0) {}
+      traverse_cnt_(0),
+      resolver_(resolver) {}
 
 DiskTableTraverseIterator::~DiskTableTraverseIterator() {
+    delete resolver_;
     delete it_;
     db_->ReleaseSnapshot(snapshot_);
 }
@@ -661,7 +755,7 @@ void DiskTableTraverseIterator::Next() {
 }
 
 openmldb::base::Slice DiskTableTraverseIterator::GetValue() const {
-    rocksdb::Slice value = it_->value();
+    rocksdb::Slice value = resolver_ == nullptr ? it_->value() : resolver_->Resolve(it_);
     return openmldb::base::Slice(value.data(), value.size());
 }
 
@@ -847,23 +941,62 @@ void DiskTableTraverseIterator::NextPK() {
     rocksdb::ReadOptions ro = rocksdb::ReadOptions();
     const rocksdb::Snapshot* snapshot = db_->GetSnapshot();
     ro.snapshot = snapshot;
-    // ro.prefix_same_as_start = true;
+    // the iterator moves across pks, the prefix bloom filter can't be used
+    ro.total_order_seek = true;
     ro.pin_data = true;
     rocksdb::Iterator* it = db_->NewIterator(ro, cf_hs_[inner_pos + 1]);
+    rocksdb::ColumnFamilyHandle* row_handle =
+        row_layout_ == ::openmldb::common::kSingleRow ? cf_hs_[0] : nullptr;
     if (inner_index && inner_index->GetIndex().size() > 1) {
         auto ts_col = index_def->GetTsColumn();
         if (ts_col) {
             return new DiskTableKeyIterator(db_, it, snapshot, ttl->ttl_type, expire_time, expire_cnt,
-                                                 ts_col->GetId(), cf_hs_[inner_pos + 1]);
+                                                 ts_col->GetId(), cf_hs_[inner_pos + 1], row_handle);
         }
     }
-    return new DiskTableKeyIterator(db_, it, snapshot, ttl->ttl_type, expire_time, expire_cnt, cf_hs_[inner_pos + 1]);
+    return new DiskTableKeyIterator(db_, it, snapshot, ttl->ttl_type, expire_time, expire_cnt, cf_hs_[inner_pos + 1],
+                                    row_handle);
+}
+
+void DiskTable::Prefetch(uint32_t idx, const std::vector<std::string>& pks) {
+    // a single pk is read by the seek directly
+    if (pks.size() < 2) {
+        return;
+    }
+    std::shared_ptr<IndexDef> index_def = table_index_.GetIndex(idx);
+    if (!index_def) {
+        return;
+    }
+    uint32_t inner_pos = index_def->GetInnerPos();
+    auto inner_index = table_index_.GetInnerIndex(inner_pos);
+    bool has_ts_idx = false;
+    uint32_t ts_idx = 0;
+    if (inner_index && inner_index->GetIndex().size() > 1) {
+        auto ts_col = index_def->GetTsColumn();
+        if (ts_col) {
+            has_ts_idx = true;
+            ts_idx = ts_col->GetId();
+        }
+    }
+    // the seek of a pk starts at the combined key with max ts, the lookup of it reads the same
+    // filter, index and data block, the pks not in a file are skipped by the prefix bloom filter
+    std::vector<std::string> combine_keys;
+    combine_keys.reserve(pks.size());
+    for (const auto& pk : pks) {
+        combine_keys.push_back(has_ts_idx ? CombineKeyTs(pk, UINT64_MAX, ts_idx) : CombineKeyTs(pk, UINT64_MAX));
+    }
+    std::vector<rocksdb::Slice> keys(combine_keys.begin(), combine_keys.end());
+    std::vector<rocksdb::PinnableSlice> values(keys.size());
+    std::vector<rocksdb::Status> statuses(keys.size());
+    db_->MultiGet(rocksdb::ReadOptions(), cf_hs_[inner_pos + 1], keys.size(), keys.data(), values.data(),
+                  statuses.data());
 }
 
 DiskTableKeyIterator::DiskTableKeyIterator(rocksdb::DB* db, rocksdb::Iterator* it,
                                            const rocksdb::Snapshot* snapshot, ::openmldb::storage::TTLType ttl_type,
                                            const uint64_t& expire_time, const uint64_t& expire_cnt,
-                                           rocksdb::ColumnFamilyHandle* column_handle)
+                                           rocksdb::ColumnFamilyHandle* column_handle,
+                                           rocksdb::ColumnFamilyHandle* row_handle)
     : db_(db),
       it_(it),
       snapshot_(snapshot),
@@ -872,12 +1005,14 @@ DiskTableKeyIterator::DiskTableKeyIterator(rocksdb::DB* db, rocksdb::Iterator* i
       expire_cnt_(expire_cnt),
       has_ts_idx_(false),
       ts_idx_(0),
-      column_handle_(column_handle) {}
+      column_handle_(column_handle),
+      row_handle_(row_handle) {}
 
 DiskTableKeyIterator::DiskTableKeyIterator(rocksdb::DB* db, rocksdb::Iterator* it,
                                            const rocksdb::Snapshot* snapshot, ::openmldb::storage::TTLType ttl_type,
                                            const uint64_t& expire_time, const uint64_t& expire_cnt, int32_t ts_idx,
-                                           rocksdb::ColumnFamilyHandle* column_handle)
+                                           rocksdb::ColumnFamilyHandle* column_handle,
+                                           rocksdb::ColumnFamilyHandle* row_handle)
     : db_(db),
       it_(it),
       snapshot_(snapshot),
@@ -886,7 +1021,8 @@ DiskTableKeyIterator::DiskTableKeyIterator(rocksdb::DB* db, rocksdb::Iterator* i
       expire_cnt_(expire_cnt),
       has_ts_idx_(true),
       ts_idx_(ts_idx),
-      column_handle_(column_handle) {}
+      column_handle_(column_handle),
+      row_handle_(row_handle) {}
 
 DiskTableKeyIterator::~DiskTableKeyIterator() {
     delete it_;
@@ -960,28 +1096,32 @@ std::unique_ptr<::hybridse::vm::RowIterator> DiskTableKeyIterator::GetValue() {
     rocksdb::ReadOptions ro = rocksdb::ReadOptions();
     const rocksdb::Snapshot* snapshot = db_->GetSnapshot();
     ro.snapshot = snapshot;
-    // ro.prefix_same_as_start = true;
+    ro.prefix_same_as_start = true;
     ro.pin_data = true;
     rocksdb::Iterator* it = db_->NewIterator(ro, column_handle_);
+    RowRefResolver* resolver =
+        row_handle_ == nullptr ? nullptr : new RowRefResolver(db_, snapshot, column_handle_, row_handle_);
     return std::make_unique<DiskTableRowIterator>(db_, it, snapshot, ttl_type_, expire_time_,
-                                                  expire_cnt_, pk_, ts_, has_ts_idx_, ts_idx_);
+                                                  expire_cnt_, pk_, ts_, has_ts_idx_, ts_idx_, resolver);
 }
 
 ::hybridse::vm::RowIterator* DiskTableKeyIterator::GetRawValue() {
     rocksdb::ReadOptions ro = rocksdb::ReadOptions();
     const rocksdb::Snapshot* snapshot = db_->GetSnapshot();
     ro.snapshot = snapshot;
-    // ro.prefix_same_as_start = true;
+    ro.prefix_same_as_start = true;
     ro.pin_data = true;
     rocksdb::Iterator* it = db_->NewIterator(ro, column_handle_);
+    RowRefResolver* resolver =
+        row_handle_ == nullptr ? nullptr : new RowRefResolver(db_, snapshot, column_handle_, row_handle_);
     return new DiskTableRowIterator(db_, it, snapshot, ttl_type_, expire_time_, expire_cnt_, pk_, ts_, has_ts_idx_,
-                                    ts_idx_);
+                                    ts_idx_, resolver);
 }
 
 DiskTableRowIterator::DiskTableRowIterator(rocksdb::DB* db, rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot,
                                            ::openmldb::storage::TTLType ttl_type, uint64_t expire_time,
                                            uint64_t expire_cnt, std::string pk, uint64_t ts, bool has_ts_idx,
-                                           uint32_t ts_idx)
+                                           uint32_t ts_idx, RowRefResolver* resolver)
     : db_(db),
       it_(it),
       snapshot_(snapshot),
@@ -992,9 +1132,11 @@ DiskTableRowIterator::DiskTableRowIterator(rocksdb::DB* db, rocksdb::Iterator* i
       ts_(ts),
       has_ts_idx_(has_ts_idx),
       ts_idx_(ts_idx),
-      row_() {}
+      row_(),
+      resolver_(resolver) {}
 
 DiskTableRowIterator::~DiskTableRowIterator() {
+    delete resolver_;
     delete it_;
     db_->ReleaseSnapshot(snapshot_);
 }
@@ -1030,6 +1172,14 @@ void DiskTableRowIterator::Next() {
 inline const uint64_t& DiskTableRowIterator::GetKey() const { return ts_; }
 
 const ::hybridse::codec::Row& DiskTableRowIterator::GetValue() {
+    if (resolver_ != nullptr) {
+        // the resolved rows are not pinned by the iterator, so the row owns a copy
+        rocksdb::Slice value = resolver_->Resolve(it_);
+        int8_t* buf = reinterpret_cast<int8_t*>(malloc(value.size()));
+        memcpy(buf, value.data(), value.size());
+        row_.Reset(::hybridse::base::RefCountedSlice::CreateManaged(buf, value.size()));
+        return row_;
+    }
     rocksdb::Slice value = it_->value();
     row_.Reset(reinterpret_cast<const int8_t*>(value.data()), value.size());
     return row_;
@@ -1134,7 +1284,7 @@ int DiskTable::GetCount(uint32_t index, const std::string& pk, uint64_t& count)
     rocksdb::ReadOptions ro = rocksdb::ReadOptions();
     const rocksdb::Snapshot* snapshot = db_->GetSnapshot();
     ro.snapshot = snapshot;
-    // ro.prefix_same_as_start = true;
+    ro.prefix_same_as_start = true;
     ro.pin_data = true;
     rocksdb::Iterator* it = db_->NewIterator(ro, cf_hs_[inner_pos + 1]);
 
@@ -91,6 +91,24 @@ static inline std::string CombineKeyTs(const std::string& key, uint64_t ts) {
     return result;
 }
 
+// the row ids of kSingleRow layout are big endian, so the rows are ordered by ids
+static inline std::string EncodeRowId(uint64_t id) {
+    std::string result(sizeof(uint64_t), '\0');
+    for (int i = sizeof(uint64_t) - 1; i >= 0; i--) {
+        result[i] = static_cast<char>(id & 0xFF);
+        id >>= 8;
+    }
+    return result;
+}
+
+static inline uint64_t DecodeRowId(const rocksdb::Slice& s) {
+    uint64_t id = 0;
+    for (size_t i = 0; i < sizeof(uint64_t) && i < s.size(); i++) {
+        id = (id << 8) | static_cast<uint8_t>(s[i]);
+    }
+    return id;
+}
+
 static inline std::string CombineKeyTs(const std::string& key, uint64_t ts, uint32_t ts_pos) {
     std::string result;
     result.resize(key.size() + TS_LEN + TS_POS_LEN);
@@ -143,79 +161,178 @@ class KeyTsPrefixTransform : public rocksdb::SliceTransform {
     bool SameResultWhenAppended(const rocksdb::Slice& prefix) const override { return InDomain(prefix); }
 };
 
-class AbsoluteTTLCompactionFilter : public rocksdb::CompactionFilter {
+// TTLCompactionFilter drops the expired entries of an inner index for all ttl types.
+// The keys are streamed in order within a compaction, so the entries of a pk are
+// counted to find the ones beyond the latest ttl. The entries of the pk out of the
+// compaction only make the real rank larger, so no entry is dropped early.
+class TTLCompactionFilter : public rocksdb::CompactionFilter {
  public:
-    explicit AbsoluteTTLCompactionFilter(std::shared_ptr<InnerIndexSt> inner_index) : inner_index_(inner_index) {}
-    virtual ~AbsoluteTTLCompactionFilter() {}
+    explicit TTLCompactionFilter(std::shared_ptr<InnerIndexSt> inner_index)
+        : inner_index_(inner_index),
+          cur_time_(::baidu::common::timer::get_micros() / 1000),
+          has_ttl_(false),
+          cnt_(0),
+          expired_(false) {}
+    virtual ~TTLCompactionFilter() {}
 
-    const char* Name() const override { return "AbsoluteTTLCompactionFilter"; }
+    const char* Name() const override { return "TTLCompactionFilter"; }
 
     bool Filter(int /*level*/, const rocksdb::Slice& key, const rocksdb::Slice& /*existing_value*/,
                 std::string* /*new_value*/, bool* /*value_changed*/) const override {
         if (key.size() < TS_LEN) {
             return false;
         }
-        uint64_t real_ttl = 0;
+        // the versions of the same key are counted once
+        if (key.size() == last_prefix_.size() + TS_LEN && key.starts_with(last_prefix_)) {
+            if (key == rocksdb::Slice(last_key_)) {
+                return expired_;
+            }
+        } else {
+            last_prefix_.assign(key.data(), key.size() - TS_LEN);
+            has_ttl_ = GetTTL(key, &ttl_);
+            cnt_ = 0;
+        }
+        last_key_.assign(key.data(), key.size());
+        expired_ = false;
+        if (!has_ttl_) {
+            return false;
+        }
+        cnt_++;
+        uint64_t ts = 0;
+        memcpy(static_cast<void*>(&ts), key.data() + key.size() - TS_LEN, TS_LEN);
+        memrev64ifbe(static_cast<void*>(&ts));
+        expired_ = ttl_.IsExpired(ts, cnt_);
+        return expired_;
+    }
+
+ private:
+    // the ttl of the index the key belongs to, abs_ttl is converted to the expire time
+    bool GetTTL(const rocksdb::Slice& key, TTLSt* ttl) const {
         const auto& indexs = inner_index_->GetIndex();
+        std::shared_ptr<IndexDef> index_def;
         if (indexs.size() > 1) {
             if (key.size() < TS_LEN + TS_POS_LEN) {
                 return false;
             }
             uint32_t ts_idx = *((uint32_t*)(key.data() + key.size() - TS_LEN -  // NOLINT
                                           TS_POS_LEN));
-            bool has_found = false;
             for (const auto& index : indexs) {
                 auto ts_col = index->GetTsColumn();
                 if (!ts_col) {
                     return false;
                 }
                 if (ts_col->GetId() == ts_idx) {
-                    real_ttl = index->GetTTL()->abs_ttl;
-                    has_found = true;
+                    index_def = index;
                     break;
                 }
             }
-            if (!has_found) {
+            if (!index_def) {
                 return false;
             }
         } else {
-            real_ttl = indexs.front()->GetTTL()->abs_ttl;
+            index_def = indexs.front();
         }
-        if (real_ttl < 1) {
+        auto index_ttl = index_def->GetTTL();
+        if (!index_ttl->NeedGc()) {
             return false;
         }
-        uint64_t ts = 0;
-        memcpy(static_cast<void*>(&ts), key.data() + key.size() - TS_LEN, TS_LEN);
-        memrev64ifbe(static_cast<void*>(&ts));
-        uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
-        if (ts < cur_time - real_ttl) {
-            return true;
-        }
-        return false;
+        uint64_t expire_time = index_ttl->abs_ttl == 0 ? 0 : cur_time_ - index_ttl->abs_ttl;
+        *ttl = TTLSt(expire_time, index_ttl->lat_ttl, index_ttl->ttl_type);
+        return true;
     }
 
- private:
     std::shared_ptr<InnerIndexSt> inner_index_;
+    uint64_t cur_time_;
+    // the state of the pk streamed last
+    mutable std::string last_prefix_;
+    mutable std::string last_key_;
+    mutable TTLSt ttl_;
+    mutable bool has_ttl_;
+    mutable uint32_t cnt_;
+    mutable bool expired_;
 };
 
-class AbsoluteTTLFilterFactory : public rocksdb::CompactionFilterFactory {
+class TTLFilterFactory : public rocksdb::CompactionFilterFactory {
  public:
-    explicit AbsoluteTTLFilterFactory(const std::shared_ptr<InnerIndexSt>& inner_index) : inner_index_(inner_index) {}
+    explicit TTLFilterFactory(const std::shared_ptr<InnerIndexSt>& inner_index) : inner_index_(inner_index) {}
     std::unique_ptr<rocksdb::CompactionFilter> CreateCompactionFilter(
         const rocksdb::CompactionFilter::Context& context) override {
-        return std::unique_ptr<rocksdb::CompactionFilter>(new AbsoluteTTLCompactionFilter(inner_index_));
+        return std::unique_ptr<rocksdb::CompactionFilter>(new TTLCompactionFilter(inner_index_));
     }
-    const char* Name() const override { return "AbsoluteTTLFilterFactory"; }
+    const char* Name() const override { return "TTLFilterFactory"; }
 
  private:
     std::shared_ptr<InnerIndexSt> inner_index_;
 };
 
+class DiskTable;
+
+// RowRefCompactionFilter drops the rows of kSingleRow layout which are not
+// referenced by any index, e.g. the index entries are expired or deleted.
+class RowRefCompactionFilter : public rocksdb::CompactionFilter {
+ public:
+    explicit RowRefCompactionFilter(DiskTable* table) : table_(table) {}
+
+    const char* Name() const override { return "RowRefCompactionFilter"; }
+
+    bool Filter(int /*level*/, const rocksdb::Slice& key, const rocksdb::Slice& existing_value,
+                std::string* /*new_value*/, bool* /*value_changed*/) const override;
+
+ private:
+    DiskTable* table_;
+};
+
+class RowRefFilterFactory : public rocksdb::CompactionFilterFactory {
+ public:
+    explicit RowRefFilterFactory(DiskTable* table) : table_(table) {}
+    std::unique_ptr<rocksdb::CompactionFilter> CreateCompactionFilter(
+        const rocksdb::CompactionFilter::Context& context) override {
+        return std::unique_ptr<rocksdb::CompactionFilter>(new RowRefCompactionFilter(table_));
+    }
+    const char* Name() const override { return "RowRefFilterFactory"; }
+
+ private:
+    DiskTable* table_;
+};
+
+// RowRefResolver resolves the row ids kept by the index entries of kSingleRow
+// layout. The row ids of the following entries with the same key are read ahead
+// and resolved by one MultiGet.
+class RowRefResolver {
+ public:
+    RowRefResolver(rocksdb::DB* db, const rocksdb::Snapshot* snapshot, rocksdb::ColumnFamilyHandle* index_cf,
+                   rocksdb::ColumnFamilyHandle* row_cf);
+    ~RowRefResolver();
+
+    // return the row of the entry `it` points to, the row is valid until the resolver is destroyed
+    // like the values of an iterator with pin_data, so the callers can keep it across Next()
+    rocksdb::Slice Resolve(const rocksdb::Iterator* it);
+
+ private:
+    void Fetch(const rocksdb::Slice& key);
+    rocksdb::Slice GetRow(size_t pos) const;
+
+    static constexpr uint32_t kBatchSize = 32;
+
+    rocksdb::DB* db_;
+    rocksdb::ReadOptions ro_;
+    rocksdb::ColumnFamilyHandle* index_cf_;
+    rocksdb::ColumnFamilyHandle* row_cf_;
+    rocksdb::Iterator* ahead_;
+    std::vector<std::string> ids_;
+    // the rows of all the fetched batches are pinned, rows_ points to the last batch
+    std::vector<std::unique_ptr<rocksdb::PinnableSlice[]>> batches_;
+    rocksdb::PinnableSlice* rows_;
+    std::vector<rocksdb::Status> statuses_;
+    size_t pos_;
+};
+
 class DiskTableIterator : public TableIterator {
  public:
-    DiskTableIterator(rocksdb::DB* db, rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot, const std::string& pk);
     DiskTableIterator(rocksdb::DB* db, rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot, const std::string& pk,
-                      uint32_t ts_idx);
+                      RowRefResolver* resolver = nullptr);
+    DiskTableIterator(rocksdb::DB* db, rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot, const std::string& pk,
+                      uint32_t ts_idx, RowRefResolver* resolver = nullptr);
     virtual ~DiskTableIterator();
     bool Valid() override;
     void Next() override;
@@ -233,16 +350,18 @@ class DiskTableIterator : public TableIterator {
     uint64_t ts_;
     uint32_t ts_idx_;
     bool has_ts_idx_ = false;
+    // resolve the row ids for kSingleRow layout, nullptr for kRowPerIndex
+    RowRefResolver* resolver_;
 };
 
 class DiskTableTraverseIterator : public TraverseIterator {
  public:
     DiskTableTraverseIterator(rocksdb::DB* db, rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot,
                               ::openmldb::storage::TTLType ttl_type, const uint64_t& expire_time,
-                              const uint64_t& expire_cnt);
+                              const uint64_t& expire_cnt, RowRefResolver* resolver = nullptr);
     DiskTableTraverseIterator(rocksdb::DB* db, rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot,
                               ::openmldb::storage::TTLType ttl_type, const uint64_t& expire_time,
-                              const uint64_t& expire_cnt, int32_t ts_idx);
+                              const uint64_t& expire_cnt, int32_t ts_idx, RowRefResolver* resolver = nullptr);
     virtual ~DiskTableTraverseIterator();
     bool Valid() override;
     void Next() override;
@@ -268,13 +387,15 @@ class DiskTableTraverseIterator : public TraverseIterator {
     bool has_ts_idx_;
     uint32_t ts_idx_;
     uint64_t traverse_cnt_;
+    RowRefResolver* resolver_;
 };
 
 class DiskTableRowIterator : public ::hybridse::vm::RowIterator {
  public:
     DiskTableRowIterator(rocksdb::DB* db, rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot,
                          ::openmldb::storage::TTLType ttl_type, uint64_t expire_time, uint64_t expire_cnt,
-                         std::string pk, uint64_t ts, bool has_ts_idx, uint32_t ts_idx);
+                         std::string pk, uint64_t ts, bool has_ts_idx, uint32_t ts_idx,
+                         RowRefResolver* resolver = nullptr);
 
     ~DiskTableRowIterator();
 
@@ -303,17 +424,19 @@ class DiskTableRowIterator : public ::hybridse::vm::RowIterator {
     uint32_t ts_idx_;
     ::hybridse::codec::Row row_;
     bool pk_valid_;
+    RowRefResolver* resolver_;
 };
 
 class DiskTableKeyIterator : public ::hybridse::vm::WindowIterator {
  public:
     DiskTableKeyIterator(rocksdb::DB* db, rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot,
                          ::openmldb::storage::TTLType ttl_type, const uint64_t& expire_time, const uint64_t& expire_cnt,
-                         int32_t ts_idx, rocksdb::ColumnFamilyHandle* column_handle);
+                         int32_t ts_idx, rocksdb::ColumnFamilyHandle* column_handle,
+                         rocksdb::ColumnFamilyHandle* row_handle = nullptr);
 
     DiskTableKeyIterator(rocksdb::DB* db, rocksdb::Iterator* it, const rocksdb::Snapshot* snapshot,
                          ::openmldb::storage::TTLType ttl_type, const uint64_t& expire_time, const uint64_t& expire_cnt,
-                         rocksdb::ColumnFamilyHandle* column_handle);
+                         rocksdb::ColumnFamilyHandle* column_handle, rocksdb::ColumnFamilyHandle* row_handle = nullptr);
 
     ~DiskTableKeyIterator() override;
 
@@ -345,6 +468,8 @@ class DiskTableKeyIterator : public ::hybridse::vm::WindowIterator {
     uint64_t ts_;
     uint32_t ts_idx_;
     rocksdb::ColumnFamilyHandle* column_handle_;
+    // the column family of rows for kSingleRow layout, nullptr for kRowPerIndex
+    rocksdb::ColumnFamilyHandle* row_handle_;
 };
 
 class DiskTable : public Table {
@@ -400,20 +525,28 @@ class DiskTable : public Table {
 
     ::hybridse::vm::WindowIterator* NewWindowIterator(uint32_t idx) override;
 
-    void SchedGc() override;
+    // load the blocks the seeks of pks will read by one MultiGet, so the reads of
+    // different files are issued together instead of one seek after another
+    void Prefetch(uint32_t idx, const std::vector<std::string>& pks) override;
 
-    void GcHead();
-    void GcTTLAndHead();
-    void GcTTLOrHead();
+    void SchedGc() override;
 
     bool IsExpire(const ::openmldb::api::LogEntry& entry) override;
 
     void CompactDB() {
-        for (rocksdb::ColumnFamilyHandle* cf : cf_hs_) {
-            db_->CompactRange(rocksdb::CompactRangeOptions(), cf, nullptr, nullptr);
+        // compact the rows of kSingleRow layout after the indexes, so the rows
+        // of expired entries are dropped
+        for (size_t i = 1; i < cf_hs_.size(); i++) {
+            db_->CompactRange(rocksdb::CompactRangeOptions(), cf_hs_[i], nullptr, nullptr);
         }
+        db_->CompactRange(rocksdb::CompactRangeOptions(), cf_hs_[0], nullptr, nullptr);
     }
 
+    ::openmldb::common::DiskRowLayout GetRowLayout() const { return row_layout_; }
+
+    // return true if any index entry in the refs of a row of kSingleRow layout still keeps `row_id`
+    bool IsRowReferenced(const rocksdb::Slice& row_id, const rocksdb::Slice& row_value);
+
     int CreateCheckPoint(const std::string& checkpoint_dir);
 
     bool DeleteIndex(const std::string& idx_name) override;
@@ -426,6 +559,12 @@ class DiskTable : public Table {
     int GetCount(uint32_t index, const std::string& pk, uint64_t& count) override; // NOLINT
 
  private:
+    // return nullptr for kRowPerIndex layout
+    RowRefResolver* NewRowRefResolver(uint32_t inner_pos, const rocksdb::Snapshot* snapshot);
+    // put the row once with the refs of index entries into the batch for kSingleRow layout
+    void PutRow(const std::string& row_id, const std::string& refs, const rocksdb::Slice& value,
+                rocksdb::WriteBatch* batch);
+
     rocksdb::DB* db_;
     rocksdb::WriteOptions write_opts_;
     std::vector<rocksdb::ColumnFamilyDescriptor> cf_ds_;
@@ -434,6 +573,11 @@ class DiskTable : public Table {
     KeyTSComparator cmp_;
     std::atomic<uint64_t> offset_;
     std::string table_path_;
+    // kSingleRow keeps the rows in the default column family by row id, the
+    // index entries keep the row id
+    ::openmldb::common::DiskRowLayout row_layout_;
+    std::atomic<uint64_t> next_row_id_;
+    std::atomic<bool> opened_;
 };
 
 }  // namespace storage
@@ -17,7 +17,9 @@
 #include "storage/disk_table.h"
 #include <gflags/gflags.h>
 #include <iostream>
+#include <map>
 #include <utility>
+#include <vector>
 #include "base/file_util.h"
 #include "base/glog_wrapper.h"
 #include "codec/schema_codec.h"
@@ -945,7 +947,7 @@ TEST_F(DiskTableTest, CompactFilterMulTs) {
     RemoveData(table_path);
 }
 
-TEST_F(DiskTableTest, GcHeadMulTs) {
+TEST_F(DiskTableTest, CompactFilterLatestMulTs) {
     ::openmldb::api::TableMeta table_meta;
     table_meta.set_tid(12);
     table_meta.set_pid(1);
@@ -1022,7 +1024,7 @@ TEST_F(DiskTableTest, GcHeadMulTs) {
             }
         }
     }
-    table->SchedGc();
+    table->CompactDB();
     iter = table->NewIterator(0, "card0", ticket);
     iter->SeekToFirst();
     while (iter->Valid()) {
@@ -1070,7 +1072,7 @@ TEST_F(DiskTableTest, GcHeadMulTs) {
     RemoveData(table_path);
 }
 
-TEST_F(DiskTableTest, GcHead) {
+TEST_F(DiskTableTest, CompactFilterLatest) {
     std::map<std::string, uint32_t> mapping;
     mapping.insert(std::make_pair("idx0", 0));
     std::string table_path = FLAGS_hdd_root_path + "/13_1";
@@ -1101,7 +1103,7 @@ TEST_F(DiskTableTest, GcHead) {
             }
         }
     }
-    table->GcHead();
+    table->CompactDB();
     for (int idx = 0; idx < 100; idx++) {
         std::string key = "test" + std::to_string(idx);
         uint64_t ts = 9537;
@@ -1123,6 +1125,64 @@ TEST_F(DiskTableTest, GcHead) {
     RemoveData(table_path);
 }
 
+TEST_F(DiskTableTest, CompactFilterAbsAndLat) {
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_tid(14);
+    table_meta.set_pid(1);
+    table_meta.set_storage_mode(::openmldb::common::kHDD);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "card", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "mcc", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts1", ::openmldb::type::kBigInt);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card", "card", "ts1", ::openmldb::type::kAbsAndLat, 3, 3);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "mcc", "mcc", "ts1", ::openmldb::type::kAbsOrLat, 3, 3);
+
+    std::string table_path = FLAGS_hdd_root_path + "/14_1";
+    DiskTable* table = new DiskTable(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    codec::SDKCodec codec(table_meta);
+    uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
+    // the rows after 5 are out of the absolute ttl
+    auto get_ts = [cur_time](int i) { return i < 5 ? cur_time - i : cur_time - i - 10 * 60 * 1000; };
+    // the old rows are compacted before the new rows are put, the entries counted
+    // in the first compaction are less than the real ranks
+    for (int round = 0; round < 2; round++) {
+        for (int idx = 0; idx < 100; idx++) {
+            Dimensions dims;
+            ::openmldb::api::Dimension* dim = dims.Add();
+            dim->set_key("card" + std::to_string(idx));
+            dim->set_idx(0);
+            ::openmldb::api::Dimension* dim1 = dims.Add();
+            dim1->set_key("mcc" + std::to_string(idx));
+            dim1->set_idx(1);
+            for (int i = round == 0 ? 5 : 0; i < (round == 0 ? 10 : 5); i++) {
+                std::vector<std::string> row = {"card" + std::to_string(idx), "mcc" + std::to_string(idx),
+                                                std::to_string(get_ts(i))};
+                std::string value;
+                ASSERT_EQ(0, codec.EncodeRow(row, &value));
+                ASSERT_TRUE(table->Put(get_ts(i), value, dims));
+            }
+        }
+        if (round == 0) {
+            table->CompactDB();
+            std::string value;
+            ASSERT_TRUE(table->Get(0, "card0", get_ts(7), value));
+            ASSERT_FALSE(table->Get(0, "card0", get_ts(8), value));
+        }
+    }
+    table->CompactDB();
+    for (int idx = 0; idx < 100; idx++) {
+        for (int i = 0; i < 10; i++) {
+            std::string value;
+            // expired if both out of the absolute ttl and the latest 3
+            ASSERT_EQ(i < 5, table->Get(0, "card" + std::to_string(idx), get_ts(i), value)) << idx << " " << i;
+            // expired if either out of the absolute ttl or the latest 3
+            ASSERT_EQ(i < 3, table->Get(1, "mcc" + std::to_string(idx), get_ts(i), value)) << idx << " " << i;
+        }
+    }
+    delete table;
+    RemoveData(table_path);
+}
+
 TEST_F(DiskTableTest, CheckPoint) {
     std::map<std::string, uint32_t> mapping;
     mapping.insert(std::make_pair("idx0", 0));
@@ -1196,6 +1256,219 @@ TEST_F(DiskTableTest, CheckPoint) {
     RemoveData(table_path);
 }
 
+TEST_F(DiskTableTest, SingleRowLayout) {
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_tid(20);
+    table_meta.set_pid(1);
+    table_meta.set_storage_mode(::openmldb::common::kHDD);
+    table_meta.set_disk_row_layout(::openmldb::common::kSingleRow);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "card", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "mcc", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts1", ::openmldb::type::kBigInt);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card", "card", "ts1", ::openmldb::type::kAbsoluteTime, 3, 0);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "mcc", "mcc", "ts1", ::openmldb::type::kAbsoluteTime, 3, 0);
+
+    std::string table_path = FLAGS_hdd_root_path + "/20_1";
+    DiskTable* table = new DiskTable(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    ASSERT_EQ(::openmldb::common::kSingleRow, table->GetRowLayout());
+
+    codec::SDKCodec codec(table_meta);
+    uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
+    // the rows after 40 are expired
+    auto get_ts = [cur_time](int i) { return i < 40 ? cur_time - i : cur_time - i - 10 * 60 * 1000; };
+    std::map<std::string, std::string> rows;
+    for (int idx = 0; idx < 10; idx++) {
+        Dimensions dims;
+        ::openmldb::api::Dimension* dim = dims.Add();
+        dim->set_key("card" + std::to_string(idx));
+        dim->set_idx(0);
+        ::openmldb::api::Dimension* dim1 = dims.Add();
+        dim1->set_key("mcc" + std::to_string(idx));
+        dim1->set_idx(1);
+        for (int i = 0; i < 50; i++) {
+            std::vector<std::string> row = {"card" + std::to_string(idx), "mcc" + std::to_string(idx),
+                                            std::to_string(get_ts(i))};
+            std::string value;
+            ASSERT_EQ(0, codec.EncodeRow(row, &value));
+            ASSERT_TRUE(table->Put(get_ts(i), value, dims));
+            rows.emplace(std::to_string(idx) + "|" + std::to_string(i), value);
+        }
+    }
+    for (int idx = 0; idx < 10; idx++) {
+        Ticket ticket;
+        TableIterator* it = table->NewIterator(0, "card" + std::to_string(idx), ticket);
+        it->SeekToFirst();
+        for (int i = 0; i < 50; i++) {
+            ASSERT_TRUE(it->Valid());
+            ASSERT_EQ(get_ts(i), it->GetKey());
+            ASSERT_EQ(rows[std::to_string(idx) + "|" + std::to_string(i)], it->GetValue().ToString());
+            it->Next();
+        }
+        ASSERT_FALSE(it->Valid());
+        delete it;
+        std::string value;
+        ASSERT_TRUE(table->Get(1, "mcc" + std::to_string(idx), get_ts(7), value));
+        ASSERT_EQ(rows[std::to_string(idx) + "|7"], value);
+    }
+    auto window_it = table->NewWindowIterator(1);
+    window_it->Seek("mcc3");
+    ASSERT_TRUE(window_it->Valid());
+    auto row_it = window_it->GetValue();
+    row_it->SeekToFirst();
+    std::vector<::hybridse::codec::Row> window_rows;
+    while (row_it->Valid()) {
+        window_rows.push_back(row_it->GetValue());
+        row_it->Next();
+    }
+    row_it.reset();
+    delete window_it;
+    // the rows own the resolved values after the iterator is released
+    ASSERT_EQ(40u, window_rows.size());
+    for (int i = 0; i < 40; i++) {
+        ASSERT_EQ(rows["3|" + std::to_string(i)], window_rows[i].ToString());
+    }
+    TraverseIterator* traverse_it = table->NewTraverseIterator(0);
+    traverse_it->SeekToFirst();
+    int count = 0;
+    while (traverse_it->Valid()) {
+        ASSERT_EQ(rows[traverse_it->GetPK().substr(4) + "|" + std::to_string(cur_time - traverse_it->GetKey())],
+                  traverse_it->GetValue().ToString());
+        count++;
+        traverse_it->Next();
+    }
+    delete traverse_it;
+    ASSERT_EQ(400, count);
+
+    // the expired entries are dropped by compaction, then the rows not referenced
+    table->CompactDB();
+    for (int idx = 0; idx < 10; idx++) {
+        std::string value;
+        ASSERT_FALSE(table->Get(0, "card" + std::to_string(idx), get_ts(45), value));
+        ASSERT_TRUE(table->Get(0, "card" + std::to_string(idx), get_ts(5), value));
+        ASSERT_EQ(rows[std::to_string(idx) + "|5"], value);
+    }
+    delete table;
+
+    // the row ids continue after reopening
+    table = new DiskTable(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    Dimensions dims;
+    ::openmldb::api::Dimension* dim = dims.Add();
+    dim->set_key("card0");
+    dim->set_idx(0);
+    std::vector<std::string> row = {"card0", "mcc100", std::to_string(cur_time + 1)};
+    std::string value;
+    ASSERT_EQ(0, codec.EncodeRow(row, &value));
+    ASSERT_TRUE(table->Put(cur_time + 1, value, dims));
+    std::string result;
+    ASSERT_TRUE(table->Get(0, "card0", cur_time + 1, result));
+    ASSERT_EQ(value, result);
+    for (int i = 0; i < 40; i++) {
+        ASSERT_TRUE(table->Get(0, "card9", get_ts(i), result));
+        ASSERT_EQ(rows["9|" + std::to_string(i)], result);
+    }
+    delete table;
+
+    // the rows are kept once in the default column family
+    rocksdb::DB* db = nullptr;
+    std::vector<rocksdb::ColumnFamilyDescriptor> cf_ds = {
+        rocksdb::ColumnFamilyDescriptor(rocksdb::kDefaultColumnFamilyName, rocksdb::ColumnFamilyOptions())};
+    std::vector<rocksdb::ColumnFamilyHandle*> cf_hs;
+    ASSERT_TRUE(rocksdb::DB::OpenForReadOnly(rocksdb::Options(), table_path + "/data", cf_ds, &cf_hs, &db).ok());
+    rocksdb::Iterator* it = db->NewIterator(rocksdb::ReadOptions(), cf_hs[0]);
+    count = 0;
+    for (it->SeekToFirst(); it->Valid(); it->Next()) {
+        count++;
+    }
+    ASSERT_EQ(401, count);
+    delete it;
+    for (auto handle : cf_hs) {
+        delete handle;
+    }
+    delete db;
+    RemoveData(table_path);
+}
+
+// seek the windows of pks one by one and return the elapsed time in microseconds
+uint64_t SeekWindows(DiskTable* table, const std::vector<std::string>& pks, bool prefetch, uint64_t* row_cnt) {
+    uint64_t start = ::baidu::common::timer::get_micros();
+    if (prefetch) {
+        table->Prefetch(0, pks);
+    }
+    auto window_it = table->NewWindowIterator(0);
+    for (const auto& pk : pks) {
+        window_it->Seek(pk);
+        if (!window_it->Valid() || window_it->GetKey().ToString() != pk) {
+            continue;
+        }
+        auto row_it = window_it->GetValue();
+        for (row_it->SeekToFirst(); row_it->Valid(); row_it->Next()) {
+            (*row_cnt)++;
+        }
+    }
+    delete window_it;
+    return ::baidu::common::timer::get_micros() - start;
+}
+
+TEST_F(DiskTableTest, PrefetchLatency) {
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_tid(21);
+    table_meta.set_pid(1);
+    table_meta.set_storage_mode(::openmldb::common::kSSD);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "card", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts1", ::openmldb::type::kBigInt);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card", "card", "ts1", ::openmldb::type::kAbsoluteTime, 0, 0);
+
+    std::string table_path = FLAGS_ssd_root_path + "/21_1";
+    DiskTable* table = new DiskTable(table_meta, table_path);
+    ASSERT_TRUE(table->Init());
+    codec::SDKCodec codec(table_meta);
+    const int pk_cnt = 4000;
+    const int row_cnt = 10;
+    for (int idx = 0; idx < pk_cnt; idx++) {
+        Dimensions dims;
+        ::openmldb::api::Dimension* dim = dims.Add();
+        dim->set_key("card" + std::to_string(idx));
+        dim->set_idx(0);
+        for (int i = 0; i < row_cnt; i++) {
+            std::vector<std::string> row = {"card" + std::to_string(idx), std::to_string(1000 + i)};
+            std::string value;
+            ASSERT_EQ(0, codec.EncodeRow(row, &value));
+            ASSERT_TRUE(table->Put(1000 + i, value, dims));
+        }
+    }
+    table->CompactDB();
+
+    // the halves of pks are not read before, so neither is in block cache. Half of the
+    // seeks of a batch miss, like the requests of new keys
+    std::vector<std::string> seek_pks;
+    std::vector<std::string> prefetch_pks;
+    for (int idx = 0; idx < pk_cnt; idx++) {
+        auto& pks = idx % 2 == 0 ? seek_pks : prefetch_pks;
+        pks.push_back("card" + std::to_string(idx));
+        pks.push_back("miss" + std::to_string(idx));
+    }
+    uint64_t seek_rows = 0;
+    uint64_t prefetch_rows = 0;
+    uint64_t seek_time = SeekWindows(table, seek_pks, false, &seek_rows);
+    uint64_t prefetch_time = SeekWindows(table, prefetch_pks, true, &prefetch_rows);
+    ASSERT_EQ(pk_cnt / 2 * row_cnt, static_cast<int>(seek_rows));
+    ASSERT_EQ(pk_cnt / 2 * row_cnt, static_cast<int>(prefetch_rows));
+    PDLOG(INFO, "window lookups of %lu keys: seek %lu us, %.2f us per key; prefetch and seek %lu us, %.2f us per key",
+          seek_pks.size(), seek_time, static_cast<double>(seek_time) / seek_pks.size(), prefetch_time,
+          static_cast<double>(prefetch_time) / prefetch_pks.size());
+
+    // both are in block cache now
+    seek_rows = 0;
+    seek_time = SeekWindows(table, seek_pks, false, &seek_rows);
+    ASSERT_EQ(pk_cnt / 2 * row_cnt, static_cast<int>(seek_rows));
+    PDLOG(INFO, "cached window lookups of %lu keys: %lu us, %.2f us per key", seek_pks.size(), seek_time,
+          static_cast<double>(seek_time) / seek_pks.size());
+    delete table;
+    RemoveData(table_path);
+}
+
 }  // namespace storage
 }  // namespace openmldb
 
@@ -34,6 +34,8 @@ DECLARE_uint32(key_entry_max_height);
 DECLARE_uint32(absolute_default_skiplist_height);
 DECLARE_uint32(latest_default_skiplist_height);
 DECLARE_uint32(max_traverse_cnt);
+DECLARE_uint32(dict_compress_max_values);
+DECLARE_uint32(dict_compress_max_value_length);
 
 namespace openmldb {
 namespace storage {
@@ -121,6 +123,18 @@ bool MemTable::Init() {
         segments_[i] = seg_arr;
         key_entry_max_height_ = cur_key_entry_max_height;
     }
+    if (compress_type_ == ::openmldb::type::kDictionary) {
+        // the string columns added later have no dictionary
+        uint32_t str_field_cnt = 0;
+        for (const auto& column : *GetSchema()) {
+            if (column.data_type() == ::openmldb::type::kVarchar || column.data_type() == ::openmldb::type::kString) {
+                str_field_cnt++;
+            }
+        }
+        dict_codec_ = std::make_unique<codec::DictRowCodec>(str_field_cnt, FLAGS_dict_compress_max_values,
+                                                            FLAGS_dict_compress_max_value_length);
+        PDLOG(INFO, "init dictionaries of %u string columns. tid %u pid %u", str_field_cnt, id_, pid_);
+    }
     PDLOG(INFO, "init table name %s, id %d, pid %d, seg_cnt %d", name_.c_str(), id_, pid_, seg_cnt_);
     return true;
 }
@@ -201,7 +215,15 @@ bool MemTable::Put(uint64_t time, const std::string& value, const Dimensions& di
     if (ts_map.empty()) {
         return false;
     }
-    auto* block = new DataBlock(real_ref_cnt, value.c_str(), value.length());
+    std::string encoded;
+    const std::string* row = &value;
+    if (dict_codec_) {
+        auto schema = GetVersionSchema(version);
+        if (schema && dict_codec_->Encode(*schema, data, value.size(), &encoded)) {
+            row = &encoded;
+        }
+    }
+    auto* block = DataBlock::New(real_ref_cnt, row->c_str(), row->length());
     for (const auto& kv : inner_index_key_map) {
         auto inner_index = table_index_.GetInnerIndex(kv.first);
         bool need_put = false;
@@ -222,7 +244,7 @@ bool MemTable::Put(uint64_t time, const std::string& value, const Dimensions& di
         }
     }
     record_cnt_.fetch_add(1, std::memory_order_relaxed);
-    record_byte_size_.fetch_add(GetRecordSize(value.length()));
+    record_byte_size_.fetch_add(GetRecordSize(row->length()));
     return true;
 }
 
@@ -491,6 +513,19 @@ uint64_t MemTable::GetRecordIdxByteSize() {
     return record_idx_byte_size;
 }
 
+uint64_t MemTable::GetRecordSlabFragByteSize() {
+    uint64_t frag_byte_size = 0;
+    for (uint32_t i = 0; i < segments_.size(); i++) {
+        if (segments_[i] == NULL) {
+            continue;
+        }
+        for (uint32_t j = 0; j < seg_cnt_; j++) {
+            frag_byte_size += segments_[i][j]->GetSlabFragByteSize();
+        }
+    }
+    return frag_byte_size;
+}
+
 uint64_t MemTable::GetRecordIdxCnt() {
     uint64_t record_idx_cnt = 0;
     std::shared_ptr<IndexDef> index_def = table_index_.GetIndex(0);
@@ -692,7 +727,8 @@ bool MemTable::DeleteIndex(const std::string& idx_name) {
     if (ts_col) {
         ts_idx = ts_col->GetId();
     }
-    return new MemTableKeyIterator(segments_[real_idx], seg_cnt_, ttl->ttl_type, expire_time, expire_cnt, ts_idx);
+    return new MemTableKeyIterator(segments_[real_idx], seg_cnt_, ttl->ttl_type, expire_time, expire_cnt, ts_idx,
+                                   dict_codec_.get());
 }
 
 TraverseIterator* MemTable::NewTraverseIterator(uint32_t index) {
@@ -23,6 +23,7 @@
 #include <string>
 #include <vector>
 
+#include "codec/dict_codec.h"
 #include "proto/tablet.pb.h"
 #include "storage/iterator.h"
 #include "storage/segment.h"
@@ -109,12 +110,19 @@ class MemTable : public Table {
     uint64_t GetRecordIdxCnt() override;
     bool GetRecordIdxCnt(uint32_t idx, uint64_t** stat, uint32_t* size) override;
     uint64_t GetRecordIdxByteSize() override;
+    // the bytes reserved by the segment slabs but not in use
+    uint64_t GetRecordSlabFragByteSize();
     uint64_t GetRecordPkCnt() override;
 
     void SetCompressType(::openmldb::type::CompressType compress_type);
     ::openmldb::type::CompressType GetCompressType();
 
-    uint64_t GetRecordByteSize() const override { return record_byte_size_.load(std::memory_order_relaxed); }
+    const codec::DictRowCodec* GetDictCodec() const override { return dict_codec_.get(); }
+
+    uint64_t GetRecordByteSize() const override {
+        uint64_t size = record_byte_size_.load(std::memory_order_relaxed);
+        return dict_codec_ ? size + dict_codec_->GetByteSize() : size;
+    }
 
     uint64_t GetRecordCnt() const override { return record_cnt_.load(std::memory_order_relaxed); }
 
@@ -148,6 +156,7 @@ class MemTable : public Table {
     bool segment_released_;
     std::atomic<uint64_t> record_byte_size_;
     uint32_t key_entry_max_height_;
+    std::unique_ptr<codec::DictRowCodec> dict_codec_;
 };
 
 }  // namespace storage
@@ -23,9 +23,12 @@
 #include <snappy.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <set>
+#include <thread>  // NOLINT
 #include <utility>
 
+#include "base/endianconv.h"
 #include "base/file_util.h"
 #include "base/glog_wrapper.h"
 #include "base/hash.h"
@@ -37,6 +40,7 @@
 #include "common/thread_pool.h"
 #include "common/timer.h"
 #include "gflags/gflags.h"
+#include "log/log_format.h"
 #include "log/log_reader.h"
 #include "log/sequential_file.h"
 #include "proto/tablet.pb.h"
@@ -96,9 +100,17 @@ void MemTableSnapshot::RecoverFromSnapshot(const std::string& snapshot_name, uin
     std::string full_path = snapshot_path_ + "/" + snapshot_name;
     std::atomic<uint64_t> g_succ_cnt(0);
     std::atomic<uint64_t> g_failed_cnt(0);
+    uint64_t consumed = ::baidu::common::timer::get_micros();
     RecoverSingleSnapshot(full_path, table, &g_succ_cnt, &g_failed_cnt);
-    PDLOG(INFO, "[Recover] progress done stat: success count %lu, failed count %lu",
-          g_succ_cnt.load(std::memory_order_relaxed), g_failed_cnt.load(std::memory_order_relaxed));
+    consumed = std::max(::baidu::common::timer::get_micros() - consumed, (uint64_t)1);
+    uint64_t file_size = 0;
+    ::openmldb::base::GetFileSize(full_path, file_size);
+    uint64_t succ_cnt = g_succ_cnt.load(std::memory_order_relaxed);
+    PDLOG(INFO,
+          "[Recover] progress done stat: success count %lu, failed count %lu, consumed %lums, "
+          "throughput %lu rows/s %.2f MB/s",
+          succ_cnt, g_failed_cnt.load(std::memory_order_relaxed), consumed / 1000, succ_cnt * 1000000 / consumed,
+          static_cast<double>(file_size) / consumed * 1000000 / (1024 * 1024));
     if (g_succ_cnt.load(std::memory_order_relaxed) != expect_cnt) {
         PDLOG(WARNING, "snapshot %s , expect cnt %lu but succ_cnt %lu", snapshot_name.c_str(), expect_cnt,
               g_succ_cnt.load(std::memory_order_relaxed));
@@ -107,6 +119,24 @@ void MemTableSnapshot::RecoverFromSnapshot(const std::string& snapshot_name, uin
 
 void MemTableSnapshot::RecoverSingleSnapshot(const std::string& path, std::shared_ptr<Table> table,
                                              std::atomic<uint64_t>* g_succ_cnt, std::atomic<uint64_t>* g_failed_cnt) {
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+    if (table != NULL && FLAGS_load_table_thread_num > 1 &&
+        SplitSnapshot(path, FLAGS_load_table_thread_num, &ranges) == 0 && ranges.size() > 1) {
+        // every thread reads and puts its own range, no record is copied and passed between threads
+        std::vector<std::thread> threads;
+        for (uint32_t i = 0; i < ranges.size(); i++) {
+            // the last range is read to the end of file in order to handle the broken tail as before
+            uint64_t block_cnt = i + 1 == ranges.size() ? 0 : ranges[i].second;
+            threads.emplace_back(&MemTableSnapshot::RecoverSnapshotRange, this, path, ranges[i].first, block_cnt,
+                                 table, g_succ_cnt, g_failed_cnt);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        PDLOG(INFO, "read path %s for table tid %u pid %u with %u threads completed", path.c_str(), tid_, pid_,
+              static_cast<uint32_t>(ranges.size()));
+        return;
+    }
     ::openmldb::base::TaskPool load_pool_(FLAGS_load_table_thread_num, FLAGS_load_table_batch);
     std::atomic<uint64_t> succ_cnt, failed_cnt;
     succ_cnt = failed_cnt = 0;
@@ -194,6 +224,102 @@ void MemTableSnapshot::Put(std::string& path, std::shared_ptr<Table>& table, std
     }
 }
 
+int MemTableSnapshot::SplitSnapshot(const std::string& path, uint32_t max_cnt,
+                                    std::vector<std::pair<uint64_t, uint64_t>>* ranges) {
+    uint64_t file_size = 0;
+    if (!::openmldb::base::GetFileSize(path, file_size)) {
+        return -1;
+    }
+    // the file offset of every block. the uncompressed blocks have fixed size,
+    // the compressed blocks are located by the length in their headers
+    std::vector<uint64_t> block_offsets;
+    if (!IsCompressed(path)) {
+        for (uint64_t offset = 0; offset < file_size; offset += ::openmldb::log::kBlockSize) {
+            block_offsets.push_back(offset);
+        }
+    } else {
+        FILE* fd = fopen(path.c_str(), "rb");
+        if (fd == NULL) {
+            PDLOG(WARNING, "fail to open path %s for error %s", path.c_str(), strerror(errno));
+            return -1;
+        }
+        char header[::openmldb::log::kHeaderSizeOfCompressBlock];
+        uint64_t offset = 0;
+        while (offset + ::openmldb::log::kHeaderSizeOfCompressBlock <= file_size) {
+            if (fseek(fd, offset, SEEK_SET) != 0 || fread(header, 1, sizeof(header), fd) != sizeof(header)) {
+                break;
+            }
+            uint32_t compress_len = 0;
+            memcpy(static_cast<void*>(&compress_len), header, sizeof(uint32_t));
+            memrev32ifbe(static_cast<void*>(&compress_len));
+            block_offsets.push_back(offset);
+            offset += ::openmldb::log::kHeaderSizeOfCompressBlock + compress_len;
+        }
+        fclose(fd);
+    }
+    ranges->clear();
+    uint64_t range_cnt = std::min(static_cast<uint64_t>(max_cnt), static_cast<uint64_t>(block_offsets.size()));
+    for (uint64_t i = 0; i < range_cnt; i++) {
+        uint64_t start = block_offsets.size() * i / range_cnt;
+        uint64_t end = block_offsets.size() * (i + 1) / range_cnt;
+        ranges->emplace_back(block_offsets[start], end - start);
+    }
+    return 0;
+}
+
+void MemTableSnapshot::RecoverSnapshotRange(const std::string& path, uint64_t file_offset, uint64_t block_cnt,
+                                            std::shared_ptr<Table> table, std::atomic<uint64_t>* succ_cnt,
+                                            std::atomic<uint64_t>* failed_cnt) {
+    FILE* fd = fopen(path.c_str(), "rb");
+    if (fd == NULL) {
+        PDLOG(WARNING, "fail to open path %s for error %s", path.c_str(), strerror(errno));
+        return;
+    }
+    if (fseek(fd, file_offset, SEEK_SET) != 0) {
+        PDLOG(WARNING, "fail to seek path %s to %lu for error %s", path.c_str(), file_offset, strerror(errno));
+        fclose(fd);
+        return;
+    }
+    bool compressed = IsCompressed(path);
+    // the offsets in reader are relative to file_offset and count the uncompressed bytes
+    uint64_t block_size = compressed ? ::openmldb::log::kCompressBlockSize : ::openmldb::log::kBlockSize;
+    uint64_t end_offset = block_cnt == 0 ? UINT64_MAX : block_cnt * block_size;
+    ::openmldb::log::SequentialFile* seq_file = ::openmldb::log::NewSeqFile(path, fd);
+    ::openmldb::log::Reader reader(seq_file, NULL, false, 0, compressed);
+    std::string buffer;
+    ::openmldb::api::LogEntry entry;
+    while (true) {
+        ::openmldb::base::Slice record;
+        ::openmldb::log::Status status = reader.ReadRecord(&record, &buffer);
+        if (status.IsWaitRecord() || status.IsEof()) {
+            break;
+        }
+        if (!status.ok()) {
+            PDLOG(WARNING, "fail to read record for tid %u, pid %u with error %s", tid_, pid_,
+                  status.ToString().c_str());
+            failed_cnt->fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        // the fragments of the record which begins in the previous range are skipped by reader,
+        // and the record which begins in the next range is left to it
+        if (reader.LastRecordOffset() >= end_offset) {
+            break;
+        }
+        if (!entry.ParseFromArray(record.data(), record.size())) {
+            failed_cnt->fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        auto scount = succ_cnt->fetch_add(1, std::memory_order_relaxed);
+        if (scount % 100000 == 0) {
+            PDLOG(INFO, "load snapshot %s with succ_cnt %lu, failed_cnt %lu", path.c_str(), scount,
+                  failed_cnt->load(std::memory_order_relaxed));
+        }
+        table->Put(entry);
+    }
+    // will close the fd atomic
+    delete seq_file;
+}
+
 int MemTableSnapshot::TTLSnapshot(std::shared_ptr<Table> table, const ::openmldb::api::Manifest& manifest,
                                   WriteHandle* wh, uint64_t& count, uint64_t& expired_key_num,
                                   uint64_t& deleted_key_num) {
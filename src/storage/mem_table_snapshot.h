@@ -21,6 +21,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "base/status.h"
@@ -120,6 +121,16 @@ class MemTableSnapshot : public Snapshot {
     void RecoverSingleSnapshot(const std::string& path, std::shared_ptr<Table> table, std::atomic<uint64_t>* g_succ_cnt,
                                std::atomic<uint64_t>* g_failed_cnt);
 
+    // split snapshot into at most max_cnt ranges of blocks, every range is
+    // described by the file offset of its first block and the count of blocks
+    int SplitSnapshot(const std::string& path, uint32_t max_cnt,
+                      std::vector<std::pair<uint64_t, uint64_t>>* ranges);
+
+    // load the records which begin in the range. block_cnt 0 means reading to the end of file
+    void RecoverSnapshotRange(const std::string& path, uint64_t file_offset, uint64_t block_cnt,
+                              std::shared_ptr<Table> table, std::atomic<uint64_t>* succ_cnt,
+                              std::atomic<uint64_t>* failed_cnt);
+
     uint64_t CollectDeletedKey(uint64_t end_offset);
 
     int DecodeData(std::shared_ptr<Table> table, const openmldb::api::LogEntry& entry, uint32_t maxIdx,
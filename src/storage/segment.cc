@@ -18,6 +18,9 @@
 
 #include <gflags/gflags.h>
 
+#include <optional>
+#include <utility>
+
 #include "base/glog_wrapper.h"
 #include "base/strings.h"
 #include "common/timer.h"
@@ -26,6 +29,7 @@
 DECLARE_int32(gc_safe_offset);
 DECLARE_uint32(skiplist_max_height);
 DECLARE_uint32(gc_deleted_pk_version_delta);
+DECLARE_uint32(segment_slab_chunk_size);
 
 namespace openmldb {
 namespace storage {
@@ -34,43 +38,61 @@ static const SliceComparator scmp;
 Segment::Segment()
     : entries_(NULL),
       mu_(),
+      entry_locks_(),
+      remove_version_(0),
       idx_cnt_(0),
       idx_byte_size_(0),
       pk_cnt_(0),
       ts_cnt_(1),
       gc_version_(0),
-      ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000) {
+      ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000),
+      slab_() {
     entries_ = new KeyEntries((uint8_t)FLAGS_skiplist_max_height, 4, scmp);
     key_entry_max_height_ = (uint8_t)FLAGS_skiplist_max_height;
     entry_free_list_ = new KeyEntryNodeList(4, 4, tcmp);
+    if (FLAGS_segment_slab_chunk_size > 0) {
+        slab_.reset(new ::openmldb::base::SlabAllocator(FLAGS_segment_slab_chunk_size));
+    }
 }
 
 Segment::Segment(uint8_t height)
     : entries_(NULL),
       mu_(),
+      entry_locks_(),
+      remove_version_(0),
       idx_cnt_(0),
       idx_byte_size_(0),
       pk_cnt_(0),
       key_entry_max_height_(height),
       ts_cnt_(1),
       gc_version_(0),
-      ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000) {
+      ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000),
+      slab_() {
     entries_ = new KeyEntries((uint8_t)FLAGS_skiplist_max_height, 4, scmp);
     entry_free_list_ = new KeyEntryNodeList(4, 4, tcmp);
+    if (FLAGS_segment_slab_chunk_size > 0) {
+        slab_.reset(new ::openmldb::base::SlabAllocator(FLAGS_segment_slab_chunk_size));
+    }
 }
 
 Segment::Segment(uint8_t height, const std::vector<uint32_t>& ts_idx_vec)
     : entries_(NULL),
       mu_(),
+      entry_locks_(),
+      remove_version_(0),
       idx_cnt_(0),
       idx_byte_size_(0),
       pk_cnt_(0),
       key_entry_max_height_(height),
       ts_cnt_(ts_idx_vec.size()),
       gc_version_(0),
-      ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000) {
+      ttl_offset_(FLAGS_gc_safe_offset * 60 * 1000),
+      slab_() {
     entries_ = new KeyEntries((uint8_t)FLAGS_skiplist_max_height, 4, scmp);
     entry_free_list_ = new KeyEntryNodeList(4, 4, tcmp);
+    if (FLAGS_segment_slab_chunk_size > 0) {
+        slab_.reset(new ::openmldb::base::SlabAllocator(FLAGS_segment_slab_chunk_size));
+    }
     for (uint32_t i = 0; i < ts_idx_vec.size(); i++) {
         ts_idx_map_[ts_idx_vec[i]] = i;
         idx_cnt_vec_.push_back(std::make_shared<std::atomic<uint64_t>>(0));
@@ -92,13 +114,13 @@ uint64_t Segment::Release() {
             if (ts_cnt_ > 1) {
                 KeyEntry** entry_arr = (KeyEntry**)it->GetValue();  // NOLINT
                 for (uint32_t i = 0; i < ts_cnt_; i++) {
-                    cnt += entry_arr[i]->Release();
+                    cnt += entry_arr[i]->Release(slab_.get());
                     delete entry_arr[i];
                 }
                 delete[] entry_arr;
             } else {
                 KeyEntry* entry = (KeyEntry*)it->GetValue();  // NOLINT
-                cnt += entry->Release();
+                cnt += entry->Release(slab_.get());
                 delete entry;
             }
         }
@@ -115,13 +137,13 @@ uint64_t Segment::Release() {
         if (ts_cnt_ > 1) {
             KeyEntry** entry_arr = (KeyEntry**)node->GetValue();  // NOLINT
             for (uint32_t i = 0; i < ts_cnt_; i++) {
-                entry_arr[i]->Release();
+                entry_arr[i]->Release(slab_.get());
                 delete entry_arr[i];
             }
             delete[] entry_arr;
         } else {
             KeyEntry* entry = (KeyEntry*)node->GetValue();  // NOLINT
-            entry->Release();
+            entry->Release(slab_.get());
             delete entry;
         }
         delete node;
@@ -138,11 +160,7 @@ void Segment::ReleaseAndCount(uint64_t& gc_idx_cnt, uint64_t& gc_record_cnt, uin
     it->SeekToFirst();
     while (it->Valid()) {
         Slice key = it->GetKey();
-        ::openmldb::base::Node<Slice, void*>* entry_node = NULL;
-        {
-            std::lock_guard<std::mutex> lock(mu_);
-            entry_node = entries_->Remove(key);
-        }
+        ::openmldb::base::Node<Slice, void*>* entry_node = RemoveKey(key, false);
         if (entry_node != NULL) {
             FreeEntry(entry_node, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
         }
@@ -159,7 +177,7 @@ void Segment::Put(const Slice& key, uint64_t time, const char* data, uint32_t si
     if (ts_cnt_ > 1) {
         return;
     }
-    auto* db = new DataBlock(1, data, size);
+    auto* db = DataBlock::New(1, data, size);
     Put(key, time, db);
 }
 
@@ -167,61 +185,108 @@ void Segment::Put(const Slice& key, uint64_t time, DataBlock* row) {
     if (ts_cnt_ > 1) {
         return;
     }
-    std::lock_guard<std::mutex> lock(mu_);
-    PutUnlock(key, time, row);
+    std::unique_lock<::openmldb::base::SpinMutex> lock;
+    KeyEntry* entry = reinterpret_cast<KeyEntry*>(LockEntry(key, &lock));
+    PutUnlock(entry, time, row, idx_cnt_);
+}
+
+void Segment::PutUnlock(KeyEntry* entry, uint64_t time, DataBlock* row, std::atomic<uint64_t>& idx_cnt) {
+    // appending a row newer than all the rows of key doesn't change the rows read before
+    auto* first = entry->entries.GetFirst();
+    bool is_append = first == NULL || time > first->GetKey();
+    uint8_t height = entry->entries.Insert(time, row, slab_.get());
+    if (!is_append) {
+        entry->BumpVersion();
+    }
+    entry->count_.fetch_add(1, std::memory_order_relaxed);
+    idx_cnt.fetch_add(1, std::memory_order_relaxed);
+    idx_byte_size_.fetch_add(GetRecordTsIdxSize(height), std::memory_order_relaxed);
 }
 
-void Segment::PutUnlock(const Slice& key, uint64_t time, DataBlock* row) {
-    void* entry = nullptr;
+void* Segment::GetOrCreateEntry(const Slice& key) {
+    void* entry = NULL;
+    if (entries_->Get(key, entry) == 0 && entry != NULL) {
+        return entry;
+    }
+    std::lock_guard<std::mutex> lock(mu_);
+    // the key may be created by other writers before we get the lock
+    if (entries_->Get(key, entry) == 0 && entry != NULL) {
+        return entry;
+    }
+    char* pk = new char[key.size()];
+    memcpy(pk, key.data(), key.size());
+    // need to delete memory when free node
+    Slice skey(pk, key.size());
     uint32_t byte_size = 0;
-    int ret = entries_->Get(key, entry);
-    if (ret < 0 || entry == NULL) {
-        char* pk = new char[key.size()];
-        memcpy(pk, key.data(), key.size());
-        // need to delete memory when free node
-        Slice skey(pk, key.size());
+    if (ts_cnt_ > 1) {
+        auto** entry_arr = new KeyEntry*[ts_cnt_];
+        for (uint32_t i = 0; i < ts_cnt_; i++) {
+            entry_arr[i] = new KeyEntry(key_entry_max_height_);
+        }
+        entry = (void*)entry_arr;  // NOLINT
+        uint8_t height = entries_->Insert(skey, entry);
+        byte_size = GetRecordPkMultiIdxSize(height, key.size(), key_entry_max_height_, ts_cnt_);
+    } else {
         entry = (void*)new KeyEntry(key_entry_max_height_);  // NOLINT
         uint8_t height = entries_->Insert(skey, entry);
-        byte_size += GetRecordPkIdxSize(height, key.size(), key_entry_max_height_);
-        pk_cnt_.fetch_add(1, std::memory_order_relaxed);
-    }
-    idx_cnt_.fetch_add(1, std::memory_order_relaxed);
-    uint8_t height = ((KeyEntry*)entry)->entries.Insert(time, row);  // NOLINT
-    ((KeyEntry*)entry)                                               // NOLINT
-        ->count_.fetch_add(1, std::memory_order_relaxed);
-    byte_size += GetRecordTsIdxSize(height);
+        byte_size = GetRecordPkIdxSize(height, key.size(), key_entry_max_height_);
+    }
     idx_byte_size_.fetch_add(byte_size, std::memory_order_relaxed);
+    pk_cnt_.fetch_add(1, std::memory_order_relaxed);
+    return entry;
+}
+
+void* Segment::LockEntry(const Slice& key, std::unique_lock<::openmldb::base::SpinMutex>* lock) {
+    while (true) {
+        uint64_t version = remove_version_.load(std::memory_order_acquire);
+        void* entry = GetOrCreateEntry(key);
+        std::unique_lock<::openmldb::base::SpinMutex> entry_lock(GetEntryLock(entry));
+        // the removal of key holds the entry lock, so the entry can not be removed once we get it.
+        // check whether the key is removed between the lookup and the lock
+        void* cur = NULL;
+        if (version == remove_version_.load(std::memory_order_acquire) ||
+            (entries_->Get(key, cur) == 0 && cur == entry)) {
+            *lock = std::move(entry_lock);
+            return entry;
+        }
+    }
 }
 
-void Segment::BulkLoadPut(unsigned int key_entry_id, const Slice& key, uint64_t time, DataBlock* row) {
-    void* key_entry_or_list = nullptr;
-    uint32_t byte_size = 0;
-    std::lock_guard<std::mutex> lock(mu_);  // TODO(hw): need lock?
-    int ret = entries_->Get(key, key_entry_or_list);
-    if (ts_cnt_ == 1) {
-        PutUnlock(key, time, row);
-    } else {
-        if (ret < 0 || key_entry_or_list == nullptr) {
-            char* pk = new char[key.size()];
-            memcpy(pk, key.data(), key.size());
-            Slice skey(pk, key.size());
-            auto** entry_arr_tmp = new KeyEntry*[ts_cnt_];
+::openmldb::base::Node<Slice, void*>* Segment::RemoveKey(const Slice& key, bool only_empty) {
+    std::lock_guard<std::mutex> lock(mu_);
+    void* entry = NULL;
+    if (entries_->Get(key, entry) < 0 || entry == NULL) {
+        return NULL;
+    }
+    std::lock_guard<::openmldb::base::SpinMutex> entry_lock(GetEntryLock(entry));
+    if (only_empty) {
+        if (ts_cnt_ > 1) {
+            KeyEntry** entry_arr = (KeyEntry**)entry;  // NOLINT
             for (uint32_t i = 0; i < ts_cnt_; i++) {
-                entry_arr_tmp[i] = new KeyEntry(key_entry_max_height_);
+                if (!entry_arr[i]->entries.IsEmpty()) {
+                    return NULL;
+                }
             }
-            auto entry_arr = (void*)entry_arr_tmp;  // NOLINT
-            uint8_t height = entries_->Insert(skey, entry_arr);
-            byte_size += GetRecordPkMultiIdxSize(height, key.size(), key_entry_max_height_, ts_cnt_);
-            pk_cnt_.fetch_add(1, std::memory_order_relaxed);
+        } else if (!((KeyEntry*)entry)->entries.IsEmpty()) {  // NOLINT
+            return NULL;
         }
-        uint8_t height = ((KeyEntry**)key_entry_or_list)[key_entry_id]->entries.Insert(  // NOLINT
-            time, row);
-        ((KeyEntry**)key_entry_or_list)[key_entry_id]->count_.fetch_add(  // NOLINT
-            1, std::memory_order_relaxed);
-        byte_size += GetRecordTsIdxSize(height);
-        idx_byte_size_.fetch_add(byte_size, std::memory_order_relaxed);
-        idx_cnt_vec_[key_entry_id]->fetch_add(1, std::memory_order_relaxed);
     }
+    ::openmldb::base::Node<Slice, void*>* entry_node = entries_->Remove(key);
+    remove_version_.fetch_add(1, std::memory_order_release);
+    return entry_node;
+}
+
+void Segment::BulkLoadPut(unsigned int key_entry_id, const Slice& key, uint64_t time, DataBlock* row) {
+    if (ts_cnt_ == 1) {
+        Put(key, time, row);
+        return;
+    }
+    if (key_entry_id >= ts_cnt_) {
+        return;
+    }
+    std::unique_lock<::openmldb::base::SpinMutex> lock;
+    KeyEntry** entry_arr = reinterpret_cast<KeyEntry**>(LockEntry(key, &lock));
+    PutUnlock(entry_arr[key_entry_id], time, row, *idx_cnt_vec_[key_entry_id]);
 }
 
 void Segment::Put(const Slice& key, const std::map<int32_t, uint64_t>& ts_map, DataBlock* row) {
@@ -236,48 +301,24 @@ void Segment::Put(const Slice& key, const std::map<int32_t, uint64_t>& ts_map, D
         }
         return;
     }
-    void* entry_arr = NULL;
-    std::lock_guard<std::mutex> lock(mu_);
+    KeyEntry** entry_arr = NULL;
+    std::unique_lock<::openmldb::base::SpinMutex> lock;
     for (const auto& kv : ts_map) {
-        uint32_t byte_size = 0;
         auto pos = ts_idx_map_.find(kv.first);
         if (pos == ts_idx_map_.end()) {
             continue;
         }
         if (entry_arr == NULL) {
-            int ret = entries_->Get(key, entry_arr);
-            if (ret < 0 || entry_arr == NULL) {
-                char* pk = new char[key.size()];
-                memcpy(pk, key.data(), key.size());
-                Slice skey(pk, key.size());
-                KeyEntry** entry_arr_tmp = new KeyEntry*[ts_cnt_];
-                for (uint32_t i = 0; i < ts_cnt_; i++) {
-                    entry_arr_tmp[i] = new KeyEntry(key_entry_max_height_);
-                }
-                entry_arr = (void*)entry_arr_tmp;  // NOLINT
-                uint8_t height = entries_->Insert(skey, entry_arr);
-                byte_size += GetRecordPkMultiIdxSize(height, key.size(), key_entry_max_height_, ts_cnt_);
-                pk_cnt_.fetch_add(1, std::memory_order_relaxed);
-            }
+            entry_arr = reinterpret_cast<KeyEntry**>(LockEntry(key, &lock));
         }
-        uint8_t height = ((KeyEntry**)entry_arr)[pos->second]->entries.Insert(  // NOLINT
-            kv.second, row);
-        ((KeyEntry**)entry_arr)[pos->second]->count_.fetch_add(  // NOLINT
-            1, std::memory_order_relaxed);
-        byte_size += GetRecordTsIdxSize(height);
-        idx_byte_size_.fetch_add(byte_size, std::memory_order_relaxed);
-        idx_cnt_vec_[pos->second]->fetch_add(1, std::memory_order_relaxed);
+        PutUnlock(entry_arr[pos->second], kv.second, row, *idx_cnt_vec_[pos->second]);
     }
 }
 
 bool Segment::Delete(const Slice& key) {
-    ::openmldb::base::Node<Slice, void*>* entry_node = NULL;
-    {
-        std::lock_guard<std::mutex> lock(mu_);
-        entry_node = entries_->Remove(key);
-        if (entry_node == NULL) {
-            return false;
-        }
+    ::openmldb::base::Node<Slice, void*>* entry_node = RemoveKey(key, false);
+    if (entry_node == NULL) {
+        return false;
     }
     {
         std::lock_guard<std::mutex> lock(gc_mu_);
@@ -288,6 +329,14 @@ bool Segment::Delete(const Slice& key) {
 
 void Segment::FreeList(::openmldb::base::Node<uint64_t, DataBlock*>* node, uint64_t& gc_idx_cnt,
                        uint64_t& gc_record_cnt, uint64_t& gc_record_byte_size) {
+    if (node == NULL) {
+        return;
+    }
+    // the nodes are given back to slab in bulk when the batch is destroyed
+    std::optional<::openmldb::base::SlabAllocator::FreeBatch> batch;
+    if (slab_) {
+        batch.emplace(slab_.get());
+    }
     while (node != NULL) {
         gc_idx_cnt++;
         ::openmldb::base::Node<uint64_t, DataBlock*>* tmp = node;
@@ -302,7 +351,11 @@ void Segment::FreeList(::openmldb::base::Node<uint64_t, DataBlock*>* node, uint6
             delete tmp->GetValue();
             gc_record_cnt++;
         }
-        delete tmp;
+        if (batch) {
+            ::openmldb::base::Node<uint64_t, DataBlock*>::Delete(tmp, &batch.value());
+        } else {
+            delete tmp;
+        }
     }
 }
 
@@ -456,13 +509,16 @@ void Segment::Gc4Head(uint64_t keep_cnt, uint64_t& gc_idx_cnt, uint64_t& gc_reco
         KeyEntry* entry = (KeyEntry*)it->GetValue();  // NOLINT
         ::openmldb::base::Node<uint64_t, DataBlock*>* node = NULL;
         {
-            std::lock_guard<std::mutex> lock(mu_);
+            std::lock_guard<::openmldb::base::SpinMutex> lock(GetEntryLock(entry));
             if (entry->refs_.load(std::memory_order_acquire) <= 0) {
                 node = entry->entries.SplitByPos(keep_cnt);
             }
         }
         uint64_t entry_gc_idx_cnt = 0;
         FreeList(node, entry_gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+        if (entry_gc_idx_cnt > 0) {
+            entry->BumpVersion();
+        }
         entry->count_.fetch_sub(entry_gc_idx_cnt, std::memory_order_relaxed);
         gc_idx_cnt += entry_gc_idx_cnt;
         it->Next();
@@ -502,7 +558,7 @@ void Segment::GcAllType(const std::map<uint32_t, TTLSt>& ttl_st_map, uint64_t& g
                         continue_flag = true;
                     } else {
                         node = NULL;
-                        std::lock_guard<std::mutex> lock(mu_);
+                        std::lock_guard<::openmldb::base::SpinMutex> lock(GetEntryLock(entry_arr));
                         SplitList(entry, kv.second.abs_ttl, &node);
                         if (entry->entries.IsEmpty()) {
                             empty_cnt++;
@@ -511,7 +567,7 @@ void Segment::GcAllType(const std::map<uint32_t, TTLSt>& ttl_st_map, uint64_t& g
                     break;
                 }
                 case ::openmldb::storage::TTLType::kLatestTime: {
-                    std::lock_guard<std::mutex> lock(mu_);
+                    std::lock_guard<::openmldb::base::SpinMutex> lock(GetEntryLock(entry_arr));
                     if (entry->refs_.load(std::memory_order_acquire) <= 0) {
                         node = entry->entries.SplitByPos(kv.second.lat_ttl);
                     }
@@ -523,7 +579,7 @@ void Segment::GcAllType(const std::map<uint32_t, TTLSt>& ttl_st_map, uint64_t& g
                         continue_flag = true;
                     } else {
                         node = NULL;
-                        std::lock_guard<std::mutex> lock(mu_);
+                        std::lock_guard<::openmldb::base::SpinMutex> lock(GetEntryLock(entry_arr));
                         if (entry->refs_.load(std::memory_order_acquire) <= 0) {
                             node = entry->entries.SplitByKeyAndPos(kv.second.abs_ttl, kv.second.lat_ttl);
                         }
@@ -536,7 +592,7 @@ void Segment::GcAllType(const std::map<uint32_t, TTLSt>& ttl_st_map, uint64_t& g
                         continue_flag = true;
                     } else {
                         node = NULL;
-                        std::lock_guard<std::mutex> lock(mu_);
+                        std::lock_guard<::openmldb::base::SpinMutex> lock(GetEntryLock(entry_arr));
                         if (entry->refs_.load(std::memory_order_acquire) <= 0) {
                             if (kv.second.abs_ttl == 0) {
                                 node = entry->entries.SplitByPos(kv.second.lat_ttl);
@@ -560,25 +616,15 @@ void Segment::GcAllType(const std::map<uint32_t, TTLSt>& ttl_st_map, uint64_t& g
             }
             uint64_t entry_gc_idx_cnt = 0;
             FreeList(node, entry_gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+            if (entry_gc_idx_cnt > 0) {
+                entry->BumpVersion();
+            }
             entry->count_.fetch_sub(entry_gc_idx_cnt, std::memory_order_relaxed);
             idx_cnt_vec_[pos->second]->fetch_sub(entry_gc_idx_cnt, std::memory_order_relaxed);
             gc_idx_cnt += entry_gc_idx_cnt;
         }
         if (empty_cnt == ts_cnt_) {
-            bool is_empty = true;
-            ::openmldb::base::Node<Slice, void*>* entry_node = NULL;
-            {
-                std::lock_guard<std::mutex> lock(mu_);
-                for (uint32_t i = 0; i < ts_cnt_; i++) {
-                    if (!entry_arr[i]->entries.IsEmpty()) {
-                        is_empty = false;
-                        break;
-                    }
-                }
-                if (is_empty) {
-                    entry_node = entries_->Remove(key);
-                }
-            }
+            ::openmldb::base::Node<Slice, void*>* entry_node = RemoveKey(key, true);
             if (entry_node != NULL) {
                 std::lock_guard<std::mutex> lock(gc_mu_);
                 entry_free_list_->Insert(gc_version_.load(std::memory_order_relaxed), entry_node);
@@ -620,12 +666,14 @@ void Segment::Gc4TTL(const uint64_t time, uint64_t& gc_idx_cnt, uint64_t& gc_rec
         }
         node = NULL;
         ::openmldb::base::Node<Slice, void*>* entry_node = NULL;
+        bool is_empty = false;
         {
-            std::lock_guard<std::mutex> lock(mu_);
+            std::lock_guard<::openmldb::base::SpinMutex> lock(GetEntryLock(entry));
             SplitList(entry, time, &node);
-            if (entry->entries.IsEmpty()) {
-                entry_node = entries_->Remove(key);
-            }
+            is_empty = entry->entries.IsEmpty();
+        }
+        if (is_empty) {
+            entry_node = RemoveKey(key, true);
         }
         if (entry_node != NULL) {
             std::lock_guard<std::mutex> lock(gc_mu_);
@@ -633,6 +681,9 @@ void Segment::Gc4TTL(const uint64_t time, uint64_t& gc_idx_cnt, uint64_t& gc_rec
         }
         uint64_t entry_gc_idx_cnt = 0;
         FreeList(node, entry_gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+        if (entry_gc_idx_cnt > 0) {
+            entry->BumpVersion();
+        }
         entry->count_.fetch_sub(entry_gc_idx_cnt, std::memory_order_relaxed);
         gc_idx_cnt += entry_gc_idx_cnt;
     }
@@ -667,13 +718,16 @@ void Segment::Gc4TTLAndHead(const uint64_t time, const uint64_t keep_cnt, uint64
         }
         node = NULL;
         {
-            std::lock_guard<std::mutex> lock(mu_);
+            std::lock_guard<::openmldb::base::SpinMutex> lock(GetEntryLock(entry));
             if (entry->refs_.load(std::memory_order_acquire) <= 0) {
                 node = entry->entries.SplitByKeyAndPos(time, keep_cnt);
             }
         }
         uint64_t entry_gc_idx_cnt = 0;
         FreeList(node, entry_gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+        if (entry_gc_idx_cnt > 0) {
+            entry->BumpVersion();
+        }
         entry->count_.fetch_sub(entry_gc_idx_cnt, std::memory_order_relaxed);
         gc_idx_cnt += entry_gc_idx_cnt;
     }
@@ -711,14 +765,16 @@ void Segment::Gc4TTLOrHead(const uint64_t time, const uint64_t keep_cnt, uint64_
         }
         node = NULL;
         ::openmldb::base::Node<Slice, void*>* entry_node = NULL;
+        bool is_empty = false;
         {
-            std::lock_guard<std::mutex> lock(mu_);
+            std::lock_guard<::openmldb::base::SpinMutex> lock(GetEntryLock(entry));
             if (entry->refs_.load(std::memory_order_acquire) <= 0) {
                 node = entry->entries.SplitByKeyOrPos(time, keep_cnt);
             }
-            if (entry->entries.IsEmpty()) {
-                entry_node = entries_->Remove(key);
-            }
+            is_empty = entry->entries.IsEmpty();
+        }
+        if (is_empty) {
+            entry_node = RemoveKey(key, true);
         }
         if (entry_node != NULL) {
             std::lock_guard<std::mutex> lock(gc_mu_);
@@ -726,6 +782,9 @@ void Segment::Gc4TTLOrHead(const uint64_t time, const uint64_t keep_cnt, uint64_
         }
         uint64_t entry_gc_idx_cnt = 0;
         FreeList(node, entry_gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+        if (entry_gc_idx_cnt > 0) {
+            entry->BumpVersion();
+        }
         entry->count_.fetch_sub(entry_gc_idx_cnt, std::memory_order_relaxed);
         gc_idx_cnt += entry_gc_idx_cnt;
     }
@@ -17,6 +17,7 @@
 #ifndef SRC_STORAGE_SEGMENT_H_
 #define SRC_STORAGE_SEGMENT_H_
 
+#include <array>
 #include <atomic>
 #include <map>
 #include <memory>
@@ -24,7 +25,9 @@
 #include <vector>
 
 #include "base/skiplist.h"
+#include "base/slab_allocator.h"
 #include "base/slice.h"
+#include "base/spinlock.h"
 #include "proto/tablet.pb.h"
 #include "storage/iterator.h"
 #include "storage/schema.h"
@@ -43,9 +46,20 @@ class Ticket;
 struct DataBlock {
     // dimension count down
     uint8_t dim_cnt_down;
+    // data is placed right after the block in the same allocation
+    bool inline_data = false;
     uint32_t size;
     char* data;
 
+    // allocate the block and its data together, it is freed by delete as usual
+    static DataBlock* New(uint8_t dim_cnt, const char* input, uint32_t len) {
+        void* buf = ::operator new(sizeof(DataBlock) + len);
+        return ::new (buf) DataBlock(dim_cnt, input, len, reinterpret_cast<char*>(buf) + sizeof(DataBlock));
+    }
+
+    static void* operator new(size_t size) { return ::operator new(size); }
+    static void operator delete(void* ptr) { ::operator delete(ptr); }
+
     DataBlock(uint8_t dim_cnt, const char* input, uint32_t len) : dim_cnt_down(dim_cnt), size(len), data(NULL) {
         data = new char[len];
         memcpy(data, input, len);
@@ -62,9 +76,17 @@ struct DataBlock {
     }
 
     ~DataBlock() {
-        delete[] data;
+        if (!inline_data) {
+            delete[] data;
+        }
         data = NULL;
     }
+
+ private:
+    DataBlock(uint8_t dim_cnt, const char* input, uint32_t len, char* buf)
+        : dim_cnt_down(dim_cnt), inline_data(true), size(len), data(buf) {
+        memcpy(data, input, len);
+    }
 };
 
 // the desc time comparator
@@ -100,12 +122,15 @@ class MemTableIterator : public TableIterator {
 
 class KeyEntry {
  public:
-    KeyEntry() : entries(12, 4, tcmp), refs_(0), count_(0) {}
-    explicit KeyEntry(uint8_t height) : entries(height, 4, tcmp), refs_(0), count_(0) {}
+    KeyEntry() : entries(12, 4, tcmp), refs_(0), count_(0), version_(NewVersionBase()) {}
+    explicit KeyEntry(uint8_t height) : entries(height, 4, tcmp), refs_(0), count_(0), version_(NewVersionBase()) {}
     ~KeyEntry() {}
 
     // just return the count of datablock
-    uint64_t Release() {
+    uint64_t Release() { return Release(NULL); }
+
+    // slab is the one the time entries are inserted with
+    uint64_t Release(::openmldb::base::SlabAllocator* slab) {
         uint64_t cnt = 0;
         TimeEntries::Iterator* it = entries.NewIterator();
         it->SeekToFirst();
@@ -120,7 +145,7 @@ class KeyEntry {
             }
             it->Next();
         }
-        entries.Clear();
+        entries.Clear(slab);
         delete it;
         return cnt;
     }
@@ -131,10 +156,24 @@ class KeyEntry {
 
     uint64_t GetCount() { return count_.load(std::memory_order_relaxed); }
 
+    // the version is changed by every put, delete and gc of the entries except appending
+    // a row newer than all of them, so the readers can tell if the rows they have seen are changed
+    uint64_t GetVersion() { return version_.load(std::memory_order_acquire); }
+
+    void BumpVersion() { version_.fetch_add(1, std::memory_order_release); }
+
+ private:
+    // the versions of entries start at distinct bases, so a key deleted and put again doesn't repeat them
+    static uint64_t NewVersionBase() {
+        static std::atomic<uint64_t> base(0);
+        return base.fetch_add(1ULL << 32, std::memory_order_relaxed);
+    }
+
  public:
     TimeEntries entries;
     std::atomic<uint64_t> refs_;
     std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> version_;
     friend Segment;
 };
 
@@ -157,8 +196,6 @@ class Segment {
 
     void Put(const Slice& key, uint64_t time, DataBlock* row);
 
-    void PutUnlock(const Slice& key, uint64_t time, DataBlock* row);
-
     void BulkLoadPut(unsigned int key_entry_id, const Slice& key, uint64_t time, DataBlock* row);
 
     void Put(const Slice& key, const std::map<int32_t, uint64_t>& ts_map, DataBlock* row);
@@ -225,6 +262,9 @@ class Segment {
 
     inline uint64_t GetPkCnt() { return pk_cnt_.load(std::memory_order_relaxed); }
 
+    // the bytes reserved by the node slab but not in use
+    inline uint64_t GetSlabFragByteSize() { return slab_ ? slab_->GetFragByteSize() : 0; }
+
     void GcFreeList(uint64_t& entry_gc_idx_cnt,      // NOLINT
                     uint64_t& gc_record_cnt,         // NOLINT
                     uint64_t& gc_record_byte_size);  // NOLINT
@@ -241,6 +281,21 @@ class Segment {
                          uint64_t& gc_record_byte_size);  // NOLINT
 
  private:
+    // insert into the time entries of entry, need the entry lock
+    void PutUnlock(KeyEntry* entry, uint64_t time, DataBlock* row, std::atomic<uint64_t>& idx_cnt);  // NOLINT
+    // return KeyEntry* or KeyEntry** if ts_cnt_ > 1, the key is created if not exist
+    void* GetOrCreateEntry(const Slice& key);
+    // get or create the entry of key and hold its lock
+    void* LockEntry(const Slice& key, std::unique_lock<::openmldb::base::SpinMutex>* lock);
+    // remove key from entries_, only remove it if all its time entries are empty when only_empty is true
+    ::openmldb::base::Node<Slice, void*>* RemoveKey(const Slice& key, bool only_empty);
+
+    // the lock of the time entries of a key, entry is the value of key in entries_
+    ::openmldb::base::SpinMutex& GetEntryLock(const void* entry) {
+        uint64_t hash = reinterpret_cast<uintptr_t>(entry) * 0x9E3779B97F4A7C15ULL;
+        return entry_locks_[(hash >> 32) % kEntryLockCnt];
+    }
+
     void FreeList(::openmldb::base::Node<uint64_t, DataBlock*>* node, uint64_t& gc_idx_cnt,  // NOLINT
                   uint64_t& gc_record_cnt,         // NOLINT
                   uint64_t& gc_record_byte_size);  // NOLINT
@@ -254,9 +309,15 @@ class Segment {
                    uint64_t& gc_record_byte_size);  // NOLINT
 
  private:
+    static constexpr uint32_t kEntryLockCnt = 64;
+
     KeyEntries* entries_;
-    // only Put need mutex
+    // the writers of entries_ (create and remove key) need mutex, the lookup is lock free
     std::mutex mu_;
+    // the writers of the time entries of a key need the entry lock, removing key needs both mu_ and it
+    std::array<::openmldb::base::SpinMutex, kEntryLockCnt> entry_locks_;
+    // increased on every key removal, the put checks it to find out the key is removed after lookup
+    std::atomic<uint64_t> remove_version_;
     std::mutex gc_mu_;
     std::atomic<uint64_t> idx_cnt_;
     std::atomic<uint64_t> idx_byte_size_;
@@ -268,6 +329,8 @@ class Segment {
     std::map<uint32_t, uint32_t> ts_idx_map_;
     std::vector<std::shared_ptr<std::atomic<uint64_t>>> idx_cnt_vec_;
     uint64_t ttl_offset_;
+    // the time entry nodes are allocated from it if segment_slab_chunk_size is not 0
+    std::unique_ptr<::openmldb::base::SlabAllocator> slab_;
 };
 
 }  // namespace storage
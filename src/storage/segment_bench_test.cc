@@ -0,0 +1,80 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "base/glog_wrapper.h"
+#include "common/timer.h"
+#include "gtest/gtest.h"
+#include "storage/segment.h"
+
+namespace openmldb {
+namespace storage {
+
+class SegmentBenchmarkTest : public ::testing::Test {
+ public:
+    SegmentBenchmarkTest() {}
+    ~SegmentBenchmarkTest() {}
+};
+
+// every thread puts put_cnt rows into key_cnt keys, the keys are shared by all threads if hot_key is true
+uint64_t RunConcurrentPut(uint32_t thread_cnt, uint32_t put_cnt, uint32_t key_cnt, bool hot_key) {
+    Segment segment;
+    std::string value(128, 'v');
+    std::vector<std::thread> threads;
+    uint64_t consumed = ::baidu::common::timer::get_micros();
+    for (uint32_t t = 0; t < thread_cnt; t++) {
+        threads.emplace_back([&, t] {
+            std::string prefix = hot_key ? "key" : "key" + std::to_string(t) + "_";
+            for (uint32_t i = 0; i < put_cnt; i++) {
+                std::string key = prefix + std::to_string(i % key_cnt);
+                segment.Put(Slice(key), 9527 + i, value.c_str(), value.size());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    consumed = ::baidu::common::timer::get_micros() - consumed;
+    EXPECT_EQ(static_cast<uint64_t>(thread_cnt) * put_cnt, segment.GetIdxCnt());
+    uint64_t qps = static_cast<uint64_t>(thread_cnt) * put_cnt * 1000000 / std::max(consumed, (uint64_t)1);
+    std::cout << (hot_key ? "hot" : "independent") << " keys, thread " << thread_cnt << " put "
+              << thread_cnt * put_cnt << " consumed " << consumed / 1000 << "ms qps " << qps << std::endl;
+    segment.Release();
+    return qps;
+}
+
+TEST_F(SegmentBenchmarkTest, ConcurrentPut) {
+    for (uint32_t thread_cnt = 1; thread_cnt <= 64; thread_cnt *= 2) {
+        RunConcurrentPut(thread_cnt, 20000, 100, false);
+    }
+    for (uint32_t thread_cnt = 1; thread_cnt <= 64; thread_cnt *= 2) {
+        RunConcurrentPut(thread_cnt, 20000, 100, true);
+    }
+}
+
+}  // namespace storage
+}  // namespace openmldb
+
+int main(int argc, char** argv) {
+    ::openmldb::base::SetLogLevel(INFO);
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
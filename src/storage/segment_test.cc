@@ -16,16 +16,24 @@
 
 #include "storage/segment.h"
 
+#include <atomic>
 #include <iostream>
+#include <optional>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "base/glog_wrapper.h"
 #include "base/slice.h"
+#include "gflags/gflags.h"
 #include "gtest/gtest.h"
 #include "storage/record.h"
+#include "storage/window_iterator.h"
 
 using ::openmldb::base::Slice;
 
+DECLARE_uint32(segment_slab_chunk_size);
+
 namespace openmldb {
 namespace storage {
 
@@ -51,6 +59,17 @@ TEST_F(SegmentTest, DataBlock) {
     delete db;
 }
 
+TEST_F(SegmentTest, InlineDataBlock) {
+    const char* test = "test";
+    DataBlock* db = DataBlock::New(2, test, 4);
+    ASSERT_TRUE(db->inline_data);
+    ASSERT_EQ(2, (int64_t)db->dim_cnt_down);
+    ASSERT_EQ(4, (int64_t)db->size);
+    ASSERT_EQ(reinterpret_cast<char*>(db) + sizeof(DataBlock), db->data);
+    ASSERT_EQ("test", std::string(db->data, db->size));
+    delete db;
+}
+
 TEST_F(SegmentTest, PutAndScan) {
     Segment segment;
     Slice pk("test1");
@@ -110,6 +129,50 @@ TEST_F(SegmentTest, Delete) {
     ASSERT_EQ(84, (int64_t)gc_record_byte_size);
 }
 
+TEST_F(SegmentTest, Version) {
+    Segment segment;
+    Segment* segments[1] = {&segment};
+    Slice pk("test1");
+    std::string value = "test0";
+    auto get_version = [&segments]() -> std::optional<uint64_t> {
+        MemTableKeyIterator it(segments, 1, TTLType::kAbsoluteTime, 0, 0, 0);
+        it.Seek("test1");
+        if (!it.Valid() || it.GetKey().ToString() != "test1") {
+            return std::nullopt;
+        }
+        return it.GetVersion();
+    };
+    ASSERT_FALSE(get_version().has_value());
+    segment.Put(pk, 9527, value.c_str(), value.size());
+    auto version = get_version();
+    ASSERT_TRUE(version.has_value());
+    // appending a newer row keeps the version
+    segment.Put(pk, 9529, value.c_str(), value.size());
+    ASSERT_EQ(version, get_version());
+    // inserting in the middle or at an existing ts bumps it
+    segment.Put(pk, 9528, value.c_str(), value.size());
+    ASSERT_NE(version, get_version());
+    version = get_version();
+    segment.Put(pk, 9529, value.c_str(), value.size());
+    ASSERT_NE(version, get_version());
+    version = get_version();
+    // gc bumps it only when rows are removed
+    uint64_t gc_idx_cnt = 0;
+    uint64_t gc_record_cnt = 0;
+    uint64_t gc_record_byte_size = 0;
+    segment.Gc4TTL(9000, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    ASSERT_EQ(version, get_version());
+    segment.Gc4TTL(9527, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    ASSERT_NE(version, get_version());
+    version = get_version();
+    // a deleted and recreated key gets a new version
+    ASSERT_TRUE(segment.Delete(pk));
+    ASSERT_FALSE(get_version().has_value());
+    segment.Put(pk, 9530, value.c_str(), value.size());
+    ASSERT_TRUE(get_version().has_value());
+    ASSERT_NE(version, get_version());
+}
+
 TEST_F(SegmentTest, GetCount) {
     Segment segment;
     Slice pk("test1");
@@ -354,6 +417,98 @@ TEST_F(SegmentTest, TestStat) {
     ASSERT_EQ(0, (int64_t)segment.GetIdxCnt());
 }
 
+TEST_F(SegmentTest, SlabPutAndGc) {
+    FLAGS_segment_slab_chunk_size = 4096;
+    Segment segment;
+    FLAGS_segment_slab_chunk_size = 0;
+    ASSERT_EQ(0u, segment.GetSlabFragByteSize());
+    for (uint64_t ts = 1; ts <= 100; ts++) {
+        std::string value = "test" + std::to_string(ts);
+        segment.Put(Slice("PK" + std::to_string(ts % 4)), 9000 + ts, value.c_str(), value.size());
+    }
+    ASSERT_EQ(100, (int64_t)segment.GetIdxCnt());
+    uint64_t frag_byte_size = segment.GetSlabFragByteSize();
+    ASSERT_GT(frag_byte_size, 0u);
+    ASSERT_LT(frag_byte_size, 4096u);
+    uint64_t gc_idx_cnt = 0;
+    uint64_t gc_record_cnt = 0;
+    uint64_t gc_record_byte_size = 0;
+    segment.Gc4Head(5, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    ASSERT_EQ(80, (int64_t)gc_idx_cnt);
+    ASSERT_EQ(80, (int64_t)gc_record_cnt);
+    ASSERT_EQ(20, (int64_t)segment.GetIdxCnt());
+    // the freed nodes are kept in slab
+    ASSERT_GT(segment.GetSlabFragByteSize(), frag_byte_size);
+    {
+        Ticket ticket;
+        MemTableIterator* it = segment.NewIterator("PK1", ticket);
+        it->SeekToFirst();
+        for (uint64_t ts = 97; ts > 77; ts -= 4) {
+            ASSERT_TRUE(it->Valid());
+            ASSERT_EQ(9000 + ts, it->GetKey());
+            ::openmldb::base::Slice value = it->GetValue();
+            ASSERT_EQ("test" + std::to_string(ts), std::string(value.data(), value.size()));
+            it->Next();
+        }
+        ASSERT_FALSE(it->Valid());
+        delete it;
+    }
+    // the freed nodes are reused
+    uint64_t reused_frag_byte_size = segment.GetSlabFragByteSize();
+    for (uint64_t ts = 101; ts <= 120; ts++) {
+        std::string value = "test" + std::to_string(ts);
+        segment.Put(Slice("PK" + std::to_string(ts % 4)), 9000 + ts, value.c_str(), value.size());
+    }
+    ASSERT_LT(segment.GetSlabFragByteSize(), reused_frag_byte_size);
+    ASSERT_EQ(40, (int64_t)segment.Release());
+}
+
+TEST_F(SegmentTest, ConcurrentPutAndGc) {
+    Segment segment;
+    uint32_t key_cnt = 64;
+    for (uint32_t i = 0; i < key_cnt; i++) {
+        segment.Put(Slice("PK" + std::to_string(i)), 1, "test0", 5);
+    }
+    std::atomic<bool> done(false);
+    uint64_t gc_idx_cnt = 0;
+    uint64_t gc_record_cnt = 0;
+    uint64_t gc_record_byte_size = 0;
+    // the keys emptied by gc are removed while putting new rows into them
+    std::thread gc_thread([&] {
+        while (!done.load(std::memory_order_relaxed)) {
+            segment.Gc4TTL(100, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+            segment.IncrGcVersion();
+        }
+    });
+    uint32_t thread_cnt = 4;
+    uint32_t put_cnt = 1920;
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < thread_cnt; t++) {
+        threads.emplace_back([&segment, t, key_cnt, put_cnt] {
+            for (uint32_t i = 0; i < put_cnt; i++) {
+                std::string value = "value" + std::to_string(t);
+                segment.Put(Slice("PK" + std::to_string(i % key_cnt)), 1000 + i, value.c_str(), value.size());
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    done.store(true, std::memory_order_relaxed);
+    gc_thread.join();
+    segment.Gc4TTL(100, gc_idx_cnt, gc_record_cnt, gc_record_byte_size);
+    ASSERT_EQ(key_cnt, gc_idx_cnt);
+    ASSERT_EQ(thread_cnt * put_cnt, segment.GetIdxCnt());
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < key_cnt; i++) {
+        uint64_t count = 0;
+        ASSERT_EQ(0, segment.GetCount(Slice("PK" + std::to_string(i)), count));
+        ASSERT_EQ(thread_cnt * put_cnt / key_cnt, count);
+        total += count;
+    }
+    ASSERT_EQ(thread_cnt * put_cnt, total);
+}
+
 TEST_F(SegmentTest, GetTsIdx) {
     std::vector<uint32_t> ts_idx_vec = {1, 3, 5};
     Segment segment(8, ts_idx_vec);
@@ -42,6 +42,7 @@
 
 DECLARE_string(db_root_path);
 DECLARE_string(snapshot_compression);
+DECLARE_uint32(load_table_thread_num);
 
 using ::openmldb::api::LogEntry;
 namespace openmldb {
@@ -1703,6 +1704,67 @@ TEST_F(SnapshotTest, Recover_large_snapshot_and_binlog) {
     delete it;
 }
 
+TEST_F(SnapshotTest, Recover_snapshot_parallel) {
+    std::string snapshot_dir = FLAGS_db_root_path + "/102_0/snapshot";
+    ::openmldb::base::MkdirRecur(snapshot_dir);
+    std::string snapshot_name = "20220101.sdb";
+    if (FLAGS_snapshot_compression != "off") {
+        snapshot_name.append(".");
+        snapshot_name.append(FLAGS_snapshot_compression);
+    }
+    uint32_t key_cnt = 10;
+    uint32_t record_cnt = 20000;
+    {
+        std::string full_path = snapshot_dir + "/" + snapshot_name;
+        FILE* fd_w = fopen(full_path.c_str(), "ab+");
+        ASSERT_TRUE(fd_w != NULL);
+        WriteHandle wh(FLAGS_snapshot_compression, snapshot_name, fd_w);
+        for (uint32_t i = 0; i < record_cnt; i++) {
+            // some records span several blocks
+            std::string value = i % 97 == 0 ? std::string(10 * 1024, 'a' + i % 26) : "value" + std::to_string(i);
+            auto entry = ::openmldb::test::PackKVEntry(i + 1, "key" + std::to_string(i % key_cnt), value, i + 1, 1);
+            std::string val;
+            ASSERT_TRUE(entry.SerializeToString(&val));
+            ASSERT_TRUE(wh.Write(Slice(val)).ok());
+        }
+        wh.EndLog();
+        wh.Sync();
+    }
+    std::map<std::string, uint32_t> mapping;
+    mapping.insert(std::make_pair("idx0", 0));
+    std::shared_ptr<MemTable> table =
+        std::make_shared<MemTable>("test", 102, 0, 8, mapping, 0, ::openmldb::type::TTLType::kAbsoluteTime);
+    table->Init();
+    LogParts* log_part = new LogParts(12, 4, scmp);
+    MemTableSnapshot snapshot(102, 0, log_part, FLAGS_db_root_path);
+    ASSERT_TRUE(snapshot.Init());
+    ASSERT_EQ(0, snapshot.GenManifest(snapshot_name, record_cnt, record_cnt, 1));
+    uint32_t old_thread_num = FLAGS_load_table_thread_num;
+    FLAGS_load_table_thread_num = 8;
+    uint64_t offset = 0;
+    ASSERT_TRUE(snapshot.Recover(table, offset));
+    FLAGS_load_table_thread_num = old_thread_num;
+    ASSERT_EQ(record_cnt, offset);
+    ASSERT_EQ(record_cnt, table->GetRecordCnt());
+    for (uint32_t k = 0; k < key_cnt; k++) {
+        Ticket ticket;
+        TableIterator* it = table->NewIterator("key" + std::to_string(k), ticket);
+        it->SeekToFirst();
+        uint32_t num = 0;
+        while (it->Valid()) {
+            uint32_t i = it->GetKey() - 1;
+            ASSERT_EQ(k, i % key_cnt);
+            std::string value = i % 97 == 0 ? std::string(10 * 1024, 'a' + i % 26) : "value" + std::to_string(i);
+            std::string value_str(it->GetValue().data(), it->GetValue().size());
+            ASSERT_EQ(value, ::openmldb::test::DecodeV(value_str));
+            num++;
+            it->Next();
+        }
+        ASSERT_EQ(record_cnt / key_cnt, num);
+        delete it;
+    }
+}
+
 }  // namespace storage
 }  // namespace openmldb
 
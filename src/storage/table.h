@@ -69,6 +69,9 @@ class Table {
 
     virtual ::hybridse::vm::WindowIterator* NewWindowIterator(uint32_t index) = 0;
 
+    // hint that the pks of index will be seeked soon, so they can be loaded in batch
+    virtual void Prefetch(uint32_t index, const std::vector<std::string>& pks) {}
+
     virtual void SchedGc() = 0;
 
     virtual uint64_t GetRecordCnt() const = 0;
@@ -108,6 +111,9 @@ class Table {
 
     inline const ::openmldb::type::CompressType GetCompressType() { return compress_type_; }
 
+    // the codec of the rows encoded by dictionaries, the values of iterators are encoded if it isn't null
+    virtual const codec::DictRowCodec* GetDictCodec() const { return nullptr; }
+
     void AddVersionSchema(const ::openmldb::api::TableMeta& table_meta);
 
     std::shared_ptr<::openmldb::api::TableMeta> GetTableMeta() {
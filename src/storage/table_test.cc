@@ -17,6 +17,8 @@
 #include <gflags/gflags.h>
 #include <atomic>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <utility>
 
 #include "base/glog_wrapper.h"
@@ -410,6 +412,10 @@ TEST_P(TableTest, SchedGcHead1) {
             count--;
         }
         table->SchedGc();
+        if (storageMode == ::openmldb::common::kHDD) {
+            // the entries of disk table are expired by compaction
+            dynamic_cast<DiskTable*>(table)->CompactDB();
+        }
         Ticket ticket;
         TableIterator* it = table->NewIterator("test", ticket);
 
@@ -1920,6 +1926,78 @@ TEST_P(TableTest, AbsAndLat) {
     delete table;
 }
 
+TEST(MemTableTest, DictionaryCompress) {
+    ::openmldb::api::TableMeta table_meta;
+    table_meta.set_name("table1");
+    table_meta.set_tid(1);
+    table_meta.set_pid(1);
+    table_meta.set_seg_cnt(8);
+    table_meta.set_mode(::openmldb::api::TableMode::kTableLeader);
+    table_meta.set_storage_mode(::openmldb::common::kMemory);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "card", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "mcc", ::openmldb::type::kString);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "price", ::openmldb::type::kBigInt);
+    SchemaCodec::SetColumnDesc(table_meta.add_column_desc(), "ts1", ::openmldb::type::kBigInt);
+    SchemaCodec::SetIndex(table_meta.add_column_key(), "card", "card", "ts1", ::openmldb::type::kAbsoluteTime, 0, 0);
+    MemTable raw_table(table_meta);
+    ASSERT_TRUE(raw_table.Init());
+    ASSERT_TRUE(raw_table.GetDictCodec() == nullptr);
+    table_meta.set_compress_type(::openmldb::type::kDictionary);
+    MemTable table(table_meta);
+    ASSERT_TRUE(table.Init());
+    ASSERT_TRUE(table.GetDictCodec() != nullptr);
+
+    codec::SDKCodec codec(table_meta);
+    std::map<uint64_t, std::string> values;
+    for (int i = 0; i < 100; i++) {
+        std::vector<std::string> row = {"card" + std::to_string(i % 10), "merchant category " + std::to_string(i % 5),
+                                        std::to_string(i), std::to_string(1000 + i)};
+        ::openmldb::api::PutRequest request;
+        ::openmldb::api::Dimension* dim = request.add_dimensions();
+        dim->set_idx(0);
+        dim->set_key(row[0]);
+        std::string value;
+        ASSERT_EQ(0, codec.EncodeRow(row, &value));
+        ASSERT_TRUE(table.Put(0, value, request.dimensions()));
+        ASSERT_TRUE(raw_table.Put(0, value, request.dimensions()));
+        values.emplace(1000 + i, value);
+    }
+    ASSERT_LT(table.GetRecordByteSize(), raw_table.GetRecordByteSize());
+
+    // the rows of traverse iterator are encoded
+    std::unique_ptr<TableIterator> it(table.NewTraverseIterator(0));
+    it->SeekToFirst();
+    int count = 0;
+    while (it->Valid()) {
+        auto value = it->GetValue();
+        const auto* row = reinterpret_cast<const int8_t*>(value.data());
+        ASSERT_TRUE(codec::DictRowCodec::IsEncoded(row));
+        ASSERT_LT(value.size(), values[it->GetKey()].size());
+        std::string decoded;
+        ASSERT_TRUE(table.GetDictCodec()->Decode(row, value.size(), &decoded));
+        ASSERT_EQ(values[it->GetKey()], decoded);
+        count++;
+        it->Next();
+    }
+    ASSERT_EQ(100, count);
+
+    // the rows of window iterator are decoded
+    std::unique_ptr<::hybridse::vm::WindowIterator> window_it(table.NewWindowIterator(0));
+    window_it->SeekToFirst();
+    count = 0;
+    while (window_it->Valid()) {
+        auto row_it = window_it->GetValue();
+        row_it->SeekToFirst();
+        while (row_it->Valid()) {
+            ASSERT_EQ(values[row_it->GetKey()], row_it->GetValue().ToString());
+            count++;
+            row_it->Next();
+        }
+        window_it->Next();
+    }
+    ASSERT_EQ(100, count);
+}
+
 INSTANTIATE_TEST_CASE_P(TestMemAndHDD, TableTest,
                         ::testing::Values(::openmldb::common::kMemory, ::openmldb::common::kHDD));
 
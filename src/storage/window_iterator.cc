@@ -17,6 +17,7 @@
 #include "storage/window_iterator.h"
 
 #include <string>
+#include "base/glog_wrapper.h"
 #include "base/hash.h"
 
 namespace openmldb {
@@ -45,7 +46,26 @@ const uint64_t& MemTableWindowIterator::GetKey() const {
 }
 
 const ::hybridse::codec::Row& MemTableWindowIterator::GetValue() {
-    row_.Reset(reinterpret_cast<const int8_t*>(it_->GetValue()->data), it_->GetValue()->size);
+    const auto* data = reinterpret_cast<const int8_t*>(it_->GetValue()->data);
+    uint32_t size = it_->GetValue()->size;
+    if (dict_codec_ == nullptr) {
+        row_.Reset(data, size);
+        return row_;
+    }
+    // the generated row decoders of the engine only read the plain format, so every encoded row is decoded
+    // into a malloc-ed copy here, see COMPRESS_TYPE in CREATE_TABLE_STATEMENT.md for the cost.
+    // The decoded row is owned by row_, so it lives as long as the rows copied from it. The slice of row_
+    // is replaced as a whole, as Reset(buf, size) keeps the ownership of the previous decoded row
+    int8_t* buf = nullptr;
+    uint32_t buf_size = 0;
+    if (codec::DictRowCodec::IsEncoded(data)) {
+        if (dict_codec_->Decode(data, size, &buf, &buf_size)) {
+            row_.Reset(::hybridse::base::RefCountedSlice::CreateManaged(buf, buf_size));
+            return row_;
+        }
+        PDLOG(WARNING, "fail to decode the row encoded by dictionaries");
+    }
+    row_.Reset(::hybridse::base::RefCountedSlice::Create(reinterpret_cast<const char*>(data), size));
     return row_;
 }
 
@@ -66,7 +86,8 @@ void MemTableWindowIterator::SeekToFirst() {
 }
 
 MemTableKeyIterator::MemTableKeyIterator(Segment** segments, uint32_t seg_cnt, ::openmldb::storage::TTLType ttl_type,
-                                         uint64_t expire_time, uint64_t expire_cnt, uint32_t ts_index)
+                                         uint64_t expire_time, uint64_t expire_cnt, uint32_t ts_index,
+                                         const codec::DictRowCodec* dict_codec)
     : segments_(segments),
       seg_cnt_(seg_cnt),
       seg_idx_(0),
@@ -76,7 +97,8 @@ MemTableKeyIterator::MemTableKeyIterator(Segment** segments, uint32_t seg_cnt, :
       expire_time_(expire_time),
       expire_cnt_(expire_cnt),
       ticket_(),
-      ts_idx_(0) {
+      ts_idx_(0),
+      dict_codec_(dict_codec) {
     uint32_t idx = 0;
     if (segments_[0]->GetTsIdx(ts_index, idx) == 0) {
         ts_idx_ = idx;
@@ -139,13 +161,23 @@ void MemTableKeyIterator::Next() {
         ticket_.Push((KeyEntry*)pk_it_->GetValue());  // NOLINT
     }
     it->SeekToFirst();
-    return new MemTableWindowIterator(it, ttl_type_, expire_time_, expire_cnt_);
+    return new MemTableWindowIterator(it, ttl_type_, expire_time_, expire_cnt_, dict_codec_);
 }
 
 std::unique_ptr<::hybridse::vm::RowIterator> MemTableKeyIterator::GetValue() {
     return std::unique_ptr<::hybridse::vm::RowIterator>(GetRawValue());
 }
 
+std::optional<uint64_t> MemTableKeyIterator::GetVersion() {
+    KeyEntry* entry = nullptr;
+    if (segments_[seg_idx_]->GetTsCnt() > 1) {
+        entry = ((KeyEntry**)pk_it_->GetValue())[ts_idx_];  // NOLINT
+    } else {
+        entry = (KeyEntry*)pk_it_->GetValue();  // NOLINT
+    }
+    return entry->GetVersion();
+}
+
 const hybridse::codec::Row MemTableKeyIterator::GetKey() {
     return hybridse::codec::Row(
             ::hybridse::base::RefCountedSlice::Create(pk_it_->GetKey().data(), pk_it_->GetKey().size()));
@@ -17,7 +17,9 @@
 #define SRC_STORAGE_WINDOW_ITERATOR_H_
 
 #include <memory>
+#include <optional>
 #include <string>
+#include "codec/dict_codec.h"
 #include "storage/segment.h"
 #include "vm/catalog.h"
 
@@ -26,9 +28,10 @@ namespace storage {
 
 class MemTableWindowIterator : public ::hybridse::vm::RowIterator {
  public:
+    // the rows encoded by `dict_codec` are decoded in GetValue
     MemTableWindowIterator(TimeEntries::Iterator* it, ::openmldb::storage::TTLType ttl_type, uint64_t expire_time,
-                           uint64_t expire_cnt)
-        : it_(it), record_idx_(1), expire_value_(expire_time, expire_cnt, ttl_type), row_() {}
+                           uint64_t expire_cnt, const codec::DictRowCodec* dict_codec = nullptr)
+        : it_(it), record_idx_(1), expire_value_(expire_time, expire_cnt, ttl_type), row_(), dict_codec_(dict_codec) {}
 
     ~MemTableWindowIterator();
 
@@ -51,12 +54,14 @@ class MemTableWindowIterator : public ::hybridse::vm::RowIterator {
     uint32_t record_idx_;
     TTLSt expire_value_;
     ::hybridse::codec::Row row_;
+    const codec::DictRowCodec* dict_codec_;
 };
 
 class MemTableKeyIterator : public ::hybridse::vm::WindowIterator {
  public:
     MemTableKeyIterator(Segment** segments, uint32_t seg_cnt, ::openmldb::storage::TTLType ttl_type,
-                        uint64_t expire_time, uint64_t expire_cnt, uint32_t ts_index);
+                        uint64_t expire_time, uint64_t expire_cnt, uint32_t ts_index,
+                        const codec::DictRowCodec* dict_codec = nullptr);
 
     ~MemTableKeyIterator() override;
 
@@ -73,6 +78,8 @@ class MemTableKeyIterator : public ::hybridse::vm::WindowIterator {
 
     const hybridse::codec::Row GetKey() override;
 
+    std::optional<uint64_t> GetVersion() override;
+
  private:
     void NextPK();
 
@@ -87,6 +94,7 @@ class MemTableKeyIterator : public ::hybridse::vm::WindowIterator {
     uint64_t expire_cnt_;
     Ticket ticket_;
     uint32_t ts_idx_;
+    const codec::DictRowCodec* dict_codec_;
 };
 
 }  // namespace storage
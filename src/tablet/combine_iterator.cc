@@ -75,6 +75,15 @@ void CombineIterator::SeekToFirst() {
     SelectIterator();
 }
 
+QueryRef* CombineIterator::NewQueryRef() const {
+    auto ref = new QueryRef();
+    for (const auto& q_it : q_its_) {
+        ref->tables.push_back(q_it.table);
+        ref->tickets.push_back(q_it.ticket);
+    }
+    return ref;
+}
+
 void CombineIterator::SelectIterator() {
     uint64_t max_ts = 0;
     bool need_delete = false;
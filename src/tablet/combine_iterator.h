@@ -113,6 +113,13 @@ struct QueryIt {
     uint32_t iter_pos = 0;
 };
 
+// QueryRef refers the tables and tickets of query iterators, so the data read by
+// the iterators is neither gc nor freed while it is alive
+struct QueryRef {
+    std::vector<std::shared_ptr<::openmldb::storage::Table>> tables;
+    std::vector<std::shared_ptr<::openmldb::storage::Ticket>> tickets;
+};
+
 class CombineIterator {
  public:
     CombineIterator(std::vector<QueryIt> q_its, uint64_t start_time, ::openmldb::api::GetType st_type,
@@ -122,8 +129,12 @@ class CombineIterator {
     bool Valid();
     uint64_t GetTs();
     openmldb::base::Slice GetValue();
+    // the codec of the partition of current value if it is encoded by dictionaries, the partitions have
+    // their own dictionaries
+    const ::openmldb::codec::DictRowCodec* GetDictCodec() const { return cur_qit_->table->GetDictCodec(); }
     inline uint64_t GetExpireTime() const { return expire_time_; }
     inline ::openmldb::storage::TTLType GetTTLType() const { return ttl_type_; }
+    QueryRef* NewQueryRef() const;
 
  private:
     void SelectIterator();
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tablet/scan_filter.h"
+
+#include "absl/strings/str_cat.h"
+#include "vm/physical_op.h"
+
+namespace openmldb {
+namespace tablet {
+
+static constexpr char kFilterColumn[] = "__scan_filter";
+
+bool ScanFilter::Init(::hybridse::vm::Engine* engine, const std::string& db, const std::string& table,
+                      const std::string& filter, std::string* msg) {
+    if (engine == nullptr || filter.empty()) {
+        *msg = "invalid filter";
+        return false;
+    }
+    std::string sql = absl::StrCat("SELECT (", filter, ") AS ", kFilterColumn, " FROM `", table, "`;");
+    ::hybridse::vm::BatchRunSession session;
+    ::hybridse::base::Status status;
+    if (!engine->Get(sql, db, session, status)) {
+        *msg = "fail to compile filter: " + status.msg;
+        return false;
+    }
+    compile_info_ = session.GetCompileInfo();
+    const ::hybridse::vm::PhysicalOpNode* node = compile_info_->GetPhysicalPlan();
+    const ::hybridse::vm::ColumnProjects* project = nullptr;
+    if (node != nullptr && node->GetOpType() == ::hybridse::vm::kPhysicalOpProject) {
+        auto project_node = dynamic_cast<const ::hybridse::vm::PhysicalProjectNode*>(node);
+        if (project_node->project_type_ == ::hybridse::vm::kTableProject) {
+            project = &project_node->project();
+        }
+    } else if (node != nullptr && node->GetOpType() == ::hybridse::vm::kPhysicalOpSimpleProject) {
+        project = &dynamic_cast<const ::hybridse::vm::PhysicalSimpleProjectNode*>(node)->project();
+    }
+    // the filter should be evaluated on the rows of table only. The filter is pasted into sql, so the
+    // plan is checked to be exactly the projection of the filter on the scanned table, in case the filter
+    // closes the parenthesis and selects from another table or adds other clauses
+    const ::hybridse::vm::PhysicalDataProviderNode* provider = nullptr;
+    if (project != nullptr && !node->GetLimitCnt().has_value() && node->GetProducerCnt() == 1 &&
+        node->GetProducer(0)->GetOpType() == ::hybridse::vm::kPhysicalOpDataProvider) {
+        provider = dynamic_cast<const ::hybridse::vm::PhysicalDataProviderNode*>(node->GetProducer(0));
+    }
+    if (provider == nullptr || provider->provider_type_ != ::hybridse::vm::kProviderTypeTable ||
+        provider->GetDb() != db || provider->GetName() != table) {
+        *msg = "filter should be an expression of the columns of table";
+        return false;
+    }
+    const auto& schema = compile_info_->GetSchema();
+    if (schema.size() != 1 || project->size() != 1 || schema.Get(0).name() != kFilterColumn ||
+        schema.Get(0).type() != ::hybridse::type::kBool || !project->fn_info().IsValid()) {
+        *msg = "filter should be a bool expression";
+        return false;
+    }
+    project_gen_ = std::make_unique<::hybridse::vm::ProjectGenerator>(project->fn_info());
+    row_view_ = std::make_unique<::hybridse::codec::RowView>(schema);
+    return true;
+}
+
+bool ScanFilter::Match(const ::openmldb::base::Slice& row) {
+    ::hybridse::codec::Row input(::hybridse::base::RefCountedSlice::Create(row.data(), row.size()));
+    ::hybridse::codec::Row output = project_gen_->Gen(input, ::hybridse::codec::Row());
+    if (!row_view_->Reset(output.buf(), output.size())) {
+        return false;
+    }
+    bool val = false;
+    return row_view_->GetBool(0, &val) == 0 && val;
+}
+
+}  // namespace tablet
+}  // namespace openmldb
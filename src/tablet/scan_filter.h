@@ -0,0 +1,55 @@
+/*
+ * Copyright 2021 4Paradigm
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SRC_TABLET_SCAN_FILTER_H_
+#define SRC_TABLET_SCAN_FILTER_H_
+
+#include <memory>
+#include <string>
+
+#include "base/slice.h"
+#include "vm/engine.h"
+#include "vm/runner.h"
+
+namespace openmldb {
+namespace tablet {
+
+// ScanFilter evaluates the filter expression of scan and traverse on the rows of a table.
+// The expression is compiled by the sql engine as the project `select (filter) from table`,
+// so the compiled function is cached by the engine and shared by the requests
+class ScanFilter {
+ public:
+    ScanFilter() {}
+    ~ScanFilter() {}
+
+    // return false if the filter is not a bool expression of the columns of table
+    bool Init(::hybridse::vm::Engine* engine, const std::string& db, const std::string& table,
+              const std::string& filter, std::string* msg);
+
+    // the row should be uncompressed. the row is filtered out if the expression is null
+    bool Match(const ::openmldb::base::Slice& row);
+
+ private:
+    // keep the compiled function alive
+    std::shared_ptr<::hybridse::vm::CompileInfo> compile_info_;
+    std::unique_ptr<::hybridse::vm::ProjectGenerator> project_gen_;
+    std::unique_ptr<::hybridse::codec::RowView> row_view_;
+};
+
+}  // namespace tablet
+}  // namespace openmldb
+
+#endif  // SRC_TABLET_SCAN_FILTER_H_
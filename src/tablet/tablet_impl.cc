@@ -50,6 +50,7 @@
 #include "brpc/controller.h"
 #include "butil/iobuf.h"
 #include "codec/codec.h"
+#include "codec/dict_codec.h"
 #include "codec/row_codec.h"
 #include "codec/sql_rpc_row_codec.h"
 #include "common/timer.h"
@@ -74,6 +75,8 @@ DECLARE_int32(gc_pool_size);
 DECLARE_int32(disk_gc_interval);
 DECLARE_int32(statdb_ttl);
 DECLARE_uint32(scan_max_bytes_size);
+DECLARE_uint32(scan_zero_copy_row_size);
+DECLARE_uint32(batch_query_cursor_timeout_ms);
 DECLARE_uint32(scan_reserve_size);
 DECLARE_double(mem_release_rate);
 DECLARE_string(db_root_path);
@@ -96,6 +99,9 @@ DECLARE_uint32(task_check_interval);
 DECLARE_uint32(load_index_max_wait_time);
 DECLARE_bool(use_name);
 DECLARE_bool(enable_distsql);
+DECLARE_string(jit_object_cache_path);
+DECLARE_uint32(jit_object_cache_capacity);
+DECLARE_uint32(batch_agg_parallelism);
 DECLARE_string(snapshot_compression);
 DECLARE_string(file_compression);
 
@@ -107,6 +113,8 @@ DECLARE_int32(zk_session_timeout);
 DECLARE_int32(zk_keep_alive_check_interval);
 
 DECLARE_int32(binlog_sync_to_disk_interval);
+DECLARE_bool(binlog_group_commit);
+DECLARE_bool(binlog_group_commit_wait_sync);
 DECLARE_int32(binlog_delete_interval);
 DECLARE_uint32(absolute_ttl_max);
 DECLARE_uint32(latest_ttl_max);
@@ -125,6 +133,61 @@ static const uint32_t SEED = 0xe17a1465;
 
 static constexpr const char DEPLOY_STATS[] = "deploy_stats";
 
+static void NoopDeleter(void*) {}
+
+static void DeleteBuffer(void* data) { delete[] reinterpret_cast<char*>(data); }
+
+// the row is uncompressed if the filter or projection should read it. The row encoded by `dict_codec` is
+// decoded, as the client doesn't have the dictionaries. Return false if the compressed row is corrupted
+static bool DecodeScanRow(const ::openmldb::base::Slice& value, bool uncompress,
+                          const ::openmldb::codec::DictRowCodec* dict_codec, std::string* buf,
+                          ::openmldb::base::Slice* row) {
+    if (dict_codec != nullptr) {
+        if (dict_codec->Decode(reinterpret_cast<const int8_t*>(value.data()), value.size(), buf)) {
+            *row = ::openmldb::base::Slice(*buf);
+        } else {
+            *row = ::openmldb::base::Slice(value.data(), value.size());
+        }
+        return true;
+    }
+    if (!uncompress) {
+        *row = ::openmldb::base::Slice(value.data(), value.size());
+        return true;
+    }
+    if (!::snappy::Uncompress(value.data(), value.size(), buf)) {
+        return false;
+    }
+    *row = ::openmldb::base::Slice(*buf);
+    return true;
+}
+
+// the projected row of compressed table is compressed again, so the client decodes it as other rows
+static bool ProjectScanRow(::openmldb::codec::RowProject* row_project, const ::openmldb::base::Slice& row,
+                           bool compressed, int8_t** ptr, uint32_t* size) {
+    if (!row_project->Project(reinterpret_cast<const int8_t*>(row.data()), row.size(), ptr, size)) {
+        return false;
+    }
+    if (compressed) {
+        std::string value;
+        ::snappy::Compress(reinterpret_cast<char*>(*ptr), *size, &value);
+        delete[] reinterpret_cast<char*>(*ptr);
+        char* buf = new char[value.size()];
+        memcpy(buf, value.data(), value.size());
+        *ptr = reinterpret_cast<int8_t*>(buf);
+        *size = value.size();
+    }
+    return true;
+}
+
+// the data of the trailer follows the QueryRef pointer in one buffer
+static void DeleteQueryRefTrailer(void* data) {
+    char* buf = reinterpret_cast<char*>(data) - sizeof(QueryRef*);
+    QueryRef* ref = nullptr;
+    memcpy(&ref, buf, sizeof(QueryRef*));
+    delete ref;
+    delete[] buf;
+}
+
 TabletImpl::TabletImpl()
     : tables_(),
       mu_(),
@@ -147,7 +210,8 @@ TabletImpl::TabletImpl()
       sp_cache_(std::shared_ptr<SpCache>(new SpCache())),
       notify_path_(),
       globalvar_changed_notify_path_(),
-      startup_mode_(::openmldb::type::StartupMode::kStandalone) {}
+      startup_mode_(::openmldb::type::StartupMode::kStandalone),
+      batch_query_id_(0) {}
 
 TabletImpl::~TabletImpl() {
     task_pool_.Stop(true);
@@ -155,6 +219,9 @@ TabletImpl::~TabletImpl() {
     gc_pool_.Stop(true);
     io_pool_.Stop(true);
     snapshot_pool_.Stop(true);
+    if (log_syncer_) {
+        log_syncer_->Stop();
+    }
     if (zk_client_) {
         delete zk_client_;
     }
@@ -207,6 +274,9 @@ bool TabletImpl::Init(const std::string& zk_cluster, const std::string& zk_path,
     } else {
         options.SetClusterOptimized(false);
     }
+    options.jit_options().SetObjectCachePath(FLAGS_jit_object_cache_path);
+    options.jit_options().SetObjectCacheCapacity(FLAGS_jit_object_cache_capacity);
+    options.SetBatchAggParallelism(FLAGS_batch_agg_parallelism);
     engine_ = std::unique_ptr<::hybridse::vm::Engine>(new ::hybridse::vm::Engine(catalog_, options));
     catalog_->SetLocalTablet(
         std::shared_ptr<::hybridse::vm::Tablet>(new ::hybridse::vm::LocalTablet(engine_.get(), sp_cache_)));
@@ -224,6 +294,11 @@ bool TabletImpl::Init(const std::string& zk_cluster, const std::string& zk_path,
         PDLOG(ERROR, "make_snapshot_time[%d] is illegal.", FLAGS_make_snapshot_time);
         return false;
     }
+    if (FLAGS_binlog_group_commit) {
+        log_syncer_ = std::make_shared<::openmldb::replica::LogSyncer>(FLAGS_binlog_sync_to_disk_interval,
+                                                                       FLAGS_binlog_group_commit_wait_sync);
+        log_syncer_->Start();
+    }
 
     if (FLAGS_db_root_path != "") {
         if (!CreateMultiDir(mode_root_paths_[::openmldb::common::kMemory])) {
@@ -302,6 +377,8 @@ bool TabletImpl::Init(const std::string& zk_cluster, const std::string& zk_path,
     if (FLAGS_recycle_ttl != 0) {
         task_pool_.DelayTask(FLAGS_recycle_ttl * 60 * 1000, boost::bind(&TabletImpl::SchedDelRecycle, this));
     }
+    task_pool_.DelayTask(FLAGS_batch_query_cursor_timeout_ms,
+                         boost::bind(&TabletImpl::SchedCleanBatchQueryCursor, this));
 #ifdef TCMALLOC_ENABLE
     MallocExtension* tcmalloc = MallocExtension::instance();
     tcmalloc->SetMemoryReleaseRate(FLAGS_mem_release_rate);
@@ -498,6 +575,12 @@ int32_t TabletImpl::GetIndex(const ::openmldb::api::GetRequest* request, const :
         if (st_type == ::openmldb::api::GetType::kSubKeyEq && st > 0 && *ts != st) {
             return 1;
         }
+        // the projection reads the row encoded by dictionaries without decoding it
+        const auto* dict_codec = it->GetDictCodec();
+        if (enable_project) {
+            row_project.SetDictCodec(dict_codec);
+        }
+        std::string decoded;
         bool jump_out = false;
         if (st_type == ::openmldb::api::GetType::kSubKeyGe || st_type == ::openmldb::api::GetType::kSubKeyGt) {
             ::openmldb::base::Slice it_value = it->GetValue();
@@ -514,7 +597,9 @@ int32_t TabletImpl::GetIndex(const ::openmldb::api::GetRequest* request, const :
                 value->assign(reinterpret_cast<char*>(ptr), size);
                 delete[] ptr;
             } else {
-                value->assign(it_value.data(), it_value.size());
+                ::openmldb::base::Slice row;
+                DecodeScanRow(it_value, false, dict_codec, &decoded, &row);
+                value->assign(row.data(), row.size());
             }
             return 0;
         }
@@ -557,7 +642,9 @@ int32_t TabletImpl::GetIndex(const ::openmldb::api::GetRequest* request, const :
             value->assign(reinterpret_cast<char*>(ptr), size);
             delete[] ptr;
         } else {
-            value->assign(it->GetValue().data(), it->GetValue().size());
+            ::openmldb::base::Slice row;
+            DecodeScanRow(it->GetValue(), false, dict_codec, &decoded, &row);
+            value->assign(row.data(), row.size());
         }
         return 0;
     }
@@ -732,7 +819,7 @@ void TabletImpl::Put(RpcController* controller, const ::openmldb::api::PutReques
     }
     bool ok = false;
     if (request->dimensions_size() > 0) {
-        int32_t ret_code = CheckDimessionPut(request, table->GetIdxCnt());
+        int32_t ret_code = CheckDimessionPut(request->dimensions(), table->GetIdxCnt());
         if (ret_code != 0) {
             response->set_code(::openmldb::base::ReturnCode::kInvalidDimensionParameter);
             response->set_msg("invalid dimension parameter");
@@ -768,16 +855,17 @@ void TabletImpl::Put(RpcController* controller, const ::openmldb::api::PutReques
             entry.mutable_ts_dimensions()->CopyFrom(request->ts_dimensions());
         }
 
-        // Aggregator update assumes that binlog_offset is strictly increasing
-        // so the update should be protected within the replicator lock
-        // in case there will be other Put jump into the middle
-        auto update_aggr = [this, &request, &ok, &entry]() {
-            ok = UpdateAggrs(request->tid(), request->pid(), request->value(),
-                               request->dimensions(), entry.log_index());
+        // Aggregator update assumes that binlog_offset is strictly increasing per key,
+        // so the update order is reserved within the replicator lock in case there will be
+        // other Put jump into the middle, and the updates are applied out of the lock
+        std::vector<AggrUpdate> aggr_updates;
+        auto reserve_aggr = [this, &request, &entry, &aggr_updates]() {
+            ReserveAggrs(request->tid(), request->pid(), request->value(), request->dimensions(), entry.log_index(),
+                         &aggr_updates);
         };
-        UpdateAggrClosure closure(update_aggr);
+        UpdateAggrClosure closure(reserve_aggr);
         replicator->AppendEntry(entry, &closure);
-        if (!ok) {
+        if (!ApplyAggrs(request->tid(), request->pid(), aggr_updates)) {
             response->set_code(::openmldb::base::ReturnCode::kError);
             response->set_msg("update aggr failed");
             return;
@@ -815,6 +903,127 @@ void TabletImpl::Put(RpcController* controller, const ::openmldb::api::PutReques
     }
 }
 
+void TabletImpl::PutBatch(RpcController* controller, const ::openmldb::api::PutBatchRequest* request,
+                          ::openmldb::api::PutBatchResponse* response, Closure* done) {
+    brpc::ClosureGuard done_guard(done);
+    response->set_put_cnt(0);
+    if (follower_.load(std::memory_order_relaxed)) {
+        response->set_code(::openmldb::base::ReturnCode::kIsFollowerCluster);
+        response->set_msg("is follower cluster");
+        return;
+    }
+    uint64_t start_time = ::baidu::common::timer::get_micros();
+    std::shared_ptr<Table> table = GetTable(request->tid(), request->pid());
+    if (!table) {
+        PDLOG(WARNING, "table does not exist. tid %u, pid %u", request->tid(), request->pid());
+        response->set_code(::openmldb::base::ReturnCode::kTableIsNotExist);
+        response->set_msg("table does not exist");
+        return;
+    }
+    if (!table->IsLeader()) {
+        response->set_code(::openmldb::base::ReturnCode::kTableIsFollower);
+        response->set_msg("table is follower");
+        return;
+    }
+    if (table->GetTableStat() == ::openmldb::storage::kLoading) {
+        PDLOG(WARNING, "table is loading. tid %u, pid %u", request->tid(), request->pid());
+        response->set_code(::openmldb::base::ReturnCode::kTableIsLoading);
+        response->set_msg("table is loading");
+        return;
+    }
+    // check all rows before applying any of them, so an invalid request will not be partially applied
+    for (const auto& row : request->rows()) {
+        if (row.dimensions_size() <= 0 || CheckDimessionPut(row.dimensions(), table->GetIdxCnt()) != 0) {
+            response->set_code(::openmldb::base::ReturnCode::kInvalidDimensionParameter);
+            response->set_msg("invalid dimension parameter");
+            return;
+        }
+    }
+    std::shared_ptr<LogReplicator> replicator = GetReplicator(request->tid(), request->pid());
+    if (!replicator) {
+        PDLOG(WARNING, "fail to find table tid %u pid %u leader's log replicator", request->tid(), request->pid());
+    }
+    std::vector<::openmldb::api::LogEntry> entries;
+    entries.reserve(request->rows_size());
+    // the index in request of every entry, used by aggregator update
+    std::vector<int> row_idx;
+    row_idx.reserve(request->rows_size());
+    int failed_idx = -1;
+    for (int i = 0; i < request->rows_size(); i++) {
+        const auto& row = request->rows(i);
+        if (!table->Put(row.time(), row.value(), row.dimensions())) {
+            failed_idx = i;
+            break;
+        }
+        if (!replicator) {
+            continue;
+        }
+        entries.emplace_back();
+        auto& entry = entries.back();
+        entry.set_ts(row.time());
+        entry.set_value(row.value());
+        entry.mutable_dimensions()->CopyFrom(row.dimensions());
+        row_idx.push_back(i);
+    }
+    if (failed_idx == 0) {
+        response->set_code(::openmldb::base::ReturnCode::kPutFailed);
+        response->set_msg("put failed");
+        return;
+    }
+    uint32_t put_cnt = failed_idx < 0 ? request->rows_size() : failed_idx;
+    if (replicator && !entries.empty()) {
+        uint64_t term = replicator->GetLeaderTerm();
+        for (auto& entry : entries) {
+            entry.set_term(term);
+        }
+        // Aggregator update assumes that binlog_offset is strictly increasing per key,
+        // the update order of all rows of the batch is reserved within the replicator lock
+        std::vector<AggrUpdate> aggr_updates;
+        auto reserve_aggr = [this, &request, &entries, &row_idx, &aggr_updates]() {
+            for (size_t i = 0; i < entries.size(); i++) {
+                const auto& row = request->rows(row_idx[i]);
+                ReserveAggrs(request->tid(), request->pid(), row.value(), row.dimensions(), entries[i].log_index(),
+                             &aggr_updates);
+            }
+        };
+        UpdateAggrClosure closure(reserve_aggr);
+        bool append_ok = replicator->AppendEntryBatch(&entries, &closure);
+        bool aggr_ok = ApplyAggrs(request->tid(), request->pid(), aggr_updates);
+        if (!append_ok) {
+            PDLOG(WARNING, "fail to append binlog. tid %u pid %u", request->tid(), request->pid());
+            response->set_code(::openmldb::base::ReturnCode::kPutFailed);
+            response->set_msg("append binlog failed");
+            return;
+        }
+        if (!aggr_ok) {
+            response->set_put_cnt(put_cnt);
+            response->set_code(::openmldb::base::ReturnCode::kError);
+            response->set_msg("update aggr failed");
+            return;
+        }
+        if (FLAGS_binlog_notify_on_put) {
+            replicator->Notify();
+        }
+    }
+    response->set_put_cnt(put_cnt);
+    if (failed_idx > 0) {
+        response->set_code(::openmldb::base::ReturnCode::kPutFailed);
+        response->set_msg("put failed at row " + std::to_string(failed_idx));
+        return;
+    }
+    response->set_code(::openmldb::base::ReturnCode::kOk);
+    uint64_t end_time = ::baidu::common::timer::get_micros();
+    if (start_time + FLAGS_put_slow_log_threshold < end_time) {
+        PDLOG(INFO, "slow log[put batch]. row cnt %d time %lu. tid %u, pid %u", request->rows_size(),
+              end_time - start_time, request->tid(), request->pid());
+    }
+    // update global var in standalone mode
+    if (!IsClusterMode() && table->GetDB() == openmldb::nameserver::INFORMATION_SCHEMA_DB &&
+        table->GetName() == openmldb::nameserver::GLOBAL_VARIABLES) {
+        UpdateGlobalVarTable();
+    }
+}
+
 int TabletImpl::CheckTableMeta(const openmldb::api::TableMeta* table_meta, std::string& msg) {
     msg.clear();
     if (table_meta->name().empty()) {
@@ -894,7 +1103,8 @@ int TabletImpl::CheckTableMeta(const openmldb::api::TableMeta* table_meta, std::
 
 int32_t TabletImpl::ScanIndex(const ::openmldb::api::ScanRequest* request, const ::openmldb::api::TableMeta& meta,
                               const std::map<int32_t, std::shared_ptr<Schema>>& vers_schema,
-                              CombineIterator* combine_it, butil::IOBuf* io_buf, uint32_t* count, bool* is_finish) {
+                              CombineIterator* combine_it, ScanFilter* filter, butil::IOBuf* io_buf, uint32_t* count,
+                              bool* is_finish) {
     uint32_t limit = request->limit();
     if (combine_it == nullptr || io_buf == nullptr || count == nullptr || is_finish == nullptr) {
         PDLOG(WARNING, "invalid args");
@@ -915,12 +1125,9 @@ int32_t TabletImpl::ScanIndex(const ::openmldb::api::ScanRequest* request, const
     }
 
     bool enable_project = false;
+    bool compressed = meta.compress_type() == ::openmldb::type::kSnappy;
     ::openmldb::codec::RowProject row_project(vers_schema, request->projection());
     if (request->projection().size() > 0) {
-        if (meta.compress_type() == ::openmldb::type::kSnappy) {
-            LOG(WARNING) << "project on compress row data do not eing supported";
-            return -1;
-        }
         bool ok = row_project.Init();
         if (!ok) {
             PDLOG(WARNING, "invalid project list");
@@ -933,6 +1140,13 @@ int32_t TabletImpl::ScanIndex(const ::openmldb::api::ScanRequest* request, const
     uint32_t total_block_size = 0;
     uint32_t record_count = 0;
     uint32_t skip_record_num = request->skip_record_num();
+    uint32_t filtered_cnt = 0;
+    // the large rows of memory table are referred by io_buf instead of copied, the rows encoded by
+    // dictionaries are decoded into temporary buffers
+    bool zero_copy = FLAGS_scan_zero_copy_row_size > 0 && meta.storage_mode() == ::openmldb::common::kMemory &&
+                     meta.compress_type() != ::openmldb::type::kDictionary;
+    std::unique_ptr<QueryRef> ref;
+    size_t last_offset = 0;
     combine_it->SeekToFirst();
     while (combine_it->Valid()) {
         if (limit > 0 && record_count >= limit) {
@@ -943,6 +1157,29 @@ int32_t TabletImpl::ScanIndex(const ::openmldb::api::ScanRequest* request, const
             combine_it->Next();
             continue;
         }
+        openmldb::base::Slice data = combine_it->GetValue();
+        // the projection reads the row encoded by dictionaries without decoding it
+        const auto* dict_codec = combine_it->GetDictCodec();
+        if (enable_project) {
+            row_project.SetDictCodec(dict_codec);
+        }
+        std::string uncompressed;
+        openmldb::base::Slice row;
+        if (!DecodeScanRow(data, compressed && (enable_project || filter != nullptr),
+                           enable_project && filter == nullptr ? nullptr : dict_codec, &uncompressed, &row)) {
+            PDLOG(WARNING, "fail to uncompress the row of ts %lu, skip it", combine_it->GetTs());
+            combine_it->Next();
+            continue;
+        }
+        if (filter != nullptr && !filter->Match(row)) {
+            // the rejected rows are bounded as Traverse does, so a selective filter doesn't scan the whole key
+            if (++filtered_cnt >= FLAGS_max_traverse_cnt) {
+                *is_finish = false;
+                break;
+            }
+            combine_it->Next();
+            continue;
+        }
         if (combine_it->GetTs() == st && skip_record_num > 0) {
             skip_record_num--;
             combine_it->Next();
@@ -956,18 +1193,32 @@ int32_t TabletImpl::ScanIndex(const ::openmldb::api::ScanRequest* request, const
         if (enable_project) {
             int8_t* ptr = nullptr;
             uint32_t size = 0;
-            openmldb::base::Slice data = combine_it->GetValue();
-            const int8_t* row_ptr = reinterpret_cast<const int8_t*>(data.data());
-            bool ok = row_project.Project(row_ptr, data.size(), &ptr, &size);
+            bool ok = ProjectScanRow(&row_project, row, compressed, &ptr, &size);
             if (!ok) {
                 PDLOG(WARNING, "fail to make a projection");
                 return -4;
             }
-            io_buf->append(reinterpret_cast<void*>(ptr), size);
+            if (zero_copy && size >= FLAGS_scan_zero_copy_row_size) {
+                io_buf->append_user_data(ptr, size, DeleteBuffer);
+            } else {
+                io_buf->append(reinterpret_cast<void*>(ptr), size);
+                delete[] reinterpret_cast<char*>(ptr);
+            }
             total_block_size += size;
         } else {
-            openmldb::base::Slice data = combine_it->GetValue();
-            io_buf->append(reinterpret_cast<const void*>(data.data()), data.size());
+            if (dict_codec != nullptr) {
+                data = row;
+            }
+            if (zero_copy && data.size() >= FLAGS_scan_zero_copy_row_size) {
+                // the row is referred by io_buf and released after the response is sent
+                if (!ref) {
+                    ref.reset(combine_it->NewQueryRef());
+                }
+                last_offset = io_buf->size();
+                io_buf->append_user_data(const_cast<char*>(data.data()), data.size(), NoopDeleter);
+            } else {
+                io_buf->append(reinterpret_cast<const void*>(data.data()), data.size());
+            }
             total_block_size += data.size();
         }
         record_count++;
@@ -977,12 +1228,25 @@ int32_t TabletImpl::ScanIndex(const ::openmldb::api::ScanRequest* request, const
         }
         combine_it->Next();
     }
+    if (ref) {
+        // the blocks of io_buf are released in order after sent, so the last referred row and the
+        // rows after it are copied into a trailer block, which releases the tables and tickets
+        // after all the referred rows
+        size_t tail_size = io_buf->size() - last_offset;
+        char* buf = new char[sizeof(QueryRef*) + tail_size];
+        QueryRef* raw_ref = ref.release();
+        memcpy(buf, &raw_ref, sizeof(QueryRef*));
+        io_buf->copy_to(buf + sizeof(QueryRef*), tail_size, last_offset);
+        io_buf->pop_back(tail_size);
+        io_buf->append_user_data(buf + sizeof(QueryRef*), tail_size, DeleteQueryRefTrailer);
+    }
     *count = record_count;
     return 0;
 }
 int32_t TabletImpl::ScanIndex(const ::openmldb::api::ScanRequest* request, const ::openmldb::api::TableMeta& meta,
                               const std::map<int32_t, std::shared_ptr<Schema>>& vers_schema,
-                              CombineIterator* combine_it, std::string* pairs, uint32_t* count, bool* is_finish) {
+                              CombineIterator* combine_it, ScanFilter* filter, std::string* pairs, uint32_t* count,
+                              bool* is_finish) {
     uint32_t limit = request->limit();
     if (combine_it == nullptr || pairs == nullptr || count == nullptr || is_finish == nullptr) {
         PDLOG(WARNING, "invalid args");
@@ -1002,12 +1266,9 @@ int32_t TabletImpl::ScanIndex(const ::openmldb::api::ScanRequest* request, const
     }
 
     bool enable_project = false;
+    bool compressed = meta.compress_type() == ::openmldb::type::kSnappy;
     ::openmldb::codec::RowProject row_project(vers_schema, request->projection());
     if (!request->projection().empty()) {
-        if (meta.compress_type() == ::openmldb::type::kSnappy) {
-            LOG(WARNING) << "project on compress row data, not supported";
-            return -1;
-        }
         bool ok = row_project.Init();
         if (!ok) {
             PDLOG(WARNING, "invalid project list");
@@ -1021,6 +1282,7 @@ int32_t TabletImpl::ScanIndex(const ::openmldb::api::ScanRequest* request, const
     uint32_t total_block_size = 0;
     combine_it->SeekToFirst();
     uint32_t skip_record_num = request->skip_record_num();
+    uint32_t filtered_cnt = 0;
     while (combine_it->Valid()) {
         if (limit > 0 && tmp.size() >= limit) {
             *is_finish = false;
@@ -1030,6 +1292,29 @@ int32_t TabletImpl::ScanIndex(const ::openmldb::api::ScanRequest* request, const
             combine_it->Next();
             continue;
         }
+        openmldb::base::Slice data = combine_it->GetValue();
+        // the projection reads the row encoded by dictionaries without decoding it
+        const auto* dict_codec = combine_it->GetDictCodec();
+        if (enable_project) {
+            row_project.SetDictCodec(dict_codec);
+        }
+        std::string uncompressed;
+        openmldb::base::Slice row;
+        if (!DecodeScanRow(data, compressed && (enable_project || filter != nullptr),
+                           enable_project && filter == nullptr ? nullptr : dict_codec, &uncompressed, &row)) {
+            PDLOG(WARNING, "fail to uncompress the row of ts %lu, skip it", combine_it->GetTs());
+            combine_it->Next();
+            continue;
+        }
+        if (filter != nullptr && !filter->Match(row)) {
+            // the rejected rows are bounded as Traverse does, so a selective filter doesn't scan the whole key
+            if (++filtered_cnt >= FLAGS_max_traverse_cnt) {
+                *is_finish = false;
+                break;
+            }
+            combine_it->Next();
+            continue;
+        }
         if (combine_it->GetTs() == st && skip_record_num > 0) {
             skip_record_num--;
             combine_it->Next();
@@ -1043,17 +1328,20 @@ int32_t TabletImpl::ScanIndex(const ::openmldb::api::ScanRequest* request, const
         if (enable_project) {
             int8_t* ptr = nullptr;
             uint32_t size = 0;
-            openmldb::base::Slice data = combine_it->GetValue();
-            const auto* row_ptr = reinterpret_cast<const int8_t*>(data.data());
-            bool ok = row_project.Project(row_ptr, data.size(), &ptr, &size);
+            bool ok = ProjectScanRow(&row_project, row, compressed, &ptr, &size);
             if (!ok) {
                 PDLOG(WARNING, "fail to make a projection");
                 return -4;
             }
             tmp.emplace_back(ts, Slice(reinterpret_cast<char*>(ptr), size, true));
             total_block_size += size;
+        } else if (dict_codec != nullptr) {
+            // the decoded row is released with uncompressed, so it is copied
+            char* buf = new char[row.size()];
+            memcpy(buf, row.data(), row.size());
+            total_block_size += row.size();
+            tmp.emplace_back(ts, Slice(buf, row.size(), true));
         } else {
-            openmldb::base::Slice data = combine_it->GetValue();
             total_block_size += data.size();
             tmp.emplace_back(ts, data);
         }
@@ -1254,6 +1542,17 @@ void TabletImpl::Scan(RpcController* controller, const ::openmldb::api::ScanRequ
         query_its[idx].table = table;
     }
     auto table_meta = query_its.begin()->table->GetTableMeta();
+    std::unique_ptr<ScanFilter> filter;
+    if (!request->filter().empty()) {
+        filter = std::make_unique<ScanFilter>();
+        std::string msg;
+        if (!filter->Init(engine_.get(), table_meta->db(), table_meta->name(), request->filter(), &msg)) {
+            PDLOG(WARNING, "invalid filter %s. tid %u, msg %s", request->filter().c_str(), tid, msg.c_str());
+            response->set_code(::openmldb::base::ReturnCode::kInvalidParameter);
+            response->set_msg(msg);
+            return;
+        }
+    }
     const std::map<int32_t, std::shared_ptr<Schema>> vers_schema = query_its.begin()->table->GetAllVersionSchema();
     CombineIterator combine_it(std::move(query_its), request->st(), openmldb::api::GetType::kSubKeyLe, expired_value);
     uint32_t count = 0;
@@ -1261,11 +1560,11 @@ void TabletImpl::Scan(RpcController* controller, const ::openmldb::api::ScanRequ
     bool is_finish = true;
     if (!request->has_use_attachment() || !request->use_attachment()) {
         std::string* pairs = response->mutable_pairs();
-        code = ScanIndex(request, *table_meta, vers_schema, &combine_it, pairs, &count, &is_finish);
+        code = ScanIndex(request, *table_meta, vers_schema, &combine_it, filter.get(), pairs, &count, &is_finish);
     } else {
         auto* cntl = dynamic_cast<brpc::Controller*>(controller);
         butil::IOBuf& buf = cntl->response_attachment();
-        code = ScanIndex(request, *table_meta, vers_schema, &combine_it, &buf, &count, &is_finish);
+        code = ScanIndex(request, *table_meta, vers_schema, &combine_it, filter.get(), &buf, &count, &is_finish);
         response->set_buf_size(buf.size());
         DLOG(INFO) << " scan " << request->pk() << " with buf size " << buf.size();
     }
@@ -1414,6 +1713,21 @@ void TabletImpl::Traverse(RpcController* controller, const ::openmldb::api::Trav
         response->set_msg("idx name not found");
         return;
     }
+    std::unique_ptr<ScanFilter> filter;
+    if (!request->filter().empty()) {
+        filter = std::make_unique<ScanFilter>();
+        std::string msg;
+        auto table_meta = table->GetTableMeta();
+        if (!filter->Init(engine_.get(), table_meta->db(), table_meta->name(), request->filter(), &msg)) {
+            PDLOG(WARNING, "invalid filter %s. tid %u, pid %u, msg %s", request->filter().c_str(), tid, pid,
+                  msg.c_str());
+            response->set_code(::openmldb::base::ReturnCode::kInvalidParameter);
+            response->set_msg(msg);
+            return;
+        }
+    }
+    bool compressed = table->GetCompressType() == ::openmldb::type::kSnappy;
+    const auto* dict_codec = table->GetDictCodec();
     ::openmldb::storage::TableIterator* it = table->NewTraverseIterator(index_def->GetId());
     if (it == NULL) {
         response->set_code(::openmldb::base::ReturnCode::kTsNameNotFound);
@@ -1477,6 +1791,20 @@ void TabletImpl::Traverse(RpcController* controller, const ::openmldb::api::Trav
                 continue;
             }
         }
+        if (filter) {
+            std::string uncompressed;
+            openmldb::base::Slice row;
+            bool decoded = DecodeScanRow(it->GetValue(), compressed, dict_codec, &uncompressed, &row);
+            if (!decoded) {
+                PDLOG(WARNING, "fail to uncompress the row of key %s ts %lu, skip it", last_pk.c_str(), last_time);
+            }
+            if (!decoded || !filter->Match(row)) {
+                if (it->GetCount() >= FLAGS_max_traverse_cnt) {
+                    break;
+                }
+                continue;
+            }
+        }
         auto map_it = value_map.find(last_pk);
         if (map_it == value_map.end()) {
             auto pair = value_map.emplace(last_pk, std::vector<std::pair<uint64_t, openmldb::base::Slice>>());
@@ -1485,8 +1813,18 @@ void TabletImpl::Traverse(RpcController* controller, const ::openmldb::api::Trav
             key_seq.emplace_back(map_it->first);
         }
         openmldb::base::Slice value = it->GetValue();
-        map_it->second.emplace_back(it->GetKey(), value);
-        total_block_size += last_pk.length() + value.size();
+        if (dict_codec != nullptr) {
+            // the decoded row is copied, as value_map outlives the buffer
+            std::string decoded;
+            openmldb::base::Slice row;
+            DecodeScanRow(value, false, dict_codec, &decoded, &row);
+            char* buf = new char[row.size()];
+            memcpy(buf, row.data(), row.size());
+            map_it->second.emplace_back(it->GetKey(), openmldb::base::Slice(buf, row.size(), true));
+        } else {
+            map_it->second.emplace_back(it->GetKey(), value);
+        }
+        total_block_size += last_pk.length() + map_it->second.back().second.size();
         scount++;
         if (it->GetCount() >= FLAGS_max_traverse_cnt) {
             DEBUGLOG("traverse cnt %lu max %lu, key %s ts %lu", it->GetCount(), FLAGS_max_traverse_cnt, last_pk.c_str(),
@@ -1648,6 +1986,26 @@ void TabletImpl::ProcessQuery(RpcController* ctrl, const openmldb::api::QueryReq
     };
 
     ::hybridse::base::Status status;
+    if (request->is_batch() && request->is_stream() && request->has_query_id()) {
+        std::shared_ptr<BatchQueryCursor> cursor;
+        {
+            // the cursor is taken out while its page is filled, so it is never used concurrently
+            std::lock_guard<std::mutex> lock(batch_query_mu_);
+            auto it = batch_query_cursors_.find(request->query_id());
+            if (it != batch_query_cursors_.end()) {
+                cursor = it->second;
+                batch_query_cursors_.erase(it);
+            }
+        }
+        if (!cursor) {
+            response->set_code(::openmldb::base::kQueryCursorNotFound);
+            response->set_msg("query cursor not found, it may be expired");
+            DLOG(WARNING) << "query cursor " << request->query_id() << " not found";
+            return;
+        }
+        FillBatchQueryPage(request->query_id(), cursor, response, buf);
+        return;
+    }
     if (request->is_batch()) {
         // convert repeated openmldb:type::DataType into hybridse::codec::Schema
         hybridse::codec::Schema parameter_schema;
@@ -1687,6 +2045,21 @@ void TabletImpl::ProcessQuery(RpcController* ctrl, const openmldb::api::QueryReq
             response->set_msg("fail to decode parameter row");
             return;
         }
+        if (request->is_stream()) {
+            auto cursor = std::make_shared<BatchQueryCursor>();
+            int32_t run_ret = session.Run(parameter_row, &cursor->cursor);
+            if (run_ret != 0) {
+                response->set_msg(status.msg);
+                response->set_code(::openmldb::base::kSQLRunError);
+                DLOG(WARNING) << "fail to run sql: " << request->sql();
+                return;
+            }
+            cursor->schema = session.GetEncodedSchema();
+            cursor->sql = request->sql();
+            FillBatchQueryPage(batch_query_id_.fetch_add(1, std::memory_order_relaxed) + 1, cursor, response, buf);
+            return;
+        }
+        // the client does not support streaming, all the rows are returned in one response
         std::vector<::hybridse::codec::Row> output_rows;
         int32_t run_ret = session.Run(parameter_row, output_rows);
         if (run_ret != 0) {
@@ -1757,6 +2130,60 @@ void TabletImpl::ProcessQuery(RpcController* ctrl, const openmldb::api::QueryReq
     }
 }
 
+void TabletImpl::FillBatchQueryPage(uint64_t query_id, std::shared_ptr<BatchQueryCursor> cursor,
+                                    ::openmldb::api::QueryResponse* response, butil::IOBuf* buf) {
+    auto& iter = cursor->cursor;
+    uint32_t byte_size = 0;
+    uint32_t count = 0;
+    // a page holds one row at least, so a large row never blocks the query
+    while (iter->Valid() && (count == 0 || byte_size < FLAGS_scan_max_bytes_size)) {
+        const auto& output_row = iter->GetValue();
+        byte_size += output_row.size();
+        buf->append(reinterpret_cast<void*>(output_row.buf()), output_row.size());
+        count++;
+        iter->Next();
+    }
+    response->set_schema(cursor->schema);
+    response->set_byte_size(byte_size);
+    response->set_count(count);
+    response->set_code(::openmldb::base::kOk);
+    if (iter->Valid()) {
+        cursor->last_time = ::baidu::common::timer::get_micros() / 1000;
+        response->set_query_id(query_id);
+        response->set_is_finish(false);
+        std::lock_guard<std::mutex> lock(batch_query_mu_);
+        batch_query_cursors_.emplace(query_id, cursor);
+    } else {
+        response->set_is_finish(true);
+    }
+    DLOG(INFO) << "handle batch sql " << cursor->sql << " page of query " << query_id << " with record cnt "
+               << count << " byte size " << byte_size;
+}
+
+void TabletImpl::SchedCleanBatchQueryCursor() {
+    uint64_t cur_time = ::baidu::common::timer::get_micros() / 1000;
+    std::vector<std::shared_ptr<BatchQueryCursor>> expired_cursors;
+    {
+        std::lock_guard<std::mutex> lock(batch_query_mu_);
+        auto it = batch_query_cursors_.begin();
+        while (it != batch_query_cursors_.end()) {
+            if (it->second->last_time + FLAGS_batch_query_cursor_timeout_ms <= cur_time) {
+                expired_cursors.push_back(it->second);
+                it = batch_query_cursors_.erase(it);
+            } else {
+                it++;
+            }
+        }
+    }
+    for (const auto& cursor : expired_cursors) {
+        PDLOG(INFO, "release expired cursor of sql: %s", cursor->sql.c_str());
+    }
+    // the cursors are released out of the lock
+    expired_cursors.clear();
+    task_pool_.DelayTask(FLAGS_batch_query_cursor_timeout_ms,
+                         boost::bind(&TabletImpl::SchedCleanBatchQueryCursor, this));
+}
+
 void TabletImpl::SubQuery(RpcController* ctrl, const openmldb::api::QueryRequest* request,
                           openmldb::api::QueryResponse* response, Closure* done) {
     DLOG(INFO) << "handle subquery request begin!";
@@ -2222,7 +2649,7 @@ void TabletImpl::AppendEntries(RpcController* controller, const ::openmldb::api:
     response->set_code(::openmldb::base::ReturnCode::kOk);
     response->set_msg("ok");
     uint64_t last_log_offset = replicator->GetOffset();
-    if (request->pre_log_index() == 0 && request->entries_size() == 0) {
+    if (request->pre_log_index() == 0 && request->entries_size() == 0 && request->attachment_entry_cnt() == 0) {
         response->set_log_offset(last_log_offset);
         if (!FLAGS_zk_cluster.empty() && request->term() > term) {
             replicator->SetLeaderTerm(request->term());
@@ -2233,25 +2660,24 @@ void TabletImpl::AppendEntries(RpcController* controller, const ::openmldb::api:
         PDLOG(INFO, "first sync log_index! log_offset[%lu] tid[%u] pid[%u]", last_log_offset, tid, pid);
         return;
     }
-    for (int32_t i = 0; i < request->entries_size(); i++) {
-        const auto& entry = request->entries(i);
+    auto apply_entry = [&](const ::openmldb::api::LogEntry& entry) {
         if (entry.log_index() <= last_log_offset) {
-            PDLOG(WARNING, "entry log_index %lu cur log_offset %lu tid %u pid %u", request->entries(i).log_index(),
+            PDLOG(WARNING, "entry log_index %lu cur log_offset %lu tid %u pid %u", entry.log_index(),
                     last_log_offset, tid, pid);
-            continue;
+            return true;
         }
         if (!replicator->ApplyEntry(entry)) {
             PDLOG(WARNING, "fail to write binlog. tid %u pid %u", tid, pid);
             response->set_code(::openmldb::base::ReturnCode::kFailToAppendEntriesToReplicator);
             response->set_msg("fail to append entries to replicator");
-            return;
+            return false;
         }
         if (entry.has_method_type() && entry.method_type() == ::openmldb::api::MethodType::kDelete) {
             if (entry.dimensions_size() == 0) {
                 PDLOG(WARNING, "no dimesion. tid %u pid %u", tid, pid);
                 response->set_code(::openmldb::base::ReturnCode::kFailToAppendEntriesToReplicator);
                 response->set_msg("fail to append entries to replicator");
-                return;
+                return false;
             }
             table->Delete(entry.dimensions(0).key(), entry.dimensions(0).idx());
         }
@@ -2259,9 +2685,34 @@ void TabletImpl::AppendEntries(RpcController* controller, const ::openmldb::api:
             PDLOG(WARNING, "fail to put entry. tid %u pid %u", tid, pid);
             response->set_code(::openmldb::base::ReturnCode::kFailToAppendEntriesToReplicator);
             response->set_msg("fail to append entry to table");
+            return false;
+        }
+        return true;
+    };
+    for (int32_t i = 0; i < request->entries_size(); i++) {
+        if (!apply_entry(request->entries(i))) {
             return;
         }
     }
+    if (request->attachment_entry_cnt() > 0) {
+        // the entries are sent from the entry cache of leader
+        brpc::Controller* cntl = static_cast<brpc::Controller*>(controller);
+        butil::IOBuf& attachment = cntl->request_attachment();
+        std::string buffer;
+        ::openmldb::api::LogEntry entry;
+        for (uint32_t i = 0; i < request->attachment_entry_cnt(); i++) {
+            if (!::openmldb::replica::LogEntryCache::DecodeEntry(&attachment, &buffer) ||
+                !entry.ParseFromString(buffer)) {
+                PDLOG(WARNING, "fail to parse entry in attachment. tid %u pid %u", tid, pid);
+                response->set_code(::openmldb::base::ReturnCode::kFailToAppendEntriesToReplicator);
+                response->set_msg("fail to parse entry in attachment");
+                return;
+            }
+            if (!apply_entry(entry)) {
+                return;
+            }
+        }
+    }
     response->set_log_offset(replicator->GetOffset());
 }
 
@@ -2399,6 +2850,7 @@ void TabletImpl::GetTableStatus(RpcController* controller, const ::openmldb::api
                     status->set_is_expire(mem_table->GetExpireStatus());
                     status->set_record_byte_size(mem_table->GetRecordByteSize());
                     status->set_record_idx_byte_size(mem_table->GetRecordIdxByteSize());
+                    status->set_record_slab_frag_byte_size(mem_table->GetRecordSlabFragByteSize());
                     status->set_record_pk_cnt(mem_table->GetRecordPkCnt());
                     status->set_skiplist_height(mem_table->GetKeyEntryHeight());
                     uint64_t record_idx_cnt = 0;
@@ -3866,6 +4318,9 @@ int TabletImpl::CreateTableInternal(const ::openmldb::api::TableMeta* table_meta
         msg.assign("fail create replicator for table");
         return -1;
     }
+    if (log_syncer_) {
+        replicator->SetLogSyncer(log_syncer_);
+    }
     ok = replicator->Init();
     if (!ok) {
         PDLOG(WARNING, "fail to init replicator for table tid %u, pid %u", tid, pid);
@@ -4180,26 +4635,34 @@ std::shared_ptr<Aggrs> TabletImpl::GetAggregatorsUnLock(uint32_t tid, uint32_t p
     return std::shared_ptr<Aggrs>();
 }
 
-bool TabletImpl::UpdateAggrs(uint32_t tid, uint32_t pid, const std::string& value,
-                 const ::openmldb::storage::Dimensions& dimensions, uint64_t log_offset) {
+void TabletImpl::ReserveAggrs(uint32_t tid, uint32_t pid, const std::string& value,
+                              const ::openmldb::storage::Dimensions& dimensions, uint64_t log_offset,
+                              std::vector<AggrUpdate>* updates) {
     auto aggrs = GetAggregators(tid, pid);
     if (!aggrs) {
-        return true;
+        return;
     }
     for (auto iter = dimensions.begin(); iter != dimensions.end(); ++iter) {
         for (const auto& aggr : *aggrs) {
             if (aggr->GetIndexPos() != iter->idx()) {
                 continue;
             }
-            auto ok = aggr->Update(iter->key(), value, log_offset);
-            if (!ok) {
-                PDLOG(WARNING, "update aggr failed. tid[%u] pid[%u] index[%u] key[%s] value[%s]",
-                     tid, pid, iter->idx(), iter->key().c_str(), value.c_str());
-                return false;
-            }
+            updates->push_back({aggr, &iter->key(), &value, log_offset, aggr->ReserveUpdate(iter->key())});
         }
     }
-    return true;
+}
+
+bool TabletImpl::ApplyAggrs(uint32_t tid, uint32_t pid, const std::vector<AggrUpdate>& updates) {
+    bool ok = true;
+    // every reserved update is applied even if the former one fails, or the later puts of the shard will wait forever
+    for (const auto& update : updates) {
+        if (!update.aggr->Update(*update.key, *update.value, update.offset, update.ticket)) {
+            PDLOG(WARNING, "update aggr failed. tid[%u] pid[%u] index[%u] key[%s] value[%s]",
+                 tid, pid, update.aggr->GetIndexPos(), update.key->c_str(), update.value->c_str());
+            ok = false;
+        }
+    }
+    return ok;
 }
 
 
@@ -4446,17 +4909,17 @@ bool TabletImpl::RefreshAggrCatalog() {
     return true;
 }
 
-int TabletImpl::CheckDimessionPut(const ::openmldb::api::PutRequest* request, uint32_t idx_cnt) {
-    for (int32_t i = 0; i < request->dimensions_size(); i++) {
-        if (idx_cnt <= request->dimensions(i).idx()) {
+int TabletImpl::CheckDimessionPut(const ::openmldb::storage::Dimensions& dimensions, uint32_t idx_cnt) {
+    for (int32_t i = 0; i < dimensions.size(); i++) {
+        if (idx_cnt <= dimensions.Get(i).idx()) {
             PDLOG(WARNING,
                   "invalid put request dimensions, request idx %u is greater "
                   "than table idx cnt %u",
-                  request->dimensions(i).idx(), idx_cnt);
+                  dimensions.Get(i).idx(), idx_cnt);
             return -1;
         }
-        if (request->dimensions(i).key().length() <= 0) {
-            PDLOG(WARNING, "invalid put request dimension key is empty with idx %u", request->dimensions(i).idx());
+        if (dimensions.Get(i).key().length() <= 0) {
+            PDLOG(WARNING, "invalid put request dimension key is empty with idx %u", dimensions.Get(i).idx());
             return 1;
         }
     }
@@ -4464,6 +4927,10 @@ int TabletImpl::CheckDimessionPut(const ::openmldb::api::PutRequest* request, ui
 }
 
 void TabletImpl::SchedSyncDisk(uint32_t tid, uint32_t pid) {
+    if (log_syncer_) {
+        // binlog is synced by the group commit syncer
+        return;
+    }
     std::shared_ptr<LogReplicator> replicator = GetReplicator(tid, pid);
     if (replicator) {
         replicator->SyncToDisk();
@@ -5351,11 +5818,15 @@ void TabletImpl::CreateProcedure(RpcController* controller, const openmldb::api:
     ::hybridse::base::Status status;
     auto sp_info_impl = std::make_shared<openmldb::catalog::ProcedureInfoImpl>(sp_info);
 
-    auto long_windows = sp_info_impl->GetOption(hybridse::vm::LONG_WINDOWS);
     std::shared_ptr<std::unordered_map<std::string, std::string>> options = nullptr;
-    if (long_windows) {
-        options = std::make_shared<std::unordered_map<std::string, std::string>>();
-        options->emplace(hybridse::vm::LONG_WINDOWS, *long_windows);
+    for (const char* name : {hybridse::vm::LONG_WINDOWS, hybridse::vm::WINDOW_STATE_CACHE}) {
+        auto option = sp_info_impl->GetOption(name);
+        if (option) {
+            if (!options) {
+                options = std::make_shared<std::unordered_map<std::string, std::string>>();
+            }
+            options->emplace(name, *option);
+        }
     }
 
     // build for single request
@@ -5484,11 +5955,15 @@ void TabletImpl::CreateProcedure(const std::shared_ptr<hybridse::sdk::ProcedureI
     const std::string& db_name = sp_info->GetDbName();
     const std::string& sp_name = sp_info->GetSpName();
     const std::string& sql = sp_info->GetSql();
-    auto long_windows = sp_info->GetOption(hybridse::vm::LONG_WINDOWS);
     std::shared_ptr<std::unordered_map<std::string, std::string>> options = nullptr;
-    if (long_windows) {
-        options = std::make_shared<std::unordered_map<std::string, std::string>>();
-        options->emplace(hybridse::vm::LONG_WINDOWS, *long_windows);
+    for (const char* name : {hybridse::vm::LONG_WINDOWS, hybridse::vm::WINDOW_STATE_CACHE}) {
+        auto option = sp_info->GetOption(name);
+        if (option) {
+            if (!options) {
+                options = std::make_shared<std::unordered_map<std::string, std::string>>();
+            }
+            options->emplace(name, *option);
+        }
     }
 
     ::hybridse::base::Status status;
@@ -5518,6 +5993,11 @@ void TabletImpl::CreateProcedure(const std::shared_ptr<hybridse::sdk::ProcedureI
                                             batch_session.GetCompileInfo());
 
     LOG(INFO) << "refresh procedure success! sp_name: " << sp_name << ", db: " << db_name << ", sql: " << sql;
+    uint64_t hit_cnt = 0;
+    uint64_t miss_cnt = 0;
+    if (engine_->GetJitObjectCacheStat(&hit_cnt, &miss_cnt)) {
+        LOG(INFO) << "jit object cache hit " << hit_cnt << ", miss " << miss_cnt;
+    }
 }
 
 void TabletImpl::GetBulkLoadInfo(RpcController* controller, const ::openmldb::api::BulkLoadInfoRequest* request,
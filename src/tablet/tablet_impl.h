@@ -19,6 +19,7 @@
 
 #include <brpc/server.h>
 
+#include <atomic>
 #include <list>
 #include <map>
 #include <memory>
@@ -42,6 +43,7 @@
 #include "tablet/bulk_load_mgr.h"
 #include "tablet/combine_iterator.h"
 #include "tablet/file_receiver.h"
+#include "tablet/scan_filter.h"
 #include "tablet/sp_cache.h"
 #include "vm/engine.h"
 #include "zk/zk_client.h"
@@ -71,6 +73,14 @@ typedef std::map<uint32_t, std::map<uint32_t, std::shared_ptr<LogReplicator>>> R
 typedef std::map<uint32_t, std::map<uint32_t, std::shared_ptr<Snapshot>>> Snapshots;
 typedef std::map<uint64_t, std::shared_ptr<Aggrs>> Aggregators;
 
+// the running state of a streaming batch query, its result is fetched page by page
+struct BatchQueryCursor {
+    std::unique_ptr<::hybridse::vm::BatchRunCursor> cursor;
+    std::string schema;
+    std::string sql;
+    uint64_t last_time;
+};
+
 class TabletImpl : public ::openmldb::api::TabletServer {
  public:
     TabletImpl();
@@ -86,6 +96,9 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     void Put(RpcController* controller, const ::openmldb::api::PutRequest* request,
              ::openmldb::api::PutResponse* response, Closure* done);
 
+    void PutBatch(RpcController* controller, const ::openmldb::api::PutBatchRequest* request,
+                  ::openmldb::api::PutBatchResponse* response, Closure* done);
+
     void Get(RpcController* controller, const ::openmldb::api::GetRequest* request,
              ::openmldb::api::GetResponse* response, Closure* done);
 
@@ -249,11 +262,11 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     // scan specified ttl type index
     int32_t ScanIndex(const ::openmldb::api::ScanRequest* request, const ::openmldb::api::TableMeta& meta,
                       const std::map<int32_t, std::shared_ptr<Schema>>& vers_schema, CombineIterator* combine_it,
-                      std::string* pairs, uint32_t* count, bool* is_finish);
+                      ScanFilter* filter, std::string* pairs, uint32_t* count, bool* is_finish);
 
     int32_t ScanIndex(const ::openmldb::api::ScanRequest* request, const ::openmldb::api::TableMeta& meta,
                       const std::map<int32_t, std::shared_ptr<Schema>>& vers_schema, CombineIterator* combine_it,
-                      butil::IOBuf* buf, uint32_t* count, bool* is_finish);
+                      ScanFilter* filter, butil::IOBuf* buf, uint32_t* count, bool* is_finish);
 
     int32_t CountIndex(uint64_t expire_time, uint64_t expire_cnt, ::openmldb::storage::TTLType ttl_type,
                        ::openmldb::storage::TableIterator* it, const ::openmldb::api::CountRequest* request,
@@ -386,7 +399,7 @@ class TabletImpl : public ::openmldb::api::TabletServer {
 
     std::shared_ptr<::openmldb::api::TaskInfo> FindMultiTask(const ::openmldb::api::TaskInfo& task_info);
 
-    int CheckDimessionPut(const ::openmldb::api::PutRequest* request, uint32_t idx_cnt);
+    int CheckDimessionPut(const ::openmldb::storage::Dimensions& dimensions, uint32_t idx_cnt);
 
     // sync log data from page cache to disk
     void SchedSyncDisk(uint32_t tid, uint32_t pid);
@@ -417,6 +430,12 @@ class TabletImpl : public ::openmldb::api::TabletServer {
 
     void SchedDelRecycle();
 
+    void SchedCleanBatchQueryCursor();
+
+    // fill the rows of cursor into buf until it reaches FLAGS_scan_max_bytes_size
+    void FillBatchQueryPage(uint64_t query_id, std::shared_ptr<BatchQueryCursor> cursor,
+                            ::openmldb::api::QueryResponse* response, butil::IOBuf* buf);
+
     bool GetRealEp(uint64_t tid, uint64_t pid, std::map<std::string, std::string>* real_ep_map);
 
     void ProcessQuery(RpcController* controller, const openmldb::api::QueryRequest* request,
@@ -425,8 +444,21 @@ class TabletImpl : public ::openmldb::api::TabletServer {
                                   openmldb::api::SQLBatchRequestQueryResponse* response,
                                   butil::IOBuf& buf);  // NOLINT
 
-    bool UpdateAggrs(uint32_t tid, uint32_t pid, const std::string& value,
-                     const ::openmldb::storage::Dimensions& dimensions, uint64_t log_offset);
+    // an aggregator update of a put row, its order is reserved within the replicator lock and
+    // it's applied out of the lock, so the updates of different keys don't serialize on the binlog
+    struct AggrUpdate {
+        std::shared_ptr<::openmldb::storage::Aggregator> aggr;
+        const std::string* key;
+        const std::string* value;
+        uint64_t offset;
+        ::openmldb::storage::Aggregator::UpdateTicket ticket;
+    };
+
+    void ReserveAggrs(uint32_t tid, uint32_t pid, const std::string& value,
+                      const ::openmldb::storage::Dimensions& dimensions, uint64_t log_offset,
+                      std::vector<AggrUpdate>* updates);
+
+    bool ApplyAggrs(uint32_t tid, uint32_t pid, const std::vector<AggrUpdate>& updates);
 
     bool CreateAggregatorInternal(const ::openmldb::api::CreateAggregatorRequest* request,
                                   std::string& msg); //NOLINT
@@ -464,6 +496,8 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     ThreadPool task_pool_;
     ThreadPool io_pool_;
     ThreadPool snapshot_pool_;
+    // group commit syncer of binlog, it is null if binlog_group_commit is false
+    std::shared_ptr<::openmldb::replica::LogSyncer> log_syncer_;
     std::map<uint64_t, std::list<std::shared_ptr<::openmldb::api::TaskInfo>>> task_map_;
     std::set<std::string> sync_snapshot_set_;
     std::map<std::string, std::shared_ptr<FileReceiver>> file_receiver_map_;
@@ -491,6 +525,10 @@ class TabletImpl : public ::openmldb::api::TabletServer {
     std::shared_ptr<std::map<std::string, std::string>> global_variables_;
 
     std::unique_ptr<openmldb::statistics::DeployQueryTimeCollector> deploy_collector_;
+
+    std::mutex batch_query_mu_;
+    std::map<uint64_t, std::shared_ptr<BatchQueryCursor>> batch_query_cursors_;
+    std::atomic<uint64_t> batch_query_id_;
 };
 
 }  // namespace tablet
@@ -18,11 +18,13 @@
 #include <gflags/gflags.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
 #include <google/protobuf/text_format.h>
+#include <snappy.h>
 #include <sys/stat.h>
 
 #include "base/file_util.h"
 #include "base/glog_wrapper.h"
 #include "base/kv_iterator.h"
+#include "base/status.h"
 #include "base/strings.h"
 #include "brpc/channel.h"
 #include "codec/row_codec.h"
@@ -673,6 +675,110 @@ TEST_P(TabletProjectTest, scan_case) {
     }
 }
 
+TEST_P(TabletProjectTest, scan_filter_case) {
+    auto args = GetParam();
+    // create a compressed table
+    std::string name = "t" + ::openmldb::tablet::GenRand();
+    std::string db = "db" + name;
+    int tid = rand() % 10000000;  // NOLINT
+    MockClosure closure;
+    {
+        ::openmldb::api::CreateTableRequest crequest;
+        ::openmldb::api::TableMeta* table_meta = crequest.mutable_table_meta();
+        table_meta->set_db(db);
+        table_meta->set_name(name);
+        table_meta->set_tid(tid);
+        table_meta->set_pid(0);
+        table_meta->set_seg_cnt(8);
+        table_meta->set_mode(::openmldb::api::TableMode::kTableLeader);
+        table_meta->set_key_entry_max_height(8);
+        table_meta->set_storage_mode(args->storage_mode);
+        table_meta->set_compress_type(::openmldb::type::kSnappy);
+        Schema* schema = table_meta->mutable_column_desc();
+        schema->CopyFrom(args->schema);
+        ::openmldb::common::ColumnKey* ck = table_meta->add_column_key();
+        ck->CopyFrom(args->ckey);
+        ::openmldb::api::CreateTableResponse cresponse;
+        tablet_.CreateTable(NULL, &crequest, &cresponse, &closure);
+        ASSERT_EQ(0, cresponse.code());
+    }
+    {
+        ::openmldb::api::PutRequest request;
+        request.set_tid(tid);
+        request.set_pid(0);
+        ::openmldb::api::Dimension* dim = request.add_dimensions();
+        dim->set_idx(0);
+        dim->set_key(args->pk);
+        std::string value;
+        ::snappy::Compress(args->input_row.data(), args->input_row.size(), &value);
+        request.set_value(value);
+        ::openmldb::api::PutResponse response;
+        tablet_.Put(NULL, &request, &response, &closure);
+        ASSERT_EQ(0, response.code());
+    }
+    auto scan = [&](const std::string& filter, std::shared_ptr<::openmldb::api::ScanResponse> srp) {
+        ::openmldb::api::ScanRequest sr;
+        sr.set_tid(tid);
+        sr.set_pid(0);
+        sr.set_pk(args->pk);
+        sr.set_st(args->ts);
+        sr.set_et(0);
+        sr.set_filter(filter);
+        sr.mutable_projection()->CopyFrom(args->plist);
+        tablet_.Scan(NULL, &sr, srp.get(), &closure);
+    };
+    {
+        auto srp = std::make_shared<::openmldb::api::ScanResponse>();
+        scan("col1 is null or col1 is not null", srp);
+        ASSERT_EQ(0, srp->code());
+        ASSERT_EQ(1, (int64_t)srp->count());
+        ::openmldb::base::ScanKvIterator kv_it(args->pk, srp);
+        ASSERT_TRUE(kv_it.Valid());
+        // the projected row is compressed as the table
+        std::string value;
+        ::snappy::Uncompress(kv_it.GetValue().data(), kv_it.GetValue().size(), &value);
+        ASSERT_EQ(value.size(), args->output_row.size());
+        codec::RowView left(args->output_schema);
+        left.Reset(reinterpret_cast<const int8_t*>(value.data()), value.size());
+        codec::RowView right(args->output_schema);
+        right.Reset(reinterpret_cast<int8_t*>(args->output_row.data()), args->output_row.size());
+        CompareRow(&left, &right, args->output_schema);
+    }
+    {
+        auto srp = std::make_shared<::openmldb::api::ScanResponse>();
+        scan("col1 is null and col1 is not null", srp);
+        ASSERT_EQ(0, srp->code());
+        ASSERT_EQ(0, (int64_t)srp->count());
+    }
+    {
+        auto srp = std::make_shared<::openmldb::api::ScanResponse>();
+        scan("col_not_exist > 0", srp);
+        ASSERT_EQ(::openmldb::base::ReturnCode::kInvalidParameter, srp->code());
+    }
+    {
+        // the filter is not allowed to change the sql it is pasted into
+        std::vector<std::string> filters = {"true) AS c FROM `" + name + "` --",
+                                            "col1 is null) AS __scan_filter, (true",
+                                            "true) AS __scan_filter FROM `" + name + "` LIMIT 1 --"};
+        for (const auto& filter : filters) {
+            auto srp = std::make_shared<::openmldb::api::ScanResponse>();
+            scan(filter, srp);
+            ASSERT_EQ(::openmldb::base::ReturnCode::kInvalidParameter, srp->code()) << filter;
+        }
+    }
+    {
+        ::openmldb::api::TraverseRequest request;
+        request.set_tid(tid);
+        request.set_pid(0);
+        request.set_filter("col1 is null and col1 is not null");
+        ::openmldb::api::TraverseResponse response;
+        tablet_.Traverse(NULL, &request, &response, &closure);
+        ASSERT_EQ(0, response.code());
+        ASSERT_EQ(0, (int64_t)response.count());
+        ASSERT_TRUE(response.is_finish());
+    }
+}
+
 INSTANTIATE_TEST_SUITE_P(TabletProjectPrefix, TabletProjectTest, testing::ValuesIn(GenCommonCase()));
 
 }  // namespace tablet
@@ -59,6 +59,8 @@ DECLARE_string(recycle_bin_ssd_root_path);
 DECLARE_string(recycle_bin_hdd_root_path);
 DECLARE_string(endpoint);
 DECLARE_uint32(recycle_ttl);
+DECLARE_uint32(scan_max_bytes_size);
+DECLARE_uint32(scan_zero_copy_row_size);
 
 namespace openmldb {
 namespace tablet {
@@ -411,6 +413,226 @@ TEST_F(TabletImplTest, ChangeRole) {
     }
 }
 
+TEST_F(TabletImplTest, StreamBatchQuery) {
+    TabletImpl tablet;
+    tablet.Init("");
+    MockClosure closure;
+    uint32_t id = counter++;
+    ASSERT_EQ(0, CreateDefaultTable("db0", "t0", id, 0, 0, 0, kLatestTime, common::kMemory, &tablet));
+    for (int i = 0; i < 100; i++) {
+        PutKVData(id, 0, "key" + std::to_string(i), std::string(100, 'v'), i + 1, &tablet);
+    }
+    uint32_t old_max_bytes_size = FLAGS_scan_max_bytes_size;
+    FLAGS_scan_max_bytes_size = 1000;
+    uint32_t total_cnt = 0;
+    uint32_t page_cnt = 0;
+    uint64_t query_id = 0;
+    {
+        ::openmldb::api::QueryRequest request;
+        request.set_db("db0");
+        request.set_sql("select * from t0;");
+        request.set_is_batch(true);
+        request.set_is_stream(true);
+        request.set_parameter_row_size(0);
+        request.set_parameter_row_slices(1);
+        ::openmldb::api::QueryResponse response;
+        brpc::Controller cntl;
+        tablet.Query(&cntl, &request, &response, &closure);
+        ASSERT_EQ(0, response.code());
+        ASSERT_FALSE(response.is_finish());
+        ASSERT_GT(response.count(), 0u);
+        ASSERT_LT(response.count(), 100u);
+        ASSERT_EQ(response.byte_size(), cntl.response_attachment().size());
+        total_cnt += response.count();
+        page_cnt++;
+        query_id = response.query_id();
+    }
+    while (true) {
+        ::openmldb::api::QueryRequest request;
+        request.set_is_batch(true);
+        request.set_is_stream(true);
+        request.set_query_id(query_id);
+        ::openmldb::api::QueryResponse response;
+        brpc::Controller cntl;
+        tablet.Query(&cntl, &request, &response, &closure);
+        ASSERT_EQ(0, response.code());
+        ASSERT_EQ(response.byte_size(), cntl.response_attachment().size());
+        total_cnt += response.count();
+        page_cnt++;
+        if (response.is_finish()) {
+            break;
+        }
+        ASSERT_EQ(query_id, response.query_id());
+    }
+    ASSERT_EQ(100u, total_cnt);
+    ASSERT_GT(page_cnt, 2u);
+    {
+        // the cursor is released after the last page
+        ::openmldb::api::QueryRequest request;
+        request.set_is_batch(true);
+        request.set_is_stream(true);
+        request.set_query_id(query_id);
+        ::openmldb::api::QueryResponse response;
+        brpc::Controller cntl;
+        tablet.Query(&cntl, &request, &response, &closure);
+        ASSERT_EQ(::openmldb::base::kQueryCursorNotFound, response.code());
+    }
+    {
+        // the request without is_stream is answered in one response
+        ::openmldb::api::QueryRequest request;
+        request.set_db("db0");
+        request.set_sql("select * from t0;");
+        request.set_is_batch(true);
+        request.set_parameter_row_size(0);
+        request.set_parameter_row_slices(1);
+        ::openmldb::api::QueryResponse response;
+        brpc::Controller cntl;
+        tablet.Query(&cntl, &request, &response, &closure);
+        ASSERT_EQ(0, response.code());
+        ASSERT_TRUE(response.is_finish());
+    }
+    FLAGS_scan_max_bytes_size = old_max_bytes_size;
+}
+
+TEST_F(TabletImplTest, ScanZeroCopy) {
+    TabletImpl tablet;
+    tablet.Init("");
+    MockClosure closure;
+    uint32_t id = counter++;
+    ASSERT_EQ(0, CreateDefaultTable("db0", "t0", id, 0, 0, 0, kLatestTime, common::kMemory, &tablet));
+    for (int i = 0; i < 50; i++) {
+        PutKVData(id, 0, "key", std::string(i * 40, 'a' + i % 26), i + 1, &tablet);
+    }
+    uint32_t old_zero_copy_row_size = FLAGS_scan_zero_copy_row_size;
+    auto scan = [&](uint32_t zero_copy_row_size) {
+        FLAGS_scan_zero_copy_row_size = zero_copy_row_size;
+        ::openmldb::api::ScanRequest sr;
+        sr.set_tid(id);
+        sr.set_pid(0);
+        sr.set_pk("key");
+        sr.set_st(0);
+        sr.set_et(0);
+        sr.set_use_attachment(true);
+        ::openmldb::api::ScanResponse srp;
+        brpc::Controller cntl;
+        tablet.Scan(&cntl, &sr, &srp, &closure);
+        EXPECT_EQ(0, srp.code());
+        EXPECT_EQ(50u, srp.count());
+        EXPECT_EQ(srp.buf_size(), cntl.response_attachment().size());
+        return cntl.response_attachment().to_string();
+    };
+    std::string expect = scan(0);
+    // all rows, part of rows and the last row only are referred
+    ASSERT_EQ(expect, scan(1));
+    ASSERT_EQ(expect, scan(1000));
+    ASSERT_EQ(expect, scan(1960));
+    ASSERT_EQ(expect, scan(1000000));
+    FLAGS_scan_zero_copy_row_size = old_zero_copy_row_size;
+}
+
+TEST_F(TabletImplTest, ScanFilterTraverseLimit) {
+    TabletImpl tablet;
+    tablet.Init("");
+    MockClosure closure;
+    uint32_t id = counter++;
+    ASSERT_EQ(0, CreateDefaultTable("db0", "t0", id, 0, 0, 0, kLatestTime, common::kMemory, &tablet));
+    for (int i = 0; i < 100; i++) {
+        ASSERT_EQ(0, PutKVData(id, 0, "key", i % 10 == 0 ? "hit" : "miss", i + 1, &tablet));
+    }
+    uint32_t old_max_traverse_cnt = FLAGS_max_traverse_cnt;
+    FLAGS_max_traverse_cnt = 20;
+    auto scan = [&](const std::string& filter, bool use_attachment, uint32_t expect_cnt, bool expect_finish) {
+        ::openmldb::api::ScanRequest sr;
+        sr.set_tid(id);
+        sr.set_pid(0);
+        sr.set_pk("key");
+        sr.set_st(0);
+        sr.set_et(0);
+        sr.set_filter(filter);
+        sr.set_use_attachment(use_attachment);
+        ::openmldb::api::ScanResponse srp;
+        brpc::Controller cntl;
+        tablet.Scan(&cntl, &sr, &srp, &closure);
+        ASSERT_EQ(0, srp.code());
+        ASSERT_EQ(expect_cnt, srp.count());
+        ASSERT_EQ(expect_finish, srp.is_finish());
+    };
+    for (bool use_attachment : {false, true}) {
+        // the scan stops after the filter rejects max_traverse_cnt rows
+        scan("value = 'none'", use_attachment, 0, false);
+        scan("value = 'hit'", use_attachment, 2, false);
+        scan("value <> 'none'", use_attachment, 100, true);
+    }
+    FLAGS_max_traverse_cnt = old_max_traverse_cnt;
+}
+
+TEST_F(TabletImplTest, ScanAndTraverseSingleRowLayout) {
+    TabletImpl tablet;
+    tablet.Init("");
+    MockClosure closure;
+    uint32_t id = counter++;
+    ::openmldb::api::CreateTableRequest request;
+    ::openmldb::api::TableMeta* table_meta = request.mutable_table_meta();
+    table_meta->set_name("t0");
+    table_meta->set_tid(id);
+    table_meta->set_pid(0);
+    table_meta->set_mode(::openmldb::api::TableMode::kTableLeader);
+    table_meta->set_storage_mode(common::kHDD);
+    table_meta->set_disk_row_layout(common::kSingleRow);
+    AddDefaultSchema(0, 0, kAbsoluteTime, table_meta);
+    ::openmldb::api::CreateTableResponse response;
+    tablet.CreateTable(NULL, &request, &response, &closure);
+    ASSERT_EQ(0, response.code());
+    // more rows than a read ahead batch of the row ref resolver in each key
+    const int row_num = 100;
+    for (int i = 0; i < row_num; i++) {
+        ASSERT_EQ(0, PutKVData(id, 0, "key1", "value1_" + std::to_string(i), i + 1, &tablet));
+        ASSERT_EQ(0, PutKVData(id, 0, "key2", "value2_" + std::to_string(i), i + 1, &tablet));
+    }
+    {
+        ::openmldb::api::ScanRequest sr;
+        sr.set_tid(id);
+        sr.set_pid(0);
+        sr.set_pk("key1");
+        sr.set_st(0);
+        sr.set_et(0);
+        auto srp = std::make_shared<::openmldb::api::ScanResponse>();
+        tablet.Scan(NULL, &sr, srp.get(), &closure);
+        ASSERT_EQ(0, srp->code());
+        ASSERT_EQ(row_num, (signed)srp->count());
+        ::openmldb::base::ScanKvIterator kv_it(sr.pk(), srp);
+        for (int i = row_num - 1; i >= 0; i--) {
+            ASSERT_TRUE(kv_it.Valid());
+            ASSERT_EQ(static_cast<uint64_t>(i + 1), kv_it.GetKey());
+            ASSERT_EQ("value1_" + std::to_string(i), ::openmldb::test::DecodeV(kv_it.GetValue().ToString()));
+            kv_it.Next();
+        }
+        ASSERT_FALSE(kv_it.Valid());
+    }
+    {
+        ::openmldb::api::TraverseRequest sr;
+        sr.set_tid(id);
+        sr.set_pid(0);
+        sr.set_limit(1000);
+        auto srp = std::make_shared<::openmldb::api::TraverseResponse>();
+        tablet.Traverse(NULL, &sr, srp.get(), &closure);
+        ASSERT_EQ(0, srp->code());
+        ASSERT_EQ(2 * row_num, (signed)srp->count());
+        ::openmldb::base::TraverseKvIterator kv_it(srp);
+        for (const std::string key : {"key1", "key2"}) {
+            for (int i = row_num - 1; i >= 0; i--) {
+                ASSERT_TRUE(kv_it.Valid());
+                ASSERT_EQ(key, kv_it.GetPK());
+                ASSERT_EQ(static_cast<uint64_t>(i + 1), kv_it.GetKey());
+                ASSERT_EQ("value" + key.substr(3) + "_" + std::to_string(i),
+                          ::openmldb::test::DecodeV(kv_it.GetValue().ToString()));
+                kv_it.Next();
+            }
+        }
+        ASSERT_FALSE(kv_it.Valid());
+    }
+}
+
 TEST_P(TabletImplTest, CountLatestTable) {
     ::openmldb::common::StorageMode storage_mode = GetParam();
     TabletImpl tablet;
@@ -1380,6 +1602,51 @@ TEST_P(TabletImplTest, ScanWithDuplicateSkip) {
     ASSERT_EQ(3, (signed)srp.count());
 }
 
+TEST_P(TabletImplTest, PutBatch) {
+    ::openmldb::common::StorageMode storage_mode = GetParam();
+    TabletImpl tablet;
+    uint32_t id = counter++;
+    tablet.Init("");
+    ASSERT_EQ(0, CreateDefaultTable("", "t0", id, 1, 0, 0, kAbsoluteTime, storage_mode, &tablet));
+    MockClosure closure;
+    ::openmldb::api::PutBatchRequest prequest;
+    prequest.set_tid(id);
+    prequest.set_pid(1);
+    for (int i = 0; i < 10; i++) {
+        auto row = prequest.add_rows();
+        std::string key = "test" + std::to_string(i % 2);
+        auto dim = row->add_dimensions();
+        dim->set_key(key);
+        dim->set_idx(0);
+        row->set_time(9520 + i);
+        row->set_value(::openmldb::test::EncodeKV(key, "value" + std::to_string(i)));
+    }
+    ::openmldb::api::PutBatchResponse presponse;
+    tablet.PutBatch(NULL, &prequest, &presponse, &closure);
+    ASSERT_EQ(0, presponse.code());
+    ASSERT_EQ(10u, presponse.put_cnt());
+
+    ::openmldb::api::ScanRequest sr;
+    sr.set_tid(id);
+    sr.set_pid(1);
+    sr.set_pk("test0");
+    sr.set_st(9530);
+    sr.set_et(0);
+    ::openmldb::api::ScanResponse srp;
+    tablet.Scan(NULL, &sr, &srp, &closure);
+    ASSERT_EQ(0, srp.code());
+    ASSERT_EQ(5, (signed)srp.count());
+
+    // invalid dimension idx rejects the whole batch
+    prequest.mutable_rows(3)->mutable_dimensions(0)->set_idx(10);
+    tablet.PutBatch(NULL, &prequest, &presponse, &closure);
+    ASSERT_EQ(::openmldb::base::ReturnCode::kInvalidDimensionParameter, presponse.code());
+    ASSERT_EQ(0u, presponse.put_cnt());
+    tablet.Scan(NULL, &sr, &srp, &closure);
+    ASSERT_EQ(0, srp.code());
+    ASSERT_EQ(5, (signed)srp.count());
+}
+
 TEST_P(TabletImplTest, ScanWithLatestN) {
     ::openmldb::common::StorageMode storage_mode = GetParam();
     TabletImpl tablet;